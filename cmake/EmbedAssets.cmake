@@ -0,0 +1,55 @@
+# Generates a C++ source file that embeds asset files as byte arrays.
+#
+# Usage (script mode):
+#   cmake -DASSET_ROOT=<dir containing assets/> -DOUTPUT=<file.cpp> -DASSETS=<a;b;c> -P EmbedAssets.cmake
+#
+# ASSETS holds paths relative to ASSET_ROOT, for example `assets/fonts/Inter-Variable.ttf`; the
+# same relative path is used as the lookup key at runtime.
+
+if (NOT DEFINED ASSET_ROOT OR NOT DEFINED OUTPUT OR NOT DEFINED ASSETS)
+    message(FATAL_ERROR "EmbedAssets.cmake requires ASSET_ROOT, OUTPUT and ASSETS")
+endif()
+
+string(REPLACE "|" ";" ASSETS "${ASSETS}")
+
+set(_byte_pattern "[0-9a-f][0-9a-f]")
+set(_line_pattern "")
+foreach(_i RANGE 1 24)
+    string(APPEND _line_pattern "${_byte_pattern}")
+endforeach()
+
+set(_content "// Generated by cmake/EmbedAssets.cmake. Do not edit.\n")
+string(APPEND _content "#include \"app/EmbeddedAssets.hpp\"\n\n")
+string(APPEND _content "namespace app::embedded {\n\nnamespace {\n\n")
+
+set(_table "")
+set(_index 0)
+foreach(_asset IN LISTS ASSETS)
+    file(READ "${ASSET_ROOT}/${_asset}" _hex HEX)
+    file(SIZE "${ASSET_ROOT}/${_asset}" _size)
+    if (_size EQUAL 0)
+        message(FATAL_ERROR "Cannot embed empty asset: ${_asset}")
+    endif()
+
+    string(REGEX REPLACE "(${_line_pattern})" "\\1\n" _hex "${_hex}")
+    string(REGEX REPLACE "(${_byte_pattern})" "0x\\1," _hex "${_hex}")
+
+    string(APPEND _content "// ${_asset}\n")
+    string(APPEND _content "const unsigned char kAsset${_index}[] = {\n${_hex}\n};\n\n")
+    string(APPEND _table "    {\"${_asset}\", kAsset${_index}, ${_size}U},\n")
+    math(EXPR _index "${_index} + 1")
+endforeach()
+
+string(APPEND _content "} // namespace\n\n")
+string(APPEND _content "const EmbeddedAsset kAssets[] = {\n${_table}};\n\n")
+string(APPEND _content "const std::size_t kAssetCount = ${_index};\n\n")
+string(APPEND _content "} // namespace app::embedded\n")
+
+# Only touch the output when it changes so dependent objects are not rebuilt needlessly.
+set(_existing "")
+if (EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" _existing)
+endif()
+if (NOT _existing STREQUAL _content)
+    file(WRITE "${OUTPUT}" "${_content}")
+endif()
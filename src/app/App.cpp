@@ -1,7 +1,15 @@
 #include "app/App.hpp"
 #include "app/AssetResolver.hpp"
+#include "app/EventLog.hpp"
+#include "app/MetricsExporter.hpp"
+#include "app/SettingsStore.hpp"
+#include "app/SliceScheduler.hpp"
 #include "app/SoundManager.hpp"
+#include "app/StartupProfiler.hpp"
 #include "core/Game.hpp"
+#include "core/Heuristics.hpp"
+#include "core/Metrics.hpp"
+#include "core/MoveSearch.hpp"
 #include "core/ScoreManager.hpp"
 
 #include <SFML/Graphics.hpp>
@@ -12,6 +20,8 @@
 #include <cmath>
 #include <cstdint>
 #include <filesystem>
+#include <fstream>
+#include <future>
 #include <iostream>
 #include <optional>
 #include <set>
@@ -48,6 +58,9 @@ constexpr float kFloatingScoreDuration = 0.85f;
 
 constexpr float kPi = 3.14159265358979323846f;
 
+// The hint search deepens up to this many moves; later depths finish over several frames.
+constexpr int kHintMaxDepth = 5;
+
 const sf::Color kBoardBackgroundColor(250, 248, 239);
 const sf::Color kEmptyTileColor(205, 193, 180);
 const sf::Color kPrimaryButtonColor(0, 150, 255);
@@ -76,6 +89,7 @@ enum class SceneCommand {
     ShowSplash,
     RestartGame,
     ToggleSound,
+    RequestHint,
     Quit
 };
 
@@ -362,6 +376,32 @@ std::optional<core2048::Direction> mapDirection(const sf::Keyboard::Key key) {
     }
 }
 
+sf::String directionLabel(const sf::Font &font, const core2048::Direction direction) {
+    switch (direction) {
+    case core2048::Direction::Up:
+        return toUnicode("YUKARI");
+    case core2048::Direction::Down:
+        return localizedText(font, "AŞAĞI", "ASAGI");
+    case core2048::Direction::Left:
+        return toUnicode("SOL");
+    case core2048::Direction::Right:
+        return localizedText(font, "SAĞ", "SAG");
+    }
+    return {};
+}
+
+// 950, 12K, 3.4M.
+std::string compactCount(const std::uint64_t count) {
+    if (count >= 1'000'000U) {
+        return std::to_string(count / 1'000'000U) + "." + std::to_string(count / 100'000U % 10U) +
+               "M";
+    }
+    if (count >= 1'000U) {
+        return std::to_string(count / 1'000U) + "K";
+    }
+    return std::to_string(count);
+}
+
 BoardCell cellAtLineIndex(const int line, const int index, const core2048::Direction direction) {
     switch (direction) {
     case core2048::Direction::Left:
@@ -428,6 +468,70 @@ MoveVisualPlan buildMoveVisualPlan(const core2048::Game::Grid &beforeGrid,
     return plan;
 }
 
+// Font bytes gathered off the main thread; `sf::Font::loadFromMemory` keeps pointing at them, so
+// the source must outlive the font.
+struct FontSource {
+    std::optional<app::AssetBytes> inMemory;
+    app::AssetResolution resolution;
+    std::vector<char> fileBytes;
+};
+
+struct SettingsAndSoundResult {
+    bool settingsLoaded{false};
+    bool soundsLoaded{false};
+};
+
+bool readFileBytes(const std::filesystem::path &path, std::vector<char> &bytes) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    bytes.resize(static_cast<std::size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(in);
+}
+
+void readFontFile(FontSource &source) {
+    source.resolution = app::resolveAssetPath(kFontRelativePath);
+    if (!source.resolution.resolvedPath.has_value() ||
+        !readFileBytes(*source.resolution.resolvedPath, source.fileBytes)) {
+        source.fileBytes.clear();
+    }
+}
+
+FontSource readFontSource() {
+    FontSource source;
+    source.inMemory = app::findInMemoryAsset(kFontRelativePath);
+    if (!source.inMemory.has_value()) {
+        readFontFile(source);
+    }
+    return source;
+}
+
+bool loadFontAsset(sf::Font &font, FontSource &source) {
+    if (source.inMemory.has_value()) {
+        if (font.loadFromMemory(source.inMemory->data(), source.inMemory->size())) {
+            return true;
+        }
+        std::cerr << "Uyarı: paketlenmiş font yüklenemedi, dosyadan deneniyor: "
+                  << kFontRelativePath << "\n";
+        readFontFile(source);
+    }
+
+    if (!source.fileBytes.empty() &&
+        font.loadFromMemory(source.fileBytes.data(), source.fileBytes.size())) {
+        return true;
+    }
+
+    std::cerr << "Font yüklenemedi. Denenen yollar:\n";
+    for (const auto &candidate : source.resolution.candidates) {
+        std::cerr << "  - " << candidate.string() << "\n";
+    }
+    return false;
+}
+
 std::filesystem::path resolveScoreFilePath() {
     std::error_code ec;
     const auto cwd = std::filesystem::current_path(ec);
@@ -800,7 +904,8 @@ class HighScoresScene {
 class PlayingScene {
   public:
     explicit PlayingScene(const sf::Font &font)
-        : scoreText_("", font, 24), bestText_("", font, 20),
+        : scoreText_("", font, 24), bestText_("", font, 20), hintText_("", font, 18),
+          hintDetailText_("", font, 13),
           menuButton_({46.f, 46.f}, kButtonCornerRadius, kRoundedCornerPointCount),
           menuPanel_({206.f, 112.f}, kButtonCornerRadius, kRoundedCornerPointCount),
           menuNewGameButton_({182.f, 40.f}, kButtonCornerRadius, kRoundedCornerPointCount),
@@ -809,6 +914,9 @@ class PlayingScene {
           menuSoundText_("", font, 18) {
         scoreText_.setFillColor(sf::Color::Black);
         bestText_.setFillColor(sf::Color(40, 40, 40));
+        hintText_.setFillColor(sf::Color(40, 40, 40));
+        hintText_.setStyle(sf::Text::Bold);
+        hintDetailText_.setFillColor(sf::Color(110, 100, 86));
 
         menuButton_.setFillColor(kMenuButtonColor);
         menuButton_.setOutlineThickness(2.f);
@@ -874,6 +982,10 @@ class PlayingScene {
             }
         }
 
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::H) {
+            return SceneCommand::RequestHint;
+        }
+
         if (moveAnimationActive_) {
             return SceneCommand::None;
         }
@@ -892,10 +1004,15 @@ class PlayingScene {
         if (!moveResult.moved) {
             return SceneCommand::None;
         }
+        if (eventLog_ != nullptr) {
+            eventLog_->recordMove(*direction, moveResult, session.game().getScore());
+        }
 
         soundManager.play(app::SoundEffect::TileSlide);
-        if (moveResult.scoreDelta > 0) {
-            soundManager.play(app::SoundEffect::Merge);
+        if (moveResult.mergeCount > 0) {
+            soundManager.play(app::SoundEffect::Merge,
+                              static_cast<std::uint32_t>(moveResult.mergeCount),
+                              moveResult.maxMergedValue);
         }
         if (moveResult.spawnedTile.has_value()) {
             soundManager.play(app::SoundEffect::Spawn);
@@ -906,6 +1023,10 @@ class PlayingScene {
         return SceneCommand::None;
     }
 
+    void setEventLog(app::EventLog *eventLog) noexcept {
+        eventLog_ = eventLog;
+    }
+
     void setSoundEnabled(const bool enabled) {
         soundEnabled_ = enabled;
         menuSoundText_.setString(localizedText(*menuSoundText_.getFont(),
@@ -939,6 +1060,11 @@ class PlayingScene {
         updateFloatingScores(now);
     }
 
+    // Shows the hint search's progress in the top panel; null hides it.
+    void setHint(const core2048::SearchProgress *progress) {
+        hint_ = progress == nullptr ? std::nullopt : std::optional(*progress);
+    }
+
     bool hasActiveAnimations() const {
         return moveAnimationActive_;
     }
@@ -978,6 +1104,10 @@ class PlayingScene {
         bestText_.setPosition(12.f, 40.f - bestBounds.top);
         window.draw(bestText_);
 
+        if (hint_.has_value()) {
+            renderHint(window, width);
+        }
+
         renderFloatingScores(window, font);
 
         const auto now = Clock::now();
@@ -1165,6 +1295,28 @@ class PlayingScene {
             floatingScores_.end());
     }
 
+    void renderHint(sf::RenderWindow &window, const float width) {
+        const sf::Font &font = *hintText_.getFont();
+        sf::String label = localizedText(font, "İpucu: ", "Ipucu: ");
+        if (hint_->bestMove.has_value()) {
+            label += directionLabel(font, *hint_->bestMove);
+        } else {
+            label += hint_->finished ? "-" : "...";
+        }
+        hintText_.setString(label);
+        centerTextOrigin(hintText_);
+        hintText_.setPosition(width * 0.5f + 24.f, 26.f);
+        window.draw(hintText_);
+
+        sf::String detail = "derinlik " + std::to_string(hint_->depthCompleted) + ", ";
+        detail += localizedText(font, "düğüm ", "dugum ");
+        detail += compactCount(hint_->nodes);
+        hintDetailText_.setString(detail);
+        centerTextOrigin(hintDetailText_);
+        hintDetailText_.setPosition(width * 0.5f + 24.f, 52.f);
+        window.draw(hintDetailText_);
+    }
+
     void renderFloatingScores(sf::RenderWindow &window, const sf::Font &font) {
         const auto now = Clock::now();
 
@@ -1184,6 +1336,8 @@ class PlayingScene {
 
     sf::Text scoreText_;
     sf::Text bestText_;
+    sf::Text hintText_;
+    sf::Text hintDetailText_;
     RoundedRectShape menuButton_;
     RoundedRectShape menuPanel_;
     RoundedRectShape menuNewGameButton_;
@@ -1193,6 +1347,8 @@ class PlayingScene {
     bool menuOpen_{false};
     bool soundEnabled_{true};
 
+    app::EventLog *eventLog_{nullptr};
+
     bool moveAnimationActive_{false};
     Clock::time_point moveAnimationStart_{};
     std::vector<MovingTileVisual> movingTiles_;
@@ -1201,6 +1357,7 @@ class PlayingScene {
     std::set<BoardCell> hiddenDuringSpawn_;
     std::optional<core2048::SpawnedTile> spawnedTile_;
     std::vector<FloatingScoreEffect> floatingScores_;
+    std::optional<core2048::SearchProgress> hint_;
 };
 
 class GameOverScene {
@@ -1336,6 +1493,7 @@ void applySceneCommand(const SceneCommand command, SceneId &scene, GameSession &
         scene = SceneId::Splash;
         return;
     case SceneCommand::ToggleSound:
+    case SceneCommand::RequestHint:
         return;
     case SceneCommand::Quit:
         window.close();
@@ -1343,11 +1501,67 @@ void applySceneCommand(const SceneCommand command, SceneId &scene, GameSession &
     }
 }
 
+app::LoggedScene loggedScene(const SceneId scene) {
+    switch (scene) {
+    case SceneId::Splash:
+        return app::LoggedScene::Splash;
+    case SceneId::HighScores:
+        return app::LoggedScene::HighScores;
+    case SceneId::Playing:
+        return app::LoggedScene::Playing;
+    case SceneId::GameOver:
+        return app::LoggedScene::GameOver;
+    }
+    return app::LoggedScene::Splash;
+}
+
+// The report itself is printed by joinBackgroundLoads; this only checks the budget.
+int finishHeadlessStartup(const app::RunConfig &config, const app::StartupProfiler &profiler) {
+    if (config.startupBudgetMs.has_value()) {
+        const auto budget = std::chrono::milliseconds(*config.startupBudgetMs);
+        if (profiler.sinceStart() > budget) {
+            std::cerr << "Hata: başlangıç " << budget.count() << " ms bütçesini aştı ("
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(
+                             profiler.sinceStart())
+                             .count()
+                      << " ms)\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
 } // namespace
 
 namespace app {
 
 int run(const RunConfig &config) {
+    app::StartupProfiler profiler;
+
+    std::optional<app::MetricsExporter> metricsExporter;
+    if (!config.metricsFile.empty() || config.metricsPort.has_value()) {
+        app::MetricsExportConfig exportConfig;
+        exportConfig.textFile = config.metricsFile;
+        exportConfig.httpPort = config.metricsPort;
+        metricsExporter.emplace(core2048::MetricsRegistry::global(), exportConfig);
+        std::string error;
+        if (!metricsExporter->start(error)) {
+            std::cerr << "Uyarı: metrikler yayınlanamıyor: " << error << "\n";
+        }
+    }
+
+    std::optional<app::EventLog> eventLog;
+    if (!config.eventLogFile.empty()) {
+        app::EventLogConfig logConfig;
+        logConfig.path = config.eventLogFile;
+        eventLog.emplace(logConfig);
+        std::string error;
+        if (!eventLog->start(error)) {
+            std::cerr << "Uyarı: olay günlüğü açılamadı: " << error << "\n";
+            eventLog.reset();
+        }
+    }
+
     const auto width =
         static_cast<unsigned int>(kGridSize * kCellSize + (kGridSize + 1) * kPadding);
     const auto height = static_cast<unsigned int>(kTopPanelHeight + kGridSize * kCellSize +
@@ -1356,64 +1570,203 @@ int run(const RunConfig &config) {
     sf::ContextSettings windowSettings;
     windowSettings.antialiasingLevel = kWindowAntialiasingLevel;
 
-    sf::RenderWindow window(sf::VideoMode(width, height), "2048",
-                            sf::Style::Titlebar | sf::Style::Close, windowSettings);
-    window.setVerticalSyncEnabled(config.vSyncEnabled);
-    if (config.frameLimit.has_value()) {
-        window.setFramerateLimit(*config.frameLimit);
-    }
-    window.requestFocus();
+    // Everything that does not need the window runs on worker threads while the window and its
+    // GL context are created. Settings feed the sound manager, so they share one worker.
+    app::SettingsStore settings(resolveSettingsFilePath());
+    std::optional<app::SoundManager> soundManager;
+    core2048::ScoreManager scoreManager(resolveScoreFilePath());
 
-    const auto fontResolution = resolveAssetPath(kFontRelativePath);
+    auto fontRead = std::async(std::launch::async, [&profiler] {
+        const auto phase = profiler.phase("yazı tipi okuma");
+        return readFontSource();
+    });
+    auto settingsAndSoundLoad = std::async(std::launch::async, [&] {
+        SettingsAndSoundResult result;
+        {
+            const auto phase = profiler.phase("ayarlar");
+            result.settingsLoaded = settings.load();
+        }
+        const auto phase = profiler.phase("sesler");
+        soundManager.emplace(kSoundsRelativePath, settings);
+        soundManager->setWavOverride(config.wavSounds ||
+                                     settings.get(app::settings::kWavSounds));
+        result.soundsLoaded = soundManager->loadSoundAssets();
+        return result;
+    });
+    auto scoreLoad = std::async(std::launch::async, [&] {
+        const auto phase = profiler.phase("skorlar");
+        return scoreManager.load();
+    });
+
+    sf::RenderWindow window;
+    if (!config.headlessStartup) {
+        const auto phase = profiler.phase("pencere (16x MSAA)");
+        window.create(sf::VideoMode(width, height), "2048", sf::Style::Titlebar | sf::Style::Close,
+                      windowSettings);
+        window.setVerticalSyncEnabled(config.vSyncEnabled);
+        if (config.frameLimit.has_value()) {
+            window.setFramerateLimit(*config.frameLimit);
+        }
+        window.requestFocus();
+    }
 
     sf::Font font;
-    if (!fontResolution.resolvedPath.has_value() ||
-        !font.loadFromFile(fontResolution.resolvedPath->string())) {
-        std::cerr << "Font yüklenemedi. Denenen yollar:\n";
-        for (const auto &candidate : fontResolution.candidates) {
-            std::cerr << "  - " << candidate.string() << "\n";
+    FontSource fontSource = fontRead.get();
+    {
+        const auto phase = profiler.phase("yazı tipi yükleme");
+        if (!loadFontAsset(font, fontSource)) {
+            return 1;
         }
-        return 1;
     }
 
-    const auto soundDirResolution = resolveAssetPath(kSoundsRelativePath);
-    app::SoundManager soundManager(
-        soundDirResolution.resolvedPath.value_or(std::filesystem::path(kSoundsRelativePath)),
-        resolveSettingsFilePath());
-    if (!soundManager.loadSettings()) {
-        std::cerr << "Uyarı: ayar dosyası yüklenemedi: " << soundManager.settingsFilePath() << "\n";
-    }
-    if (!soundManager.loadSoundAssets()) {
-        std::cerr << "Uyarı: bazı ses dosyaları yüklenemedi:\n";
-        for (const auto &missing : soundManager.missingFiles()) {
-            std::cerr << "  - " << missing.string() << "\n";
+    int bestScore = 0;
+    bool finalScorePersisted = false;
+    bool startupReported = false;
+
+    const auto maybeReportStartup = [&] {
+        if (!config.reportStartup || startupReported || settingsAndSoundLoad.valid() ||
+            scoreLoad.valid() ||
+            (!config.headlessStartup && !profiler.timeToFirstFrame().has_value())) {
+            return;
         }
-    }
+        profiler.writeReport(std::cout);
+        startupReported = true;
+    };
 
-    core2048::ScoreManager scoreManager(resolveScoreFilePath());
-    if (!scoreManager.load()) {
-        std::cerr << "Uyarı: skor dosyası yüklenemedi: " << scoreManager.scoreFilePath() << "\n";
+    // Idempotent; the splash scene keeps rendering until a later scene needs sound or scores.
+    const auto joinBackgroundLoads = [&] {
+        if (settingsAndSoundLoad.valid()) {
+            const auto result = settingsAndSoundLoad.get();
+            if (!result.settingsLoaded) {
+                std::cerr << "Uyarı: ayar dosyası yüklenemedi: " << settings.filePath() << "\n";
+            }
+            if (!result.soundsLoaded) {
+                std::cerr << "Uyarı: bazı WAV ses dosyaları yüklenemedi, yerlerine sentezlenmiş "
+                             "sesler çalınacak:\n";
+                for (const auto &missing : soundManager->missingFiles()) {
+                    std::cerr << "  - " << missing.string() << "\n";
+                }
+            }
+            if (config.traceStartup) {
+                const auto resolverStats = app::defaultAssetResolver().stats();
+                std::cout << "[başlangıç] varlık çözümleme: " << resolverStats.lookups
+                          << " arama, " << resolverStats.cacheHits << " önbellek isabeti, "
+                          << resolverStats.existenceChecks << " varlık kontrolü, "
+                          << resolverStats.directoryScans << " dizin taraması, "
+                          << std::chrono::duration<double, std::milli>(resolverStats.elapsed)
+                                 .count()
+                          << " ms\n";
+            }
+        }
+
+        if (scoreLoad.valid()) {
+            if (!scoreLoad.get()) {
+                std::cerr << "Uyarı: skor dosyası yüklenemedi: " << scoreManager.scoreFilePath()
+                          << "\n";
+            }
+            bestScore = scoreManager.bestScore();
+        }
+
+        maybeReportStartup();
+    };
+
+    const auto backgroundLoadsReady = [&] {
+        const auto isReady = [](const auto &future) {
+            return !future.valid() ||
+                   future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        };
+        return isReady(settingsAndSoundLoad) && isReady(scoreLoad);
+    };
+
+    // Scenes build text geometry from the font, which needs a GL context; a headless run stops
+    // before them.
+    if (config.headlessStartup) {
+        joinBackgroundLoads();
+        return finishHeadlessStartup(config, profiler);
     }
-    int bestScore = scoreManager.bestScore();
-    bool finalScorePersisted = false;
 
     GameSession session;
+    auto splashPhase = profiler.phase("sahne: açılış");
     SplashScene splashScene(font, static_cast<float>(width), static_cast<float>(height));
+    splashPhase.end();
+    auto highScoresPhase = profiler.phase("sahne: yüksek skorlar");
     HighScoresScene highScoresScene(font, static_cast<float>(width), static_cast<float>(height));
+    highScoresPhase.end();
+    auto playingPhase = profiler.phase("sahne: oyun");
     PlayingScene playingScene(font);
-    playingScene.setSoundEnabled(soundManager.isEnabled());
+    playingScene.setEventLog(eventLog.has_value() ? &*eventLog : nullptr);
+    playingPhase.end();
+    auto gameOverPhase = profiler.phase("sahne: oyun sonu");
     GameOverScene gameOverScene(font, static_cast<float>(width), static_cast<float>(height));
+    gameOverPhase.end();
+
+    // Joins the background loads once a scene past the splash needs sound or scores.
+    const auto ensureLoaded = [&] {
+        if (!settingsAndSoundLoad.valid() && !scoreLoad.valid()) {
+            return;
+        }
+        joinBackgroundLoads();
+        playingScene.setSoundEnabled(soundManager->isEnabled());
+        soundManager->setEventLog(eventLog.has_value() ? &*eventLog : nullptr);
+    };
+
+    // The hint search runs on this thread, resumed for a slice of each frame between event
+    // handling and rendering. The slice is sized from the measured frame work so frames keep
+    // their deadline on a single core.
+    std::optional<core2048::BoardEvaluator> hintEvaluator;
+    std::optional<core2048::MoveSearch> hintSearch;
+    app::SliceSchedulerConfig sliceConfig;
+    if (config.frameLimit.has_value() && *config.frameLimit > 0U) {
+        sliceConfig.frameBudget = std::chrono::nanoseconds(1'000'000'000 / *config.frameLimit);
+    }
+    app::SliceScheduler sliceScheduler(sliceConfig);
+    // Frames this much longer than the budget go into the event log.
+    const auto slowFrameTime = 2 * sliceConfig.frameBudget;
+    Clock::time_point frameStart = Clock::now();
+    Clock::duration frameSliceTime{};
+
+    auto &metrics = core2048::MetricsRegistry::global();
+    auto &frameSeconds = metrics.histogram(
+        "sfml_2048_frame_seconds", "Time from the start of one frame to the start of the next.",
+        {0.004, 0.008, 0.0125, 0.0167, 0.025, 0.0334, 0.05, 0.1, 0.25});
+    auto &inputEvents = metrics.counter("sfml_2048_input_events_total", "Window events handled.");
+    auto &gamesFinished =
+        metrics.counter("sfml_2048_games_finished_total", "Games played until no move was left.");
 
     SceneId scene = SceneId::Splash;
+    const auto presentFrame = [&] {
+        // Time blocked in `display` for vertical sync is headroom, not work.
+        sliceScheduler.recordFrameWork(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - frameStart - frameSliceTime));
+        window.display();
+        if (!profiler.timeToFirstFrame().has_value()) {
+            profiler.markFirstFrame();
+            maybeReportStartup();
+        }
+    };
 
     while (window.isOpen()) {
+        const auto previousFrameStart = frameStart;
+        frameStart = Clock::now();
+        frameSeconds.observe(
+            std::chrono::duration<double>(frameStart - previousFrameStart).count());
+        if (eventLog.has_value() && frameStart - previousFrameStart > slowFrameTime) {
+            eventLog->recordSlowFrame(frameStart - previousFrameStart, sliceConfig.frameBudget);
+        }
         sf::Event event;
         while (window.pollEvent(event)) {
+            inputEvents.add();
             if (event.type == sf::Event::Closed) {
                 window.close();
                 continue;
             }
 
+            if (scene != SceneId::Splash) {
+                ensureLoaded();
+            }
+
+            const SceneId sceneBefore = scene;
+            const int scoreBefore = session.game().getScore();
             SceneCommand command = SceneCommand::None;
             switch (scene) {
             case SceneId::Splash:
@@ -1426,7 +1779,7 @@ int run(const RunConfig &config) {
                 command = highScoresScene.handleEvent(event, window);
                 break;
             case SceneId::Playing:
-                command = playingScene.handleEvent(event, window, session, soundManager,
+                command = playingScene.handleEvent(event, window, session, *soundManager,
                                                    static_cast<float>(width));
                 break;
             case SceneId::GameOver:
@@ -1435,28 +1788,40 @@ int run(const RunConfig &config) {
             }
 
             applySceneCommand(command, scene, session, window);
+            if (eventLog.has_value() &&
+                (scene != sceneBefore || command == SceneCommand::RestartGame)) {
+                eventLog->recordSceneChange(loggedScene(sceneBefore), loggedScene(scene),
+                                            scoreBefore);
+            }
 
             if (command == SceneCommand::StartGame || command == SceneCommand::RestartGame) {
                 finalScorePersisted = false;
                 playingScene.resetVisualEffects();
             }
             if (command == SceneCommand::ToggleSound) {
-                soundManager.toggleEnabled();
-                if (!soundManager.saveSettings()) {
-                    std::cerr << "Uyarı: ayar dosyası kaydedilemedi: "
-                              << soundManager.settingsFilePath() << "\n";
-                }
-                playingScene.setSoundEnabled(soundManager.isEnabled());
+                soundManager->toggleEnabled();
+                playingScene.setSoundEnabled(soundManager->isEnabled());
             }
             if (command == SceneCommand::ShowSplash) {
                 playingScene.resetVisualEffects();
             }
+            if (command == SceneCommand::RequestHint) {
+                if (!hintEvaluator.has_value()) {
+                    hintEvaluator.emplace();
+                }
+                hintSearch.reset();
+                hintSearch.emplace(*hintEvaluator, session.game().getGrid(), kHintMaxDepth);
+            }
         }
 
         if (!window.isOpen()) {
             break;
         }
 
+        if (scene != SceneId::Splash || backgroundLoadsReady()) {
+            ensureLoaded();
+        }
+
         const sf::Vector2f mousePos = window.mapPixelToCoords(sf::Mouse::getPosition(window));
         if (scene == SceneId::Splash) {
             splashScene.updateHover(mousePos);
@@ -1480,25 +1845,48 @@ int run(const RunConfig &config) {
                 }
                 bestScore = scoreManager.bestScore();
                 finalScorePersisted = true;
-                soundManager.play(app::SoundEffect::GameOver);
+                gamesFinished.add();
+                soundManager->play(app::SoundEffect::GameOver);
                 if (isNewBest) {
-                    soundManager.play(app::SoundEffect::HighScore);
+                    soundManager->play(app::SoundEffect::HighScore);
+                }
+                if (eventLog.has_value()) {
+                    eventLog->recordSceneChange(app::LoggedScene::Playing,
+                                                app::LoggedScene::GameOver,
+                                                session.game().getScore());
                 }
             }
             scene = SceneId::GameOver;
         }
 
+        // A hint only holds for the board it was asked on.
+        if (hintSearch.has_value() &&
+            (scene != SceneId::Playing || hintSearch->grid() != session.game().getGrid())) {
+            hintSearch.reset();
+        }
+        frameSliceTime = {};
+        if (hintSearch.has_value() && !hintSearch->progress().finished) {
+            const auto sliceStart = Clock::now();
+            hintSearch->runFor(sliceScheduler.nextSlice());
+            frameSliceTime = Clock::now() - sliceStart;
+        }
+        playingScene.setHint(hintSearch.has_value() ? &hintSearch->progress() : nullptr);
+
+        // Nothing can trigger a sound before the loads are joined.
+        if (!settingsAndSoundLoad.valid()) {
+            soundManager->flushFrame();
+        }
         window.clear(kBoardBackgroundColor);
 
         if (scene == SceneId::Splash) {
             splashScene.render(window);
-            window.display();
+            presentFrame();
             continue;
         }
 
         if (scene == SceneId::HighScores) {
             highScoresScene.render(window, scoreManager.topScores());
-            window.display();
+            presentFrame();
             continue;
         }
 
@@ -1507,7 +1895,36 @@ int run(const RunConfig &config) {
             gameOverScene.render(window, session.game().getScore(), bestScore);
         }
 
-        window.display();
+        presentFrame();
+    }
+
+    ensureLoaded();
+    if (metricsExporter.has_value()) {
+        metricsExporter->stop();
+        if (const auto error = metricsExporter->lastError(); !error.empty()) {
+            std::cerr << "Uyarı: metrik dosyası yazılamadı: " << error << "\n";
+        }
+    }
+    if (eventLog.has_value()) {
+        eventLog->stop();
+        if (const auto error = eventLog->lastError(); !error.empty()) {
+            std::cerr << "Uyarı: olay günlüğü yazılamadı: " << error << "\n";
+        }
+    }
+    if (!settings.flush()) {
+        std::cerr << "Uyarı: ayar dosyası kaydedilemedi: " << settings.filePath() << "\n";
+    }
+
+    if (config.reportAudioTimings) {
+        const auto timings = soundManager->timings();
+        std::cout << "Ses zamanlaması:\n"
+                  << "  play() en kötü kuyruk süresi: " << timings.worstEnqueue.count() << " ns\n"
+                  << "  ses cihazı en kötü çağrı süresi: " << timings.worstDeviceCall.count()
+                  << " ns\n"
+                  << "  işlenen komut: " << timings.processedCommands << "\n"
+                  << "  düşürülen komut: " << timings.droppedCommands << "\n"
+                  << "  birleştirilen tetikleme: " << timings.coalescedTriggers << "\n"
+                  << "  hız sınırına takılan tetikleme: " << timings.rateLimitedTriggers << "\n";
     }
 
     return 0;
@@ -2,12 +2,27 @@
 
 #include <cstdint>
 #include <optional>
+#include <string>
 
 namespace app {
 
 struct RunConfig {
     bool vSyncEnabled{true};
     std::optional<unsigned int> frameLimit;
+    bool reportAudioTimings{false};
+    bool traceStartup{false};
+    bool wavSounds{false};
+    bool reportStartup{false};
+    // Runs every startup phase except window and scene creation, then exits; no display needed.
+    bool headlessStartup{false};
+    // With `headlessStartup`, exit with status 1 if startup took longer than this.
+    std::optional<unsigned int> startupBudgetMs;
+    // Prometheus text file rewritten every 15 s, for node_exporter's textfile collector.
+    std::string metricsFile;
+    // Serves the same text on http://127.0.0.1:<port>/metrics.
+    std::optional<std::uint16_t> metricsPort;
+    // Binary gameplay event log with rotated siblings; decode with `sfml_2048_eventlog`.
+    std::string eventLogFile;
 };
 
 int run(const RunConfig &config = {});
@@ -0,0 +1,317 @@
+#include "app/AssetPack.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace app {
+
+namespace {
+
+constexpr std::array<char, 4> kMagic = {'S', '2', 'P', 'K'};
+constexpr std::size_t kHeaderSize = 16;
+constexpr std::size_t kNameFieldSize = AssetPack::kMaxNameLength + 1U;
+constexpr std::size_t kEntrySize = kNameFieldSize + 3U * sizeof(std::uint64_t);
+constexpr std::size_t kBlobAlignment = 16;
+
+std::uint32_t readU32(const std::byte *data) {
+    std::uint32_t value = 0;
+    for (std::size_t i = 0; i < sizeof(value); ++i) {
+        value |= static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(data[i])) << (8U * i);
+    }
+    return value;
+}
+
+std::uint64_t readU64(const std::byte *data) {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < sizeof(value); ++i) {
+        value |= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(data[i])) << (8U * i);
+    }
+    return value;
+}
+
+template <typename T> void appendLittleEndian(std::vector<std::byte> &out, const T value) {
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<std::byte>((value >> (8U * i)) & 0xFFU));
+    }
+}
+
+std::size_t alignUp(const std::size_t value) {
+    return (value + kBlobAlignment - 1U) / kBlobAlignment * kBlobAlignment;
+}
+
+bool readWholeFile(const std::filesystem::path &path, std::vector<std::byte> &bytes) {
+    std::error_code ec;
+    const auto fileSize = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    bytes.resize(static_cast<std::size_t>(fileSize));
+    in.read(reinterpret_cast<char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(in);
+}
+
+std::string normalizedKey(const std::string_view relativePath) {
+    return std::filesystem::path(relativePath).lexically_normal().generic_string();
+}
+
+} // namespace
+
+std::optional<AssetPack> AssetPack::open(const std::filesystem::path &packPath) {
+    AssetPack pack;
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(packPath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return std::nullopt;
+    }
+    pack.fileHandle_ = file;
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+        return std::nullopt;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        return std::nullopt;
+    }
+    pack.mappingHandle_ = mapping;
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        return std::nullopt;
+    }
+    pack.data_ = static_cast<const std::byte *>(view);
+    pack.size_ = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    const int fd = ::open(packPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    struct stat fileStat {};
+    if (::fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    void *view =
+        ::mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return std::nullopt;
+    }
+    pack.data_ = static_cast<const std::byte *>(view);
+    pack.size_ = static_cast<std::size_t>(fileStat.st_size);
+#endif
+
+    if (pack.size_ < kHeaderSize ||
+        std::memcmp(pack.data_, kMagic.data(), kMagic.size()) != 0 ||
+        readU32(pack.data_ + 4) != kVersion) {
+        return std::nullopt;
+    }
+
+    const std::size_t entryCount = readU32(pack.data_ + 8);
+    if (entryCount > (pack.size_ - kHeaderSize) / kEntrySize) {
+        return std::nullopt;
+    }
+
+    const std::size_t indexEnd = kHeaderSize + entryCount * kEntrySize;
+    pack.entries_.reserve(entryCount);
+    for (std::size_t i = 0; i < entryCount; ++i) {
+        const std::byte *record = pack.data_ + kHeaderSize + i * kEntrySize;
+        const char *name = reinterpret_cast<const char *>(record);
+        const std::size_t nameLength =
+            static_cast<std::size_t>(std::find(name, name + kNameFieldSize, '\0') - name);
+        if (nameLength == 0 || nameLength == kNameFieldSize) {
+            return std::nullopt;
+        }
+
+        Entry entry;
+        entry.name = std::string_view(name, nameLength);
+        entry.offset = readU64(record + kNameFieldSize);
+        entry.size = readU64(record + kNameFieldSize + 8);
+        entry.hash = readU64(record + kNameFieldSize + 16);
+
+        if (entry.offset < indexEnd || entry.offset > pack.size_ ||
+            entry.size > pack.size_ - entry.offset) {
+            return std::nullopt;
+        }
+        pack.entries_.push_back(entry);
+    }
+
+    return pack;
+}
+
+bool AssetPack::write(const std::filesystem::path &packPath, const std::vector<SourceFile> &files,
+                      std::string &error) {
+    std::vector<std::vector<std::byte>> blobs;
+    blobs.reserve(files.size());
+
+    for (const auto &file : files) {
+        if (file.name.empty() || file.name.size() > kMaxNameLength) {
+            error = "invalid asset name: " + file.name;
+            return false;
+        }
+
+        auto &blob = blobs.emplace_back();
+        if (!readWholeFile(file.path, blob)) {
+            error = "cannot read " + file.path.string();
+            return false;
+        }
+    }
+
+    std::vector<std::byte> out;
+    out.reserve(kHeaderSize + files.size() * kEntrySize);
+    for (const char c : kMagic) {
+        out.push_back(static_cast<std::byte>(c));
+    }
+    appendLittleEndian<std::uint32_t>(out, kVersion);
+    appendLittleEndian<std::uint32_t>(out, static_cast<std::uint32_t>(files.size()));
+    appendLittleEndian<std::uint32_t>(out, 0U);
+
+    std::size_t blobOffset = alignUp(kHeaderSize + files.size() * kEntrySize);
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        const auto key = normalizedKey(files[i].name);
+        std::array<std::byte, kNameFieldSize> name{};
+        std::memcpy(name.data(), key.data(), std::min(key.size(), kMaxNameLength));
+        out.insert(out.end(), name.begin(), name.end());
+
+        appendLittleEndian<std::uint64_t>(out, blobOffset);
+        appendLittleEndian<std::uint64_t>(out, blobs[i].size());
+        appendLittleEndian<std::uint64_t>(out, hashBytes(blobs[i]));
+        blobOffset = alignUp(blobOffset + blobs[i].size());
+    }
+
+    for (const auto &blob : blobs) {
+        out.resize(alignUp(out.size()));
+        out.insert(out.end(), blob.begin(), blob.end());
+    }
+
+    auto tempPath = packPath;
+    tempPath += ".tmp";
+    {
+        std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+        if (!stream.is_open()) {
+            error = "cannot open " + tempPath.string();
+            return false;
+        }
+        stream.write(reinterpret_cast<const char *>(out.data()),
+                     static_cast<std::streamsize>(out.size()));
+        if (!stream) {
+            error = "cannot write " + tempPath.string();
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, packPath, ec);
+    if (ec) {
+        error = "cannot replace " + packPath.string() + ": " + ec.message();
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+std::uint64_t AssetPack::hashBytes(const AssetBytes bytes) noexcept {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const std::byte b : bytes) {
+        hash ^= std::to_integer<std::uint64_t>(b);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+AssetPack::AssetPack(AssetPack &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0U)),
+#if defined(_WIN32)
+      fileHandle_(std::exchange(other.fileHandle_, nullptr)),
+      mappingHandle_(std::exchange(other.mappingHandle_, nullptr)),
+#endif
+      entries_(std::move(other.entries_)) {
+}
+
+AssetPack &AssetPack::operator=(AssetPack &&other) noexcept {
+    if (this != &other) {
+        unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0U);
+#if defined(_WIN32)
+        fileHandle_ = std::exchange(other.fileHandle_, nullptr);
+        mappingHandle_ = std::exchange(other.mappingHandle_, nullptr);
+#endif
+        entries_ = std::move(other.entries_);
+    }
+    return *this;
+}
+
+AssetPack::~AssetPack() {
+    unmap();
+}
+
+std::optional<AssetBytes> AssetPack::find(const std::string_view relativePath) const {
+    const auto key = normalizedKey(relativePath);
+    for (const auto &entry : entries_) {
+        if (entry.name == key) {
+            return AssetBytes(data_ + entry.offset, static_cast<std::size_t>(entry.size));
+        }
+    }
+    return std::nullopt;
+}
+
+const std::vector<AssetPack::Entry> &AssetPack::entries() const noexcept {
+    return entries_;
+}
+
+bool AssetPack::verify() const {
+    return std::all_of(entries_.begin(), entries_.end(), [this](const Entry &entry) {
+        const AssetBytes bytes(data_ + entry.offset, static_cast<std::size_t>(entry.size));
+        return hashBytes(bytes) == entry.hash;
+    });
+}
+
+void AssetPack::unmap() noexcept {
+#if defined(_WIN32)
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mappingHandle_ != nullptr) {
+        CloseHandle(mappingHandle_);
+    }
+    if (fileHandle_ != nullptr) {
+        CloseHandle(fileHandle_);
+    }
+    fileHandle_ = nullptr;
+    mappingHandle_ = nullptr;
+#else
+    if (data_ != nullptr) {
+        ::munmap(const_cast<std::byte *>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    entries_.clear();
+}
+
+} // namespace app
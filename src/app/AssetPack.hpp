@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace app {
+
+using AssetBytes = std::span<const std::byte>;
+
+// Read-only view of a packed asset archive.
+//
+// Layout (little-endian):
+//   header  : magic "S2PK", u32 version, u32 entry count, u32 reserved
+//   index   : `entry count` fixed-size records (name[96], u64 offset, u64 size, u64 hash)
+//   blobs   : asset bytes, each starting on a 16-byte boundary
+//
+// The file is memory-mapped; `find` returns spans into the mapping without copying.
+class AssetPack {
+  public:
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::size_t kMaxNameLength = 95;
+
+    struct Entry {
+        std::string_view name;
+        std::uint64_t offset{0};
+        std::uint64_t size{0};
+        std::uint64_t hash{0};
+    };
+
+    struct SourceFile {
+        std::string name;
+        std::filesystem::path path;
+    };
+
+    static std::optional<AssetPack> open(const std::filesystem::path &packPath);
+
+    // Writes to a temporary sibling file and renames it over `packPath`, so readers never
+    // observe a half-written pack.
+    static bool write(const std::filesystem::path &packPath, const std::vector<SourceFile> &files,
+                      std::string &error);
+
+    static std::uint64_t hashBytes(AssetBytes bytes) noexcept;
+
+    AssetPack(AssetPack &&other) noexcept;
+    AssetPack &operator=(AssetPack &&other) noexcept;
+    AssetPack(const AssetPack &) = delete;
+    AssetPack &operator=(const AssetPack &) = delete;
+    ~AssetPack();
+
+    std::optional<AssetBytes> find(std::string_view relativePath) const;
+    const std::vector<Entry> &entries() const noexcept;
+    bool verify() const;
+
+  private:
+    AssetPack() = default;
+    void unmap() noexcept;
+
+    const std::byte *data_{nullptr};
+    std::size_t size_{0};
+#if defined(_WIN32)
+    void *fileHandle_{nullptr};
+    void *mappingHandle_{nullptr};
+#endif
+    std::vector<Entry> entries_;
+};
+
+} // namespace app
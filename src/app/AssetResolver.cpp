@@ -1,8 +1,14 @@
 #include "app/AssetResolver.hpp"
 
+#if defined(SFML_2048_EMBED_ASSETS)
+#include "app/EmbeddedAssets.hpp"
+#endif
+
 #include <array>
 #include <string>
 #include <system_error>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #if defined(_WIN32)
@@ -63,59 +69,203 @@ std::filesystem::path getExecutablePath() {
 #endif
 }
 
-std::vector<std::filesystem::path>
-buildCandidatePaths(const std::filesystem::path &relativeAssetPath) {
-    std::vector<std::filesystem::path> candidates;
-    const auto appendCandidate = [&](const std::filesystem::path &candidatePath) {
-        const auto normalized = candidatePath.lexically_normal();
-        for (const auto &existing : candidates) {
+std::vector<std::filesystem::path> buildBaseDirectories() {
+    std::vector<std::filesystem::path> bases;
+    const auto appendBase = [&](const std::filesystem::path &base) {
+        const auto normalized = base.lexically_normal();
+        for (const auto &existing : bases) {
             if (existing == normalized) {
                 return;
             }
         }
-        candidates.push_back(normalized);
+        bases.push_back(normalized);
     };
 
     const auto executablePath = getExecutablePath();
     if (!executablePath.empty()) {
         const auto executableDir = executablePath.parent_path();
-        appendCandidate(executableDir / relativeAssetPath);
-        appendCandidate(executableDir.parent_path() / relativeAssetPath);
+        appendBase(executableDir);
+        appendBase(executableDir.parent_path());
 #if defined(__APPLE__)
-        appendCandidate(executableDir / ".." / ".." / "Resources" / relativeAssetPath);
+        appendBase(executableDir / ".." / ".." / "Resources");
 #endif
     }
 
     std::error_code ec;
     const auto cwd = std::filesystem::current_path(ec);
     if (!ec) {
-        appendCandidate(cwd / relativeAssetPath);
+        appendBase(cwd);
+    } else {
+        bases.emplace_back();
     }
 
-    appendCandidate(relativeAssetPath);
-    return candidates;
+    return bases;
+}
+
+using ResolverClock = std::chrono::steady_clock;
+
+} // namespace
+
+namespace app {
+
+AssetResolver::AssetResolver() : AssetResolver(buildBaseDirectories()) {
+}
+
+AssetResolver::AssetResolver(std::vector<std::filesystem::path> baseDirectories)
+    : baseDirectories_(std::move(baseDirectories)) {
 }
 
-std::optional<std::filesystem::path>
-findFirstExistingPath(const std::vector<std::filesystem::path> &candidates) {
-    for (const auto &candidate : candidates) {
+AssetResolution AssetResolver::resolve(const std::filesystem::path &relativeAssetPath) {
+    const auto startedAt = ResolverClock::now();
+    const std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.lookups;
+
+    const auto key = cacheKey(relativeAssetPath);
+    if (const auto cached = cache_.find(key); cached != cache_.end()) {
+        ++stats_.cacheHits;
+        stats_.elapsed += ResolverClock::now() - startedAt;
+        return cached->second;
+    }
+
+    AssetResolution resolution;
+    resolution.candidates = candidatesFor(relativeAssetPath);
+    for (const auto &candidate : resolution.candidates) {
+        ++stats_.existenceChecks;
         std::error_code ec;
         if (std::filesystem::exists(candidate, ec) && !ec) {
-            return candidate;
+            resolution.resolvedPath = candidate;
+            break;
         }
     }
-    return std::nullopt;
+
+    cache_.emplace(key, resolution);
+    stats_.elapsed += ResolverClock::now() - startedAt;
+    return resolution;
 }
 
-} // namespace
+std::vector<AssetResolution>
+AssetResolver::resolveBatch(const std::vector<std::filesystem::path> &paths) {
+    const auto startedAt = ResolverClock::now();
+    const std::lock_guard<std::mutex> lock(mutex_);
+    stats_.lookups += paths.size();
 
-namespace app {
+    std::vector<AssetResolution> results(paths.size());
+    std::unordered_map<std::string, std::vector<std::size_t>> pendingByParent;
+
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        if (const auto cached = cache_.find(cacheKey(paths[i])); cached != cache_.end()) {
+            ++stats_.cacheHits;
+            results[i] = cached->second;
+            continue;
+        }
+
+        results[i].candidates = candidatesFor(paths[i]);
+        pendingByParent[paths[i].lexically_normal().parent_path().generic_string()].push_back(i);
+    }
+
+    for (const auto &base : baseDirectories_) {
+        for (auto &[parent, pending] : pendingByParent) {
+            if (pending.empty()) {
+                continue;
+            }
+
+            ++stats_.directoryScans;
+            std::unordered_set<std::string> entryNames;
+            std::error_code ec;
+            for (std::filesystem::directory_iterator it(base / parent, ec), end; !ec && it != end;
+                 it.increment(ec)) {
+                entryNames.insert(it->path().filename().string());
+            }
+            if (entryNames.empty()) {
+                continue;
+            }
+
+            std::erase_if(pending, [&](const std::size_t index) {
+                const auto relative = paths[index].lexically_normal();
+                if (entryNames.count(relative.filename().string()) == 0U) {
+                    return false;
+                }
+                results[index].resolvedPath = (base / relative).lexically_normal();
+                return true;
+            });
+        }
+    }
+
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        cache_.emplace(cacheKey(paths[i]), results[i]);
+    }
+
+    stats_.elapsed += ResolverClock::now() - startedAt;
+    return results;
+}
+
+const std::vector<std::filesystem::path> &AssetResolver::baseDirectories() const noexcept {
+    return baseDirectories_;
+}
+
+AssetResolver::Stats AssetResolver::stats() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::string AssetResolver::cacheKey(const std::filesystem::path &relativeAssetPath) {
+    return relativeAssetPath.lexically_normal().generic_string();
+}
+
+std::vector<std::filesystem::path>
+AssetResolver::candidatesFor(const std::filesystem::path &relative) const {
+    std::vector<std::filesystem::path> candidates;
+    candidates.reserve(baseDirectories_.size());
+    for (const auto &base : baseDirectories_) {
+        candidates.push_back((base / relative).lexically_normal());
+    }
+    return candidates;
+}
+
+AssetResolver &defaultAssetResolver() {
+    static AssetResolver resolver;
+    return resolver;
+}
 
 AssetResolution resolveAssetPath(const std::filesystem::path &relativeAssetPath) {
-    AssetResolution resolution;
-    resolution.candidates = buildCandidatePaths(relativeAssetPath);
-    resolution.resolvedPath = findFirstExistingPath(resolution.candidates);
-    return resolution;
+    return defaultAssetResolver().resolve(relativeAssetPath);
+}
+
+std::optional<AssetBytes> findEmbeddedAsset(const std::filesystem::path &relativeAssetPath) {
+#if defined(SFML_2048_EMBED_ASSETS)
+    const auto key = relativeAssetPath.lexically_normal().generic_string();
+    for (std::size_t i = 0; i < embedded::kAssetCount; ++i) {
+        const auto &asset = embedded::kAssets[i];
+        if (key == asset.relativePath) {
+            return AssetBytes(reinterpret_cast<const std::byte *>(asset.data), asset.size);
+        }
+    }
+#else
+    (void)relativeAssetPath;
+#endif
+    return std::nullopt;
+}
+
+std::optional<AssetBytes> findPackedAsset(const std::filesystem::path &relativeAssetPath) {
+    static const std::optional<AssetPack> pack = []() -> std::optional<AssetPack> {
+        const auto resolution = resolveAssetPath(kAssetPackFileName);
+        if (!resolution.resolvedPath.has_value()) {
+            return std::nullopt;
+        }
+        return AssetPack::open(*resolution.resolvedPath);
+    }();
+
+    if (!pack.has_value()) {
+        return std::nullopt;
+    }
+    return pack->find(relativeAssetPath.generic_string());
+}
+
+std::optional<AssetBytes> findInMemoryAsset(const std::filesystem::path &relativeAssetPath) {
+    if (auto embedded = findEmbeddedAsset(relativeAssetPath); embedded.has_value()) {
+        return embedded;
+    }
+    return findPackedAsset(relativeAssetPath);
 }
 
 } // namespace app
@@ -1,16 +1,75 @@
 #pragma once
 
+#include "app/AssetPack.hpp"
+
+#include <chrono>
+#include <cstddef>
 #include <filesystem>
+#include <mutex>
 #include <optional>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace app {
 
+inline constexpr char kAssetPackFileName[] = "assets.pack";
+
 struct AssetResolution {
     std::optional<std::filesystem::path> resolvedPath;
     std::vector<std::filesystem::path> candidates;
 };
 
+// Resolves relative asset paths against the executable directory, its parent (plus the bundle
+// `Resources` directory on macOS) and the working directory. The base directories are computed
+// once and every answer, found or not, is cached per relative path. Thread-safe.
+class AssetResolver {
+  public:
+    struct Stats {
+        std::size_t lookups{0};
+        std::size_t cacheHits{0};
+        std::size_t existenceChecks{0};
+        std::size_t directoryScans{0};
+        std::chrono::nanoseconds elapsed{0};
+    };
+
+    AssetResolver();
+    explicit AssetResolver(std::vector<std::filesystem::path> baseDirectories);
+
+    AssetResolution resolve(const std::filesystem::path &relativeAssetPath);
+
+    // Resolves several paths with one directory listing per (base, parent directory) pair
+    // instead of one existence check per candidate.
+    std::vector<AssetResolution> resolveBatch(const std::vector<std::filesystem::path> &paths);
+
+    const std::vector<std::filesystem::path> &baseDirectories() const noexcept;
+    Stats stats() const;
+
+  private:
+    static std::string cacheKey(const std::filesystem::path &relativeAssetPath);
+    std::vector<std::filesystem::path> candidatesFor(const std::filesystem::path &relative) const;
+
+    std::vector<std::filesystem::path> baseDirectories_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, AssetResolution> cache_;
+    Stats stats_;
+};
+
+// Process-wide resolver used by the app; created on first use.
+AssetResolver &defaultAssetResolver();
+
 AssetResolution resolveAssetPath(const std::filesystem::path &relativeAssetPath);
 
+// Returns the bytes of an asset compiled into the executable (SFML_2048_EMBED_ASSETS).
+// Never touches the filesystem; always empty when assets are not embedded.
+std::optional<AssetBytes> findEmbeddedAsset(const std::filesystem::path &relativeAssetPath);
+
+// Returns the bytes of an asset stored in `assets.pack`. The pack is located and memory-mapped
+// on first use and stays mapped for the lifetime of the process.
+std::optional<AssetBytes> findPackedAsset(const std::filesystem::path &relativeAssetPath);
+
+// Embedded assets first, then the asset pack. Callers fall back to `resolveAssetPath` and loose
+// files when this returns nothing.
+std::optional<AssetBytes> findInMemoryAsset(const std::filesystem::path &relativeAssetPath);
+
 } // namespace app
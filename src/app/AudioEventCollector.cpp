@@ -0,0 +1,88 @@
+#include "app/AudioEventCollector.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace app {
+
+namespace {
+
+// Merge feedback grows with the number of merges in a frame and saturates at this count.
+constexpr std::uint32_t kMergeScaleSaturation = 6;
+constexpr float kMergeVolumeStep = 0.12f;
+constexpr float kMergePitchStep = 0.05f;
+
+} // namespace
+
+AudioEventCollector::AudioEventCollector(const RetriggerIntervals &intervals) noexcept
+    : intervals_(intervals) {
+}
+
+void AudioEventCollector::trigger(const SoundEffect effect, const std::uint32_t count,
+                                  const int tileValue) noexcept {
+    if (count == 0U) {
+        return;
+    }
+
+    const std::size_t index = soundEffectIndex(effect);
+    pending_[index] += count;
+    ++pendingTriggers_[index];
+    pendingTileValues_[index] = std::max(pendingTileValues_[index], tileValue);
+    ++stats_.triggers;
+}
+
+std::size_t AudioEventCollector::flush(const Clock::time_point now, FrameEvents &out) noexcept {
+    std::size_t written = 0;
+
+    for (std::size_t index = 0; index < kSoundEffectCount; ++index) {
+        const std::uint32_t count = std::exchange(pending_[index], 0U);
+        const std::uint32_t triggers = std::exchange(pendingTriggers_[index], 0U);
+        const int tileValue = std::exchange(pendingTileValues_[index], 0);
+        if (count == 0U) {
+            continue;
+        }
+
+        if (everEmitted_[index] && now - lastEmitted_[index] < intervals_[index]) {
+            stats_.rateLimited += triggers;
+            continue;
+        }
+
+        const auto effect = static_cast<SoundEffect>(index);
+        AudioEvent &event = out[written++];
+        event.effect = effect;
+        event.count = count;
+        event.tileValue = tileValue;
+        event.volumeScale = effect == SoundEffect::Merge ? mergeVolumeScale(count) : 1.f;
+        event.pitch = effect == SoundEffect::Merge ? mergePitch(count) : 1.f;
+
+        lastEmitted_[index] = now;
+        everEmitted_[index] = true;
+        ++stats_.emitted;
+        stats_.coalesced += triggers - 1U;
+    }
+
+    return written;
+}
+
+void AudioEventCollector::reset() noexcept {
+    pending_.fill(0U);
+    pendingTriggers_.fill(0U);
+    pendingTileValues_.fill(0);
+    everEmitted_.fill(false);
+}
+
+AudioEventCollector::Stats AudioEventCollector::stats() const noexcept {
+    return stats_;
+}
+
+float AudioEventCollector::mergeVolumeScale(const std::uint32_t count) noexcept {
+    const std::uint32_t extra = std::clamp(count, 1U, kMergeScaleSaturation) - 1U;
+    return 1.f + kMergeVolumeStep * static_cast<float>(extra);
+}
+
+float AudioEventCollector::mergePitch(const std::uint32_t count) noexcept {
+    const std::uint32_t extra = std::clamp(count, 1U, kMergeScaleSaturation) - 1U;
+    return 1.f + kMergePitchStep * static_cast<float>(extra);
+}
+
+} // namespace app
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "app/SoundEffect.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace app {
+
+struct AudioEvent {
+    SoundEffect effect{SoundEffect::TileSlide};
+    std::uint32_t count{1};
+    // Largest tile value reported with the frame's triggers; 0 when none was given.
+    int tileValue{0};
+    float volumeScale{1.f};
+    float pitch{1.f};
+};
+
+// Collects the sound triggers of one frame and turns them into at most one event per effect.
+// Duplicate triggers are merged, effects retriggered sooner than their minimum interval are
+// dropped, and merge events get louder and higher instead of being replayed per merge.
+class AudioEventCollector {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using RetriggerIntervals = std::array<std::chrono::milliseconds, kSoundEffectCount>;
+    using FrameEvents = std::array<AudioEvent, kSoundEffectCount>;
+
+    struct Stats {
+        std::uint64_t triggers{0};
+        std::uint64_t emitted{0};
+        std::uint64_t coalesced{0};
+        std::uint64_t rateLimited{0};
+    };
+
+    explicit AudioEventCollector(const RetriggerIntervals &intervals) noexcept;
+
+    void trigger(SoundEffect effect, std::uint32_t count = 1, int tileValue = 0) noexcept;
+
+    // Writes this frame's events to the front of `out`, in `SoundEffect` order, and returns
+    // how many were written. Pending triggers are cleared either way.
+    std::size_t flush(Clock::time_point now, FrameEvents &out) noexcept;
+    void reset() noexcept;
+
+    Stats stats() const noexcept;
+
+    static float mergeVolumeScale(std::uint32_t count) noexcept;
+    static float mergePitch(std::uint32_t count) noexcept;
+
+  private:
+    RetriggerIntervals intervals_{};
+    std::array<std::uint32_t, kSoundEffectCount> pending_{};
+    std::array<std::uint32_t, kSoundEffectCount> pendingTriggers_{};
+    std::array<int, kSoundEffectCount> pendingTileValues_{};
+    std::array<Clock::time_point, kSoundEffectCount> lastEmitted_{};
+    std::array<bool, kSoundEffectCount> everEmitted_{};
+    Stats stats_;
+};
+
+} // namespace app
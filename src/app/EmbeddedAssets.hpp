@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+namespace app::embedded {
+
+struct EmbeddedAsset {
+    const char *relativePath;
+    const unsigned char *data;
+    std::size_t size;
+};
+
+// Defined by the EmbeddedAssets.cpp that cmake/EmbedAssets.cmake generates at build time when
+// SFML_2048_EMBED_ASSETS is enabled.
+extern const EmbeddedAsset kAssets[];
+extern const std::size_t kAssetCount;
+
+} // namespace app::embedded
@@ -0,0 +1,373 @@
+#include "app/EventLog.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <system_error>
+#include <utility>
+
+namespace app {
+
+namespace {
+
+using Json = nlohmann::ordered_json;
+
+constexpr std::array<char, 4> kMagic = {'S', '2', 'E', 'L'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kHeaderSize = 24;
+
+template <typename T> void appendRaw(std::vector<char> &bytes, const T value) {
+    const auto *raw = reinterpret_cast<const char *>(&value);
+    bytes.insert(bytes.end(), raw, raw + sizeof(T));
+}
+
+template <typename T> T readRaw(const char *data) {
+    T value{};
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+std::uint32_t clampToU32(const long long value) {
+    return static_cast<std::uint32_t>(std::clamp<long long>(
+        value, 0, static_cast<long long>(std::numeric_limits<std::uint32_t>::max())));
+}
+
+std::uint16_t clampToU16(const std::uint32_t value) {
+    return static_cast<std::uint16_t>(
+        std::min<std::uint32_t>(value, std::numeric_limits<std::uint16_t>::max()));
+}
+
+std::filesystem::path rotatedPath(const std::filesystem::path &path, const unsigned int index) {
+    auto rotated = path;
+    rotated += '.';
+    rotated += std::to_string(index);
+    return rotated;
+}
+
+const char *directionName(const std::uint8_t code) {
+    constexpr std::array<const char *, 4> kNames = {"up", "down", "left", "right"};
+    return code < kNames.size() ? kNames[code] : "unknown";
+}
+
+const char *sceneName(const std::uint8_t code) {
+    constexpr std::array<const char *, 4> kNames = {"splash", "high_scores", "playing",
+                                                    "game_over"};
+    return code < kNames.size() ? kNames[code] : "unknown";
+}
+
+const char *effectName(const std::uint8_t code) {
+    constexpr std::array<const char *, kSoundEffectCount> kNames = {
+        "tile_slide", "merge", "spawn", "game_over", "high_score"};
+    return code < kNames.size() ? kNames[code] : "unknown";
+}
+
+} // namespace
+
+EventLog::EventLog(EventLogConfig config)
+    : config_(std::move(config)), startedNs_(monotonicNs()),
+      startedUnixNs_(static_cast<std::uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::system_clock::now().time_since_epoch())
+              .count())) {
+}
+
+EventLog::~EventLog() {
+    stop();
+}
+
+bool EventLog::start(std::string &error) {
+    if (thread_.joinable()) {
+        return true;
+    }
+    if constexpr (std::endian::native != std::endian::little) {
+        error = "event logs are written on little-endian hosts only";
+        return false;
+    }
+    if (config_.maxFileBytes < kHeaderSize + sizeof(EventRecord) || config_.maxFiles == 0U) {
+        error = "an event log file must hold at least one record";
+        return false;
+    }
+    // A log left by an earlier run is the interesting one after a crash; keep it.
+    std::error_code ec;
+    if (std::filesystem::exists(config_.path, ec) && !rotate()) {
+        error = lastError();
+        return false;
+    }
+    if (!out_.is_open() && !openFile()) {
+        error = lastError();
+        return false;
+    }
+
+    stopping_ = false;
+    thread_ = std::thread([this] { runLoop(); });
+    return true;
+}
+
+void EventLog::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+    out_.close();
+}
+
+void EventLog::recordMove(const core2048::Direction direction,
+                          const core2048::MoveResult &result, const int score) noexcept {
+    const auto merges = clampToU16(static_cast<std::uint32_t>(result.mergeCount));
+    record(EventType::Move, static_cast<std::uint8_t>(direction), merges,
+           clampToU32(result.scoreDelta), clampToU32(score));
+    if (result.mergeCount > 0) {
+        record(EventType::Merge, 0, merges, clampToU32(result.maxMergedValue), 0);
+    }
+    if (result.spawnedTile.has_value()) {
+        const auto &spawned = *result.spawnedTile;
+        record(EventType::Spawn,
+               static_cast<std::uint8_t>(spawned.row * core2048::Game::kGridSize + spawned.col), 0,
+               clampToU32(spawned.value), 0);
+    }
+}
+
+void EventLog::recordSceneChange(const LoggedScene from, const LoggedScene to,
+                                 const int score) noexcept {
+    record(EventType::SceneChange, static_cast<std::uint8_t>(from),
+           static_cast<std::uint16_t>(to), clampToU32(score), 0);
+}
+
+void EventLog::recordSound(const SoundEffect effect, const std::uint32_t count,
+                           const int tileValue) noexcept {
+    record(EventType::Sound, static_cast<std::uint8_t>(soundEffectIndex(effect)),
+           clampToU16(count), clampToU32(tileValue), 0);
+}
+
+void EventLog::recordSlowFrame(const std::chrono::nanoseconds frameTime,
+                               const std::chrono::nanoseconds budget) noexcept {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    record(EventType::SlowFrame, 0, 0, clampToU32(duration_cast<microseconds>(frameTime).count()),
+           clampToU32(duration_cast<microseconds>(budget).count()));
+}
+
+std::size_t EventLog::drain(std::vector<EventRecord> &out) {
+    std::size_t drained = 0;
+    while (const auto event = queue_.tryPop()) {
+        out.push_back(*event);
+        ++drained;
+    }
+    return drained;
+}
+
+std::uint64_t EventLog::droppedRecords() const noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t EventLog::writtenRecords() const noexcept {
+    return written_.load(std::memory_order_relaxed);
+}
+
+std::string EventLog::lastError() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+void EventLog::runLoop() {
+    std::vector<EventRecord> batch;
+    batch.reserve(kCapacity);
+    bool stopping = false;
+    while (!stopping) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait_for(lock, config_.flushInterval, [this] { return stopping_; });
+            stopping = stopping_;
+        }
+        batch.clear();
+        // Once stopping, the game thread has no more records to add, so one drain gets all.
+        if (drain(batch) > 0U && writeRecords(batch)) {
+            written_.fetch_add(batch.size(), std::memory_order_relaxed);
+        }
+    }
+}
+
+bool EventLog::writeRecords(const std::vector<EventRecord> &records) {
+    if (!out_.is_open()) {
+        return false;
+    }
+    std::size_t next = 0;
+    while (next < records.size()) {
+        const std::uint64_t room = (config_.maxFileBytes - fileBytes_) / sizeof(EventRecord);
+        if (room == 0U) {
+            if (!rotate() || !openFile()) {
+                return false;
+            }
+            continue;
+        }
+        const auto count =
+            static_cast<std::size_t>(std::min<std::uint64_t>(room, records.size() - next));
+        out_.write(reinterpret_cast<const char *>(records.data() + next),
+                   static_cast<std::streamsize>(count * sizeof(EventRecord)));
+        fileBytes_ += count * sizeof(EventRecord);
+        next += count;
+    }
+    out_.flush();
+    if (!out_) {
+        setError("cannot write " + config_.path.string());
+        out_.close();
+        return false;
+    }
+    return true;
+}
+
+bool EventLog::openFile() {
+    out_.open(config_.path, std::ios::binary | std::ios::trunc);
+    std::vector<char> header(kMagic.begin(), kMagic.end());
+    appendRaw(header, kVersion);
+    appendRaw(header, static_cast<std::uint32_t>(sizeof(EventRecord)));
+    appendRaw(header, std::uint32_t{0});
+    appendRaw(header, startedUnixNs_);
+    out_.write(header.data(), static_cast<std::streamsize>(header.size()));
+    out_.flush();
+    if (!out_) {
+        setError("cannot create " + config_.path.string());
+        out_.close();
+        return false;
+    }
+    fileBytes_ = header.size();
+    return true;
+}
+
+bool EventLog::rotate() {
+    out_.close();
+    std::error_code ec;
+    if (config_.maxFiles == 1U) {
+        std::filesystem::remove(config_.path, ec);
+        return true;
+    }
+    std::filesystem::remove(rotatedPath(config_.path, config_.maxFiles - 1U), ec);
+    for (unsigned int index = config_.maxFiles - 1U; index > 1U; --index) {
+        const auto from = rotatedPath(config_.path, index - 1U);
+        if (std::filesystem::exists(from, ec)) {
+            std::filesystem::rename(from, rotatedPath(config_.path, index), ec);
+        }
+    }
+    std::filesystem::rename(config_.path, rotatedPath(config_.path, 1U), ec);
+    if (ec) {
+        setError("cannot rotate " + config_.path.string() + ": " + ec.message());
+        return false;
+    }
+    return true;
+}
+
+void EventLog::setError(const std::string &error) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (error_.empty()) {
+        error_ = error;
+    }
+}
+
+bool readEventLog(const std::filesystem::path &path, EventLogFile &file, std::string &error) {
+    const std::string name = path.string();
+    if constexpr (std::endian::native != std::endian::little) {
+        error = "event logs are read on little-endian hosts only";
+        return false;
+    }
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        error = "cannot open " + name;
+        return false;
+    }
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(in)),
+                                  std::istreambuf_iterator<char>());
+    if (bytes.size() < kHeaderSize ||
+        std::memcmp(bytes.data(), kMagic.data(), kMagic.size()) != 0) {
+        error = name + ": not an event log";
+        return false;
+    }
+    if (readRaw<std::uint32_t>(bytes.data() + 4) != kVersion ||
+        readRaw<std::uint32_t>(bytes.data() + 8) != sizeof(EventRecord)) {
+        error = name + ": unsupported event log version";
+        return false;
+    }
+
+    file = {};
+    file.startedUnixNs = readRaw<std::uint64_t>(bytes.data() + 16);
+    const std::size_t payload = bytes.size() - kHeaderSize;
+    file.records.resize(payload / sizeof(EventRecord));
+    std::memcpy(file.records.data(), bytes.data() + kHeaderSize,
+                file.records.size() * sizeof(EventRecord));
+    file.truncated = payload % sizeof(EventRecord) != 0U;
+    return true;
+}
+
+std::vector<std::filesystem::path> eventLogFiles(const std::filesystem::path &path) {
+    std::vector<std::filesystem::path> files;
+    std::error_code ec;
+    for (unsigned int index = 1; std::filesystem::exists(rotatedPath(path, index), ec);
+         ++index) {
+        files.push_back(rotatedPath(path, index));
+    }
+    std::reverse(files.begin(), files.end());
+    if (std::filesystem::exists(path, ec)) {
+        files.push_back(path);
+    }
+    return files;
+}
+
+std::string eventJsonLine(const EventRecord &record, const std::uint64_t startedUnixNs) {
+    Json line;
+    line["seq"] = record.sequence;
+    line["time_ns"] = record.timeNs;
+    line["unix_ms"] = (startedUnixNs + record.timeNs) / 1'000'000U;
+    switch (record.type) {
+    case EventType::Move:
+        line["event"] = "move";
+        line["direction"] = directionName(record.code);
+        line["merges"] = record.count;
+        line["score_delta"] = record.value;
+        line["score"] = record.extra;
+        break;
+    case EventType::Spawn:
+        line["event"] = "spawn";
+        line["row"] = record.code / core2048::Game::kGridSize;
+        line["col"] = record.code % core2048::Game::kGridSize;
+        line["value"] = record.value;
+        break;
+    case EventType::Merge:
+        line["event"] = "merge";
+        line["merges"] = record.count;
+        line["max_value"] = record.value;
+        break;
+    case EventType::SceneChange:
+        line["event"] = "scene";
+        line["from"] = sceneName(record.code);
+        line["to"] = sceneName(static_cast<std::uint8_t>(record.count));
+        line["score"] = record.value;
+        break;
+    case EventType::Sound:
+        line["event"] = "sound";
+        line["effect"] = effectName(record.code);
+        line["count"] = record.count;
+        line["tile"] = record.value;
+        break;
+    case EventType::SlowFrame:
+        line["event"] = "slow_frame";
+        line["frame_us"] = record.value;
+        line["budget_us"] = record.extra;
+        break;
+    default:
+        line["event"] = "unknown";
+        line["type"] = static_cast<unsigned int>(record.type);
+        break;
+    }
+    return line.dump();
+}
+
+} // namespace app
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "app/SoundEffect.hpp"
+#include "app/SpscQueue.hpp"
+#include "core/Game.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+namespace app {
+
+enum class EventType : std::uint8_t {
+    Move = 1,
+    Spawn,
+    Merge,
+    SceneChange,
+    Sound,
+    SlowFrame,
+};
+
+// Scenes as logged; independent of the app's own scene enum so old logs keep decoding.
+enum class LoggedScene : std::uint8_t { Splash, HighScores, Playing, GameOver };
+
+// One event. What `code`, `count`, `value` and `extra` hold depends on `type`:
+//   Move        direction,            merges,        score delta,      score after
+//   Spawn       cell (row * 4 + col), -,             tile value,       -
+//   Merge       -,                    merges,        largest merged,   -
+//   SceneChange from scene,           to scene,      score on leaving, -
+//   Sound       effect,               trigger count, tile value,       -
+//   SlowFrame   -,                    -,             frame time in us, budget in us
+struct EventRecord {
+    // Since the log was created, on the monotonic clock (see `EventLog::monotonicNs`).
+    std::uint64_t timeNs{0};
+    // Counts every record, including dropped ones, so a gap in a file shows a drop.
+    std::uint32_t sequence{0};
+    EventType type{EventType::Move};
+    std::uint8_t code{0};
+    std::uint16_t count{0};
+    std::uint32_t value{0};
+    std::uint32_t extra{0};
+};
+
+static_assert(sizeof(EventRecord) == 24, "event records are 24 bytes on disk");
+
+struct EventLogConfig {
+    // The current file; full files move to `<path>.1`, `<path>.2`, ... like logrotate.
+    std::filesystem::path path;
+    std::uint64_t maxFileBytes{1U << 20U};
+    // Files kept, counting the current one.
+    unsigned int maxFiles{4};
+    // How often buffered records are written and flushed; a crash loses at most this much.
+    std::chrono::milliseconds flushInterval{250};
+};
+
+// Post-mortem log of gameplay events. `record` copies a 24-byte record into a wait-free
+// single-producer ring buffer and returns; a background thread writes the buffer to rotating
+// files, so the game thread never formats text or touches the disk. All `record*` calls must
+// come from one thread. When the buffer is full the record is dropped and counted.
+//
+// File layout (`.s2el`, little-endian): magic "S2EL", u32 version, u32 record size, u32 zero,
+// u64 log start in Unix nanoseconds, then records back to back.
+class EventLog {
+  public:
+    static constexpr std::size_t kCapacity = 8192;
+
+    explicit EventLog(EventLogConfig config);
+    // Stops the thread after writing what is buffered.
+    ~EventLog();
+
+    EventLog(const EventLog &) = delete;
+    EventLog &operator=(const EventLog &) = delete;
+
+    // Opens the file, replacing one left by an earlier run after rotating it, and starts the
+    // writer thread.
+    bool start(std::string &error);
+    void stop();
+
+    void record(EventType type, std::uint8_t code, std::uint16_t count, std::uint32_t value,
+                std::uint32_t extra) noexcept {
+        const EventRecord event{monotonicNs() - startedNs_, sequence_++, type, code, count, value,
+                                extra};
+        if (!queue_.tryPush(event)) {
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1U,
+                           std::memory_order_relaxed);
+        }
+    }
+
+    // A Move record, then Merge and Spawn records when the move merged or spawned.
+    void recordMove(core2048::Direction direction, const core2048::MoveResult &result,
+                    int score) noexcept;
+    void recordSceneChange(LoggedScene from, LoggedScene to, int score) noexcept;
+    void recordSound(SoundEffect effect, std::uint32_t count, int tileValue) noexcept;
+    void recordSlowFrame(std::chrono::nanoseconds frameTime,
+                         std::chrono::nanoseconds budget) noexcept;
+
+    // Moves every buffered record into `out` and returns how many. The writer thread is the
+    // consumer once started; before that, tests and benchmarks may drain the buffer here.
+    std::size_t drain(std::vector<EventRecord> &out);
+
+    std::uint64_t droppedRecords() const noexcept;
+    std::uint64_t writtenRecords() const noexcept;
+    // The first write or rotation failure; empty while everything was written.
+    std::string lastError() const;
+
+    // On Linux the coarse monotonic clock: it advances once per scheduler tick (1-4 ms), which
+    // the sequence numbers make up for, and a read costs a few nanoseconds where a precise one
+    // can take 40 in a VM.
+    static std::uint64_t monotonicNs() noexcept {
+#if defined(__linux__)
+        timespec now{};
+        ::clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+        return static_cast<std::uint64_t>(now.tv_sec) * 1'000'000'000U +
+               static_cast<std::uint64_t>(now.tv_nsec);
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+#endif
+    }
+
+  private:
+    void runLoop();
+    bool writeRecords(const std::vector<EventRecord> &records);
+    bool openFile();
+    bool rotate();
+    void setError(const std::string &error);
+
+    EventLogConfig config_;
+    const std::uint64_t startedNs_;
+    const std::uint64_t startedUnixNs_;
+    std::uint32_t sequence_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> written_{0};
+    SpscQueue<EventRecord, kCapacity> queue_;
+
+    std::ofstream out_;
+    std::uint64_t fileBytes_{0};
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_{false};
+    std::string error_;
+    std::thread thread_;
+};
+
+struct EventLogFile {
+    std::uint64_t startedUnixNs{0};
+    std::vector<EventRecord> records;
+    // The file ended inside a record, as after a crash mid-write; that record is skipped.
+    bool truncated{false};
+};
+
+bool readEventLog(const std::filesystem::path &path, EventLogFile &file, std::string &error);
+
+// The existing files of a log, oldest first: `<path>.N` ... `<path>.1`, `<path>`.
+std::vector<std::filesystem::path> eventLogFiles(const std::filesystem::path &path);
+
+// One JSON object without a trailing newline, e.g.
+// {"seq":7,"time_ns":1200,"unix_ms":...,"event":"move","direction":"left",...}.
+std::string eventJsonLine(const EventRecord &record, std::uint64_t startedUnixNs);
+
+} // namespace app
@@ -0,0 +1,251 @@
+#include "app/MetricsExporter.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace app {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// How long the thread blocks in `poll` before it looks at the stop flag and the file timer.
+constexpr auto kPollInterval = std::chrono::milliseconds(100);
+constexpr std::size_t kMaxRequestBytes = 8192;
+
+#if !defined(_WIN32)
+#if defined(MSG_NOSIGNAL)
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+bool sendAll(const int socket, const std::string_view data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        const auto written = ::send(socket, data.data() + sent, data.size() - sent, kSendFlags);
+        if (written <= 0) {
+            return false;
+        }
+        sent += static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+std::string httpResponse(const std::string_view status, const std::string_view body) {
+    std::string response = "HTTP/1.1 ";
+    response += status;
+    response += "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: ";
+    response += std::to_string(body.size());
+    response += "\r\nConnection: close\r\n\r\n";
+    response += body;
+    return response;
+}
+#endif
+
+} // namespace
+
+MetricsExporter::MetricsExporter(const core2048::MetricsRegistry &registry,
+                                 MetricsExportConfig config)
+    : registry_(registry), config_(std::move(config)) {
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::start(std::string &error) {
+    if (thread_.joinable()) {
+        return true;
+    }
+    if (!writeTextFile(error)) {
+        return false;
+    }
+    if (config_.httpPort.has_value()) {
+#if defined(_WIN32)
+        error = "the metrics HTTP endpoint is not available on Windows; use a text file";
+        return false;
+#else
+        const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listener < 0) {
+            error = std::string("cannot create socket: ") + std::strerror(errno);
+            return false;
+        }
+        const int reuse = 1;
+        ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#if defined(SO_NOSIGPIPE)
+        ::setsockopt(listener, SOL_SOCKET, SO_NOSIGPIPE, &reuse, sizeof(reuse));
+#endif
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(*config_.httpPort);
+        socklen_t length = sizeof(address);
+        if (::bind(listener, reinterpret_cast<sockaddr *>(&address), length) != 0 ||
+            ::listen(listener, 8) != 0 ||
+            ::getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length) != 0) {
+            error = "cannot listen on 127.0.0.1:" + std::to_string(*config_.httpPort) + ": " +
+                    std::strerror(errno);
+            ::close(listener);
+            return false;
+        }
+        listenSocket_ = listener;
+        boundPort_ = ntohs(address.sin_port);
+#endif
+    }
+
+    stopping_ = false;
+    thread_ = std::thread([this] { runLoop(); });
+    return true;
+}
+
+void MetricsExporter::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+#if !defined(_WIN32)
+    if (listenSocket_ >= 0) {
+        ::close(listenSocket_);
+        listenSocket_ = -1;
+    }
+#endif
+    boundPort_ = 0;
+
+    if (!config_.textFile.empty()) {
+        writeTextFileRecordingError();
+    }
+}
+
+bool MetricsExporter::writeTextFile(std::string &error) const {
+    if (config_.textFile.empty()) {
+        return true;
+    }
+
+    auto tempPath = config_.textFile;
+    tempPath += ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        out << registry_.renderPrometheus();
+        if (!out) {
+            error = "cannot write " + tempPath.string();
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, config_.textFile, ec);
+    if (ec) {
+        error = "cannot rename " + tempPath.string() + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+std::uint16_t MetricsExporter::httpPort() const noexcept {
+    return boundPort_;
+}
+
+std::string MetricsExporter::lastError() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+void MetricsExporter::writeTextFileRecordingError() {
+    std::string error;
+    if (!writeTextFile(error)) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (error_.empty()) {
+            error_ = std::move(error);
+        }
+    }
+}
+
+void MetricsExporter::runLoop() {
+    const bool writesFile = !config_.textFile.empty();
+    // `start` has just written the file.
+    auto nextWrite = Clock::now() + config_.interval;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (writesFile && Clock::now() >= nextWrite) {
+            lock.unlock();
+            writeTextFileRecordingError();
+            lock.lock();
+            nextWrite = Clock::now() + config_.interval;
+        }
+
+        const auto wakeAt = writesFile ? nextWrite : Clock::time_point::max();
+        if (listenSocket_ < 0) {
+            wake_.wait_until(lock, wakeAt, [this] { return stopping_; });
+            continue;
+        }
+
+#if !defined(_WIN32)
+        lock.unlock();
+        const auto untilWrite = std::chrono::ceil<std::chrono::milliseconds>(
+            std::max(wakeAt, Clock::now()) - Clock::now());
+        const auto timeout = std::min<std::chrono::milliseconds>(untilWrite, kPollInterval);
+        pollfd listener{listenSocket_, POLLIN, 0};
+        if (::poll(&listener, 1, static_cast<int>(timeout.count())) > 0 &&
+            (listener.revents & POLLIN) != 0) {
+            serveOneRequest();
+        }
+        lock.lock();
+#endif
+    }
+}
+
+void MetricsExporter::serveOneRequest() {
+#if !defined(_WIN32)
+    const int client = ::accept(listenSocket_, nullptr, nullptr);
+    if (client < 0) {
+        return;
+    }
+    // A client that never finishes its request must not stall the file writes.
+    timeval timeout{};
+    timeout.tv_sec = 1;
+    ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < kMaxRequestBytes) {
+        const auto received = ::recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<std::size_t>(received));
+    }
+
+    const std::string_view line = std::string_view(request).substr(0, request.find("\r\n"));
+    if (line.starts_with("GET /metrics ") || line.starts_with("GET /metrics?")) {
+        sendAll(client, httpResponse("200 OK", registry_.renderPrometheus()));
+    } else if (line.starts_with("GET ")) {
+        sendAll(client, httpResponse("404 Not Found", "metrics are served at /metrics\n"));
+    } else {
+        sendAll(client, httpResponse("405 Method Not Allowed", "only GET is supported\n"));
+    }
+    ::close(client);
+#endif
+}
+
+} // namespace app
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "core/Metrics.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace app {
+
+struct MetricsExportConfig {
+    // Rewritten every `interval` through a temporary sibling and a rename, as node_exporter's
+    // textfile collector expects; empty writes no file.
+    std::filesystem::path textFile;
+    std::chrono::milliseconds interval{15000};
+    // Serves `GET /metrics` on 127.0.0.1 only; 0 picks a free port (see `httpPort`).
+    std::optional<std::uint16_t> httpPort;
+};
+
+// Publishes a registry in the Prometheus text format from one background thread, so neither
+// disk writes nor scrapes run on the render thread.
+class MetricsExporter {
+  public:
+    MetricsExporter(const core2048::MetricsRegistry &registry, MetricsExportConfig config);
+    // Stops the thread and writes the file one last time.
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter &) = delete;
+    MetricsExporter &operator=(const MetricsExporter &) = delete;
+
+    // Writes the text file once, binds the listener, if any, and starts the thread. Fails
+    // without starting anything when the file cannot be written, the port is taken, or on
+    // platforms without the HTTP endpoint.
+    bool start(std::string &error);
+    void stop();
+
+    // Writes the text file now, from the calling thread.
+    bool writeTextFile(std::string &error) const;
+    // The bound port once started; 0 when not serving HTTP.
+    std::uint16_t httpPort() const noexcept;
+    // The first failed write of the background thread or `stop`; empty while every write
+    // succeeded.
+    std::string lastError() const;
+
+  private:
+    void runLoop();
+    void serveOneRequest();
+    void writeTextFileRecordingError();
+
+    const core2048::MetricsRegistry &registry_;
+    MetricsExportConfig config_;
+    int listenSocket_{-1};
+    std::uint16_t boundPort_{0};
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_{false};
+    std::string error_;
+    std::thread thread_;
+};
+
+} // namespace app
@@ -0,0 +1,201 @@
+#include "app/SettingsStore.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+namespace app {
+
+namespace {
+
+using Json = nlohmann::json;
+
+std::optional<SettingValue> fromJson(const Json &value) {
+    if (value.is_boolean()) {
+        return SettingValue(value.get<bool>());
+    }
+    if (value.is_number_integer()) {
+        return SettingValue(value.get<std::int64_t>());
+    }
+    if (value.is_number_float()) {
+        return SettingValue(value.get<double>());
+    }
+    if (value.is_string()) {
+        return SettingValue(value.get<std::string>());
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+SettingsStore::SettingsStore(std::filesystem::path filePath,
+                             const std::chrono::milliseconds debounce)
+    : filePath_(std::move(filePath)), debounce_(debounce) {
+    writer_ = std::thread([this] { writerMain(); });
+}
+
+SettingsStore::~SettingsStore() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeWriter_.notify_one();
+    writer_.join();
+}
+
+bool SettingsStore::load() {
+    std::error_code ec;
+    if (!std::filesystem::exists(filePath_, ec)) {
+        return !ec;
+    }
+    if (ec) {
+        return false;
+    }
+
+    std::ifstream in(filePath_);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    Json root;
+    try {
+        in >> root;
+    } catch (const Json::parse_error &) {
+        return false;
+    }
+
+    if (!root.is_object()) {
+        return false;
+    }
+
+    std::map<std::string, SettingValue, std::less<>> loaded;
+    for (const auto &[name, value] : root.items()) {
+        if (auto converted = fromJson(value); converted.has_value()) {
+            loaded.emplace(name, std::move(*converted));
+        }
+    }
+
+    const std::lock_guard<std::mutex> lock(mutex_);
+    values_ = std::move(loaded);
+    return true;
+}
+
+bool SettingsStore::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const std::uint64_t target = generation_;
+    if (writtenGeneration_ >= target) {
+        return lastWriteOk_;
+    }
+
+    flushRequested_ = true;
+    wakeWriter_.notify_one();
+    writeFinished_.wait(lock, [&] { return writtenGeneration_ >= target; });
+    return lastWriteOk_;
+}
+
+const std::filesystem::path &SettingsStore::filePath() const noexcept {
+    return filePath_;
+}
+
+SettingsStore::Stats SettingsStore::stats() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::optional<SettingValue> SettingsStore::find(const std::string_view name) const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (const auto it = values_.find(name); it != values_.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+void SettingsStore::store(const std::string_view name, SettingValue value) {
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (const auto it = values_.find(name); it != values_.end()) {
+            it->second = std::move(value);
+        } else {
+            values_.emplace(std::string(name), std::move(value));
+        }
+
+        ++generation_;
+        ++stats_.sets;
+        if (!dirty_) {
+            dirty_ = true;
+            dirtySince_ = Clock::now();
+        }
+    }
+    wakeWriter_.notify_one();
+}
+
+bool SettingsStore::writeSnapshot(
+    const std::map<std::string, SettingValue, std::less<>> &values) const {
+    const auto parent = filePath_.parent_path();
+    if (!parent.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(parent, ec);
+        if (ec) {
+            return false;
+        }
+    }
+
+    Json root = Json::object();
+    for (const auto &[name, value] : values) {
+        std::visit([&root, &name = name](const auto &held) { root[name] = held; }, value);
+    }
+
+    auto tempPath = filePath_;
+    tempPath += ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+        out << root.dump(2) << '\n';
+        if (!out) {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, filePath_, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+void SettingsStore::writerMain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wakeWriter_.wait(lock, [this] { return dirty_ || stopping_; });
+        if (!dirty_) {
+            return;
+        }
+
+        // Everything set within the window after the first unsaved change lands in one write,
+        // which also spaces writes at least `debounce_` apart.
+        wakeWriter_.wait_until(lock, dirtySince_ + debounce_,
+                               [this] { return stopping_ || flushRequested_; });
+
+        auto snapshot = values_;
+        const std::uint64_t generation = generation_;
+        dirty_ = false;
+        flushRequested_ = false;
+
+        lock.unlock();
+        const bool written = writeSnapshot(snapshot);
+        lock.lock();
+
+        ++(written ? stats_.writes : stats_.failedWrites);
+        lastWriteOk_ = written;
+        writtenGeneration_ = generation;
+        writeFinished_.notify_all();
+    }
+}
+
+} // namespace app
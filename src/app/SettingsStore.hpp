@@ -0,0 +1,136 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace app {
+
+using SettingValue = std::variant<bool, std::int64_t, double, std::string>;
+
+// A typed entry in `settings.json`. Values that are missing, of the wrong type or rejected
+// by `isValid` read back as `defaultValue`.
+template <typename T> struct SettingKey {
+    static_assert(std::is_same_v<T, bool> || std::is_same_v<T, std::int64_t> ||
+                      std::is_same_v<T, double> || std::is_same_v<T, std::string>,
+                  "settings hold bool, int64, double or string values");
+
+    std::string_view name;
+    T defaultValue{};
+    bool (*isValid)(const T &value){nullptr};
+};
+
+namespace settings {
+
+inline constexpr SettingKey<bool> kSoundEnabled{"sound_enabled", true};
+inline constexpr SettingKey<double> kMasterVolume{
+    "master_volume", 100.0, [](const double &value) { return value >= 0.0 && value <= 100.0; }};
+inline constexpr SettingKey<bool> kWavSounds{"wav_sounds", false};
+
+} // namespace settings
+
+// In-memory settings backed by one JSON file. `set` only updates memory and schedules a save;
+// a background thread writes the file at most once per debounce window, through a temporary
+// sibling and a rename, so the render thread never waits on disk I/O.
+class SettingsStore {
+  public:
+    static constexpr std::chrono::milliseconds kDefaultDebounce{1000};
+
+    struct Stats {
+        std::uint64_t sets{0};
+        std::uint64_t writes{0};
+        std::uint64_t failedWrites{0};
+    };
+
+    explicit SettingsStore(std::filesystem::path filePath,
+                           std::chrono::milliseconds debounce = kDefaultDebounce);
+    // Writes any pending change before returning.
+    ~SettingsStore();
+
+    SettingsStore(const SettingsStore &) = delete;
+    SettingsStore &operator=(const SettingsStore &) = delete;
+
+    // A missing file is not an error. Unknown keys with scalar values are kept and written back.
+    bool load();
+
+    template <typename T> T get(const SettingKey<T> &key) const;
+    // Returns false, leaving the stored value untouched, when `value` fails validation.
+    template <typename T> bool set(const SettingKey<T> &key, T value);
+
+    // Writes pending changes now and waits for the write; false if the last write failed.
+    bool flush();
+
+    const std::filesystem::path &filePath() const noexcept;
+    Stats stats() const;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    std::optional<SettingValue> find(std::string_view name) const;
+    void store(std::string_view name, SettingValue value);
+    bool writeSnapshot(const std::map<std::string, SettingValue, std::less<>> &values) const;
+    void writerMain();
+
+    std::filesystem::path filePath_;
+    std::chrono::milliseconds debounce_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeWriter_;
+    std::condition_variable writeFinished_;
+    std::map<std::string, SettingValue, std::less<>> values_;
+    bool dirty_{false};
+    bool flushRequested_{false};
+    bool stopping_{false};
+    bool lastWriteOk_{true};
+    std::uint64_t generation_{0};
+    std::uint64_t writtenGeneration_{0};
+    Clock::time_point dirtySince_{};
+    Stats stats_;
+    std::thread writer_;
+};
+
+template <typename T> T SettingsStore::get(const SettingKey<T> &key) const {
+    const auto stored = find(key.name);
+    if (!stored.has_value()) {
+        return key.defaultValue;
+    }
+
+    T value{};
+    if (const auto *exact = std::get_if<T>(&*stored)) {
+        value = *exact;
+    } else if constexpr (std::is_same_v<T, double>) {
+        // JSON does not distinguish `80` from `80.0`.
+        const auto *integral = std::get_if<std::int64_t>(&*stored);
+        if (integral == nullptr) {
+            return key.defaultValue;
+        }
+        value = static_cast<double>(*integral);
+    } else {
+        return key.defaultValue;
+    }
+
+    if (key.isValid != nullptr && !key.isValid(value)) {
+        return key.defaultValue;
+    }
+    return value;
+}
+
+template <typename T> bool SettingsStore::set(const SettingKey<T> &key, T value) {
+    if (key.isValid != nullptr && !key.isValid(value)) {
+        return false;
+    }
+    store(key.name, SettingValue(std::move(value)));
+    return true;
+}
+
+} // namespace app
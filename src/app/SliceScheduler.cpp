@@ -0,0 +1,38 @@
+#include "app/SliceScheduler.hpp"
+
+#include <algorithm>
+
+namespace app {
+
+namespace {
+
+// Shorter frames move the estimate this fraction of the way down per frame.
+constexpr double kDecay = 0.125;
+
+} // namespace
+
+SliceScheduler::SliceScheduler(const SliceSchedulerConfig &config) : config_(config) {
+}
+
+void SliceScheduler::recordFrameWork(const std::chrono::nanoseconds work) noexcept {
+    if (work >= estimatedWork_) {
+        estimatedWork_ = work;
+        return;
+    }
+    const auto drop = static_cast<double>((estimatedWork_ - work).count()) * kDecay;
+    estimatedWork_ -= std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(drop));
+}
+
+std::chrono::nanoseconds SliceScheduler::estimatedFrameWork() const noexcept {
+    return estimatedWork_;
+}
+
+std::chrono::nanoseconds SliceScheduler::nextSlice() const noexcept {
+    const auto headroom =
+        std::max(config_.frameBudget - estimatedWork_, std::chrono::nanoseconds(0));
+    const auto share = std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(
+        static_cast<double>(headroom.count()) * config_.headroomShare));
+    return std::clamp(share, config_.minSlice, config_.maxSlice);
+}
+
+} // namespace app
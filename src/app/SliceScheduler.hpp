@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+
+namespace app {
+
+struct SliceSchedulerConfig {
+    // Frame time to stay within: the refresh interval, or the frame limit when one is set.
+    std::chrono::nanoseconds frameBudget{std::chrono::nanoseconds(16'666'667)};
+    // Share of the estimated headroom handed out; the rest absorbs frame-to-frame jitter.
+    double headroomShare{0.75};
+    std::chrono::nanoseconds minSlice{std::chrono::microseconds(250)};
+    std::chrono::nanoseconds maxSlice{std::chrono::milliseconds(12)};
+};
+
+// Sizes the slice of each frame spent on background work that runs on the render thread, such
+// as the hint search. It tracks how long frames take without that work: a longer frame raises
+// the estimate at once, while shorter frames lower it gradually, so a single spike shrinks the
+// next slices immediately and the slice only grows back once frames stay short.
+class SliceScheduler {
+  public:
+    explicit SliceScheduler(const SliceSchedulerConfig &config = {});
+
+    // The frame's own work: its time minus the slice and any wait for vertical sync.
+    void recordFrameWork(std::chrono::nanoseconds work) noexcept;
+
+    std::chrono::nanoseconds estimatedFrameWork() const noexcept;
+    std::chrono::nanoseconds nextSlice() const noexcept;
+
+  private:
+    SliceSchedulerConfig config_;
+    std::chrono::nanoseconds estimatedWork_{0};
+};
+
+} // namespace app
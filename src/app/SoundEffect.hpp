@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+
+namespace app {
+
+enum class SoundEffect { TileSlide, Merge, Spawn, GameOver, HighScore };
+
+inline constexpr std::size_t kSoundEffectCount = 5;
+
+constexpr std::size_t soundEffectIndex(const SoundEffect effect) noexcept {
+    return static_cast<std::size_t>(effect);
+}
+
+} // namespace app
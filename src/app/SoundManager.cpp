@@ -1,130 +1,287 @@
 #include "app/SoundManager.hpp"
+#include "app/AssetResolver.hpp"
+#include "core/Metrics.hpp"
 
-#include <nlohmann/json.hpp>
-
-#include <fstream>
-#include <system_error>
+#include <algorithm>
 
 namespace app {
 
 namespace {
 
-using Json = nlohmann::json;
+using TimingClock = std::chrono::steady_clock;
 
 } // namespace
 
-SoundManager::SoundManager(std::filesystem::path soundsDirectory,
-                           std::filesystem::path settingsFilePath)
-    : soundsDirectory_(std::move(soundsDirectory)), settingsFilePath_(std::move(settingsFilePath)) {
+SoundManager::SoundManager(std::filesystem::path soundsRelativeDirectory, SettingsStore &settings)
+    : soundsRelativeDirectory_(std::move(soundsRelativeDirectory)), settings_(settings),
+      enabled_(settings.get(settings::kSoundEnabled)) {
 }
 
-bool SoundManager::loadSettings() {
-    std::error_code ec;
-    if (!std::filesystem::exists(settingsFilePath_, ec)) {
-        return !ec;
-    }
-    if (ec) {
-        return false;
-    }
-
-    std::ifstream in(settingsFilePath_);
-    if (!in.is_open()) {
-        return false;
-    }
+SoundManager::~SoundManager() {
+    stopAudioThread();
+}
 
-    Json root;
-    try {
-        in >> root;
-    } catch (const Json::parse_error &) {
-        return false;
-    }
+void SoundManager::setWavOverride(const bool enabled) noexcept {
+    wavOverride_ = enabled;
+}
 
-    if (!root.is_object()) {
-        return false;
-    }
+bool SoundManager::loadSoundAssets() {
+    stopAudioThread();
+    missingFiles_.clear();
+    stopAllVoices();
 
-    if (root.contains("sound_enabled")) {
-        if (!root["sound_enabled"].is_boolean()) {
-            return false;
-        }
-        enabled_ = root["sound_enabled"].get<bool>();
+    masterVolume_ = static_cast<float>(settings_.get(settings::kMasterVolume));
+    synthesizeSoundAssets();
+    if (wavOverride_) {
+        loadWavOverrides();
     }
 
-    return true;
+    startAudioThread();
+    return missingFiles_.empty();
 }
 
-bool SoundManager::saveSettings() const {
-    const auto parent = settingsFilePath_.parent_path();
-    if (!parent.empty()) {
-        std::error_code ec;
-        std::filesystem::create_directories(parent, ec);
-        if (ec) {
-            return false;
-        }
-    }
-
-    Json root;
-    root["sound_enabled"] = enabled_;
+void SoundManager::synthesizeSoundAssets() {
+    const auto upload = [](sf::SoundBuffer &buffer, const PcmSamples &samples) {
+        return buffer.loadFromSamples(samples.data(), samples.size(), 1U, kSynthSampleRate);
+    };
 
-    std::ofstream out(settingsFilePath_);
-    if (!out.is_open()) {
-        return false;
+    for (std::size_t i = 0; i < kSoundEffectCount; ++i) {
+        auto &audio = effects_[i];
+        audio.loaded = upload(audio.buffer, synthesizeEffect(static_cast<SoundEffect>(i)));
+        audio.synthesized = audio.loaded;
     }
 
-    out << root.dump(2) << '\n';
-    return static_cast<bool>(out);
+    for (std::size_t i = 0; i < kMergeToneCount; ++i) {
+        const int exponent = kMinMergeToneExponent + static_cast<int>(i);
+        if (!upload(mergeTones_[i], synthesizeMergeTone(exponent))) {
+            // Without its tones the merge effect falls back to the single synthesized sample.
+            audioForEffect(SoundEffect::Merge).synthesized = false;
+        }
+    }
 }
 
-bool SoundManager::loadSoundAssets() {
-    missingFiles_.clear();
-
+void SoundManager::loadWavOverrides() {
+    std::vector<SoundEffect> looseEffects;
+    std::vector<std::filesystem::path> loosePaths;
     for (const SoundEffect effect : {SoundEffect::TileSlide, SoundEffect::Merge, SoundEffect::Spawn,
                                      SoundEffect::GameOver, SoundEffect::HighScore}) {
         auto &audio = audioForEffect(effect);
-        audio.loaded = false;
+        const auto relativePath = soundsRelativeDirectory_ / effectFileName(effect);
+        if (const auto inMemory = findInMemoryAsset(relativePath); inMemory.has_value()) {
+            if (audio.buffer.loadFromMemory(inMemory->data(), inMemory->size())) {
+                audio.loaded = true;
+                audio.synthesized = false;
+                continue;
+            }
+        }
 
-        const auto path = soundsDirectory_ / effectFileName(effect);
-        if (!audio.buffer.loadFromFile(path.string())) {
+        looseEffects.push_back(effect);
+        loosePaths.push_back(relativePath);
+    }
+
+    const auto resolutions = defaultAssetResolver().resolveBatch(loosePaths);
+    for (std::size_t i = 0; i < looseEffects.size(); ++i) {
+        const auto path = resolutions[i].resolvedPath.value_or(loosePaths[i]);
+        auto &audio = audioForEffect(looseEffects[i]);
+        if (!resolutions[i].resolvedPath.has_value() || !audio.buffer.loadFromFile(path.string())) {
             missingFiles_.push_back(path);
+            // A failed load may have cleared the buffer; put the synthesized sound back.
+            const auto samples = synthesizeEffect(looseEffects[i]);
+            audio.loaded = audio.buffer.loadFromSamples(samples.data(), samples.size(), 1U,
+                                                        kSynthSampleRate);
             continue;
         }
 
-        audio.sound.setBuffer(audio.buffer);
-        audio.sound.setVolume(effectVolume(effect));
         audio.loaded = true;
+        audio.synthesized = false;
     }
-
-    return missingFiles_.empty();
 }
 
-void SoundManager::play(const SoundEffect effect) {
-    if (!enabled_) {
+void SoundManager::play(const SoundEffect effect, const std::uint32_t count, const int tileValue) {
+    if (!enabled_ || !audioForEffect(effect).loaded) {
         return;
     }
 
-    auto &audio = audioForEffect(effect);
-    if (!audio.loaded) {
-        return;
+    // Labelled by the effect's file name without the extension, e.g. `effect="game_over"`.
+    static const auto playCounters = [] {
+        std::array<core2048::Counter *, kSoundEffectCount> counters{};
+        for (std::size_t i = 0; i < kSoundEffectCount; ++i) {
+            const auto name = std::filesystem::path(effectFileName(static_cast<SoundEffect>(i)));
+            counters[i] = &core2048::MetricsRegistry::global().counter(
+                "sfml_2048_sound_plays_total", "Sound triggers while sound is on, per effect.",
+                {{"effect", name.stem().string()}});
+        }
+        return counters;
+    }();
+    playCounters[soundEffectIndex(effect)]->add(count);
+    if (eventLog_ != nullptr) {
+        eventLog_->recordSound(effect, count, tileValue);
     }
+    eventCollector_.trigger(effect, count, tileValue);
+}
 
-    audio.sound.stop();
-    audio.sound.play();
+void SoundManager::flushFrame() {
+    AudioEventCollector::FrameEvents events;
+    const std::size_t eventCount = eventCollector_.flush(TimingClock::now(), events);
+
+    for (std::size_t i = 0; i < eventCount; ++i) {
+        AudioCommand command;
+        command.type = AudioCommand::Type::Play;
+        command.effect = events[i].effect;
+        command.volume = events[i].volumeScale;
+        command.pitch = events[i].pitch;
+        command.tileValue = events[i].tileValue;
+        enqueue(command);
+    }
 }
 
 bool SoundManager::isEnabled() const noexcept {
     return enabled_;
 }
 
-void SoundManager::setEnabled(const bool enabled) noexcept {
+void SoundManager::setEnabled(const bool enabled) {
     enabled_ = enabled;
+    settings_.set(settings::kSoundEnabled, enabled_);
+    if (!enabled_) {
+        eventCollector_.reset();
+        AudioCommand command;
+        command.type = AudioCommand::Type::StopAll;
+        enqueue(command);
+    }
+}
+
+void SoundManager::toggleEnabled() {
+    setEnabled(!enabled_);
 }
 
-void SoundManager::toggleEnabled() noexcept {
-    enabled_ = !enabled_;
+void SoundManager::setEventLog(EventLog *eventLog) noexcept {
+    eventLog_ = eventLog;
 }
 
-const std::filesystem::path &SoundManager::settingsFilePath() const noexcept {
-    return settingsFilePath_;
+void SoundManager::setMasterVolume(const float volume) {
+    AudioCommand command;
+    command.type = AudioCommand::Type::SetVolume;
+    command.volume = std::clamp(volume, 0.f, 100.f);
+    settings_.set(settings::kMasterVolume, static_cast<double>(command.volume));
+    enqueue(command);
+}
+
+SoundManager::Timings SoundManager::timings() const noexcept {
+    Timings result;
+    result.worstEnqueue = worstEnqueue_;
+    result.worstDeviceCall =
+        std::chrono::nanoseconds(worstDeviceCallNs_.load(std::memory_order_relaxed));
+    result.processedCommands = processedCommands_.load(std::memory_order_relaxed);
+    result.droppedCommands = droppedCommands_;
+    const auto collectorStats = eventCollector_.stats();
+    result.coalescedTriggers = collectorStats.coalesced;
+    result.rateLimitedTriggers = collectorStats.rateLimited;
+    return result;
+}
+
+void SoundManager::startAudioThread() {
+    if (audioThread_.joinable()) {
+        return;
+    }
+
+    audioThreadRunning_.store(true, std::memory_order_release);
+    audioThread_ = std::thread([this] { audioThreadMain(); });
+}
+
+void SoundManager::stopAudioThread() {
+    if (!audioThread_.joinable()) {
+        return;
+    }
+
+    audioThreadRunning_.store(false, std::memory_order_release);
+    commandSignal_.fetch_add(1U, std::memory_order_release);
+    commandSignal_.notify_one();
+    audioThread_.join();
+}
+
+void SoundManager::audioThreadMain() {
+    while (true) {
+        const std::uint32_t observedSignal = commandSignal_.load(std::memory_order_acquire);
+
+        while (const auto command = commands_.tryPop()) {
+            const auto startedAt = TimingClock::now();
+            execute(*command);
+            const auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       TimingClock::now() - startedAt)
+                                       .count();
+
+            if (elapsedNs > worstDeviceCallNs_.load(std::memory_order_relaxed)) {
+                worstDeviceCallNs_.store(elapsedNs, std::memory_order_relaxed);
+            }
+            processedCommands_.fetch_add(1U, std::memory_order_relaxed);
+        }
+
+        if (!audioThreadRunning_.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        commandSignal_.wait(observedSignal, std::memory_order_acquire);
+    }
+
+    stopAllVoices();
+}
+
+void SoundManager::enqueue(const AudioCommand &command) noexcept {
+    if (!audioThreadRunning_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    const auto startedAt = TimingClock::now();
+    if (commands_.tryPush(command)) {
+        commandSignal_.fetch_add(1U, std::memory_order_release);
+        commandSignal_.notify_one();
+    } else {
+        ++droppedCommands_;
+    }
+
+    worstEnqueue_ = std::max(worstEnqueue_, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                TimingClock::now() - startedAt));
+}
+
+void SoundManager::execute(const AudioCommand &command) {
+    switch (command.type) {
+    case AudioCommand::Type::Play:
+        break;
+    case AudioCommand::Type::StopAll:
+        for (auto &voice : voices_) {
+            voice.stop();
+        }
+        return;
+    case AudioCommand::Type::SetVolume:
+        masterVolume_ = command.volume;
+        for (std::size_t v = 0; v < voices_.size(); ++v) {
+            voices_[v].setVolume(voiceVolume(voiceEffects_[v]));
+        }
+        return;
+    }
+
+    const SoundEffect effect = command.effect;
+    const sf::SoundBuffer &buffer = bufferFor(command);
+
+    VoiceAllocator::VoiceFlags busyVoices{};
+    for (std::size_t v = 0; v < voices_.size(); ++v) {
+        busyVoices[v] = voices_[v].getStatus() == sf::Sound::Playing;
+    }
+
+    const auto acquisition = voiceAllocator_.acquire(effect, busyVoices);
+    auto &voice = voices_[acquisition.voice];
+    if (acquisition.stolen) {
+        voice.stop();
+    }
+    if (acquisition.rebind || voiceBuffers_[acquisition.voice] != &buffer) {
+        voice.setBuffer(buffer);
+        voiceEffects_[acquisition.voice] = effect;
+        voiceBuffers_[acquisition.voice] = &buffer;
+    }
+    voice.setVolume(std::min(voiceVolume(effect) * command.volume, 100.f));
+    // Merge tones carry the tile's pitch; the per-frame merge count raises it further.
+    voice.setPitch(command.pitch);
+    voice.play();
 }
 
 const std::vector<std::filesystem::path> &SoundManager::missingFiles() const noexcept {
@@ -148,6 +305,10 @@ const char *SoundManager::effectFileName(const SoundEffect effect) {
     return "unknown.wav";
 }
 
+float SoundManager::voiceVolume(const SoundEffect effect) const noexcept {
+    return effectVolume(effect) * masterVolume_ / 100.f;
+}
+
 float SoundManager::effectVolume(const SoundEffect effect) {
     switch (effect) {
     case SoundEffect::TileSlide:
@@ -165,38 +326,53 @@ float SoundManager::effectVolume(const SoundEffect effect) {
     return 45.f;
 }
 
-SoundManager::EffectAudio &SoundManager::audioForEffect(const SoundEffect effect) {
-    switch (effect) {
-    case SoundEffect::TileSlide:
-        return tileSlide_;
-    case SoundEffect::Merge:
-        return merge_;
-    case SoundEffect::Spawn:
-        return spawn_;
-    case SoundEffect::GameOver:
-        return gameOver_;
-    case SoundEffect::HighScore:
-        return highScore_;
-    }
+VoiceAllocator::PolyphonyLimits SoundManager::polyphonyLimits() {
+    VoiceAllocator::PolyphonyLimits limits{};
+    limits[soundEffectIndex(SoundEffect::TileSlide)] = 3;
+    limits[soundEffectIndex(SoundEffect::Merge)] = 4;
+    limits[soundEffectIndex(SoundEffect::Spawn)] = 2;
+    limits[soundEffectIndex(SoundEffect::GameOver)] = 1;
+    limits[soundEffectIndex(SoundEffect::HighScore)] = 1;
+    return limits;
+}
+
+// A move can trigger slide, merge and spawn together, and held keys or autoplay repeat moves
+// faster than the effects can be told apart; anything sooner than this is dropped.
+AudioEventCollector::RetriggerIntervals SoundManager::retriggerIntervals() {
+    using std::chrono::milliseconds;
+
+    AudioEventCollector::RetriggerIntervals intervals{};
+    intervals[soundEffectIndex(SoundEffect::TileSlide)] = milliseconds(45);
+    intervals[soundEffectIndex(SoundEffect::Merge)] = milliseconds(45);
+    intervals[soundEffectIndex(SoundEffect::Spawn)] = milliseconds(60);
+    intervals[soundEffectIndex(SoundEffect::GameOver)] = milliseconds(0);
+    intervals[soundEffectIndex(SoundEffect::HighScore)] = milliseconds(0);
+    return intervals;
+}
 
-    return tileSlide_;
+SoundManager::EffectAudio &SoundManager::audioForEffect(const SoundEffect effect) {
+    return effects_[soundEffectIndex(effect)];
 }
 
 const SoundManager::EffectAudio &SoundManager::audioForEffect(const SoundEffect effect) const {
-    switch (effect) {
-    case SoundEffect::TileSlide:
-        return tileSlide_;
-    case SoundEffect::Merge:
-        return merge_;
-    case SoundEffect::Spawn:
-        return spawn_;
-    case SoundEffect::GameOver:
-        return gameOver_;
-    case SoundEffect::HighScore:
-        return highScore_;
+    return effects_[soundEffectIndex(effect)];
+}
+
+const sf::SoundBuffer &SoundManager::bufferFor(const AudioCommand &command) const {
+    const auto &audio = audioForEffect(command.effect);
+    if (command.effect == SoundEffect::Merge && audio.synthesized && command.tileValue > 0) {
+        return mergeTones_[mergeToneIndex(command.tileValue)];
     }
+    return audio.buffer;
+}
 
-    return tileSlide_;
+void SoundManager::stopAllVoices() {
+    for (auto &voice : voices_) {
+        voice.stop();
+        voice.resetBuffer();
+    }
+    voiceBuffers_.fill(nullptr);
+    voiceAllocator_.reset();
 }
 
 } // namespace app
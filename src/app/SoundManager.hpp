@@ -1,55 +1,135 @@
 #pragma once
 
+#include "app/AudioEventCollector.hpp"
+#include "app/EventLog.hpp"
+#include "app/SettingsStore.hpp"
+#include "app/SoundEffect.hpp"
+#include "app/SoundSynth.hpp"
+#include "app/SpscQueue.hpp"
+#include "app/VoiceAllocator.hpp"
+
 #include <SFML/Audio/Sound.hpp>
 #include <SFML/Audio/SoundBuffer.hpp>
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
+#include <thread>
 #include <vector>
 
 namespace app {
 
-enum class SoundEffect { TileSlide, Merge, Spawn, GameOver, HighScore };
-
+// Audio device calls run on a dedicated thread. `play` only records a trigger; `flushFrame`
+// coalesces the frame's triggers and pushes the survivors onto a lock-free queue. `play`,
+// `flushFrame`, `setEnabled` and `setMasterVolume` must all be called from the same thread.
 class SoundManager {
   public:
-    SoundManager(std::filesystem::path soundsDirectory, std::filesystem::path settingsFilePath);
+    struct Timings {
+        std::chrono::nanoseconds worstEnqueue{0};
+        std::chrono::nanoseconds worstDeviceCall{0};
+        std::uint64_t processedCommands{0};
+        std::uint64_t droppedCommands{0};
+        std::uint64_t coalescedTriggers{0};
+        std::uint64_t rateLimitedTriggers{0};
+    };
 
-    bool loadSettings();
-    bool saveSettings() const;
+    // Effects are synthesized in memory by default. `soundsRelativeDirectory` is an asset path
+    // such as `assets/sounds` holding the optional WAV overrides (see `setWavOverride`).
+    // `settings` supplies the persisted on/off state and master volume and must outlive this.
+    SoundManager(std::filesystem::path soundsRelativeDirectory, SettingsStore &settings);
+    ~SoundManager();
 
+    SoundManager(const SoundManager &) = delete;
+    SoundManager &operator=(const SoundManager &) = delete;
+
+    // Takes effect on the next `loadSoundAssets`. Each WAV found (embedded, packed or loose)
+    // replaces the synthesized effect it names; missing ones are listed in `missingFiles`.
+    void setWavOverride(bool enabled) noexcept;
     bool loadSoundAssets();
-    void play(SoundEffect effect);
+    // `count` is the number of occurrences this trigger stands for, e.g. merges in one move.
+    // `tileValue` picks the pre-rendered merge tone for synthesized merges.
+    void play(SoundEffect effect, std::uint32_t count = 1, int tileValue = 0);
+    // Call once per frame.
+    void flushFrame();
 
     bool isEnabled() const noexcept;
-    void setEnabled(bool enabled) noexcept;
-    void toggleEnabled() noexcept;
+    // Both persist through the settings store.
+    void setEnabled(bool enabled);
+    void toggleEnabled();
+    void setMasterVolume(float volume);
+    // Triggers are recorded here while sound is on; null stops recording. Not owned.
+    void setEventLog(EventLog *eventLog) noexcept;
+
+    Timings timings() const noexcept;
 
-    const std::filesystem::path &settingsFilePath() const noexcept;
     const std::vector<std::filesystem::path> &missingFiles() const noexcept;
 
   private:
     struct EffectAudio {
         sf::SoundBuffer buffer;
-        sf::Sound sound;
         bool loaded{false};
+        bool synthesized{false};
+    };
+
+    struct AudioCommand {
+        enum class Type : std::uint8_t { Play, StopAll, SetVolume };
+
+        Type type{Type::Play};
+        SoundEffect effect{SoundEffect::TileSlide};
+        // Master volume for SetVolume, gain on top of the effect volume for Play.
+        float volume{1.f};
+        float pitch{1.f};
+        int tileValue{0};
     };
 
+    static constexpr std::size_t kCommandQueueCapacity = 256;
+
     static const char *effectFileName(SoundEffect effect);
     static float effectVolume(SoundEffect effect);
+    static VoiceAllocator::PolyphonyLimits polyphonyLimits();
+    static AudioEventCollector::RetriggerIntervals retriggerIntervals();
+    float voiceVolume(SoundEffect effect) const noexcept;
 
     EffectAudio &audioForEffect(SoundEffect effect);
     const EffectAudio &audioForEffect(SoundEffect effect) const;
+    void stopAllVoices();
+    void synthesizeSoundAssets();
+    void loadWavOverrides();
+    const sf::SoundBuffer &bufferFor(const AudioCommand &command) const;
 
-    std::filesystem::path soundsDirectory_;
-    std::filesystem::path settingsFilePath_;
+    void startAudioThread();
+    void stopAudioThread();
+    void audioThreadMain();
+    void enqueue(const AudioCommand &command) noexcept;
+    void execute(const AudioCommand &command);
+
+    std::filesystem::path soundsRelativeDirectory_;
+    SettingsStore &settings_;
     bool enabled_{true};
+    bool wavOverride_{false};
+    EventLog *eventLog_{nullptr};
+    AudioEventCollector eventCollector_{retriggerIntervals()};
     std::vector<std::filesystem::path> missingFiles_;
 
-    EffectAudio tileSlide_;
-    EffectAudio merge_;
-    EffectAudio spawn_;
-    EffectAudio gameOver_;
-    EffectAudio highScore_;
+    std::array<EffectAudio, kSoundEffectCount> effects_;
+    std::array<sf::SoundBuffer, kMergeToneCount> mergeTones_;
+    std::array<sf::Sound, VoiceAllocator::kVoiceCount> voices_;
+    std::array<SoundEffect, VoiceAllocator::kVoiceCount> voiceEffects_{};
+    std::array<const sf::SoundBuffer *, VoiceAllocator::kVoiceCount> voiceBuffers_{};
+    VoiceAllocator voiceAllocator_{polyphonyLimits()};
+    float masterVolume_{100.f};
+
+    SpscQueue<AudioCommand, kCommandQueueCapacity> commands_;
+    std::atomic<std::uint32_t> commandSignal_{0};
+    std::atomic<bool> audioThreadRunning_{false};
+    std::thread audioThread_;
+
+    std::chrono::nanoseconds worstEnqueue_{0};
+    std::uint64_t droppedCommands_{0};
+    std::atomic<std::int64_t> worstDeviceCallNs_{0};
+    std::atomic<std::uint64_t> processedCommands_{0};
 };
 
 } // namespace app
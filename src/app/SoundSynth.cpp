@@ -0,0 +1,155 @@
+#include "app/SoundSynth.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <numbers>
+
+namespace app {
+
+namespace {
+
+constexpr float kPeakLevel = 0.8f;
+constexpr float kAttackSeconds = 0.004f;
+
+struct Note {
+    float frequency{440.f};
+    float startSeconds{0.f};
+    float durationSeconds{0.1f};
+    // Linear frequency glide over the note, in Hz per second.
+    float glide{0.f};
+    // Exponential decay rate; larger values die out faster.
+    float decay{8.f};
+};
+
+class Renderer {
+  public:
+    Renderer(const unsigned sampleRate, const float totalSeconds)
+        : sampleRate_(static_cast<float>(sampleRate)),
+          mix_(static_cast<std::size_t>(totalSeconds * static_cast<float>(sampleRate)), 0.f) {
+    }
+
+    // Sine with a quieter octave partial, shaped by a short attack and exponential decay.
+    void addNote(const Note &note, const float gain = 1.f) {
+        const auto first = static_cast<std::size_t>(note.startSeconds * sampleRate_);
+        const auto length = static_cast<std::size_t>(note.durationSeconds * sampleRate_);
+        const std::size_t last = std::min(mix_.size(), first + length);
+
+        float phase = 0.f;
+        for (std::size_t i = first; i < last; ++i) {
+            const float t = static_cast<float>(i - first) / sampleRate_;
+            const float attack = std::min(t / kAttackSeconds, 1.f);
+            const float release = std::min((note.durationSeconds - t) / kAttackSeconds, 1.f);
+            const float envelope = attack * release * std::exp(-note.decay * t);
+
+            phase += 2.f * std::numbers::pi_v<float> * (note.frequency + note.glide * t) /
+                     sampleRate_;
+            mix_[i] += gain * envelope * (std::sin(phase) + 0.3f * std::sin(2.f * phase));
+        }
+    }
+
+    // Deterministic one-pole low-passed noise, used for the sliding "whoosh".
+    void addNoise(const float startSeconds, const float durationSeconds, const float decay,
+                  const float smoothing, const float gain) {
+        const auto first = static_cast<std::size_t>(startSeconds * sampleRate_);
+        const auto length = static_cast<std::size_t>(durationSeconds * sampleRate_);
+        const std::size_t last = std::min(mix_.size(), first + length);
+
+        std::uint32_t state = 0x2048U;
+        float filtered = 0.f;
+        for (std::size_t i = first; i < last; ++i) {
+            state = state * 1664525U + 1013904223U;
+            const float white = static_cast<float>(state >> 8U) / 8388608.f - 1.f;
+            filtered += smoothing * (white - filtered);
+
+            const float t = static_cast<float>(i - first) / sampleRate_;
+            const float attack = std::min(t / kAttackSeconds, 1.f);
+            mix_[i] += gain * attack * std::exp(-decay * t) * filtered;
+        }
+    }
+
+    PcmSamples finish() const {
+        float peak = 0.f;
+        for (const float sample : mix_) {
+            peak = std::max(peak, std::abs(sample));
+        }
+
+        const float scale = peak > 0.f ? kPeakLevel * 32767.f / peak : 0.f;
+        PcmSamples samples(mix_.size());
+        std::transform(mix_.begin(), mix_.end(), samples.begin(), [scale](const float sample) {
+            return static_cast<std::int16_t>(std::lround(sample * scale));
+        });
+        return samples;
+    }
+
+  private:
+    float sampleRate_;
+    std::vector<float> mix_;
+};
+
+PcmSamples renderArpeggio(const unsigned sampleRate, const std::initializer_list<float> notes,
+                          const float step, const float noteLength, const float decay) {
+    Renderer renderer(sampleRate, step * static_cast<float>(notes.size() - 1U) + noteLength);
+    float start = 0.f;
+    for (const float frequency : notes) {
+        renderer.addNote({frequency, start, noteLength, 0.f, decay});
+        start += step;
+    }
+    return renderer.finish();
+}
+
+} // namespace
+
+PcmSamples synthesizeEffect(const SoundEffect effect, const unsigned sampleRate) {
+    switch (effect) {
+    case SoundEffect::TileSlide: {
+        Renderer renderer(sampleRate, 0.07f);
+        renderer.addNoise(0.f, 0.07f, 45.f, 0.18f, 1.f);
+        renderer.addNote({320.f, 0.f, 0.07f, -1800.f, 40.f}, 0.25f);
+        return renderer.finish();
+    }
+    case SoundEffect::Merge: {
+        Renderer renderer(sampleRate, 0.12f);
+        renderer.addNote({523.25f, 0.f, 0.12f, 0.f, 22.f});
+        renderer.addNote({783.99f, 0.f, 0.12f, 0.f, 26.f}, 0.5f);
+        return renderer.finish();
+    }
+    case SoundEffect::Spawn: {
+        Renderer renderer(sampleRate, 0.06f);
+        renderer.addNote({880.f, 0.f, 0.06f, 7000.f, 35.f});
+        return renderer.finish();
+    }
+    case SoundEffect::GameOver:
+        return renderArpeggio(sampleRate, {392.f, 329.63f, 261.63f, 196.f}, 0.16f, 0.3f, 6.f);
+    case SoundEffect::HighScore:
+        return renderArpeggio(sampleRate, {523.25f, 659.25f, 783.99f, 1046.5f}, 0.1f, 0.35f,
+                              7.f);
+    }
+
+    return {};
+}
+
+PcmSamples synthesizeMergeTone(const int exponent, const unsigned sampleRate) {
+    // Whole-tone steps from middle C: 4 -> C4, 131072 -> F#6.
+    const int step = std::clamp(exponent, kMinMergeToneExponent, kMaxMergeToneExponent) -
+                     kMinMergeToneExponent;
+    const float frequency = 261.63f * std::exp2(static_cast<float>(step) * 2.f / 12.f);
+
+    Renderer renderer(sampleRate, 0.14f);
+    renderer.addNote({frequency, 0.f, 0.14f, 0.f, 20.f});
+    renderer.addNote({frequency * 1.5f, 0.f, 0.14f, 0.f, 26.f}, 0.45f);
+    return renderer.finish();
+}
+
+std::size_t mergeToneIndex(const int tileValue) noexcept {
+    int exponent = 0;
+    for (int value = tileValue; value > 1; value >>= 1) {
+        ++exponent;
+    }
+    return static_cast<std::size_t>(
+        std::clamp(exponent, kMinMergeToneExponent, kMaxMergeToneExponent) -
+        kMinMergeToneExponent);
+}
+
+} // namespace app
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "app/SoundEffect.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace app {
+
+// Mono 16-bit PCM rendered at startup in place of decoding WAV files.
+using PcmSamples = std::vector<std::int16_t>;
+
+inline constexpr unsigned kSynthSampleRate = 44100;
+
+// One pre-rendered merge tone per tile value from 4 (2^2) to 131072 (2^17).
+inline constexpr int kMinMergeToneExponent = 2;
+inline constexpr int kMaxMergeToneExponent = 17;
+inline constexpr std::size_t kMergeToneCount =
+    static_cast<std::size_t>(kMaxMergeToneExponent - kMinMergeToneExponent + 1);
+
+PcmSamples synthesizeEffect(SoundEffect effect, unsigned sampleRate = kSynthSampleRate);
+PcmSamples synthesizeMergeTone(int exponent, unsigned sampleRate = kSynthSampleRate);
+
+// Maps a merged tile value to its tone slot; values outside 4..131072 are clamped.
+std::size_t mergeToneIndex(int tileValue) noexcept;
+
+} // namespace app
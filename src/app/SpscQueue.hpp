@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+
+namespace app {
+
+// Bounded wait-free queue for exactly one producer thread and one consumer thread.
+// Indices grow monotonically and are masked on access, so all `Capacity` slots are usable.
+template <typename T, std::size_t Capacity> class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+    static_assert(std::is_trivially_copyable_v<T>, "SpscQueue stores trivially copyable items");
+    static_assert(std::atomic<std::size_t>::is_always_lock_free,
+                  "SpscQueue requires lock-free size_t atomics");
+
+  public:
+    static constexpr std::size_t kCapacity = Capacity;
+
+    bool tryPush(const T &item) noexcept {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+
+        slots_[tail & kMask] = item;
+        tail_.store(tail + 1U, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<T> tryPop() noexcept {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+
+        const T item = slots_[head & kMask];
+        head_.store(head + 1U, std::memory_order_release);
+        return item;
+    }
+
+    bool empty() const noexcept {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+  private:
+    static constexpr std::size_t kMask = Capacity - 1U;
+    static constexpr std::size_t kCacheLineSize = 64;
+
+    alignas(kCacheLineSize) std::atomic<std::size_t> head_{0};
+    alignas(kCacheLineSize) std::atomic<std::size_t> tail_{0};
+    alignas(kCacheLineSize) std::array<T, Capacity> slots_{};
+};
+
+} // namespace app
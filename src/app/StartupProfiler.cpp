@@ -0,0 +1,116 @@
+#include "app/StartupProfiler.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <utility>
+
+namespace app {
+
+namespace {
+
+// Column width in characters; phase names are UTF-8 and `std::setw` would count bytes.
+std::size_t displayWidth(const std::string &text) {
+    return static_cast<std::size_t>(std::count_if(text.begin(), text.end(), [](const char c) {
+        return (static_cast<unsigned char>(c) & 0xC0U) != 0x80U;
+    }));
+}
+
+void writePadded(std::ostream &out, const std::string &text, const std::size_t width) {
+    out << text << std::string(width - std::min(width, displayWidth(text)), ' ');
+}
+
+double toMilliseconds(const StartupProfiler::Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+StartupProfiler::Scope::Scope(StartupProfiler &profiler, std::string name)
+    : profiler_(&profiler), name_(std::move(name)), startedAt_(Clock::now()) {
+}
+
+StartupProfiler::Scope::~Scope() {
+    end();
+}
+
+void StartupProfiler::Scope::end() {
+    if (profiler_ == nullptr) {
+        return;
+    }
+    profiler_->record(std::move(name_), startedAt_, Clock::now());
+    profiler_ = nullptr;
+}
+
+StartupProfiler::StartupProfiler() : origin_(Clock::now()) {
+}
+
+StartupProfiler::Scope StartupProfiler::phase(std::string name) {
+    return Scope(*this, std::move(name));
+}
+
+void StartupProfiler::record(std::string name, const Clock::time_point startedAt,
+                             const Clock::time_point endedAt) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    phases_.push_back({std::move(name), startedAt - origin_, endedAt - startedAt});
+}
+
+void StartupProfiler::markFirstFrame() {
+    const auto now = Clock::now();
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!firstFrame_.has_value()) {
+        firstFrame_ = now - origin_;
+    }
+}
+
+std::optional<StartupProfiler::Clock::duration> StartupProfiler::timeToFirstFrame() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return firstFrame_;
+}
+
+StartupProfiler::Clock::duration StartupProfiler::sinceStart() const {
+    return Clock::now() - origin_;
+}
+
+std::vector<StartupProfiler::Phase> StartupProfiler::phases() const {
+    std::vector<Phase> sorted;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        sorted = phases_;
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const Phase &lhs, const Phase &rhs) { return lhs.start < rhs.start; });
+    return sorted;
+}
+
+void StartupProfiler::writeReport(std::ostream &out) const {
+    const auto sortedPhases = phases();
+    std::size_t nameWidth = 3;
+    for (const auto &phase : sortedPhases) {
+        nameWidth = std::max(nameWidth, displayWidth(phase.name));
+    }
+
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+
+    out << "Başlangıç süreleri:\n  ";
+    writePadded(out, "Faz", nameWidth);
+    out << "   başlangıç        süre\n";
+    for (const auto &phase : sortedPhases) {
+        out << "  ";
+        writePadded(out, phase.name, nameWidth);
+        out << std::setw(9) << toMilliseconds(phase.start) << " ms" << std::setw(9)
+            << toMilliseconds(phase.elapsed) << " ms\n";
+    }
+
+    if (const auto firstFrame = timeToFirstFrame(); firstFrame.has_value()) {
+        out << "  ilk kareye kadar: " << toMilliseconds(*firstFrame) << " ms\n";
+    } else {
+        out << "  toplam: " << toMilliseconds(sinceStart()) << " ms (kare çizilmedi)\n";
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace app
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace app {
+
+// Records named startup phases relative to the moment the profiler was created, plus the time
+// to the first presented frame. Phases may be recorded from any thread.
+class StartupProfiler {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase {
+        std::string name;
+        Clock::duration start{};
+        Clock::duration elapsed{};
+    };
+
+    // Ends its phase when destroyed or when `end` is called, whichever comes first.
+    class Scope {
+      public:
+        Scope(StartupProfiler &profiler, std::string name);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        void end();
+
+      private:
+        StartupProfiler *profiler_;
+        std::string name_;
+        Clock::time_point startedAt_;
+    };
+
+    StartupProfiler();
+
+    [[nodiscard]] Scope phase(std::string name);
+    void record(std::string name, Clock::time_point startedAt, Clock::time_point endedAt);
+
+    // Only the first call counts.
+    void markFirstFrame();
+    std::optional<Clock::duration> timeToFirstFrame() const;
+    Clock::duration sinceStart() const;
+
+    // Phases sorted by start time.
+    std::vector<Phase> phases() const;
+    void writeReport(std::ostream &out) const;
+
+  private:
+    Clock::time_point origin_;
+    mutable std::mutex mutex_;
+    std::vector<Phase> phases_;
+    std::optional<Clock::duration> firstFrame_;
+};
+
+} // namespace app
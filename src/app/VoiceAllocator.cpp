@@ -0,0 +1,98 @@
+#include "app/VoiceAllocator.hpp"
+
+#include <algorithm>
+
+namespace app {
+
+VoiceAllocator::VoiceAllocator(const PolyphonyLimits &limits) noexcept : limits_(limits) {
+    for (auto &limit : limits_) {
+        limit = std::clamp<std::size_t>(limit, 1U, kVoiceCount);
+    }
+}
+
+VoiceAllocator::Acquisition VoiceAllocator::acquire(const SoundEffect effect,
+                                                    const VoiceFlags &busyVoices) noexcept {
+    const std::size_t effectIndex = soundEffectIndex(effect);
+
+    std::size_t sameEffectCount = 0;
+    std::size_t oldestSameEffect = kVoiceCount;
+    std::size_t oldestOverall = kVoiceCount;
+    std::size_t freeBoundVoice = kVoiceCount;
+    std::size_t freeVoice = kVoiceCount;
+
+    for (std::size_t v = 0; v < kVoiceCount; ++v) {
+        auto &voice = voices_[v];
+        if (voice.owner != kNoEffect && !busyVoices[v]) {
+            voice.owner = kNoEffect;
+        }
+
+        if (voice.owner == kNoEffect) {
+            if (freeBoundVoice == kVoiceCount && voice.boundEffect == effectIndex) {
+                freeBoundVoice = v;
+            }
+            if (freeVoice == kVoiceCount) {
+                freeVoice = v;
+            }
+            continue;
+        }
+
+        if (voice.owner == effectIndex) {
+            ++sameEffectCount;
+            if (oldestSameEffect == kVoiceCount ||
+                voice.startedAt < voices_[oldestSameEffect].startedAt) {
+                oldestSameEffect = v;
+            }
+        }
+
+        if (oldestOverall == kVoiceCount || voice.startedAt < voices_[oldestOverall].startedAt) {
+            oldestOverall = v;
+        }
+    }
+
+    Acquisition result;
+    if (sameEffectCount >= limits_[effectIndex]) {
+        result.voice = oldestSameEffect;
+        result.stolen = true;
+    } else if (freeBoundVoice != kVoiceCount) {
+        result.voice = freeBoundVoice;
+    } else if (freeVoice != kVoiceCount) {
+        result.voice = freeVoice;
+    } else {
+        result.voice = oldestOverall;
+        result.stolen = true;
+    }
+
+    auto &chosen = voices_[result.voice];
+    result.rebind = chosen.boundEffect != effectIndex;
+    chosen.owner = effectIndex;
+    chosen.boundEffect = effectIndex;
+    chosen.startedAt = ++sequence_;
+
+    if (result.stolen) {
+        ++stolenCount_;
+    }
+    return result;
+}
+
+void VoiceAllocator::reset() noexcept {
+    voices_.fill(Voice{});
+    sequence_ = 0;
+    stolenCount_ = 0;
+}
+
+std::size_t VoiceAllocator::activeVoices(const SoundEffect effect) const noexcept {
+    const std::size_t effectIndex = soundEffectIndex(effect);
+    return static_cast<std::size_t>(
+        std::count_if(voices_.begin(), voices_.end(),
+                      [effectIndex](const Voice &voice) { return voice.owner == effectIndex; }));
+}
+
+std::size_t VoiceAllocator::polyphonyLimit(const SoundEffect effect) const noexcept {
+    return limits_[soundEffectIndex(effect)];
+}
+
+std::uint64_t VoiceAllocator::stolenCount() const noexcept {
+    return stolenCount_;
+}
+
+} // namespace app
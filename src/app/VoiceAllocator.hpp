@@ -0,0 +1,51 @@
+#pragma once
+
+#include "app/SoundEffect.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace app {
+
+// Assigns a fixed set of playback voices to sound effects. Every acquisition scans the whole
+// pool exactly once, so its cost does not depend on how many effects were triggered before.
+class VoiceAllocator {
+  public:
+    static constexpr std::size_t kVoiceCount = 12;
+
+    using PolyphonyLimits = std::array<std::size_t, kSoundEffectCount>;
+    using VoiceFlags = std::array<bool, kVoiceCount>;
+
+    struct Acquisition {
+        std::size_t voice{0};
+        bool stolen{false};
+        bool rebind{false};
+    };
+
+    explicit VoiceAllocator(const PolyphonyLimits &limits) noexcept;
+
+    // `busyVoices` reports which voices are still audible; finished voices are reclaimed first.
+    Acquisition acquire(SoundEffect effect, const VoiceFlags &busyVoices) noexcept;
+    void reset() noexcept;
+
+    std::size_t activeVoices(SoundEffect effect) const noexcept;
+    std::size_t polyphonyLimit(SoundEffect effect) const noexcept;
+    std::uint64_t stolenCount() const noexcept;
+
+  private:
+    static constexpr std::size_t kNoEffect = kSoundEffectCount;
+
+    struct Voice {
+        std::size_t owner{kNoEffect};
+        std::size_t boundEffect{kNoEffect};
+        std::uint64_t startedAt{0};
+    };
+
+    PolyphonyLimits limits_{};
+    std::array<Voice, kVoiceCount> voices_{};
+    std::uint64_t sequence_{0};
+    std::uint64_t stolenCount_{0};
+};
+
+} // namespace app
@@ -17,6 +17,19 @@ void printUsage(std::ostream &out) {
         << "  --fps <uint>       Kare hizini ayarla (0 = sinirsiz)\n"
         << "  --vsync            Dikey senkronu ac (varsayilan)\n"
         << "  --no-vsync         Dikey senkronu kapat\n"
+        << "  --audio-timing     Cikista ses komutu zamanlama ozetini yazdir\n"
+        << "  --startup-trace    Baslangicta varlik cozumleme izini yazdir\n"
+        << "  --wav-sounds       Sentezlenmis sesler yerine WAV dosyalarini kullan\n"
+        << "  --startup-report   Baslangic fazlarinin surelerini ve ilk kare suresini yazdir\n"
+        << "  --headless-startup Pencere acmadan baslangic fazlarini calistir ve cik\n"
+        << "  --startup-budget-ms <uint>\n"
+        << "                     Penceresiz baslangic bu sureyi asarsa hata ile cik\n"
+        << "  --metrics-file <yol>\n"
+        << "                     Prometheus metriklerini 15 saniyede bir bu dosyaya yaz\n"
+        << "  --metrics-port <port>\n"
+        << "                     Metrikleri http://127.0.0.1:<port>/metrics adresinde sun\n"
+        << "  --event-log <yol>  Oyun olaylarini bu ikili dosyaya yaz (sfml_2048_eventlog ile "
+           "coz)\n"
         << "  --help             Bu yardim mesajini goster\n";
 }
 
@@ -75,6 +88,90 @@ int main(int argc, char *argv[]) {
             continue;
         }
 
+        if (arg == "--audio-timing") {
+            config.reportAudioTimings = true;
+            continue;
+        }
+
+        if (arg == "--startup-trace") {
+            config.traceStartup = true;
+            continue;
+        }
+
+        if (arg == "--wav-sounds") {
+            config.wavSounds = true;
+            continue;
+        }
+
+        if (arg == "--startup-report") {
+            config.reportStartup = true;
+            continue;
+        }
+
+        if (arg == "--headless-startup") {
+            config.headlessStartup = true;
+            continue;
+        }
+
+        if (arg == "--startup-budget-ms") {
+            if (i + 1 >= argc) {
+                std::cerr << "--startup-budget-ms bir deger gerektirir\n";
+                return 2;
+            }
+
+            unsigned int budget = 0;
+            if (!parseUnsignedValue(argv[++i], budget)) {
+                std::cerr << "gecersiz baslangic butcesi\n";
+                return 2;
+            }
+            config.startupBudgetMs = budget;
+            continue;
+        }
+
+        if (arg == "--metrics-file") {
+            if (i + 1 >= argc) {
+                std::cerr << "--metrics-file bir deger gerektirir\n";
+                return 2;
+            }
+
+            config.metricsFile = argv[++i];
+            if (config.metricsFile.empty()) {
+                std::cerr << "gecersiz metrik dosyasi\n";
+                return 2;
+            }
+            continue;
+        }
+
+        if (arg == "--event-log") {
+            if (i + 1 >= argc) {
+                std::cerr << "--event-log bir deger gerektirir\n";
+                return 2;
+            }
+
+            config.eventLogFile = argv[++i];
+            if (config.eventLogFile.empty()) {
+                std::cerr << "gecersiz olay gunlugu dosyasi\n";
+                return 2;
+            }
+            continue;
+        }
+
+        if (arg == "--metrics-port") {
+            if (i + 1 >= argc) {
+                std::cerr << "--metrics-port bir deger gerektirir\n";
+                return 2;
+            }
+
+            unsigned int port = 0;
+            if (!parseUnsignedValue(argv[++i], port) || port == 0U ||
+                port > std::numeric_limits<std::uint16_t>::max()) {
+                std::cerr << "gecersiz metrik portu\n";
+                return 2;
+            }
+            config.metricsPort = static_cast<std::uint16_t>(port);
+            continue;
+        }
+
         std::cerr << "Bilinmeyen arguman: " << arg << "\n";
         printUsage(std::cerr);
         return 2;
@@ -1,5 +1,7 @@
 #include "core/Game.hpp"
 
+#include "core/Metrics.hpp"
+
 #include <algorithm>
 #include <cstdint>
 #include <random>
@@ -27,20 +29,33 @@ std::uint32_t nextBounded(std::mt19937 &rng, const std::uint32_t upperExclusive)
     return static_cast<std::uint32_t>(value / bucketSize);
 }
 
+Counter &movesCounter() {
+    static Counter &counter = MetricsRegistry::global().counter(
+        "sfml_2048_game_moves_total", "Moves that changed the board, on every board size.");
+    return counter;
+}
+
+Counter &mergesCounter() {
+    static Counter &counter = MetricsRegistry::global().counter(
+        "sfml_2048_game_merges_total", "Tile merges made by those moves.");
+    return counter;
+}
+
 } // namespace
 
-Game::Game() : Game(static_cast<std::uint32_t>(std::random_device{}())) {
+template <int Size>
+BasicGame<Size>::BasicGame() : BasicGame(static_cast<std::uint32_t>(std::random_device{}())) {
 }
 
-Game::Game(std::uint32_t seed) {
+template <int Size> BasicGame<Size>::BasicGame(std::uint32_t seed) {
     reset(seed);
 }
 
-void Game::reset() {
+template <int Size> void BasicGame<Size>::reset() {
     reset(static_cast<std::uint32_t>(std::random_device{}()));
 }
 
-void Game::reset(std::uint32_t seed) {
+template <int Size> void BasicGame<Size>::reset(std::uint32_t seed) {
     seed_ = seed;
     rng_.seed(seed_);
 
@@ -53,20 +68,21 @@ void Game::reset(std::uint32_t seed) {
     spawnTile();
 }
 
-void Game::loadState(const Grid &grid, int score) {
+template <int Size> void BasicGame<Size>::loadState(const Grid &grid, int score) {
     grid_ = grid;
     score_ = score;
 }
 
-const Game::Grid &Game::getGrid() const noexcept {
+template <int Size>
+const typename BasicGame<Size>::Grid &BasicGame<Size>::getGrid() const noexcept {
     return grid_;
 }
 
-int Game::getScore() const noexcept {
+template <int Size> int BasicGame<Size>::getScore() const noexcept {
     return score_;
 }
 
-bool Game::isGameOver() const {
+template <int Size> bool BasicGame<Size>::isGameOver() const {
     for (int r = 0; r < kGridSize; ++r) {
         for (int c = 0; c < kGridSize; ++c) {
             if (grid_[r][c] == 0) {
@@ -90,7 +106,9 @@ bool Game::isGameOver() const {
     return true;
 }
 
-Game::LineResult Game::slideAndMergeLine(const std::array<int, kGridSize> &line) {
+template <int Size>
+typename BasicGame<Size>::LineResult
+BasicGame<Size>::slideAndMergeLine(const std::array<int, kGridSize> &line) {
     std::vector<int> compact;
     compact.reserve(kGridSize);
 
@@ -108,6 +126,8 @@ Game::LineResult Game::slideAndMergeLine(const std::array<int, kGridSize> &line)
             const int mergedValue = compact[i] * 2;
             result.values[writeIndex++] = mergedValue;
             result.scoreDelta += mergedValue;
+            ++result.mergeCount;
+            result.maxMergedValue = std::max(result.maxMergedValue, mergedValue);
             ++i;
             continue;
         }
@@ -119,7 +139,7 @@ Game::LineResult Game::slideAndMergeLine(const std::array<int, kGridSize> &line)
     return result;
 }
 
-std::optional<SpawnedTile> Game::spawnTile() {
+template <int Size> std::optional<SpawnedTile> BasicGame<Size>::spawnTile() {
     std::vector<std::pair<int, int>> emptyCells;
     emptyCells.reserve(kGridSize * kGridSize);
 
@@ -145,15 +165,17 @@ std::optional<SpawnedTile> Game::spawnTile() {
     return SpawnedTile{row, col, tileValue};
 }
 
-MoveResult Game::applyMove(Direction dir, const bool spawnOnMove) {
+template <int Size> MoveResult BasicGame<Size>::slide(Grid &grid, const Direction dir) {
     bool moved = false;
     int scoreDelta = 0;
+    int mergeCount = 0;
+    int maxMergedValue = 0;
 
     const auto applyToRow = [&](int row, bool reverse) {
         std::array<int, kGridSize> line{};
 
         for (int c = 0; c < kGridSize; ++c) {
-            line[c] = reverse ? grid_[row][kGridSize - 1 - c] : grid_[row][c];
+            line[c] = reverse ? grid[row][kGridSize - 1 - c] : grid[row][c];
         }
 
         const LineResult lineResult = slideAndMergeLine(line);
@@ -163,12 +185,14 @@ MoveResult Game::applyMove(Direction dir, const bool spawnOnMove) {
         }
 
         scoreDelta += lineResult.scoreDelta;
+        mergeCount += lineResult.mergeCount;
+        maxMergedValue = std::max(maxMergedValue, lineResult.maxMergedValue);
 
         for (int c = 0; c < kGridSize; ++c) {
             if (reverse) {
-                grid_[row][kGridSize - 1 - c] = lineResult.values[c];
+                grid[row][kGridSize - 1 - c] = lineResult.values[c];
             } else {
-                grid_[row][c] = lineResult.values[c];
+                grid[row][c] = lineResult.values[c];
             }
         }
     };
@@ -177,7 +201,7 @@ MoveResult Game::applyMove(Direction dir, const bool spawnOnMove) {
         std::array<int, kGridSize> line{};
 
         for (int r = 0; r < kGridSize; ++r) {
-            line[r] = reverse ? grid_[kGridSize - 1 - r][col] : grid_[r][col];
+            line[r] = reverse ? grid[kGridSize - 1 - r][col] : grid[r][col];
         }
 
         const LineResult lineResult = slideAndMergeLine(line);
@@ -187,12 +211,14 @@ MoveResult Game::applyMove(Direction dir, const bool spawnOnMove) {
         }
 
         scoreDelta += lineResult.scoreDelta;
+        mergeCount += lineResult.mergeCount;
+        maxMergedValue = std::max(maxMergedValue, lineResult.maxMergedValue);
 
         for (int r = 0; r < kGridSize; ++r) {
             if (reverse) {
-                grid_[kGridSize - 1 - r][col] = lineResult.values[r];
+                grid[kGridSize - 1 - r][col] = lineResult.values[r];
             } else {
-                grid_[r][col] = lineResult.values[r];
+                grid[r][col] = lineResult.values[r];
             }
         }
     };
@@ -224,15 +250,34 @@ MoveResult Game::applyMove(Direction dir, const bool spawnOnMove) {
         return MoveResult{};
     }
 
-    score_ += scoreDelta;
-
     MoveResult result;
     result.moved = true;
     result.scoreDelta = scoreDelta;
+    result.mergeCount = mergeCount;
+    result.maxMergedValue = maxMergedValue;
+    return result;
+}
+
+template <int Size>
+MoveResult BasicGame<Size>::applyMove(Direction dir, const bool spawnOnMove) {
+    MoveResult result = slide(grid_, dir);
+    if (!result.moved) {
+        return result;
+    }
+
+    score_ += result.scoreDelta;
+    movesCounter().add();
+    if (result.mergeCount > 0) {
+        mergesCounter().add(static_cast<std::uint64_t>(result.mergeCount));
+    }
     if (spawnOnMove) {
         result.spawnedTile = spawnTile();
     }
     return result;
 }
 
+template class BasicGame<2>;
+template class BasicGame<3>;
+template class BasicGame<4>;
+
 } // namespace core2048
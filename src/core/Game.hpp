@@ -18,16 +18,22 @@ struct SpawnedTile {
 struct MoveResult {
     bool moved{false};
     int scoreDelta{0};
+    int mergeCount{0};
+    int maxMergedValue{0};
     std::optional<SpawnedTile> spawnedTile;
 };
 
-class Game {
+// Rules on a `Size` x `Size` board. `Game` (4x4) is the board the app and bots play; the 2x2
+// and 3x3 instantiations exist for exhaustive analysis (see `sfml_2048_solve3x3`).
+template <int Size> class BasicGame {
   public:
-    static constexpr int kGridSize = 4;
+    static_assert(Size >= 2, "a board needs at least two cells per line");
+
+    static constexpr int kGridSize = Size;
     using Grid = std::array<std::array<int, kGridSize>, kGridSize>;
 
-    Game();
-    explicit Game(std::uint32_t seed);
+    BasicGame();
+    explicit BasicGame(std::uint32_t seed);
 
     void reset();
     void reset(std::uint32_t seed);
@@ -35,6 +41,10 @@ class Game {
 
     MoveResult applyMove(Direction dir, bool spawnOnMove = true);
 
+    // Slides and merges `grid` in place without touching any game, score or RNG state; the
+    // result never carries a spawned tile. Bots use it to look ahead.
+    static MoveResult slide(Grid &grid, Direction dir);
+
     const Grid &getGrid() const noexcept;
     int getScore() const noexcept;
     bool isGameOver() const;
@@ -44,6 +54,8 @@ class Game {
         std::array<int, kGridSize> values{};
         bool moved{false};
         int scoreDelta{0};
+        int mergeCount{0};
+        int maxMergedValue{0};
     };
 
     static LineResult slideAndMergeLine(const std::array<int, kGridSize> &line);
@@ -55,4 +67,11 @@ class Game {
     std::uint32_t seed_{0};
 };
 
+// Defined in Game.cpp for these sizes only.
+extern template class BasicGame<2>;
+extern template class BasicGame<3>;
+extern template class BasicGame<4>;
+
+using Game = BasicGame<4>;
+
 } // namespace core2048
@@ -0,0 +1,254 @@
+#include "core/Heuristics.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SFML_2048_HEURISTICS_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace core2048 {
+
+namespace {
+
+constexpr std::size_t kRowCount = 4;
+constexpr std::size_t kRowValues = std::size_t{1} << 16U;
+constexpr int kMaxExponent = 15;
+
+using Line = std::array<int, 4>;
+
+Line unpackLine(const std::size_t row) {
+    Line line{};
+    for (std::size_t i = 0; i < line.size(); ++i) {
+        line[i] = static_cast<int>((row >> (4U * i)) & 0xFU);
+    }
+    return line;
+}
+
+float lineScore(const Line &line, const HeuristicWeights &weights) {
+    float left = 0.0F;
+    float right = 0.0F;
+    for (std::size_t i = 0; i + 1U < line.size(); ++i) {
+        const float a = static_cast<float>(line[i] * line[i] * line[i] * line[i]);
+        const float b = static_cast<float>(line[i + 1U] * line[i + 1U] * line[i + 1U] *
+                                           line[i + 1U]);
+        if (line[i] > line[i + 1U]) {
+            left += a - b;
+        } else {
+            right += b - a;
+        }
+    }
+
+    std::array<int, 4> tiles{};
+    std::size_t tileCount = 0;
+    for (const int exponent : line) {
+        if (exponent != 0) {
+            tiles[tileCount++] = exponent;
+        }
+    }
+    int steps = 0;
+    int merges = 0;
+    for (std::size_t i = 0; i + 1U < tileCount; ++i) {
+        steps += std::abs(tiles[i] - tiles[i + 1U]);
+    }
+    for (std::size_t i = 0; i + 1U < tileCount;) {
+        if (tiles[i] == tiles[i + 1U]) {
+            ++merges;
+            i += 2U;
+        } else {
+            ++i;
+        }
+    }
+
+    return weights.mergePotential * static_cast<float>(merges) -
+           weights.monotonicity * std::min(left, right) -
+           weights.smoothness * static_cast<float>(steps);
+}
+
+float rowScore(const Line &line, const std::size_t rowIndex, const HeuristicWeights &weights) {
+    int empty = 0;
+    float corner = 0.0F;
+    for (std::size_t col = 0; col < line.size(); ++col) {
+        empty += line[col] == 0 ? 1 : 0;
+        // 0 at the top-right cell, 1 at the bottom-left one.
+        const auto cellWeight = static_cast<float>(rowIndex + (line.size() - 1U - col)) / 6.0F;
+        corner += cellWeight * static_cast<float>(line[col]);
+    }
+    return weights.emptyCells * static_cast<float>(empty) + weights.corner * corner;
+}
+
+std::size_t rowOf(const PackedBoard board, const std::size_t row) {
+    return static_cast<std::size_t>((board >> (16U * row)) & 0xFFFFU);
+}
+
+#if defined(SFML_2048_HEURISTICS_AVX2)
+
+__attribute__((target("avx2"))) __m256i transpose4(const __m256i board) {
+    // Same nibble shuffle as transposeBoard, on four boards per register.
+    const __m256i a = _mm256_or_si256(
+        _mm256_and_si256(board, _mm256_set1_epi64x(static_cast<long long>(0xF0F00F0FF0F00F0FULL))),
+        _mm256_or_si256(
+            _mm256_slli_epi64(_mm256_and_si256(board, _mm256_set1_epi64x(0x0000F0F00000F0F0LL)),
+                              12),
+            _mm256_srli_epi64(_mm256_and_si256(board, _mm256_set1_epi64x(0x0F0F00000F0F0000LL)),
+                              12)));
+    return _mm256_or_si256(
+        _mm256_and_si256(a, _mm256_set1_epi64x(static_cast<long long>(0xFF00FF0000FF00FFULL))),
+        _mm256_or_si256(
+            _mm256_srli_epi64(_mm256_and_si256(a, _mm256_set1_epi64x(0x00FF00FF00000000LL)), 24),
+            _mm256_slli_epi64(_mm256_and_si256(a, _mm256_set1_epi64x(0x00000000FF00FF00LL)),
+                              24)));
+}
+
+// Row `row` of eight boards held four per register, as eight 32-bit table indices in board order.
+__attribute__((target("avx2"))) __m256i rowIndices(const __m256i low, const __m256i high,
+                                                    const int row) {
+    const __m128i shift = _mm_cvtsi32_si128(16 * row);
+    const __m256i mask = _mm256_set1_epi64x(0xFFFF);
+    const __m256i lowRows = _mm256_and_si256(_mm256_srl_epi64(low, shift), mask);
+    const __m256i highRows = _mm256_and_si256(_mm256_srl_epi64(high, shift), mask);
+    // Interleaved as low0, high0, low1, high1, ...; the permute restores board order.
+    const __m256i interleaved = _mm256_or_si256(lowRows, _mm256_slli_epi64(highRows, 32));
+    return _mm256_permutevar8x32_epi32(interleaved, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+}
+
+#endif
+
+} // namespace
+
+PackedBoard packBoard(const Game::Grid &grid) noexcept {
+    PackedBoard board = 0;
+    int shift = 0;
+    for (const auto &row : grid) {
+        for (const int value : row) {
+            int exponent = 0;
+            for (int v = value; v > 1 && exponent < kMaxExponent; v >>= 1) {
+                ++exponent;
+            }
+            board |= static_cast<PackedBoard>(exponent) << shift;
+            shift += 4;
+        }
+    }
+    return board;
+}
+
+Game::Grid unpackBoard(PackedBoard board) noexcept {
+    Game::Grid grid{};
+    for (auto &row : grid) {
+        for (int &value : row) {
+            const auto exponent = static_cast<int>(board & 0xFU);
+            value = exponent == 0 ? 0 : 1 << exponent;
+            board >>= 4U;
+        }
+    }
+    return grid;
+}
+
+PackedBoard transposeBoard(const PackedBoard board) noexcept {
+    // Swap the off-diagonal nibbles of each 2x2 block, then the off-diagonal 2x2 blocks.
+    const PackedBoard a = (board & 0xF0F00F0FF0F00F0FULL) |
+                          ((board & 0x0000F0F00000F0F0ULL) << 12U) |
+                          ((board & 0x0F0F00000F0F0000ULL) >> 12U);
+    return (a & 0xFF00FF0000FF00FFULL) | ((a & 0x00FF00FF00000000ULL) >> 24U) |
+           ((a & 0x00000000FF00FF00ULL) << 24U);
+}
+
+BoardEvaluator::BoardEvaluator(const HeuristicWeights &weights)
+    : lineTable_(kRowValues), rowTables_(kRowCount * kRowValues) {
+    for (std::size_t row = 0; row < kRowValues; ++row) {
+        const Line line = unpackLine(row);
+        lineTable_[row] = lineScore(line, weights);
+        for (std::size_t rowIndex = 0; rowIndex < kRowCount; ++rowIndex) {
+            rowTables_[rowIndex * kRowValues + row] = rowScore(line, rowIndex, weights);
+        }
+    }
+}
+
+float BoardEvaluator::evaluate(const PackedBoard board) const noexcept {
+    // The AVX2 batch adds the same terms in the same order, so both paths round identically.
+    float score = 0.0F;
+    for (std::size_t row = 0; row < kRowCount; ++row) {
+        const std::size_t index = rowOf(board, row);
+        score += rowTables_[row * kRowValues + index];
+        score += lineTable_[index];
+    }
+    const PackedBoard columns = transposeBoard(board);
+    for (std::size_t col = 0; col < kRowCount; ++col) {
+        score += lineTable_[rowOf(columns, col)];
+    }
+    return score;
+}
+
+float BoardEvaluator::evaluate(const Game::Grid &grid) const noexcept {
+    return evaluate(packBoard(grid));
+}
+
+void BoardEvaluator::evaluateBatch(const std::span<const PackedBoard> boards,
+                                   const std::span<float> scores) const noexcept {
+    if (batchIsVectorized()) {
+        evaluateBatchAvx2(boards, scores);
+    } else {
+        evaluateBatchScalar(boards, scores);
+    }
+}
+
+bool BoardEvaluator::batchIsVectorized() noexcept {
+#if defined(SFML_2048_HEURISTICS_AVX2)
+    static const bool supported = __builtin_cpu_supports("avx2") != 0;
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void BoardEvaluator::evaluateBatchScalar(const std::span<const PackedBoard> boards,
+                                         const std::span<float> scores) const noexcept {
+    for (std::size_t i = 0; i < boards.size(); ++i) {
+        scores[i] = evaluate(boards[i]);
+    }
+}
+
+#if defined(SFML_2048_HEURISTICS_AVX2)
+
+__attribute__((target("avx2"))) void
+BoardEvaluator::evaluateBatchAvx2(const std::span<const PackedBoard> boards,
+                                  const std::span<float> scores) const noexcept {
+    constexpr std::size_t kLanes = 8;
+    const std::size_t vectorized = boards.size() - boards.size() % kLanes;
+
+    for (std::size_t i = 0; i < vectorized; i += kLanes) {
+        const auto *source = reinterpret_cast<const __m256i *>(boards.data() + i);
+        const __m256i low = _mm256_loadu_si256(source);
+        const __m256i high = _mm256_loadu_si256(source + 1);
+
+        __m256 score = _mm256_setzero_ps();
+        for (int row = 0; row < static_cast<int>(kRowCount); ++row) {
+            const __m256i index = rowIndices(low, high, row);
+            const float *rowTable = rowTables_.data() + static_cast<std::size_t>(row) * kRowValues;
+            score = _mm256_add_ps(score, _mm256_i32gather_ps(rowTable, index, 4));
+            score = _mm256_add_ps(score, _mm256_i32gather_ps(lineTable_.data(), index, 4));
+        }
+        const __m256i lowColumns = transpose4(low);
+        const __m256i highColumns = transpose4(high);
+        for (int col = 0; col < static_cast<int>(kRowCount); ++col) {
+            const __m256i index = rowIndices(lowColumns, highColumns, col);
+            score = _mm256_add_ps(score, _mm256_i32gather_ps(lineTable_.data(), index, 4));
+        }
+        _mm256_storeu_ps(scores.data() + i, score);
+    }
+
+    evaluateBatchScalar(boards.subspan(vectorized), scores.subspan(vectorized));
+}
+
+#else
+
+void BoardEvaluator::evaluateBatchAvx2(const std::span<const PackedBoard> boards,
+                                       const std::span<float> scores) const noexcept {
+    evaluateBatchScalar(boards, scores);
+}
+
+#endif
+
+} // namespace core2048
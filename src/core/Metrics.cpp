@@ -0,0 +1,417 @@
+#include "core/Metrics.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <tuple>
+
+namespace core2048 {
+
+namespace {
+
+// Slot of a metric registered after the shard was full; updates to it are dropped.
+constexpr std::size_t kNoSlot = std::numeric_limits<std::size_t>::max();
+
+std::atomic<std::uint64_t> nextRegistryId{1};
+
+// Registries by id, so a thread exiting after its registry was destroyed finds nothing to
+// return its shard to. Leaked, since threads may still exit during static destruction.
+struct LiveRegistries {
+    std::mutex mutex;
+    std::vector<std::pair<std::uint64_t, MetricsRegistry *>> registries;
+};
+
+LiveRegistries &liveRegistries() {
+    static auto *live = new LiveRegistries;
+    return *live;
+}
+
+std::string numberText(const double value) {
+    if (std::isnan(value)) {
+        return "NaN";
+    }
+    if (std::isinf(value)) {
+        return value > 0.0 ? "+Inf" : "-Inf";
+    }
+    std::ostringstream text;
+    text.imbue(std::locale::classic());
+    text.precision(15);
+    text << value;
+    return text.str();
+}
+
+std::string escaped(const std::string &text, const bool quotes) {
+    std::string result;
+    result.reserve(text.size());
+    for (const char c : text) {
+        if (c == '\\') {
+            result += "\\\\";
+        } else if (c == '\n') {
+            result += "\\n";
+        } else if (c == '"' && quotes) {
+            result += "\\\"";
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+std::string labelsText(const MetricLabels &labels) {
+    std::string text;
+    for (const auto &[name, value] : labels) {
+        if (!text.empty()) {
+            text += ',';
+        }
+        text += name + "=\"" + escaped(value, true) + "\"";
+    }
+    return text;
+}
+
+// `name{labels}` with `extra` appended to the labels, or plain `name` without any.
+std::string seriesName(const std::string &name, const std::string &labels,
+                       const std::string &extra = {}) {
+    if (labels.empty() && extra.empty()) {
+        return name;
+    }
+    std::string joined = labels;
+    if (!joined.empty() && !extra.empty()) {
+        joined += ',';
+    }
+    joined += extra;
+    return name + "{" + joined + "}";
+}
+
+} // namespace
+
+struct MetricsRegistry::Shard {
+    std::array<std::atomic<std::uint64_t>, kMaxSlots> slots{};
+};
+
+struct MetricsRegistry::Entry {
+    enum class Kind { Counter, Gauge, Histogram };
+
+    Kind kind{Kind::Counter};
+    std::string name;
+    std::string help;
+    std::string labels;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<Histogram> histogram;
+};
+
+// Every shard this thread took, returned when the thread exits.
+struct MetricsRegistry::ThreadLeases {
+    std::vector<std::pair<std::uint64_t, Shard *>> shards;
+
+    ~ThreadLeases() {
+        LiveRegistries &live = liveRegistries();
+        const std::lock_guard<std::mutex> lock(live.mutex);
+        for (const auto &[id, shard] : shards) {
+            for (const auto &[liveId, registry] : live.registries) {
+                if (liveId == id) {
+                    registry->retireShard(shard);
+                }
+            }
+        }
+    }
+};
+
+thread_local MetricsRegistry::ShardCache MetricsRegistry::cache_{0, nullptr};
+thread_local MetricsRegistry::ThreadLeases MetricsRegistry::leases_;
+
+Counter::Counter(MetricsRegistry &registry, const std::size_t slot) noexcept
+    : registry_(&registry), slot_(slot) {
+}
+
+void Counter::add(const std::uint64_t amount) noexcept {
+    if (slot_ == kNoSlot) {
+        return;
+    }
+    // Only this thread writes its shard, so a plain load and store cannot lose an update.
+    auto &slot = registry_->localShard().slots[slot_];
+    slot.store(slot.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+std::uint64_t Counter::value() const {
+    if (slot_ == kNoSlot) {
+        return 0;
+    }
+    const std::lock_guard<std::mutex> lock(registry_->mutex_);
+    return registry_->slotTotal(slot_);
+}
+
+void Gauge::set(const double value) noexcept {
+    value_.store(value, std::memory_order_relaxed);
+}
+
+void Gauge::add(const double delta) noexcept {
+    double current = value_.load(std::memory_order_relaxed);
+    while (!value_.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+    }
+}
+
+double Gauge::value() const noexcept {
+    return value_.load(std::memory_order_relaxed);
+}
+
+Histogram::Timer::Timer(Histogram &histogram) noexcept
+    : histogram_(histogram), started_(std::chrono::steady_clock::now()) {
+}
+
+Histogram::Timer::~Timer() {
+    histogram_.observe(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count());
+}
+
+Histogram::Histogram(MetricsRegistry &registry, const std::size_t firstSlot,
+                     std::vector<double> bounds)
+    : registry_(&registry), firstSlot_(firstSlot), bounds_(std::move(bounds)) {
+}
+
+void Histogram::observe(const double value) noexcept {
+    if (firstSlot_ == kNoSlot) {
+        return;
+    }
+    const auto bucket = static_cast<std::size_t>(
+        std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin());
+    auto &slots = registry_->localShard().slots;
+    auto &count = slots[firstSlot_ + bucket];
+    count.store(count.load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+    auto &sum = slots[firstSlot_ + bounds_.size() + 1U];
+    const double total = std::bit_cast<double>(sum.load(std::memory_order_relaxed)) + value;
+    sum.store(std::bit_cast<std::uint64_t>(total), std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snapshot;
+    snapshot.buckets.assign(bounds_.size() + 1U, 0U);
+    if (firstSlot_ == kNoSlot) {
+        return snapshot;
+    }
+    const std::lock_guard<std::mutex> lock(registry_->mutex_);
+    for (std::size_t i = 0; i < snapshot.buckets.size(); ++i) {
+        snapshot.buckets[i] = registry_->slotTotal(firstSlot_ + i);
+        snapshot.count += snapshot.buckets[i];
+    }
+    snapshot.sum = registry_->slotTotalDouble(firstSlot_ + bounds_.size() + 1U);
+    return snapshot;
+}
+
+const std::vector<double> &Histogram::bounds() const noexcept {
+    return bounds_;
+}
+
+MetricsRegistry::MetricsRegistry() : id_(nextRegistryId.fetch_add(1U)) {
+    LiveRegistries &live = liveRegistries();
+    const std::lock_guard<std::mutex> lock(live.mutex);
+    live.registries.emplace_back(id_, this);
+}
+
+MetricsRegistry::~MetricsRegistry() {
+    LiveRegistries &live = liveRegistries();
+    const std::lock_guard<std::mutex> lock(live.mutex);
+    std::erase_if(live.registries, [this](const auto &entry) { return entry.first == id_; });
+}
+
+MetricsRegistry &MetricsRegistry::global() {
+    static auto *registry = new MetricsRegistry;
+    return *registry;
+}
+
+Counter &MetricsRegistry::counter(const std::string &name, const std::string &help,
+                                  const MetricLabels &labels) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const std::string labelText = labelsText(labels);
+    if (Entry *entry = findEntry(name, labelText); entry != nullptr && entry->counter) {
+        return *entry->counter;
+    }
+    auto entry = std::make_unique<Entry>();
+    entry->kind = Entry::Kind::Counter;
+    entry->name = name;
+    entry->help = help;
+    entry->labels = labelText;
+    entry->counter.reset(new Counter(*this, allocateSlots(1U)));
+    entries_.push_back(std::move(entry));
+    return *entries_.back()->counter;
+}
+
+Gauge &MetricsRegistry::gauge(const std::string &name, const std::string &help,
+                              const MetricLabels &labels) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const std::string labelText = labelsText(labels);
+    if (Entry *entry = findEntry(name, labelText); entry != nullptr && entry->gauge) {
+        return *entry->gauge;
+    }
+    auto entry = std::make_unique<Entry>();
+    entry->kind = Entry::Kind::Gauge;
+    entry->name = name;
+    entry->help = help;
+    entry->labels = labelText;
+    entry->gauge = std::make_unique<Gauge>();
+    entries_.push_back(std::move(entry));
+    return *entries_.back()->gauge;
+}
+
+Histogram &MetricsRegistry::histogram(const std::string &name, const std::string &help,
+                                      std::vector<double> bounds, const MetricLabels &labels) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const std::string labelText = labelsText(labels);
+    if (Entry *entry = findEntry(name, labelText); entry != nullptr && entry->histogram) {
+        return *entry->histogram;
+    }
+    const std::size_t firstSlot = allocateSlots(bounds.size() + 2U);
+    if (firstSlot != kNoSlot) {
+        holdsDouble_[firstSlot + bounds.size() + 1U] = true;
+    }
+    auto entry = std::make_unique<Entry>();
+    entry->kind = Entry::Kind::Histogram;
+    entry->name = name;
+    entry->help = help;
+    entry->labels = labelText;
+    entry->histogram.reset(new Histogram(*this, firstSlot, std::move(bounds)));
+    entries_.push_back(std::move(entry));
+    return *entries_.back()->histogram;
+}
+
+std::string MetricsRegistry::renderPrometheus() const {
+    std::vector<const Entry *> sorted;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &entry : entries_) {
+            sorted.push_back(entry.get());
+        }
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Entry *a, const Entry *b) {
+        return std::tie(a->name, a->labels) < std::tie(b->name, b->labels);
+    });
+
+    std::string text;
+    const std::string *previousName = nullptr;
+    for (const Entry *entry : sorted) {
+        if (previousName == nullptr || *previousName != entry->name) {
+            constexpr const char *kTypes[] = {"counter", "gauge", "histogram"};
+            text += "# HELP " + entry->name + " " + escaped(entry->help, false) + "\n";
+            text += "# TYPE " + entry->name + " " + kTypes[static_cast<int>(entry->kind)] + "\n";
+            previousName = &entry->name;
+        }
+
+        switch (entry->kind) {
+        case Entry::Kind::Counter:
+            text += seriesName(entry->name, entry->labels) + " " +
+                    std::to_string(entry->counter->value()) + "\n";
+            break;
+        case Entry::Kind::Gauge:
+            text += seriesName(entry->name, entry->labels) + " " +
+                    numberText(entry->gauge->value()) + "\n";
+            break;
+        case Entry::Kind::Histogram: {
+            const Histogram::Snapshot snapshot = entry->histogram->snapshot();
+            const auto &bounds = entry->histogram->bounds();
+            std::uint64_t cumulative = 0;
+            for (std::size_t i = 0; i < snapshot.buckets.size(); ++i) {
+                cumulative += snapshot.buckets[i];
+                const double bound =
+                    i < bounds.size() ? bounds[i] : std::numeric_limits<double>::infinity();
+                text += seriesName(entry->name + "_bucket", entry->labels,
+                                   "le=\"" + numberText(bound) + "\"") +
+                        " " + std::to_string(cumulative) + "\n";
+            }
+            text += seriesName(entry->name + "_sum", entry->labels) + " " +
+                    numberText(snapshot.sum) + "\n";
+            text += seriesName(entry->name + "_count", entry->labels) + " " +
+                    std::to_string(snapshot.count) + "\n";
+            break;
+        }
+        }
+    }
+    return text;
+}
+
+MetricsRegistry::Shard &MetricsRegistry::localShard() {
+    if (cache_.registryId == id_) {
+        return *cache_.shard;
+    }
+    return acquireShard();
+}
+
+MetricsRegistry::Shard &MetricsRegistry::acquireShard() {
+    for (const auto &[id, shard] : leases_.shards) {
+        if (id == id_) {
+            cache_ = {id_, shard};
+            return *shard;
+        }
+    }
+
+    Shard *shard = nullptr;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (freeShards_.empty()) {
+            shards_.push_back(std::make_unique<Shard>());
+            shard = shards_.back().get();
+        } else {
+            shard = freeShards_.back();
+            freeShards_.pop_back();
+        }
+        activeShards_.push_back(shard);
+    }
+    leases_.shards.emplace_back(id_, shard);
+    cache_ = {id_, shard};
+    return *shard;
+}
+
+void MetricsRegistry::retireShard(Shard *shard) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t slot = 0; slot < nextSlot_; ++slot) {
+        const std::uint64_t value = shard->slots[slot].load(std::memory_order_relaxed);
+        if (holdsDouble_[slot]) {
+            retired_[slot] = std::bit_cast<std::uint64_t>(std::bit_cast<double>(retired_[slot]) +
+                                                          std::bit_cast<double>(value));
+        } else {
+            retired_[slot] += value;
+        }
+        shard->slots[slot].store(0U, std::memory_order_relaxed);
+    }
+    std::erase(activeShards_, shard);
+    freeShards_.push_back(shard);
+}
+
+std::size_t MetricsRegistry::allocateSlots(const std::size_t count) {
+    if (nextSlot_ + count > kMaxSlots) {
+        return kNoSlot;
+    }
+    const std::size_t first = nextSlot_;
+    nextSlot_ += count;
+    return first;
+}
+
+MetricsRegistry::Entry *MetricsRegistry::findEntry(const std::string &name,
+                                                   const std::string &labels) {
+    for (const auto &entry : entries_) {
+        if (entry->name == name && entry->labels == labels) {
+            return entry.get();
+        }
+    }
+    return nullptr;
+}
+
+std::uint64_t MetricsRegistry::slotTotal(const std::size_t slot) const {
+    std::uint64_t total = retired_[slot];
+    for (const Shard *shard : activeShards_) {
+        total += shard->slots[slot].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+double MetricsRegistry::slotTotalDouble(const std::size_t slot) const {
+    double total = std::bit_cast<double>(retired_[slot]);
+    for (const Shard *shard : activeShards_) {
+        total += std::bit_cast<double>(shard->slots[slot].load(std::memory_order_relaxed));
+    }
+    return total;
+}
+
+} // namespace core2048
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace core2048 {
+
+class MetricsRegistry;
+
+// Label names and values of one series, e.g. {{"effect", "merge"}}.
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+// Monotonic count. `add` writes a slot of the calling thread's shard, with no lock and no
+// read-modify-write shared with other threads; `value` sums every shard.
+class Counter {
+  public:
+    void add(std::uint64_t amount = 1) noexcept;
+    std::uint64_t value() const;
+
+  private:
+    friend class MetricsRegistry;
+    Counter(MetricsRegistry &registry, std::size_t slot) noexcept;
+
+    MetricsRegistry *registry_;
+    std::size_t slot_;
+};
+
+// Current level of something. One shared atomic instead of shards: a `set` from one thread
+// replaces what the others set, so there is nothing to merge.
+class Gauge {
+  public:
+    void set(double value) noexcept;
+    void add(double delta) noexcept;
+    double value() const noexcept;
+
+  private:
+    std::atomic<double> value_{0.0};
+};
+
+// Distribution over fixed upper bounds, sharded like `Counter`: every bucket and the running
+// sum are slots of the calling thread's shard.
+class Histogram {
+  public:
+    struct Snapshot {
+        // Per bucket, not cumulative; the last one counts values above every bound.
+        std::vector<std::uint64_t> buckets;
+        std::uint64_t count{0};
+        double sum{0.0};
+    };
+
+    // Observes the time from construction to destruction, in seconds.
+    class Timer {
+      public:
+        explicit Timer(Histogram &histogram) noexcept;
+        ~Timer();
+
+        Timer(const Timer &) = delete;
+        Timer &operator=(const Timer &) = delete;
+
+      private:
+        Histogram &histogram_;
+        std::chrono::steady_clock::time_point started_;
+    };
+
+    void observe(double value) noexcept;
+    Snapshot snapshot() const;
+    const std::vector<double> &bounds() const noexcept;
+
+  private:
+    friend class MetricsRegistry;
+    Histogram(MetricsRegistry &registry, std::size_t firstSlot, std::vector<double> bounds);
+
+    MetricsRegistry *registry_;
+    // Buckets take `bounds_.size() + 1` slots from here, the sum the slot after them.
+    std::size_t firstSlot_;
+    std::vector<double> bounds_;
+};
+
+// Owns metrics and the per-thread shards their updates go to. Registration takes a lock and
+// returns a reference that stays valid for the registry's lifetime; asking again for the same
+// name and labels returns the same metric, so call sites can keep it in a function-local
+// static. A thread's shard is created on its first update and folded into the registry's
+// totals when the thread exits, so values survive worker pools coming and going.
+class MetricsRegistry {
+  public:
+    // Slots per shard: one per counter, `bounds + 2` per histogram. Metrics registered past
+    // the limit count nothing.
+    static constexpr std::size_t kMaxSlots = 512;
+
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry &) = delete;
+    MetricsRegistry &operator=(const MetricsRegistry &) = delete;
+
+    // The registry the game, app and tools report to. Never destroyed, so threads may update
+    // it until the process exits.
+    static MetricsRegistry &global();
+
+    Counter &counter(const std::string &name, const std::string &help,
+                     const MetricLabels &labels = {});
+    Gauge &gauge(const std::string &name, const std::string &help,
+                 const MetricLabels &labels = {});
+    // `bounds` must be ascending; a repeated registration keeps the first bounds.
+    Histogram &histogram(const std::string &name, const std::string &help,
+                         std::vector<double> bounds, const MetricLabels &labels = {});
+
+    // Prometheus text exposition format 0.0.4, series sorted by name and labels.
+    std::string renderPrometheus() const;
+
+  private:
+    friend class Counter;
+    friend class Histogram;
+    struct Shard;
+    struct Entry;
+    struct ThreadLeases;
+    // The last shard this thread used, checked before anything else on every update.
+    struct ShardCache {
+        std::uint64_t registryId;
+        Shard *shard;
+    };
+
+    static thread_local ShardCache cache_;
+    static thread_local ThreadLeases leases_;
+
+    Shard &localShard();
+    Shard &acquireShard();
+    void retireShard(Shard *shard);
+    std::size_t allocateSlots(std::size_t count);
+    Entry *findEntry(const std::string &name, const std::string &labels);
+    std::uint64_t slotTotal(std::size_t slot) const;
+    double slotTotalDouble(std::size_t slot) const;
+
+    const std::uint64_t id_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Entry>> entries_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::vector<Shard *> activeShards_;
+    std::vector<Shard *> freeShards_;
+    // Values of shards whose threads have exited.
+    std::array<std::uint64_t, kMaxSlots> retired_{};
+    // Histogram sums keep a double's bits in their slot and are added as doubles.
+    std::array<bool, kMaxSlots> holdsDouble_{};
+    std::size_t nextSlot_{0};
+};
+
+} // namespace core2048
@@ -0,0 +1,298 @@
+#include "core/MoveSearch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <exception>
+
+namespace core2048 {
+
+namespace {
+
+constexpr std::size_t kRowValues = std::size_t{1} << 16U;
+constexpr int kCellCount = 16;
+constexpr int kMaxExponent = 15;
+constexpr float kFourProbability = 0.1F;
+// A position without legal moves; far below any heuristic score, still finite so weighted sums
+// over spawns stay ordered.
+constexpr float kLostValue = -1.0e12F;
+
+struct MoveTables {
+    std::array<std::uint16_t, kRowValues> left{};
+    std::array<std::uint16_t, kRowValues> right{};
+};
+
+std::uint16_t slideRowLeft(const std::size_t row) {
+    std::array<int, 4> tiles{};
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < 4U; ++i) {
+        const auto exponent = static_cast<int>((row >> (4U * i)) & 0xFU);
+        if (exponent != 0) {
+            tiles[count++] = exponent;
+        }
+    }
+
+    std::uint16_t result = 0;
+    unsigned int shift = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        int exponent = tiles[i];
+        if (i + 1U < count && tiles[i + 1U] == exponent) {
+            exponent = std::min(exponent + 1, kMaxExponent);
+            ++i;
+        }
+        result = static_cast<std::uint16_t>(result | (exponent << shift));
+        shift += 4U;
+    }
+    return result;
+}
+
+std::uint16_t reverseRow(const std::size_t row) {
+    return static_cast<std::uint16_t>(((row & 0xFU) << 12U) | ((row & 0xF0U) << 4U) |
+                                      ((row & 0xF00U) >> 4U) | ((row & 0xF000U) >> 12U));
+}
+
+const MoveTables &moveTables() {
+    static const MoveTables tables = [] {
+        MoveTables built;
+        for (std::size_t row = 0; row < kRowValues; ++row) {
+            built.left[row] = slideRowLeft(row);
+            built.right[row] = reverseRow(slideRowLeft(reverseRow(row)));
+        }
+        return built;
+    }();
+    return tables;
+}
+
+PackedBoard moveRows(const PackedBoard board, const std::array<std::uint16_t, kRowValues> &table) {
+    PackedBoard result = 0;
+    for (unsigned int shift = 0; shift < 64U; shift += 16U) {
+        result |= static_cast<PackedBoard>(table[(board >> shift) & 0xFFFFU]) << shift;
+    }
+    return result;
+}
+
+int emptyCellCount(const PackedBoard board) {
+    int count = 0;
+    for (int cell = 0; cell < kCellCount; ++cell) {
+        count += ((board >> (4 * cell)) & 0xFU) == 0U ? 1 : 0;
+    }
+    return count;
+}
+
+} // namespace
+
+struct MoveSearch::Task::promise_type {
+    Task get_return_object() {
+        return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    // Nothing runs until the first resume, and the finished frame stays for `done()`.
+    std::suspend_always initial_suspend() noexcept {
+        return {};
+    }
+    std::suspend_always final_suspend() noexcept {
+        return {};
+    }
+    void return_void() noexcept {
+    }
+    void unhandled_exception() noexcept {
+        std::terminate();
+    }
+};
+
+PackedBoard movePackedBoard(const PackedBoard board, const Direction direction) noexcept {
+    const MoveTables &tables = moveTables();
+    switch (direction) {
+    case Direction::Left:
+        return moveRows(board, tables.left);
+    case Direction::Right:
+        return moveRows(board, tables.right);
+    case Direction::Up:
+        return transposeBoard(moveRows(transposeBoard(board), tables.left));
+    case Direction::Down:
+        return transposeBoard(moveRows(transposeBoard(board), tables.right));
+    }
+    return board;
+}
+
+MoveSearch::MoveSearch(const BoardEvaluator &evaluator, const Game::Grid &grid,
+                       const int maxDepth)
+    : evaluator_(evaluator), grid_(grid), root_(packBoard(grid)), maxDepth_(maxDepth) {
+    moveTables();
+    // A move node and a spawn node per searched move, plus the root.
+    stack_.reserve(static_cast<std::size_t>(2 * std::max(maxDepth_, 1) + 1));
+    task_ = search();
+}
+
+MoveSearch::~MoveSearch() {
+    if (task_.handle) {
+        task_.handle.destroy();
+    }
+}
+
+bool MoveSearch::step() {
+    if (!task_.handle.done()) {
+        resumedAt_ = Clock::now();
+        task_.handle.resume();
+        progress_.elapsed += Clock::now() - resumedAt_;
+    }
+    return progress_.finished;
+}
+
+bool MoveSearch::runUntil(const Clock::time_point deadline) {
+    while (!step()) {
+        if (Clock::now() >= deadline) {
+            break;
+        }
+    }
+    return progress_.finished;
+}
+
+bool MoveSearch::runFor(const Clock::duration slice) {
+    return runUntil(Clock::now() + slice);
+}
+
+void MoveSearch::runToEnd() {
+    runUntil(Clock::time_point::max());
+}
+
+const SearchProgress &MoveSearch::progress() const noexcept {
+    return progress_;
+}
+
+const Game::Grid &MoveSearch::grid() const noexcept {
+    return grid_;
+}
+
+MoveSearch::Task MoveSearch::search() {
+    std::uint64_t nextCheckpoint = kNodesPerCheckpoint;
+
+    for (int depth = 1; depth <= maxDepth_; ++depth) {
+        const std::uint64_t nodesBefore = progress_.nodes;
+        const auto startedAt = progress_.elapsed + (Clock::now() - resumedAt_);
+        std::optional<Direction> bestMove;
+        std::optional<float> returned;
+        stack_.clear();
+        stack_.push_back(Frame{root_, depth, false, 0, kLostValue, 0, 0.0F});
+
+        while (!stack_.empty()) {
+            if (progress_.nodes >= nextCheckpoint) {
+                nextCheckpoint = progress_.nodes + kNodesPerCheckpoint;
+                co_await std::suspend_always{};
+            }
+
+            Frame &frame = stack_.back();
+            if (!frame.spawn) {
+                if (returned.has_value()) {
+                    if (*returned > frame.value || (stack_.size() == 1U && !bestMove)) {
+                        frame.value = *returned;
+                        if (stack_.size() == 1U) {
+                            bestMove = static_cast<Direction>(frame.childMove);
+                        }
+                    }
+                    returned.reset();
+                }
+
+                PackedBoard moved = frame.board;
+                while (frame.next < 4 && moved == frame.board) {
+                    frame.childMove = frame.next++;
+                    moved = movePackedBoard(frame.board, static_cast<Direction>(frame.childMove));
+                }
+                if (moved != frame.board) {
+                    const int childDepth = frame.depth;
+                    stack_.push_back(Frame{moved, childDepth, true, 0, 0.0F, 0, 0.0F});
+                    ++progress_.nodes;
+                    continue;
+                }
+
+                returned = frame.value;
+                stack_.pop_back();
+                continue;
+            }
+
+            if (returned.has_value()) {
+                frame.value += frame.childWeight * *returned;
+                returned.reset();
+            }
+
+            int cell = frame.next / 2;
+            while (cell < kCellCount && ((frame.board >> (4 * cell)) & 0xFU) != 0U) {
+                frame.next = 2 * ++cell;
+            }
+            if (cell == kCellCount) {
+                const int empty = std::max(emptyCellCount(frame.board), 1);
+                returned = frame.value / static_cast<float>(empty);
+                stack_.pop_back();
+                continue;
+            }
+
+            const int exponent = frame.next % 2 + 1;
+            ++frame.next;
+            const PackedBoard child =
+                frame.board | (static_cast<PackedBoard>(exponent) << (4 * cell));
+            const float weight = exponent == 1 ? 1.0F - kFourProbability : kFourProbability;
+            ++progress_.nodes;
+            if (frame.depth <= 1) {
+                frame.value += weight * evaluator_.evaluate(child);
+                continue;
+            }
+            frame.childWeight = weight;
+            const int childDepth = frame.depth - 1;
+            stack_.push_back(Frame{child, childDepth, false, 0, kLostValue, 0, 0.0F});
+        }
+
+        if (!bestMove.has_value()) {
+            break;
+        }
+        progress_.depthCompleted = depth;
+        progress_.bestMove = bestMove;
+        progress_.bestValue = *returned;
+        const auto endedAt = progress_.elapsed + (Clock::now() - resumedAt_);
+        progress_.iterations.push_back(SearchIteration{
+            depth, progress_.nodes - nodesBefore,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(endedAt - startedAt), bestMove,
+            *returned});
+    }
+    progress_.finished = true;
+}
+
+SearchResult searchBestMove(const Game &game, const BoardEvaluator &evaluator,
+                            const MoveSearch::Clock::time_point deadline, const int maxDepth) {
+    MoveSearch search(evaluator, game.getGrid(), maxDepth);
+    const SearchProgress &progress = search.progress();
+    std::size_t iterationsSeen = 0;
+    while (!search.step()) {
+        const auto now = MoveSearch::Clock::now();
+        if (progress.depthCompleted > 0 && now >= deadline) {
+            break;
+        }
+        const auto &iterations = progress.iterations;
+        if (iterations.size() == iterationsSeen || iterations.size() < 2U) {
+            continue;
+        }
+        iterationsSeen = iterations.size();
+
+        // Nodes grow by roughly the same factor per depth, and so does time.
+        const auto &last = iterations.back();
+        const auto &previous = iterations[iterations.size() - 2U];
+        const double growth =
+            static_cast<double>(last.nodes) / static_cast<double>(std::max<std::uint64_t>(
+                                                  previous.nodes, 1U));
+        const auto predicted = std::chrono::nanoseconds(
+            static_cast<std::chrono::nanoseconds::rep>(static_cast<double>(last.elapsed.count()) *
+                                                       growth));
+        if (now + predicted > deadline) {
+            break;
+        }
+    }
+
+    SearchResult result;
+    result.move = progress.bestMove;
+    result.depthCompleted = progress.depthCompleted;
+    result.nodes = progress.nodes;
+    result.elapsed = progress.elapsed;
+    const double seconds = std::chrono::duration<double>(progress.elapsed).count();
+    result.nodesPerSecond = seconds > 0.0 ? static_cast<double>(progress.nodes) / seconds : 0.0;
+    result.iterations = progress.iterations;
+    return result;
+}
+
+} // namespace core2048
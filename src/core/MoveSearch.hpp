@@ -0,0 +1,128 @@
+#pragma once
+
+#include "core/Game.hpp"
+#include "core/Heuristics.hpp"
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace core2048 {
+
+// Slides and merges a packed board; returns `board` unchanged when the move is not legal.
+PackedBoard movePackedBoard(PackedBoard board, Direction direction) noexcept;
+
+struct SearchIteration {
+    int depth{0};
+    // Nodes of this iteration alone.
+    std::uint64_t nodes{0};
+    // Search time of this iteration; time suspended between slices is not counted.
+    std::chrono::nanoseconds elapsed{0};
+    std::optional<Direction> bestMove;
+    float bestValue{0.0F};
+};
+
+struct SearchProgress {
+    // Deepest depth, in moves, searched to the end; 0 until the first iteration completes.
+    int depthCompleted{0};
+    // Nodes visited over all iterations, including the unfinished one.
+    std::uint64_t nodes{0};
+    // Best move of the deepest completed iteration; empty when no move is legal.
+    std::optional<Direction> bestMove;
+    float bestValue{0.0F};
+    // Every depth up to the limit is done, or no move is legal.
+    bool finished{false};
+    // Search time so far, suspended time excluded.
+    std::chrono::nanoseconds elapsed{0};
+    // Completed iterations, shallowest first.
+    std::vector<SearchIteration> iterations;
+};
+
+// Expectimax over moves and tile spawns, scored with a `BoardEvaluator` at the leaves and
+// deepened one move at a time up to `maxDepth`. The search is a C++20 coroutine over an explicit
+// node stack that suspends every `kNodesPerCheckpoint` nodes, so the caller decides how long it
+// runs each time: a frame loop can spend a slice of every frame on it without a thread.
+// The coroutine refers to the search object and the evaluator, so neither may move or go away
+// while the search exists.
+class MoveSearch {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::uint64_t kNodesPerCheckpoint = 512;
+
+    MoveSearch(const BoardEvaluator &evaluator, const Game::Grid &grid, int maxDepth);
+    ~MoveSearch();
+
+    MoveSearch(const MoveSearch &) = delete;
+    MoveSearch &operator=(const MoveSearch &) = delete;
+
+    // Runs to the next checkpoint; returns whether the search has finished.
+    bool step();
+    // Resumes until `deadline` has passed or the search has finished, and returns whether it has
+    // finished. Each call runs at least up to the next checkpoint.
+    bool runUntil(Clock::time_point deadline);
+    bool runFor(Clock::duration slice);
+    void runToEnd();
+
+    const SearchProgress &progress() const noexcept;
+    const Game::Grid &grid() const noexcept;
+
+  private:
+    // Owns the coroutine frame; the promise type is defined with the coroutine.
+    struct Task {
+        struct promise_type;
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    struct Frame {
+        PackedBoard board{0};
+        // Moves still to search below this node.
+        int depth{0};
+        // A spawn node follows a move; a move node follows a spawn.
+        bool spawn{false};
+        // Next child: a direction for move nodes, cell * 2 + (tile exponent - 1) for spawn nodes.
+        int next{0};
+        // Best child value for move nodes, probability-weighted sum for spawn nodes.
+        float value{0.0F};
+        // Direction or spawn probability of the child being searched.
+        int childMove{0};
+        float childWeight{0.0F};
+    };
+
+    Task search();
+
+    const BoardEvaluator &evaluator_;
+    Game::Grid grid_;
+    PackedBoard root_;
+    int maxDepth_;
+    SearchProgress progress_;
+    Clock::time_point resumedAt_{};
+    std::vector<Frame> stack_;
+    Task task_;
+};
+
+inline constexpr int kMaxSearchDepth = 16;
+
+struct SearchResult {
+    // Best move of the deepest completed iteration; empty only when no move is legal.
+    std::optional<Direction> move;
+    int depthCompleted{0};
+    std::uint64_t nodes{0};
+    std::chrono::nanoseconds elapsed{0};
+    double nodesPerSecond{0.0};
+    std::vector<SearchIteration> iterations;
+};
+
+// Anytime search with a hard deadline: deepens one move at a time and returns the best move of
+// the deepest iteration finished in time. The deadline is checked at every `MoveSearch`
+// checkpoint, so it is overrun by at most one checkpoint's worth of nodes. The first checkpoint
+// always completes depth 1, so a legal move is always returned. The search also stops early
+// when the next depth, predicted from the growth of the last two iterations, would not finish
+// before the deadline, because a partial iteration is thrown away.
+SearchResult searchBestMove(const Game &game, const BoardEvaluator &evaluator,
+                            MoveSearch::Clock::time_point deadline,
+                            int maxDepth = kMaxSearchDepth);
+
+} // namespace core2048
@@ -1,5 +1,7 @@
 #include "core/ScoreManager.hpp"
 
+#include "core/Metrics.hpp"
+
 #include <nlohmann/json.hpp>
 
 #include <algorithm>
@@ -96,6 +98,11 @@ bool ScoreManager::load() {
 }
 
 bool ScoreManager::save() const {
+    static Histogram &saveSeconds = MetricsRegistry::global().histogram(
+        "sfml_2048_score_save_seconds", "Time to write the high score file, failures included.",
+        {0.001, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 1.0});
+    const Histogram::Timer timer(saveSeconds);
+
     const auto parent = scoreFilePath_.parent_path();
     if (!parent.empty()) {
         std::error_code ec;
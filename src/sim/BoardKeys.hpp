@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace sim2048 {
+
+// Boards of the exhaustive tools (perft, solver) as 64-bit keys: cell i, row by row, holds its
+// tile exponent in bits [4i, 4i + 4), 0 for an empty cell.
+inline constexpr int kMaxKeyExponent = 15;
+
+// Returns false if a tile does not fit in 4 bits (above 32768).
+template <typename Grid> bool packBoardKey(const Grid &grid, std::uint64_t &key) {
+    key = 0;
+    int shift = 0;
+    for (const auto &row : grid) {
+        for (const int value : row) {
+            int exponent = 0;
+            for (int v = value; v > 1; v >>= 1) {
+                ++exponent;
+            }
+            if (exponent > kMaxKeyExponent) {
+                return false;
+            }
+            key |= static_cast<std::uint64_t>(exponent) << shift;
+            shift += 4;
+        }
+    }
+    return true;
+}
+
+template <typename Grid> Grid unpackBoardKey(std::uint64_t key) {
+    Grid grid{};
+    for (auto &row : grid) {
+        for (int &value : row) {
+            const auto exponent = static_cast<int>(key & 0xFU);
+            value = exponent == 0 ? 0 : 1 << exponent;
+            key >>= 4U;
+        }
+    }
+    return grid;
+}
+
+// Runs `fn(i)` for i in [0, count) on `count` threads and joins them.
+template <typename Fn> void forEachWorker(const std::size_t count, Fn &&fn) {
+    std::vector<std::thread> workers;
+    workers.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        workers.emplace_back(fn, i);
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+} // namespace sim2048
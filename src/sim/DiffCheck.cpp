@@ -0,0 +1,254 @@
+#include "sim/DiffCheck.hpp"
+
+#include "sim/ReferenceGame.hpp"
+#include "sim/Simulation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace sim2048 {
+
+namespace {
+
+using core2048::Direction;
+using core2048::Game;
+using core2048::MoveResult;
+
+constexpr std::uint64_t kBlockCases = 256;
+constexpr auto kProgressInterval = std::chrono::seconds(1);
+constexpr int kMaxBoardExponent = 14;
+
+MoveResult playProduction(const DiffEngineStep &engine, Game &game, const Direction direction) {
+    return engine ? engine(game, direction) : game.applyMove(direction);
+}
+
+// The first field that differs, or nullptr.
+const char *firstDifference(const Game &game, const MoveResult &actual,
+                            const ReferenceGame &reference, const MoveResult &expected) {
+    if (actual.moved != expected.moved) {
+        return "moved";
+    }
+    if (actual.scoreDelta != expected.scoreDelta) {
+        return "score_delta";
+    }
+    if (actual.mergeCount != expected.mergeCount) {
+        return "merge_count";
+    }
+    if (actual.maxMergedValue != expected.maxMergedValue) {
+        return "max_merged_value";
+    }
+    const auto &a = actual.spawnedTile;
+    const auto &b = expected.spawnedTile;
+    if (a.has_value() != b.has_value() ||
+        (a.has_value() && (a->row != b->row || a->col != b->col || a->value != b->value))) {
+        return "spawn";
+    }
+    if (game.getGrid() != reference.getGrid()) {
+        return "grid";
+    }
+    if (game.getScore() != reference.getScore()) {
+        return "score";
+    }
+    return nullptr;
+}
+
+// Mostly small tiles with about a third of the cells empty, and now and then a large one.
+Game::Grid randomBoard(std::minstd_rand &rng) {
+    Game::Grid grid{};
+    for (auto &row : grid) {
+        for (int &value : row) {
+            const std::uint32_t roll = rng() % 24U;
+            if (roll < 8U) {
+                value = 0;
+            } else if (roll < 22U) {
+                value = 1 << (1U + rng() % 10U);
+            } else {
+                value = 1 << (1U + rng() % kMaxBoardExponent);
+            }
+        }
+    }
+    return grid;
+}
+
+struct GeneratedCase {
+    Game::Grid start{};
+    std::vector<Direction> moves;
+};
+
+GeneratedCase generateCase(const std::uint32_t seed, const std::uint32_t moveCount) {
+    // A different generator from the engines' spawn sequence, which gets the same seed; cheap to
+    // seed, since every case starts a new one.
+    std::minstd_rand rng(seed);
+    GeneratedCase generated;
+    generated.start = randomBoard(rng);
+    generated.moves.resize(moveCount);
+    for (auto &move : generated.moves) {
+        move = static_cast<Direction>(rng() % 4U);
+    }
+    return generated;
+}
+
+// Greedy reduction to a fixpoint: drop tiles, then halve them, keeping every change that still
+// fails.
+DiffMismatch shrinkBoard(const DiffEngineStep &engine, DiffMismatch failing) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int r = 0; r < Game::kGridSize; ++r) {
+                for (int c = 0; c < Game::kGridSize; ++c) {
+                    const int value = failing.start[r][c];
+                    if (value == 0 || (pass == 1 && value <= 2)) {
+                        continue;
+                    }
+                    Game::Grid candidate = failing.start;
+                    candidate[r][c] = pass == 0 ? 0 : value / 2;
+                    auto result =
+                        replayDifferential(engine, failing.seed, candidate, failing.moves);
+                    if (result.has_value()) {
+                        failing = std::move(*result);
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+    return failing;
+}
+
+} // namespace
+
+std::optional<DiffMismatch> replayDifferential(const DiffEngineStep &engine,
+                                               const std::uint32_t seed,
+                                               const Game::Grid &start,
+                                               const std::vector<Direction> &moves) {
+    Game game(seed);
+    ReferenceGame reference(seed);
+    game.loadState(start, 0);
+    reference.loadState(start, 0);
+
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        const Game::Grid board = reference.getGrid();
+        const int score = reference.getScore();
+        const MoveResult actual = playProduction(engine, game, moves[i]);
+        const MoveResult expected = reference.applyMove(moves[i]);
+        if (const char *field = firstDifference(game, actual, reference, expected)) {
+            DiffMismatch mismatch;
+            mismatch.seed = seed;
+            mismatch.start = start;
+            mismatch.moves.assign(moves.begin(),
+                                  moves.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+            mismatch.board = board;
+            mismatch.score = score;
+            mismatch.field = field;
+            return mismatch;
+        }
+    }
+    return std::nullopt;
+}
+
+bool runDifferentialCheck(const DiffCheckConfig &config, DiffCheckResult &result,
+                          std::string &error, const DiffCheckProgress &progress) {
+    const auto began = std::chrono::steady_clock::now();
+    result = {};
+    if (config.movesPerCase == 0U) {
+        error = "moves per case must be positive";
+        return false;
+    }
+    const std::uint64_t totalCases =
+        (config.moves + config.movesPerCase - 1U) / config.movesPerCase;
+    if (totalCases > std::uint64_t{std::numeric_limits<std::uint32_t>::max()} + 1U) {
+        error = "too many cases for 32-bit seeds; raise the moves per case";
+        return false;
+    }
+
+    const std::size_t workerCount = resolveThreadCount(config.threads);
+    constexpr std::uint64_t kNoFailure = std::numeric_limits<std::uint64_t>::max();
+
+    std::atomic<std::uint64_t> nextBlock{0};
+    std::atomic<std::uint64_t> failingCase{kNoFailure};
+    std::atomic<std::uint64_t> casesDone{0};
+    std::atomic<std::uint64_t> movesDone{0};
+    std::mutex stateMutex;
+    std::condition_variable stateChanged;
+    std::size_t activeWorkers = workerCount;
+    std::optional<DiffMismatch> firstMismatch;
+
+    const auto worker = [&] {
+        for (std::uint64_t block = nextBlock.fetch_add(1U); block * kBlockCases < totalCases;
+             block = nextBlock.fetch_add(1U)) {
+            const std::uint64_t first = block * kBlockCases;
+            if (first > failingCase.load()) {
+                break;
+            }
+            const std::uint64_t last = std::min(first + kBlockCases, totalCases);
+            for (std::uint64_t index = first; index < last && index < failingCase.load();
+                 ++index) {
+                const auto seed = static_cast<std::uint32_t>(config.firstSeed + index);
+                const GeneratedCase generated = generateCase(seed, config.movesPerCase);
+                auto mismatch =
+                    replayDifferential(config.engine, seed, generated.start, generated.moves);
+                casesDone.fetch_add(1U);
+                if (!mismatch.has_value()) {
+                    movesDone.fetch_add(config.movesPerCase);
+                    continue;
+                }
+                movesDone.fetch_add(mismatch->moves.size());
+
+                const std::lock_guard<std::mutex> lock(stateMutex);
+                if (index < failingCase.load()) {
+                    failingCase.store(index);
+                    firstMismatch = std::move(mismatch);
+                }
+                break;
+            }
+        }
+
+        const std::lock_guard<std::mutex> lock(stateMutex);
+        --activeWorkers;
+        stateChanged.notify_all();
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for (std::size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(worker);
+    }
+    {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        while (activeWorkers > 0U) {
+            stateChanged.wait_for(lock, kProgressInterval);
+            if (progress) {
+                lock.unlock();
+                progress(movesDone.load(), totalCases * config.movesPerCase);
+                lock.lock();
+            }
+        }
+    }
+    for (auto &thread : workers) {
+        thread.join();
+    }
+
+    result.cases = casesDone.load();
+    result.moves = movesDone.load();
+    result.mismatch = std::move(firstMismatch);
+    if (result.mismatch.has_value() && config.shrink) {
+        // A single move from a fresh game only reproduces failures that do not depend on
+        // the spawn generator's position in its sequence.
+        const std::vector<Direction> lastMove = {result.mismatch->moves.back()};
+        auto single = replayDifferential(config.engine, result.mismatch->seed,
+                                         result.mismatch->board, lastMove);
+        if (single.has_value()) {
+            result.shrunk = shrinkBoard(config.engine, std::move(*single));
+        }
+    }
+    result.elapsed = std::chrono::steady_clock::now() - began;
+    return true;
+}
+
+} // namespace sim2048
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "core/Game.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace sim2048 {
+
+// How the checked engine plays a move. The default is `Game::applyMove`; tests swap in a faulty
+// engine to exercise the checker.
+using DiffEngineStep = std::function<core2048::MoveResult(core2048::Game &, core2048::Direction)>;
+
+struct DiffCheckConfig {
+    // Moves to compare in total, rounded up to whole cases.
+    std::uint64_t moves{1'000'000};
+    // Each case plays this many random moves from a random board.
+    std::uint32_t movesPerCase{256};
+    // Case i seeds both engines and its board and move generator with `firstSeed + i`.
+    std::uint32_t firstSeed{0};
+    // 0 uses every hardware thread.
+    unsigned int threads{0};
+    // Reduce the first failing case to a minimal board.
+    bool shrink{true};
+    DiffEngineStep engine;
+};
+
+struct DiffMismatch {
+    std::uint32_t seed{0};
+    // Board the case started from and every move up to and including the failing one.
+    core2048::Game::Grid start{};
+    std::vector<core2048::Direction> moves;
+    // Board and score right before the failing move.
+    core2048::Game::Grid board{};
+    int score{0};
+    // First difference: grid, score, moved, score_delta, merge_count, max_merged_value or spawn.
+    std::string field;
+};
+
+struct DiffCheckResult {
+    std::uint64_t cases{0};
+    std::uint64_t moves{0};
+    // The failing case with the lowest index. Cases after it may be skipped.
+    std::optional<DiffMismatch> mismatch;
+    // The failing move replayed alone, from a fresh game with the same seed, on the smallest
+    // board that still fails: tiles are removed and halved while the failure persists. Empty
+    // when the single move does not fail on its own, i.e. the case needs its earlier moves.
+    std::optional<DiffMismatch> shrunk;
+    std::chrono::nanoseconds elapsed{0};
+};
+
+// Called from the calling thread about once a second with (moves checked, total) counts.
+using DiffCheckProgress = std::function<void(std::uint64_t, std::uint64_t)>;
+
+// Plays identical random boards, seeds and moves through the checked engine and
+// `ReferenceGame`, comparing the grid, score, `moved`, score delta, merge count, largest merge
+// and spawned tile after every move. Cases are handed out to the workers in blocks; after a
+// failure, blocks past it are skipped, and the failing case with the lowest index is reported,
+// so the report does not depend on the thread count.
+bool runDifferentialCheck(const DiffCheckConfig &config, DiffCheckResult &result,
+                          std::string &error, const DiffCheckProgress &progress = {});
+
+// Replays `moves` from `start` with both engines seeded with `seed`; returns the first
+// difference, if any, with `moves` cut after the failing move.
+std::optional<DiffMismatch> replayDifferential(const DiffEngineStep &engine, std::uint32_t seed,
+                                               const core2048::Game::Grid &start,
+                                               const std::vector<core2048::Direction> &moves);
+
+} // namespace sim2048
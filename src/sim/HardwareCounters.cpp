@@ -0,0 +1,235 @@
+#include "sim/HardwareCounters.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace sim2048 {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t eventIndex(const HardwareEvent event) noexcept {
+    return static_cast<std::size_t>(event);
+}
+
+std::string countText(const std::optional<double> value) {
+    if (!value) {
+        return "-";
+    }
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(*value < 10.0 ? 3 : 1) << *value;
+    return text.str();
+}
+
+#if defined(__linux__)
+struct EventConfig {
+    std::uint32_t type;
+    std::uint64_t config;
+};
+
+constexpr std::uint64_t cacheEvent(const std::uint64_t cache) noexcept {
+    return cache | (std::uint64_t{PERF_COUNT_HW_CACHE_OP_READ} << 8U) |
+           (std::uint64_t{PERF_COUNT_HW_CACHE_RESULT_MISS} << 16U);
+}
+
+// In `HardwareEvent` order. The generic cache-miss event is what the kernel maps to last
+// level cache misses on both Intel and AMD, where the LL cache event is often missing.
+constexpr std::array<EventConfig, kHardwareEventCount> kEventConfigs = {{
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+}};
+
+int openEvent(const EventConfig &event) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = event.type;
+    attr.config = event.config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // This thread on any CPU.
+    return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+#endif
+
+} // namespace
+
+std::string_view hardwareEventName(const HardwareEvent event) noexcept {
+    switch (event) {
+    case HardwareEvent::Cycles:
+        return "cycles";
+    case HardwareEvent::Instructions:
+        return "instructions";
+    case HardwareEvent::L1dMisses:
+        return "L1d misses";
+    case HardwareEvent::LlcMisses:
+        return "LLC misses";
+    case HardwareEvent::BranchMisses:
+        return "branch misses";
+    }
+    return "";
+}
+
+std::optional<double> HardwareCounts::operator[](const HardwareEvent event) const noexcept {
+    return values[eventIndex(event)];
+}
+
+std::optional<double> HardwareCounts::ipc() const noexcept {
+    const auto cycles = (*this)[HardwareEvent::Cycles];
+    const auto instructions = (*this)[HardwareEvent::Instructions];
+    if (!cycles || !instructions || *cycles <= 0.0) {
+        return std::nullopt;
+    }
+    return *instructions / *cycles;
+}
+
+HardwareCounts HardwareCounts::per(const std::uint64_t operations) const noexcept {
+    HardwareCounts scaled = *this;
+    const double divisor = operations == 0U ? 1.0 : static_cast<double>(operations);
+    for (auto &value : scaled.values) {
+        if (value) {
+            *value /= divisor;
+        }
+    }
+    return scaled;
+}
+
+HardwareCounters::~HardwareCounters() {
+#if defined(__linux__)
+    for (const int fd : fds_) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+#endif
+}
+
+bool HardwareCounters::open(std::string &error) {
+#if defined(__linux__)
+    int firstErrno = 0;
+    for (std::size_t i = 0; i < kHardwareEventCount; ++i) {
+        if (fds_[i] < 0) {
+            fds_[i] = openEvent(kEventConfigs[i]);
+            if (fds_[i] < 0 && firstErrno == 0) {
+                firstErrno = errno;
+            }
+        }
+    }
+    if (isOpen()) {
+        return true;
+    }
+    error = "perf_event_open failed: " + std::string(std::strerror(firstErrno));
+    if (firstErrno == EACCES || firstErrno == EPERM) {
+        error += " (see /proc/sys/kernel/perf_event_paranoid, or the container's seccomp "
+                 "profile)";
+    } else if (firstErrno == ENOENT || firstErrno == EOPNOTSUPP) {
+        error += " (no hardware PMU, as in most VMs)";
+    }
+    return false;
+#else
+    error = "hardware counters need Linux perf_event_open";
+    return false;
+#endif
+}
+
+bool HardwareCounters::isOpen() const noexcept {
+    return std::any_of(fds_.begin(), fds_.end(), [](const int fd) { return fd >= 0; });
+}
+
+bool HardwareCounters::has(const HardwareEvent event) const noexcept {
+    return fds_[eventIndex(event)] >= 0;
+}
+
+void HardwareCounters::start() noexcept {
+#if defined(__linux__)
+    for (const int fd : fds_) {
+        if (fd >= 0) {
+            ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+HardwareCounts HardwareCounters::stop() noexcept {
+    HardwareCounts counts;
+#if defined(__linux__)
+    for (const int fd : fds_) {
+        if (fd >= 0) {
+            ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (std::size_t i = 0; i < kHardwareEventCount; ++i) {
+        // value, time enabled, time running
+        std::array<std::uint64_t, 3> raw{};
+        if (fds_[i] < 0 ||
+            ::read(fds_[i], raw.data(), sizeof(raw)) != static_cast<ssize_t>(sizeof(raw))) {
+            continue;
+        }
+        // A counter the PMU never scheduled in has no count, rather than a zero one.
+        if (raw[2] == 0U) {
+            continue;
+        }
+        counts.values[i] = static_cast<double>(raw[0]) * static_cast<double>(raw[1]) /
+                           static_cast<double>(raw[2]);
+    }
+#endif
+    return counts;
+}
+
+HardwareCounts countPerOperation(HardwareCounters &counters, const PerfBenchmark &benchmark,
+                                 const std::chrono::nanoseconds sampleTime) {
+    const auto warmUntil = Clock::now() + sampleTime / 2;
+    do {
+        benchmark.run();
+    } while (Clock::now() < warmUntil);
+
+    std::uint64_t operations = 0;
+    const auto began = Clock::now();
+    counters.start();
+    do {
+        operations += benchmark.run();
+    } while (Clock::now() - began < sampleTime);
+    return counters.stop().per(operations);
+}
+
+std::string
+formatHardwareCounts(const std::vector<std::pair<std::string, HardwareCounts>> &rows) {
+    constexpr int kColumnWidth = 15;
+    std::size_t nameWidth = 9;
+    for (const auto &row : rows) {
+        nameWidth = std::max(nameWidth, row.first.size());
+    }
+
+    std::ostringstream table;
+    table << std::left << std::setw(static_cast<int>(nameWidth)) << "benchmark" << std::right;
+    for (std::size_t i = 0; i < kHardwareEventCount; ++i) {
+        table << std::setw(kColumnWidth) << hardwareEventName(static_cast<HardwareEvent>(i));
+    }
+    table << std::setw(8) << "IPC" << '\n';
+    for (const auto &[name, counts] : rows) {
+        table << std::left << std::setw(static_cast<int>(nameWidth)) << name << std::right;
+        for (const auto &value : counts.values) {
+            table << std::setw(kColumnWidth) << countText(value);
+        }
+        table << std::setw(8) << countText(counts.ipc()) << '\n';
+    }
+    return table.str();
+}
+
+} // namespace sim2048
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "sim/PerfCheck.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace sim2048 {
+
+enum class HardwareEvent : std::uint8_t {
+    Cycles,
+    Instructions,
+    L1dMisses,
+    LlcMisses,
+    BranchMisses,
+};
+
+inline constexpr std::size_t kHardwareEventCount = 5;
+
+// Column name, e.g. "L1d misses".
+std::string_view hardwareEventName(HardwareEvent event) noexcept;
+
+struct HardwareCounts {
+    // Indexed by `HardwareEvent`; empty where the counter could not be opened. Counts are
+    // scaled up by enabled / running time when the kernel had to multiplex the counters.
+    std::array<std::optional<double>, kHardwareEventCount> values;
+
+    std::optional<double> operator[](HardwareEvent event) const noexcept;
+    // Instructions per cycle, when both were counted.
+    std::optional<double> ipc() const noexcept;
+    // Every count divided by `operations`.
+    HardwareCounts per(std::uint64_t operations) const noexcept;
+};
+
+// User-space hardware counters of the calling thread through Linux `perf_event_open`. Each
+// event is opened on its own, so a PMU without, say, an LLC event still reports the others.
+// Containers and VMs often grant none: `open` then fails with the reason and callers print
+// wall time only.
+class HardwareCounters {
+  public:
+    HardwareCounters() = default;
+    ~HardwareCounters();
+
+    HardwareCounters(const HardwareCounters &) = delete;
+    HardwareCounters &operator=(const HardwareCounters &) = delete;
+
+    // True when at least one counter opened. Fails on other platforms, under a restrictive
+    // `perf_event_paranoid` or seccomp profile, and without a PMU.
+    bool open(std::string &error);
+    bool isOpen() const noexcept;
+    bool has(HardwareEvent event) const noexcept;
+
+    // Resets and enables every open counter.
+    void start() noexcept;
+    // Disables them and returns the counts since `start`.
+    HardwareCounts stop() noexcept;
+
+  private:
+    std::array<int, kHardwareEventCount> fds_{-1, -1, -1, -1, -1};
+};
+
+// Warms `benchmark` up like `measureBenchmarks`, then counts calls to it for about
+// `sampleTime` and returns the counts per operation it reported.
+HardwareCounts countPerOperation(HardwareCounters &counters, const PerfBenchmark &benchmark,
+                                 std::chrono::nanoseconds sampleTime);
+
+// Aligned table with one row per name: every event and the IPC, "-" where missing.
+std::string
+formatHardwareCounts(const std::vector<std::pair<std::string, HardwareCounts>> &rows);
+
+} // namespace sim2048
@@ -0,0 +1,188 @@
+#include "sim/MappedFile.hpp"
+
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sim2048 {
+
+std::optional<MappedFile> MappedFile::openReadOnly(const std::filesystem::path &path,
+                                                   std::string &error) {
+    return map(path, false, std::nullopt, error);
+}
+
+std::optional<MappedFile> MappedFile::openReadWrite(const std::filesystem::path &path,
+                                                    std::string &error) {
+    return map(path, true, std::nullopt, error);
+}
+
+std::optional<MappedFile> MappedFile::create(const std::filesystem::path &path,
+                                             const std::uint64_t size, std::string &error) {
+    return map(path, true, size, error);
+}
+
+std::optional<MappedFile> MappedFile::map(const std::filesystem::path &path, const bool writable,
+                                          const std::optional<std::uint64_t> createSize,
+                                          std::string &error) {
+    MappedFile file;
+    file.writable_ = writable;
+    const std::string name = path.string();
+
+#if defined(_WIN32)
+    const DWORD access = writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+    const DWORD disposition = createSize.has_value() ? CREATE_ALWAYS : OPEN_EXISTING;
+    HANDLE handle = CreateFileW(path.c_str(), access, FILE_SHARE_READ, nullptr, disposition,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        error = "cannot open " + name;
+        return std::nullopt;
+    }
+    file.fileHandle_ = handle;
+
+    LARGE_INTEGER fileSize{};
+    if (createSize.has_value()) {
+        fileSize.QuadPart = static_cast<LONGLONG>(*createSize);
+        if (!SetFilePointerEx(handle, fileSize, nullptr, FILE_BEGIN) || !SetEndOfFile(handle)) {
+            error = "cannot resize " + name;
+            return std::nullopt;
+        }
+    } else if (!GetFileSizeEx(handle, &fileSize)) {
+        error = "cannot stat " + name;
+        return std::nullopt;
+    }
+    if (fileSize.QuadPart == 0) {
+        return file;
+    }
+
+    HANDLE mapping = CreateFileMappingW(handle, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                        0, 0, nullptr);
+    if (mapping == nullptr) {
+        error = "cannot map " + name;
+        return std::nullopt;
+    }
+    file.mappingHandle_ = mapping;
+
+    void *view = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        error = "cannot map " + name;
+        return std::nullopt;
+    }
+    file.data_ = static_cast<std::byte *>(view);
+    file.size_ = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    int flags = writable ? O_RDWR : O_RDONLY;
+    if (createSize.has_value()) {
+        flags |= O_CREAT | O_TRUNC;
+    }
+    const int fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = "cannot open " + name;
+        return std::nullopt;
+    }
+
+    if (createSize.has_value() && ::ftruncate(fd, static_cast<off_t>(*createSize)) != 0) {
+        ::close(fd);
+        error = "cannot resize " + name;
+        return std::nullopt;
+    }
+
+    struct stat fileStat {};
+    if (::fstat(fd, &fileStat) != 0) {
+        ::close(fd);
+        error = "cannot stat " + name;
+        return std::nullopt;
+    }
+    if (fileStat.st_size == 0) {
+        ::close(fd);
+        return file;
+    }
+
+    const int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void *view =
+        ::mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), protection, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        error = "cannot map " + name;
+        return std::nullopt;
+    }
+    file.data_ = static_cast<std::byte *>(view);
+    file.size_ = static_cast<std::size_t>(fileStat.st_size);
+#endif
+
+    return file;
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0U)),
+      writable_(other.writable_)
+#if defined(_WIN32)
+      ,
+      fileHandle_(std::exchange(other.fileHandle_, nullptr)),
+      mappingHandle_(std::exchange(other.mappingHandle_, nullptr))
+#endif
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0U);
+        writable_ = other.writable_;
+#if defined(_WIN32)
+        fileHandle_ = std::exchange(other.fileHandle_, nullptr);
+        mappingHandle_ = std::exchange(other.mappingHandle_, nullptr);
+#endif
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+std::size_t MappedFile::size() const noexcept {
+    return size_;
+}
+
+bool MappedFile::flush() noexcept {
+    if (data_ == nullptr || !writable_) {
+        return true;
+    }
+#if defined(_WIN32)
+    return FlushViewOfFile(data_, 0) != 0 && FlushFileBuffers(fileHandle_) != 0;
+#else
+    return ::msync(data_, size_, MS_SYNC) == 0;
+#endif
+}
+
+void MappedFile::unmap() noexcept {
+#if defined(_WIN32)
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mappingHandle_ != nullptr) {
+        CloseHandle(mappingHandle_);
+    }
+    if (fileHandle_ != nullptr) {
+        CloseHandle(fileHandle_);
+    }
+    fileHandle_ = nullptr;
+    mappingHandle_ = nullptr;
+#else
+    if (data_ != nullptr) {
+        ::munmap(data_, size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+} // namespace sim2048
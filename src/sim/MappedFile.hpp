@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace sim2048 {
+
+// A whole file mapped into memory. Pages are loaded and written back by the OS, so data sets
+// larger than RAM can be processed through plain spans. An empty file maps to an empty span.
+class MappedFile {
+  public:
+    static std::optional<MappedFile> openReadOnly(const std::filesystem::path &path,
+                                                  std::string &error);
+    static std::optional<MappedFile> openReadWrite(const std::filesystem::path &path,
+                                                   std::string &error);
+    // Creates or truncates `path` to `size` zero bytes and maps it writable.
+    static std::optional<MappedFile> create(const std::filesystem::path &path, std::uint64_t size,
+                                            std::string &error);
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    std::size_t size() const noexcept;
+
+    // The mapping viewed as an array of `T`; trailing bytes that do not fill a `T` are ignored.
+    template <typename T> std::span<T> as() noexcept {
+        return {reinterpret_cast<T *>(data_), size_ / sizeof(T)};
+    }
+    template <typename T> std::span<const T> as() const noexcept {
+        return {reinterpret_cast<const T *>(data_), size_ / sizeof(T)};
+    }
+
+    // Writes dirty pages of a writable mapping back to the file.
+    bool flush() noexcept;
+
+  private:
+    MappedFile() = default;
+    static std::optional<MappedFile> map(const std::filesystem::path &path, bool writable,
+                                         std::optional<std::uint64_t> createSize,
+                                         std::string &error);
+    void unmap() noexcept;
+
+    std::byte *data_{nullptr};
+    std::size_t size_{0};
+    bool writable_{false};
+#if defined(_WIN32)
+    void *fileHandle_{nullptr};
+    void *mappingHandle_{nullptr};
+#endif
+};
+
+} // namespace sim2048
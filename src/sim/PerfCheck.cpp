@@ -0,0 +1,298 @@
+#include "sim/PerfCheck.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <system_error>
+
+namespace sim2048 {
+
+namespace {
+
+// Ordered, so benchmarks keep their run order through a load and a rewrite.
+using Json = nlohmann::ordered_json;
+using Clock = std::chrono::steady_clock;
+
+// Scales a median absolute deviation to a standard deviation for normally distributed noise.
+constexpr double kMadToSigma = 1.4826;
+
+const PerfMeasurement *findMeasurement(const std::vector<PerfMeasurement> &measurements,
+                                       const std::string &name) {
+    const auto found = std::find_if(measurements.begin(), measurements.end(),
+                                    [&](const PerfMeasurement &m) { return m.name == name; });
+    return found == measurements.end() ? nullptr : &*found;
+}
+
+const char *statusLabel(const PerfComparison::Status status) {
+    switch (status) {
+    case PerfComparison::Status::Ok:
+        return "ok";
+    case PerfComparison::Status::Faster:
+        return "faster";
+    case PerfComparison::Status::Regressed:
+        return "REGRESSED";
+    case PerfComparison::Status::Missing:
+        return "missing";
+    case PerfComparison::Status::New:
+        return "new";
+    }
+    return "";
+}
+
+// Operations per second with a metric suffix, e.g. "81.2M/s".
+std::string rateText(const double rate) {
+    if (rate <= 0.0) {
+        return "-";
+    }
+    constexpr const char *kSuffixes[] = {"", "k", "M", "G"};
+    double scaled = rate;
+    std::size_t suffix = 0;
+    while (scaled >= 1000.0 && suffix + 1U < std::size(kSuffixes)) {
+        scaled /= 1000.0;
+        ++suffix;
+    }
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(scaled < 100.0 ? 2 : 1) << scaled
+         << kSuffixes[suffix] << "/s";
+    return text.str();
+}
+
+std::string percentText(const double fraction, const bool sign) {
+    std::ostringstream text;
+    if (sign) {
+        text << std::showpos;
+    }
+    text << std::fixed << std::setprecision(1) << fraction * 100.0 << '%';
+    return text.str();
+}
+
+} // namespace
+
+std::vector<PerfMeasurement> measureBenchmarks(const std::vector<PerfBenchmark> &benchmarks,
+                                               const PerfRunConfig &config,
+                                               const PerfProgress &progress) {
+    std::vector<PerfMeasurement> measurements(benchmarks.size());
+    for (std::size_t i = 0; i < benchmarks.size(); ++i) {
+        // Faults in pages, fills caches and lets lazy tables build outside the timed samples.
+        const auto warmUntil = Clock::now() + config.sampleTime / 2;
+        do {
+            benchmarks[i].run();
+        } while (Clock::now() < warmUntil);
+        measurements[i].name = benchmarks[i].name;
+        measurements[i].samples.reserve(config.repetitions);
+    }
+
+    for (unsigned int round = 0; round < config.repetitions; ++round) {
+        for (std::size_t i = 0; i < benchmarks.size(); ++i) {
+            std::uint64_t operations = 0;
+            const auto began = Clock::now();
+            auto now = began;
+            do {
+                operations += benchmarks[i].run();
+                now = Clock::now();
+            } while (now - began < config.sampleTime);
+            const double seconds = std::chrono::duration<double>(now - began).count();
+            measurements[i].samples.push_back(static_cast<double>(operations) / seconds);
+        }
+        if (progress) {
+            progress(round + 1U, config.repetitions);
+        }
+    }
+
+    for (auto &measurement : measurements) {
+        measurement.median = medianOf(measurement.samples);
+        measurement.noise = relativeNoise(measurement.samples, measurement.median);
+    }
+    return measurements;
+}
+
+double medianOf(std::vector<double> values) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    const std::size_t middle = values.size() / 2U;
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(middle),
+                     values.end());
+    const double upper = values[middle];
+    if (values.size() % 2U != 0U) {
+        return upper;
+    }
+    const double lower = *std::max_element(
+        values.begin(), values.begin() + static_cast<std::ptrdiff_t>(middle));
+    return (lower + upper) / 2.0;
+}
+
+double relativeNoise(const std::vector<double> &values, const double median) {
+    if (values.size() < 2U || median <= 0.0) {
+        return 0.0;
+    }
+    std::vector<double> deviations;
+    deviations.reserve(values.size());
+    for (const double value : values) {
+        deviations.push_back(std::abs(value - median));
+    }
+    return kMadToSigma * medianOf(std::move(deviations)) / median;
+}
+
+bool loadPerfBaseline(const std::filesystem::path &path, PerfBaseline &baseline,
+                      std::string &error) {
+    const std::string name = path.string();
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        error = "cannot open " + name;
+        return false;
+    }
+
+    const Json document = Json::parse(in, nullptr, false);
+    if (document.is_discarded() || !document.is_object()) {
+        error = name + ": not a perf baseline";
+        return false;
+    }
+    if (document.value("version", 0) != kPerfBaselineVersion) {
+        error = name + ": unsupported baseline version";
+        return false;
+    }
+    const Json &benchmarks = document.value("benchmarks", Json());
+    if (!benchmarks.is_object()) {
+        error = name + ": missing benchmarks";
+        return false;
+    }
+
+    baseline = {};
+    baseline.buildType = document.value("build_type", std::string());
+    baseline.compiler = document.value("compiler", std::string());
+    for (const auto &[key, entry] : benchmarks.items()) {
+        if (!entry.is_object() || !entry.value("median", Json()).is_number() ||
+            !entry.value("noise", Json()).is_number()) {
+            error = name + ": malformed benchmark " + key;
+            return false;
+        }
+        PerfMeasurement measurement;
+        measurement.name = key;
+        measurement.median = entry["median"].get<double>();
+        measurement.noise = entry["noise"].get<double>();
+        baseline.benchmarks.push_back(std::move(measurement));
+    }
+    return true;
+}
+
+bool savePerfBaseline(const std::filesystem::path &path, const PerfBaseline &baseline,
+                      std::string &error) {
+    Json document;
+    document["version"] = baseline.version;
+    document["build_type"] = baseline.buildType;
+    document["compiler"] = baseline.compiler;
+    document["benchmarks"] = Json::object();
+    for (const auto &measurement : baseline.benchmarks) {
+        document["benchmarks"][measurement.name] = {{"median", measurement.median},
+                                                    {"noise", measurement.noise},
+                                                    {"unit", "ops/s"}};
+    }
+
+    auto tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::trunc);
+        out << document.dump(2) << '\n';
+        if (!out) {
+            error = "cannot write " + tempPath.string();
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        error = "cannot rename " + tempPath.string() + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+std::vector<PerfComparison> comparePerf(const PerfBaseline &baseline,
+                                        const std::vector<PerfMeasurement> &current,
+                                        const PerfCompareConfig &config) {
+    double scale = 1.0;
+    if (!config.calibration.empty()) {
+        const auto *before = findMeasurement(baseline.benchmarks, config.calibration);
+        const auto *now = findMeasurement(current, config.calibration);
+        if (before != nullptr && now != nullptr && before->median > 0.0) {
+            scale = now->median / before->median;
+        }
+    }
+
+    std::vector<PerfComparison> comparisons;
+    for (const auto &expected : baseline.benchmarks) {
+        if (expected.name == config.calibration) {
+            continue;
+        }
+        PerfComparison comparison;
+        comparison.name = expected.name;
+        comparison.expected = expected.median * scale;
+        const auto *measured = findMeasurement(current, expected.name);
+        if (measured == nullptr) {
+            comparison.status = PerfComparison::Status::Missing;
+            comparisons.push_back(comparison);
+            continue;
+        }
+
+        comparison.current = measured->median;
+        const double noise = std::max(expected.noise, measured->noise);
+        comparison.allowed = std::max(config.threshold, config.noiseFactor * noise);
+        comparison.change =
+            comparison.expected > 0.0 ? comparison.current / comparison.expected - 1.0 : 0.0;
+        if (comparison.change < -comparison.allowed) {
+            comparison.status = PerfComparison::Status::Regressed;
+        } else if (comparison.change > comparison.allowed) {
+            comparison.status = PerfComparison::Status::Faster;
+        }
+        comparisons.push_back(comparison);
+    }
+
+    for (const auto &measured : current) {
+        if (measured.name != config.calibration &&
+            findMeasurement(baseline.benchmarks, measured.name) == nullptr) {
+            PerfComparison comparison;
+            comparison.name = measured.name;
+            comparison.status = PerfComparison::Status::New;
+            comparison.current = measured.median;
+            comparisons.push_back(comparison);
+        }
+    }
+    return comparisons;
+}
+
+bool hasRegression(const std::vector<PerfComparison> &comparisons) {
+    return std::any_of(comparisons.begin(), comparisons.end(), [](const PerfComparison &c) {
+        return c.status == PerfComparison::Status::Regressed;
+    });
+}
+
+std::string formatPerfComparison(const std::vector<PerfComparison> &comparisons) {
+    std::size_t nameWidth = 9;
+    for (const auto &comparison : comparisons) {
+        nameWidth = std::max(nameWidth, comparison.name.size());
+    }
+
+    std::ostringstream table;
+    table << std::left << std::setw(static_cast<int>(nameWidth)) << "benchmark" << std::right
+          << std::setw(13) << "expected" << std::setw(13) << "current" << std::setw(9)
+          << "change" << std::setw(9) << "allowed" << "  status\n";
+    for (const auto &comparison : comparisons) {
+        const bool compared = comparison.status != PerfComparison::Status::Missing &&
+                              comparison.status != PerfComparison::Status::New;
+        table << std::left << std::setw(static_cast<int>(nameWidth)) << comparison.name
+              << std::right << std::setw(13) << rateText(comparison.expected) << std::setw(13)
+              << rateText(comparison.current) << std::setw(9)
+              << (compared ? percentText(comparison.change, true) : "-") << std::setw(9)
+              << (compared ? percentText(-comparison.allowed, false) : "-") << "  "
+              << statusLabel(comparison.status) << '\n';
+    }
+    return table.str();
+}
+
+} // namespace sim2048
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sim2048 {
+
+inline constexpr int kPerfBaselineVersion = 1;
+
+struct PerfBenchmark {
+    std::string name;
+    // Does a fixed amount of work and returns how many operations it did. Called repeatedly;
+    // must not get faster or slower from one call to the next.
+    std::function<std::uint64_t()> run;
+};
+
+struct PerfMeasurement {
+    std::string name;
+    // Median operations per second over the repetitions.
+    double median{0.0};
+    // Median absolute deviation relative to the median, scaled to estimate a standard
+    // deviation; 0.02 means the repetitions scatter by about 2%.
+    double noise{0.0};
+    std::vector<double> samples;
+};
+
+struct PerfRunConfig {
+    unsigned int repetitions{7};
+    // Each sample calls `run` until this much time has passed.
+    std::chrono::nanoseconds sampleTime{std::chrono::milliseconds(40)};
+};
+
+// Called after every round with (rounds done, total).
+using PerfProgress = std::function<void(std::uint64_t, std::uint64_t)>;
+
+// Warms every benchmark up, then takes `repetitions` rounds of one sample of about
+// `sampleTime` per benchmark. Interleaving the rounds spreads a burst of load from elsewhere
+// over all benchmarks as one slow sample each, where back-to-back samples would hand it to
+// one benchmark as a slow median.
+std::vector<PerfMeasurement> measureBenchmarks(const std::vector<PerfBenchmark> &benchmarks,
+                                               const PerfRunConfig &config,
+                                               const PerfProgress &progress = {});
+
+double medianOf(std::vector<double> values);
+// Median absolute deviation relative to `median`, times 1.4826; 0 for fewer than two values.
+double relativeNoise(const std::vector<double> &values, double median);
+
+struct PerfBaseline {
+    int version{kPerfBaselineVersion};
+    // Build type and compiler the numbers were recorded with; informational only, the test
+    // picks the baseline file by them.
+    std::string buildType;
+    std::string compiler;
+    std::vector<PerfMeasurement> benchmarks;
+};
+
+bool loadPerfBaseline(const std::filesystem::path &path, PerfBaseline &baseline,
+                      std::string &error);
+// Samples are not stored. Written to a temporary file and renamed over `path`.
+bool savePerfBaseline(const std::filesystem::path &path, const PerfBaseline &baseline,
+                      std::string &error);
+
+struct PerfCompareConfig {
+    // Slowdown that fails the check when both runs are quiet.
+    double threshold{0.10};
+    // Noisy benchmarks get a wider band: `noiseFactor` times the larger of the two noises.
+    double noiseFactor{3.0};
+    // A benchmark whose speed tracks the machine rather than the code. When both sides have
+    // it, every baseline median is scaled by its speed ratio first, so a slower or faster
+    // machine does not read as a regression. It is not judged itself.
+    std::string calibration;
+};
+
+struct PerfComparison {
+    enum class Status { Ok, Faster, Regressed, Missing, New };
+
+    std::string name;
+    Status status{Status::Ok};
+    // Baseline median after calibration scaling, and the current median.
+    double expected{0.0};
+    double current{0.0};
+    // current / expected - 1; negative is slower.
+    double change{0.0};
+    // The slowdown this benchmark was allowed.
+    double allowed{0.0};
+};
+
+// One entry per benchmark in either set, in baseline order followed by new ones. Benchmarks
+// only in the baseline are `Missing` and those only in `current` are `New`; neither fails.
+std::vector<PerfComparison> comparePerf(const PerfBaseline &baseline,
+                                        const std::vector<PerfMeasurement> &current,
+                                        const PerfCompareConfig &config);
+
+bool hasRegression(const std::vector<PerfComparison> &comparisons);
+
+// Aligned table with one row per comparison, for the test log.
+std::string formatPerfComparison(const std::vector<PerfComparison> &comparisons);
+
+} // namespace sim2048
@@ -0,0 +1,139 @@
+#include "sim/Perft.hpp"
+
+#include "sim/BoardKeys.hpp"
+#include "sim/Simulation.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <unordered_map>
+
+namespace sim2048 {
+
+namespace {
+
+using core2048::Direction;
+using core2048::Game;
+
+// Board -> number of distinct paths reaching it.
+using Layer = std::unordered_map<std::uint64_t, std::uint64_t>;
+
+constexpr int kCellCount = Game::kGridSize * Game::kGridSize;
+constexpr std::array<Direction, 4> kDirections = {Direction::Up, Direction::Down, Direction::Left,
+                                                  Direction::Right};
+
+std::size_t partitionOf(std::uint64_t key, const std::size_t partitions) {
+    // splitmix64 finalizer: packed boards differ mostly in low nibbles.
+    key ^= key >> 30U;
+    key *= 0xBF58476D1CE4E5B9ULL;
+    key ^= key >> 27U;
+    key *= 0x94D049BB133111EBULL;
+    key ^= key >> 31U;
+    return static_cast<std::size_t>(key % partitions);
+}
+
+// Expands `parents` into `buckets` (one per destination partition).
+std::uint64_t expand(const Layer &parents, std::vector<Layer> &buckets, bool &overflow) {
+    std::uint64_t generated = 0;
+    for (const auto &[key, paths] : parents) {
+        const Game::Grid grid = unpackBoardKey<Game::Grid>(key);
+        for (const Direction direction : kDirections) {
+            Game::Grid moved = grid;
+            if (!Game::slide(moved, direction).moved) {
+                continue;
+            }
+
+            std::uint64_t base = 0;
+            if (!packBoardKey(moved, base)) {
+                overflow = true;
+                return generated;
+            }
+            for (int cell = 0; cell < kCellCount; ++cell) {
+                const int shift = 4 * cell;
+                if (((base >> shift) & 0xFU) != 0U) {
+                    continue;
+                }
+                for (const std::uint64_t exponent : {1U, 2U}) {
+                    const std::uint64_t child = base | (exponent << shift);
+                    buckets[partitionOf(child, buckets.size())][child] += paths;
+                    ++generated;
+                }
+            }
+        }
+    }
+    return generated;
+}
+
+} // namespace
+
+bool runPerft(const Game::Grid &start, const int depth, const unsigned int threads,
+              PerftResult &result, std::string &error) {
+    if (depth < 0) {
+        error = "depth must not be negative";
+        return false;
+    }
+    std::uint64_t startKey = 0;
+    if (!packBoardKey(start, startKey)) {
+        error = "start board has a tile above 32768";
+        return false;
+    }
+
+    const auto began = std::chrono::steady_clock::now();
+    const std::size_t workerCount = resolveThreadCount(threads);
+
+    std::vector<Layer> frontier(workerCount);
+    frontier[partitionOf(startKey, workerCount)][startKey] = 1U;
+
+    result = {};
+    result.layers.push_back({1U, 1U});
+
+    std::vector<std::vector<Layer>> buckets(workerCount, std::vector<Layer>(workerCount));
+    std::vector<std::uint64_t> generated(workerCount, 0U);
+    std::atomic<bool> overflow{false};
+
+    for (int ply = 1; ply <= depth; ++ply) {
+        forEachWorker(workerCount, [&](const std::size_t worker) {
+            bool workerOverflow = false;
+            generated[worker] += expand(frontier[worker], buckets[worker], workerOverflow);
+            if (workerOverflow) {
+                overflow.store(true);
+            }
+        });
+        if (overflow.load()) {
+            error = "a merge produced a tile above 32768";
+            return false;
+        }
+
+        std::vector<PerftLayer> counts(workerCount);
+        forEachWorker(workerCount, [&](const std::size_t partition) {
+            Layer merged = std::move(buckets[0][partition]);
+            buckets[0][partition] = {};
+            for (std::size_t worker = 1; worker < workerCount; ++worker) {
+                for (const auto &[key, paths] : buckets[worker][partition]) {
+                    merged[key] += paths;
+                }
+                buckets[worker][partition] = {};
+            }
+            for (const auto &[key, paths] : merged) {
+                counts[partition].paths += paths;
+            }
+            counts[partition].positions = merged.size();
+            frontier[partition] = std::move(merged);
+        });
+
+        PerftLayer layer;
+        for (const auto &count : counts) {
+            layer.paths += count.paths;
+            layer.positions += count.positions;
+        }
+        result.layers.push_back(layer);
+    }
+
+    for (const auto count : generated) {
+        result.generated += count;
+    }
+    result.elapsed = std::chrono::steady_clock::now() - began;
+    return true;
+}
+
+} // namespace sim2048
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "core/Game.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sim2048 {
+
+// Counts at one depth of the game tree. A ply is one board-changing move followed by one spawn
+// (every empty cell, value 2 or 4), so `paths` is the classic perft count and `positions` the
+// number of distinct boards those paths end on.
+struct PerftLayer {
+    std::uint64_t paths{0};
+    std::uint64_t positions{0};
+};
+
+struct PerftResult {
+    // layers[0] is the start board, layers[d] the boards after d plies.
+    std::vector<PerftLayer> layers;
+    // Child boards produced by slide + spawn, before deduplication: the throughput measure.
+    std::uint64_t generated{0};
+    std::chrono::nanoseconds elapsed{0};
+};
+
+// Enumerates every move and spawn from `start` to `depth` plies, one layer at a time. Boards
+// are packed into 64 bits (4-bit tile exponents, so tiles up to 32768) and deduplicated per
+// layer in hash maps that carry path counts, so a transposition is expanded once. Each layer is
+// split across `threads` workers (0 = all cores): the frontier is partitioned by board hash,
+// every worker expands its part into per-destination buckets, then each worker merges one
+// bucket from everyone. Counts do not depend on the thread count.
+bool runPerft(const core2048::Game::Grid &start, int depth, unsigned int threads,
+              PerftResult &result, std::string &error);
+
+} // namespace sim2048
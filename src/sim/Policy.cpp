@@ -0,0 +1,115 @@
+#include "sim/Policy.hpp"
+
+#include <array>
+#include <random>
+
+namespace sim2048 {
+
+namespace {
+
+using core2048::Direction;
+using core2048::Game;
+
+constexpr std::array<Direction, 4> kAllDirections = {Direction::Up, Direction::Down,
+                                                     Direction::Left, Direction::Right};
+constexpr std::array<std::string_view, 3> kPolicyNames = {"random", "corner", "greedy"};
+
+int countEmptyCells(const Game::Grid &grid) {
+    int empty = 0;
+    for (const auto &row : grid) {
+        for (const int value : row) {
+            empty += value == 0 ? 1 : 0;
+        }
+    }
+    return empty;
+}
+
+// Uniform over the legal moves.
+class RandomPolicy final : public MovePolicy {
+  public:
+    explicit RandomPolicy(const std::uint32_t seed) : rng_(seed) {
+    }
+
+    std::optional<Direction> chooseMove(const Game::Grid &grid) override {
+        std::array<Direction, 4> legal{};
+        std::uint32_t legalCount = 0;
+        for (const Direction direction : kAllDirections) {
+            Game::Grid next = grid;
+            if (Game::slide(next, direction).moved) {
+                legal[legalCount++] = direction;
+            }
+        }
+
+        if (legalCount == 0U) {
+            return std::nullopt;
+        }
+        return legal[rng_() % legalCount];
+    }
+
+  private:
+    std::mt19937 rng_;
+};
+
+// Keeps the largest tiles in the bottom-left corner by trying moves in a fixed priority.
+class CornerPolicy final : public MovePolicy {
+  public:
+    std::optional<Direction> chooseMove(const Game::Grid &grid) override {
+        for (const Direction direction :
+             {Direction::Down, Direction::Left, Direction::Right, Direction::Up}) {
+            Game::Grid next = grid;
+            if (Game::slide(next, direction).moved) {
+                return direction;
+            }
+        }
+        return std::nullopt;
+    }
+};
+
+// One-ply lookahead: most points, then most empty cells; ties keep the earlier direction.
+class GreedyPolicy final : public MovePolicy {
+  public:
+    std::optional<Direction> chooseMove(const Game::Grid &grid) override {
+        std::optional<Direction> best;
+        int bestScore = -1;
+        int bestEmpty = -1;
+
+        for (const Direction direction : kAllDirections) {
+            Game::Grid next = grid;
+            const auto result = Game::slide(next, direction);
+            if (!result.moved) {
+                continue;
+            }
+
+            const int empty = countEmptyCells(next);
+            if (result.scoreDelta > bestScore ||
+                (result.scoreDelta == bestScore && empty > bestEmpty)) {
+                best = direction;
+                bestScore = result.scoreDelta;
+                bestEmpty = empty;
+            }
+        }
+        return best;
+    }
+};
+
+} // namespace
+
+std::span<const std::string_view> policyNames() noexcept {
+    return kPolicyNames;
+}
+
+std::unique_ptr<MovePolicy> makePolicy(const std::string_view name, const std::uint32_t seed) {
+    if (name == "random") {
+        // Decorrelate from the game's spawn generator, which is seeded with the same value.
+        return std::make_unique<RandomPolicy>(seed ^ 0x9E3779B9U);
+    }
+    if (name == "corner") {
+        return std::make_unique<CornerPolicy>();
+    }
+    if (name == "greedy") {
+        return std::make_unique<GreedyPolicy>();
+    }
+    return nullptr;
+}
+
+} // namespace sim2048
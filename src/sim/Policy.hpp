@@ -0,0 +1,29 @@
+#pragma once
+
+#include "core/Game.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace sim2048 {
+
+// Chooses moves for a bot. Implementations are deterministic for a given construction seed, so
+// a game replays identically from `(policy, seed)`.
+class MovePolicy {
+  public:
+    virtual ~MovePolicy() = default;
+
+    // Returns a direction that changes the board, or nothing when no move is legal.
+    virtual std::optional<core2048::Direction> chooseMove(const core2048::Game::Grid &grid) = 0;
+};
+
+// `random`, `corner` and `greedy`.
+std::span<const std::string_view> policyNames() noexcept;
+
+// Returns nullptr for an unknown name. `seed` feeds policies that make random choices.
+std::unique_ptr<MovePolicy> makePolicy(std::string_view name, std::uint32_t seed);
+
+} // namespace sim2048
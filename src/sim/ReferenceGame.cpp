@@ -0,0 +1,208 @@
+#include "sim/ReferenceGame.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace sim2048 {
+
+namespace {
+
+using core2048::Direction;
+using core2048::MoveResult;
+using core2048::SpawnedTile;
+
+constexpr int kGridSize = 4;
+
+std::uint32_t nextBounded(std::mt19937 &rng, const std::uint32_t upperExclusive) {
+    if (upperExclusive == 0U) {
+        return 0U;
+    }
+
+    constexpr std::uint64_t range = static_cast<std::uint64_t>(std::mt19937::max()) + 1ULL;
+    const std::uint64_t bucketSize = range / upperExclusive;
+    const std::uint64_t rejectionLimit = bucketSize * upperExclusive;
+
+    std::uint64_t value = 0;
+    do {
+        value = static_cast<std::uint64_t>(rng());
+    } while (value >= rejectionLimit);
+
+    return static_cast<std::uint32_t>(value / bucketSize);
+}
+
+} // namespace
+
+ReferenceGame::ReferenceGame(const std::uint32_t seed) : rng_(seed) {
+    spawnTile();
+    spawnTile();
+}
+
+void ReferenceGame::loadState(const Grid &grid, const int score) {
+    grid_ = grid;
+    score_ = score;
+}
+
+const ReferenceGame::Grid &ReferenceGame::getGrid() const noexcept {
+    return grid_;
+}
+
+int ReferenceGame::getScore() const noexcept {
+    return score_;
+}
+
+ReferenceGame::LineResult ReferenceGame::slideAndMergeLine(const std::array<int, 4> &line) {
+    std::vector<int> compact;
+    compact.reserve(kGridSize);
+
+    for (int value : line) {
+        if (value != 0) {
+            compact.push_back(value);
+        }
+    }
+
+    LineResult result;
+
+    int writeIndex = 0;
+    for (size_t i = 0; i < compact.size(); ++i) {
+        if (i + 1 < compact.size() && compact[i] == compact[i + 1]) {
+            const int mergedValue = compact[i] * 2;
+            result.values[writeIndex++] = mergedValue;
+            result.scoreDelta += mergedValue;
+            ++result.mergeCount;
+            result.maxMergedValue = std::max(result.maxMergedValue, mergedValue);
+            ++i;
+            continue;
+        }
+
+        result.values[writeIndex++] = compact[i];
+    }
+
+    result.moved = result.values != line;
+    return result;
+}
+
+std::optional<SpawnedTile> ReferenceGame::spawnTile() {
+    std::vector<std::pair<int, int>> emptyCells;
+    emptyCells.reserve(kGridSize * kGridSize);
+
+    for (int r = 0; r < kGridSize; ++r) {
+        for (int c = 0; c < kGridSize; ++c) {
+            if (grid_[r][c] == 0) {
+                emptyCells.emplace_back(r, c);
+            }
+        }
+    }
+
+    if (emptyCells.empty()) {
+        return std::nullopt;
+    }
+
+    const size_t cellIndex =
+        static_cast<size_t>(nextBounded(rng_, static_cast<std::uint32_t>(emptyCells.size())));
+    const auto [row, col] = emptyCells[cellIndex];
+
+    const int tileValue = (nextBounded(rng_, 10U) == 0U) ? 4 : 2;
+
+    grid_[row][col] = tileValue;
+    return SpawnedTile{row, col, tileValue};
+}
+
+MoveResult ReferenceGame::applyMove(const Direction dir) {
+    Grid &grid = grid_;
+    bool moved = false;
+    int scoreDelta = 0;
+    int mergeCount = 0;
+    int maxMergedValue = 0;
+
+    const auto applyToRow = [&](int row, bool reverse) {
+        std::array<int, kGridSize> line{};
+
+        for (int c = 0; c < kGridSize; ++c) {
+            line[c] = reverse ? grid[row][kGridSize - 1 - c] : grid[row][c];
+        }
+
+        const LineResult lineResult = slideAndMergeLine(line);
+
+        if (lineResult.moved) {
+            moved = true;
+        }
+
+        scoreDelta += lineResult.scoreDelta;
+        mergeCount += lineResult.mergeCount;
+        maxMergedValue = std::max(maxMergedValue, lineResult.maxMergedValue);
+
+        for (int c = 0; c < kGridSize; ++c) {
+            if (reverse) {
+                grid[row][kGridSize - 1 - c] = lineResult.values[c];
+            } else {
+                grid[row][c] = lineResult.values[c];
+            }
+        }
+    };
+
+    const auto applyToCol = [&](int col, bool reverse) {
+        std::array<int, kGridSize> line{};
+
+        for (int r = 0; r < kGridSize; ++r) {
+            line[r] = reverse ? grid[kGridSize - 1 - r][col] : grid[r][col];
+        }
+
+        const LineResult lineResult = slideAndMergeLine(line);
+
+        if (lineResult.moved) {
+            moved = true;
+        }
+
+        scoreDelta += lineResult.scoreDelta;
+        mergeCount += lineResult.mergeCount;
+        maxMergedValue = std::max(maxMergedValue, lineResult.maxMergedValue);
+
+        for (int r = 0; r < kGridSize; ++r) {
+            if (reverse) {
+                grid[kGridSize - 1 - r][col] = lineResult.values[r];
+            } else {
+                grid[r][col] = lineResult.values[r];
+            }
+        }
+    };
+
+    switch (dir) {
+    case Direction::Left:
+        for (int r = 0; r < kGridSize; ++r) {
+            applyToRow(r, false);
+        }
+        break;
+    case Direction::Right:
+        for (int r = 0; r < kGridSize; ++r) {
+            applyToRow(r, true);
+        }
+        break;
+    case Direction::Up:
+        for (int c = 0; c < kGridSize; ++c) {
+            applyToCol(c, false);
+        }
+        break;
+    case Direction::Down:
+        for (int c = 0; c < kGridSize; ++c) {
+            applyToCol(c, true);
+        }
+        break;
+    }
+
+    if (!moved) {
+        return MoveResult{};
+    }
+
+    MoveResult result;
+    result.moved = true;
+    result.scoreDelta = scoreDelta;
+    result.mergeCount = mergeCount;
+    result.maxMergedValue = maxMergedValue;
+
+    score_ += result.scoreDelta;
+    result.spawnedTile = spawnTile();
+    return result;
+}
+
+} // namespace sim2048
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "core/Game.hpp"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <random>
+
+namespace sim2048 {
+
+// A frozen copy of the 4x4 rules as `core2048::Game` implemented them before any low-level
+// optimization: line-by-line slide and merge on `int` grids, and the same seeded spawn
+// sequence. It is the oracle for `runDifferentialCheck`, so keep it simple and leave it
+// unchanged. A rule change has to land here and in `Game` together.
+class ReferenceGame {
+  public:
+    using Grid = core2048::Game::Grid;
+
+    explicit ReferenceGame(std::uint32_t seed);
+
+    void loadState(const Grid &grid, int score = 0);
+    core2048::MoveResult applyMove(core2048::Direction dir);
+
+    const Grid &getGrid() const noexcept;
+    int getScore() const noexcept;
+
+  private:
+    struct LineResult {
+        std::array<int, 4> values{};
+        bool moved{false};
+        int scoreDelta{0};
+        int mergeCount{0};
+        int maxMergedValue{0};
+    };
+
+    static LineResult slideAndMergeLine(const std::array<int, 4> &line);
+    std::optional<core2048::SpawnedTile> spawnTile();
+
+    Grid grid_{};
+    int score_{0};
+    std::mt19937 rng_;
+};
+
+} // namespace sim2048
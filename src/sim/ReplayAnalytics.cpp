@@ -0,0 +1,264 @@
+#include "sim/ReplayAnalytics.hpp"
+
+#include "core/Heuristics.hpp"
+#include "sim/TrainingData.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+namespace sim2048 {
+
+namespace {
+
+using core2048::Direction;
+using core2048::Game;
+
+constexpr std::array<const char *, kBoardPhaseCount> kPhaseNames = {"early", "middle", "late"};
+
+struct WorkUnit {
+    std::size_t file{0};
+    std::size_t chunk{0};
+};
+
+bool collectFiles(const std::vector<std::filesystem::path> &inputs,
+                  std::vector<std::filesystem::path> &files, std::string &error) {
+    for (const auto &input : inputs) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(input, ec)) {
+            files.push_back(input);
+            continue;
+        }
+
+        std::vector<std::filesystem::path> found;
+        for (std::filesystem::recursive_directory_iterator it(input, ec), end; !ec && it != end;
+             it.increment(ec)) {
+            if (it->is_regular_file() && it->path().extension() == ".s2td") {
+                found.push_back(it->path());
+            }
+        }
+        if (ec) {
+            error = "cannot list " + input.string() + ": " + ec.message();
+            return false;
+        }
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    if (files.empty()) {
+        error = "no .s2td files found";
+        return false;
+    }
+    return true;
+}
+
+int maxTileOf(const Game::Grid &grid) {
+    int maxTile = 0;
+    for (const auto &row : grid) {
+        maxTile = std::max(maxTile, *std::max_element(row.begin(), row.end()));
+    }
+    return maxTile;
+}
+
+bool isInCorner(const Game::Grid &grid, const int tile) {
+    constexpr int last = Game::kGridSize - 1;
+    return grid[0][0] == tile || grid[0][last] == tile || grid[last][0] == tile ||
+           grid[last][last] == tile;
+}
+
+// Analyzes the game starting at sample `index` of chunk `chunk`, following it into later chunks,
+// and leaves `chunk`/`index` just past its last sample.
+GameAnalytics analyzeGame(const TrainingReader &reader, std::size_t &chunk, std::size_t &index) {
+    TrainingChunkView view = reader.chunk(chunk);
+    GameAnalytics game;
+    game.seed = view.games[index];
+    game.outcome.score = static_cast<int>(view.outcomes[index]);
+    const int finalTile = view.finalTiles[index];
+    game.outcome.maxTile = finalTile == 0 ? 0 : 1 << finalTile;
+
+    std::uint64_t moves = 0;
+    while (true) {
+        if (index == view.size()) {
+            if (chunk + 1U == reader.chunkCount()) {
+                break;
+            }
+            view = reader.chunk(++chunk);
+            index = 0;
+            continue;
+        }
+        if (view.games[index] != game.seed) {
+            break;
+        }
+
+        Game::Grid grid = core2048::unpackBoard(view.boards[index]);
+        const int maxTile = maxTileOf(grid);
+        const auto phase = static_cast<std::size_t>(boardPhaseOf(maxTile));
+        const std::uint8_t move = view.moves[index] & 0x3U;
+        ++game.moveCounts[phase][move];
+        game.cornerMoves += isInCorner(grid, maxTile) ? 1U : 0U;
+
+        const auto result = Game::slide(grid, static_cast<Direction>(move));
+        ++moves;
+        game.merges += static_cast<std::uint64_t>(result.mergeCount);
+        for (std::size_t m = 0; m < kMilestoneTiles.size(); ++m) {
+            auto &milestone = game.milestoneMoves[m];
+            if (!milestone.has_value() && result.maxMergedValue >= kMilestoneTiles[m]) {
+                milestone = moves;
+            }
+        }
+        ++index;
+    }
+    game.outcome.moves = static_cast<int>(moves);
+    return game;
+}
+
+} // namespace
+
+BoardPhase boardPhaseOf(const int maxTile) noexcept {
+    if (maxTile < 256) {
+        return BoardPhase::Early;
+    }
+    return maxTile <= 1024 ? BoardPhase::Middle : BoardPhase::Late;
+}
+
+const char *boardPhaseName(const BoardPhase phase) noexcept {
+    return kPhaseNames[static_cast<std::size_t>(phase)];
+}
+
+void ReplayAccumulator::add(const GameAnalytics &game) {
+    outcomes_.add(game.outcome);
+    merges_ += game.merges;
+    cornerMoves_ += game.cornerMoves;
+    for (std::size_t m = 0; m < kMilestoneTiles.size(); ++m) {
+        if (game.milestoneMoves[m].has_value()) {
+            ++milestoneGames_[m];
+            milestoneMoves_[m] += *game.milestoneMoves[m];
+        }
+    }
+    for (std::size_t phase = 0; phase < kBoardPhaseCount; ++phase) {
+        for (std::size_t move = 0; move < 4U; ++move) {
+            moveCounts_[phase][move] += game.moveCounts[phase][move];
+        }
+    }
+}
+
+void ReplayAccumulator::merge(const ReplayAccumulator &other) {
+    outcomes_.merge(other.outcomes_);
+    merges_ += other.merges_;
+    cornerMoves_ += other.cornerMoves_;
+    for (std::size_t m = 0; m < kMilestoneTiles.size(); ++m) {
+        milestoneGames_[m] += other.milestoneGames_[m];
+        milestoneMoves_[m] += other.milestoneMoves_[m];
+    }
+    for (std::size_t phase = 0; phase < kBoardPhaseCount; ++phase) {
+        for (std::size_t move = 0; move < 4U; ++move) {
+            moveCounts_[phase][move] += other.moveCounts_[phase][move];
+        }
+    }
+}
+
+const OutcomeAccumulator &ReplayAccumulator::outcomes() const noexcept {
+    return outcomes_;
+}
+
+std::uint64_t ReplayAccumulator::merges() const noexcept {
+    return merges_;
+}
+
+std::uint64_t ReplayAccumulator::cornerMoves() const noexcept {
+    return cornerMoves_;
+}
+
+const std::array<std::uint64_t, kMilestoneTiles.size()> &
+ReplayAccumulator::milestoneGames() const noexcept {
+    return milestoneGames_;
+}
+
+const std::array<std::uint64_t, kMilestoneTiles.size()> &
+ReplayAccumulator::milestoneMoves() const noexcept {
+    return milestoneMoves_;
+}
+
+const std::array<std::array<std::uint64_t, 4>, kBoardPhaseCount> &
+ReplayAccumulator::moveCounts() const noexcept {
+    return moveCounts_;
+}
+
+bool analyzeReplays(const ReplayAnalyticsConfig &config, ReplayAnalyticsResult &result,
+                    std::string &error) {
+    const auto began = std::chrono::steady_clock::now();
+    result = {};
+    if (!collectFiles(config.inputs, result.files, error)) {
+        return false;
+    }
+
+    std::vector<TrainingReader> readers(result.files.size());
+    std::vector<WorkUnit> units;
+    for (std::size_t file = 0; file < readers.size(); ++file) {
+        if (!readers[file].open(result.files[file], error)) {
+            return false;
+        }
+        result.policies.push_back(readers[file].policy());
+        result.samples += readers[file].samples();
+        for (std::size_t chunk = 0; chunk < readers[file].chunkCount(); ++chunk) {
+            units.push_back({file, chunk});
+        }
+    }
+
+    const std::size_t workerCount = resolveThreadCount(config.threads);
+    std::vector<ReplayAccumulator> partials(workerCount);
+    std::vector<std::vector<GameAnalytics>> unitGames(config.perGame ? units.size() : 0U);
+    std::atomic<std::size_t> nextUnit{0};
+
+    const auto work = [&](const std::size_t worker) {
+        for (std::size_t u = nextUnit.fetch_add(1U); u < units.size();
+             u = nextUnit.fetch_add(1U)) {
+            const auto [file, chunk] = units[u];
+            const TrainingReader &reader = readers[file];
+            const TrainingChunkView view = reader.chunk(chunk);
+
+            // Samples continuing a game from the previous chunk belong to that chunk's unit.
+            std::size_t index = 0;
+            if (chunk > 0U && view.size() > 0U) {
+                const TrainingChunkView previous = reader.chunk(chunk - 1U);
+                if (previous.size() > 0U && previous.games.back() == view.games[0]) {
+                    while (index < view.size() && view.games[index] == view.games[0]) {
+                        ++index;
+                    }
+                }
+            }
+
+            std::size_t cursorChunk = chunk;
+            while (cursorChunk == chunk && index < view.size()) {
+                GameAnalytics game = analyzeGame(reader, cursorChunk, index);
+                game.file = file;
+                partials[worker].add(game);
+                if (config.perGame) {
+                    unitGames[u].push_back(game);
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for (std::size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(work, i);
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    for (const auto &partial : partials) {
+        result.total.merge(partial);
+    }
+    for (auto &games : unitGames) {
+        result.games.insert(result.games.end(), std::make_move_iterator(games.begin()),
+                            std::make_move_iterator(games.end()));
+    }
+    result.elapsed = std::chrono::steady_clock::now() - began;
+    return true;
+}
+
+} // namespace sim2048
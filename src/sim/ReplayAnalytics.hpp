@@ -0,0 +1,94 @@
+#pragma once
+
+#include "sim/Simulation.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace sim2048 {
+
+// Tiles whose first appearance is timed, in moves from the start of the game.
+inline constexpr std::array<int, 6> kMilestoneTiles = {256, 512, 1024, 2048, 4096, 8192};
+
+// Game phase by the largest tile on the board before a move: early below 256, middle up to
+// 1024, late from 2048.
+enum class BoardPhase { Early, Middle, Late };
+inline constexpr std::size_t kBoardPhaseCount = 3;
+
+BoardPhase boardPhaseOf(int maxTile) noexcept;
+const char *boardPhaseName(BoardPhase phase) noexcept;
+
+// Per-game analytics of a recorded game.
+struct GameAnalytics {
+    // Index into `ReplayAnalyticsResult::files`.
+    std::size_t file{0};
+    std::uint32_t seed{0};
+    GameOutcome outcome;
+    std::uint64_t merges{0};
+    // Moves made with the largest tile in a corner.
+    std::uint64_t cornerMoves{0};
+    // Moves played until a merge first produced each milestone tile.
+    std::array<std::optional<std::uint64_t>, kMilestoneTiles.size()> milestoneMoves;
+    // Moves played per phase and `Direction`.
+    std::array<std::array<std::uint64_t, 4>, kBoardPhaseCount> moveCounts{};
+};
+
+// Exact totals over many games. `merge` is associative and commutative, so per-worker partial
+// results combine into the same totals in any order.
+class ReplayAccumulator {
+  public:
+    void add(const GameAnalytics &game);
+    void merge(const ReplayAccumulator &other);
+
+    const OutcomeAccumulator &outcomes() const noexcept;
+    std::uint64_t merges() const noexcept;
+    std::uint64_t cornerMoves() const noexcept;
+    // Games that reached each milestone, and the moves they needed in total.
+    const std::array<std::uint64_t, kMilestoneTiles.size()> &milestoneGames() const noexcept;
+    const std::array<std::uint64_t, kMilestoneTiles.size()> &milestoneMoves() const noexcept;
+    const std::array<std::array<std::uint64_t, 4>, kBoardPhaseCount> &moveCounts() const noexcept;
+
+    bool operator==(const ReplayAccumulator &other) const = default;
+
+  private:
+    OutcomeAccumulator outcomes_;
+    std::uint64_t merges_{0};
+    std::uint64_t cornerMoves_{0};
+    std::array<std::uint64_t, kMilestoneTiles.size()> milestoneGames_{};
+    std::array<std::uint64_t, kMilestoneTiles.size()> milestoneMoves_{};
+    std::array<std::array<std::uint64_t, 4>, kBoardPhaseCount> moveCounts_{};
+};
+
+struct ReplayAnalyticsConfig {
+    // Training data files (`.s2td`) or directories, searched recursively for them.
+    std::vector<std::filesystem::path> inputs;
+    // 0 uses every hardware thread.
+    unsigned int threads{0};
+    // Keep every game's analytics in `ReplayAnalyticsResult::games`.
+    bool perGame{false};
+};
+
+struct ReplayAnalyticsResult {
+    std::vector<std::filesystem::path> files;
+    std::vector<std::string> policies;
+    ReplayAccumulator total;
+    // In file order, then in recorded order within a file; only with `perGame`.
+    std::vector<GameAnalytics> games;
+    std::uint64_t samples{0};
+    std::chrono::nanoseconds elapsed{0};
+};
+
+// Analyzes recorded games in parallel. Every file is memory-mapped; its chunks are the units of
+// work, and a worker follows a game that starts in its chunk into the next ones. Each worker
+// accumulates its own totals, which are merged at the end (map-reduce), so the result does not
+// depend on the thread count. Games are told apart by their seed column.
+bool analyzeReplays(const ReplayAnalyticsConfig &config, ReplayAnalyticsResult &result,
+                    std::string &error);
+
+} // namespace sim2048
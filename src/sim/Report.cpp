@@ -0,0 +1,112 @@
+#include "sim/Report.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <array>
+
+namespace sim2048 {
+
+namespace {
+
+constexpr std::array<const char *, 4> kMoveNames = {"up", "down", "left", "right"};
+
+double ratio(const std::uint64_t part, const std::uint64_t whole) {
+    return whole == 0U ? 0.0 : static_cast<double>(part) / static_cast<double>(whole);
+}
+
+nlohmann::json
+movesByPhase(const std::array<std::array<std::uint64_t, 4>, kBoardPhaseCount> &counts) {
+    nlohmann::json phases = nlohmann::json::object();
+    for (std::size_t phase = 0; phase < kBoardPhaseCount; ++phase) {
+        nlohmann::json moves = nlohmann::json::object();
+        for (std::size_t move = 0; move < kMoveNames.size(); ++move) {
+            moves[kMoveNames[move]] = counts[phase][move];
+        }
+        phases[boardPhaseName(static_cast<BoardPhase>(phase))] = moves;
+    }
+    return phases;
+}
+
+} // namespace
+
+std::string gameJsonLine(const std::string &policy, const std::uint32_t seed,
+                         const GameOutcome &outcome) {
+    nlohmann::json line;
+    line["type"] = "game";
+    line["policy"] = policy;
+    line["seed"] = seed;
+    line["score"] = outcome.score;
+    line["max_tile"] = outcome.maxTile;
+    line["moves"] = outcome.moves;
+    return line.dump();
+}
+
+std::string aggregateJsonLine(const std::string &policy, const OutcomeSummary &summary) {
+    nlohmann::json line;
+    line["type"] = "aggregate";
+    line["policy"] = policy;
+    line["games"] = summary.games;
+    line["mean_score"] = summary.meanScore;
+    line["median_score"] = summary.medianScore;
+    line["p99_score"] = summary.p99Score;
+    line["best_score"] = summary.bestScore;
+    line["reach_2048"] = summary.reach2048;
+    line["reach_4096"] = summary.reach4096;
+    line["reach_8192"] = summary.reach8192;
+    return line.dump();
+}
+
+std::string replayGameJsonLine(const std::string &file, const std::string &policy,
+                               const GameAnalytics &game) {
+    const auto moves = static_cast<std::uint64_t>(game.outcome.moves);
+    nlohmann::json line;
+    line["type"] = "replay";
+    line["file"] = file;
+    line["policy"] = policy;
+    line["seed"] = game.seed;
+    line["score"] = game.outcome.score;
+    line["max_tile"] = game.outcome.maxTile;
+    line["moves"] = moves;
+    line["merge_rate"] = ratio(game.merges, moves);
+    line["corner_stability"] = ratio(game.cornerMoves, moves);
+    nlohmann::json milestones = nlohmann::json::object();
+    for (std::size_t m = 0; m < kMilestoneTiles.size(); ++m) {
+        if (game.milestoneMoves[m].has_value()) {
+            milestones[std::to_string(kMilestoneTiles[m])] = *game.milestoneMoves[m];
+        }
+    }
+    line["moves_to_tile"] = milestones;
+    line["moves_by_phase"] = movesByPhase(game.moveCounts);
+    return line.dump();
+}
+
+std::string replayAggregateJsonLine(const std::size_t files, const ReplayAccumulator &total) {
+    const auto &outcomes = total.outcomes();
+    const OutcomeSummary summary = outcomes.summary();
+    nlohmann::json line;
+    line["type"] = "replay_aggregate";
+    line["files"] = files;
+    line["games"] = outcomes.games();
+    line["moves"] = outcomes.totalMoves();
+    line["mean_moves"] = ratio(outcomes.totalMoves(), outcomes.games());
+    line["merge_rate"] = ratio(total.merges(), outcomes.totalMoves());
+    line["corner_stability"] = ratio(total.cornerMoves(), outcomes.totalMoves());
+    line["mean_score"] = summary.meanScore;
+    line["median_score"] = summary.medianScore;
+    line["p99_score"] = summary.p99Score;
+    line["best_score"] = summary.bestScore;
+
+    nlohmann::json milestones = nlohmann::json::array();
+    for (std::size_t m = 0; m < kMilestoneTiles.size(); ++m) {
+        const std::uint64_t games = total.milestoneGames()[m];
+        milestones.push_back({{"tile", kMilestoneTiles[m]},
+                              {"games", games},
+                              {"rate", ratio(games, outcomes.games())},
+                              {"mean_moves", ratio(total.milestoneMoves()[m], games)}});
+    }
+    line["milestones"] = milestones;
+    line["moves_by_phase"] = movesByPhase(total.moveCounts());
+    return line.dump();
+}
+
+} // namespace sim2048
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "sim/ReplayAnalytics.hpp"
+#include "sim/Simulation.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace sim2048 {
+
+// One JSON object per line, without the trailing newline. Shared by every tool that reports
+// games or per-policy aggregates so their output can be compared and post-processed alike.
+std::string gameJsonLine(const std::string &policy, std::uint32_t seed,
+                         const GameOutcome &outcome);
+std::string aggregateJsonLine(const std::string &policy, const OutcomeSummary &summary);
+
+// Replay analytics of one recorded game, and the totals over all analyzed files.
+std::string replayGameJsonLine(const std::string &file, const std::string &policy,
+                               const GameAnalytics &game);
+std::string replayAggregateJsonLine(std::size_t files, const ReplayAccumulator &total);
+
+} // namespace sim2048
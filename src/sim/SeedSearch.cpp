@@ -0,0 +1,545 @@
+#include "sim/SeedSearch.hpp"
+
+#include "core/Game.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+
+namespace sim2048 {
+
+namespace {
+
+using Json = nlohmann::json;
+
+constexpr int kCheckpointVersion = 1;
+constexpr std::size_t kDefaultTopCount = 10;
+constexpr auto kProgressInterval = std::chrono::seconds(1);
+
+struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<SeedRange> ranges;
+    // Block taken from `ranges` that has not been published yet; still counts as remaining.
+    std::optional<SeedRange> inFlight;
+};
+
+std::uint64_t rangeSize(const SeedRange &range) {
+    return range.end - range.begin;
+}
+
+bool parseInt(const std::string_view text, int &value) {
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return !text.empty() && ec == std::errc{} && ptr == text.data() + text.size() && value >= 0;
+}
+
+bool isPowerOfTwo(const int value) {
+    return value > 0 && (value & (value - 1)) == 0;
+}
+
+bool better(const SeedMatch &a, const SeedMatch &b) {
+    return a.outcome.score != b.outcome.score ? a.outcome.score > b.outcome.score
+                                              : a.seed < b.seed;
+}
+
+std::size_t topCount(const SeedSearchConfig &config) {
+    return config.limit == 0U ? kDefaultTopCount : config.limit;
+}
+
+void orderMatches(const SeedSearchConfig &config, std::vector<SeedMatch> &matches) {
+    if (config.predicate.kind == SeedPredicate::Kind::MaxScore) {
+        std::sort(matches.begin(), matches.end(), better);
+        matches.resize(std::min(matches.size(), topCount(config)));
+    } else {
+        std::sort(matches.begin(), matches.end(),
+                  [](const SeedMatch &a, const SeedMatch &b) { return a.seed < b.seed; });
+        if (config.limit != 0U) {
+            matches.resize(std::min(matches.size(), config.limit));
+        }
+    }
+}
+
+std::optional<GameOutcome> evaluateSeed(const SeedSearchConfig &config, const std::uint32_t seed) {
+    const SeedPredicate &predicate = config.predicate;
+    if (predicate.kind == SeedPredicate::Kind::Opening) {
+        const core2048::Game game(seed);
+        GameOutcome outcome;
+        std::size_t cell = 0;
+        for (const auto &row : game.getGrid()) {
+            for (const int value : row) {
+                const int expected = predicate.opening[cell++];
+                if (expected >= 0 && expected != value) {
+                    return std::nullopt;
+                }
+                outcome.maxTile = std::max(outcome.maxTile, value);
+            }
+        }
+        return outcome;
+    }
+
+    const auto policy = makePolicy(config.policy, seed);
+    if (predicate.kind == SeedPredicate::Kind::ReachTile) {
+        const GameOutcome outcome = playGame(*policy, seed, config.maxMoves, predicate.tile);
+        return outcome.maxTile >= predicate.tile ? std::optional(outcome) : std::nullopt;
+    }
+    return playGame(*policy, seed, config.maxMoves);
+}
+
+// Sorts and joins adjacent ranges.
+std::vector<SeedRange> coalesce(std::vector<SeedRange> ranges) {
+    std::sort(ranges.begin(), ranges.end(),
+              [](const SeedRange &a, const SeedRange &b) { return a.begin < b.begin; });
+    std::vector<SeedRange> joined;
+    for (const auto &range : ranges) {
+        if (rangeSize(range) == 0U) {
+            continue;
+        }
+        if (!joined.empty() && joined.back().end >= range.begin) {
+            joined.back().end = std::max(joined.back().end, range.end);
+        } else {
+            joined.push_back(range);
+        }
+    }
+    return joined;
+}
+
+// Cuts `ranges` into one contiguous piece of about equal seed count per queue.
+void distribute(const std::vector<SeedRange> &ranges, std::vector<WorkerQueue> &queues) {
+    std::uint64_t total = 0;
+    for (const auto &range : ranges) {
+        total += rangeSize(range);
+    }
+
+    const std::uint64_t share = (total + queues.size() - 1U) / queues.size();
+    std::size_t worker = 0;
+    std::uint64_t assigned = 0;
+    for (SeedRange range : ranges) {
+        while (rangeSize(range) > 0U) {
+            const std::uint64_t take = std::min(rangeSize(range), share - assigned);
+            queues[worker].ranges.push_back({range.begin, range.begin + take});
+            range.begin += take;
+            assigned += take;
+            if (assigned == share && worker + 1U < queues.size()) {
+                ++worker;
+                assigned = 0;
+            }
+        }
+    }
+}
+
+// Takes the next block from the front of `queue`; the caller holds its mutex.
+std::optional<SeedRange> takeBlock(WorkerQueue &queue, const std::uint32_t blockSize) {
+    if (queue.ranges.empty()) {
+        return std::nullopt;
+    }
+    SeedRange &front = queue.ranges.front();
+    const SeedRange block{front.begin, front.begin + std::min<std::uint64_t>(blockSize,
+                                                                             rangeSize(front))};
+    front.begin = block.end;
+    if (rangeSize(front) == 0U) {
+        queue.ranges.pop_front();
+    }
+    queue.inFlight = block;
+    return block;
+}
+
+// `stateMutex` is held while stealing: a steal moves a range between two queues, and a
+// snapshot that locks the queues one at a time under `stateMutex` would otherwise miss it.
+std::optional<SeedRange> nextBlock(std::vector<WorkerQueue> &queues, const std::size_t self,
+                                   const std::uint32_t blockSize, std::mutex &stateMutex) {
+    {
+        const std::lock_guard<std::mutex> lock(queues[self].mutex);
+        if (auto block = takeBlock(queues[self], blockSize)) {
+            return block;
+        }
+    }
+
+    // Steal from the back, where the victim will get to last; large ranges are split in half.
+    const std::lock_guard<std::mutex> stateLock(stateMutex);
+    for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue &victim = queues[(self + offset) % queues.size()];
+        const std::scoped_lock lock(queues[self].mutex, victim.mutex);
+        if (victim.ranges.empty()) {
+            continue;
+        }
+
+        SeedRange &back = victim.ranges.back();
+        if (rangeSize(back) > blockSize) {
+            const std::uint64_t half = rangeSize(back) / 2U;
+            queues[self].ranges.push_back({back.end - half, back.end});
+            back.end -= half;
+        } else {
+            queues[self].ranges.push_back(back);
+            victim.ranges.pop_back();
+        }
+        return takeBlock(queues[self], blockSize);
+    }
+    return std::nullopt;
+}
+
+Json matchJson(const SeedMatch &match) {
+    return Json{{"seed", match.seed},
+                {"score", match.outcome.score},
+                {"max_tile", match.outcome.maxTile},
+                {"moves", match.outcome.moves}};
+}
+
+Json checkpointHeader(const SeedSearchConfig &config) {
+    return Json{{"version", kCheckpointVersion},
+                {"predicate", describeSeedPredicate(config.predicate)},
+                {"policy", config.policy},
+                {"max_moves", config.maxMoves},
+                {"seeds", Json::array({config.seeds.begin, config.seeds.end})}};
+}
+
+bool writeCheckpoint(const SeedSearchConfig &config, const std::vector<SeedRange> &remaining,
+                     const std::vector<SeedMatch> &matches, const std::uint64_t searched,
+                     std::string &error) {
+    Json checkpoint = checkpointHeader(config);
+    checkpoint["searched"] = searched;
+    checkpoint["remaining"] = Json::array();
+    for (const auto &range : remaining) {
+        checkpoint["remaining"].push_back(Json::array({range.begin, range.end}));
+    }
+    checkpoint["matches"] = Json::array();
+    for (const auto &match : matches) {
+        checkpoint["matches"].push_back(matchJson(match));
+    }
+
+    auto tempPath = config.checkpointPath;
+    tempPath += ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::trunc);
+        out << checkpoint.dump() << '\n';
+        if (!out) {
+            error = "cannot write " + tempPath.string();
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, config.checkpointPath, ec);
+    if (ec) {
+        error = "cannot rename " + tempPath.string() + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+bool readCheckpoint(const SeedSearchConfig &config, std::vector<SeedRange> &remaining,
+                    std::vector<SeedMatch> &matches, std::uint64_t &searched,
+                    std::string &error) {
+    const std::string name = config.checkpointPath.string();
+    std::ifstream in(config.checkpointPath);
+    if (!in.is_open()) {
+        error = "cannot open " + name;
+        return false;
+    }
+
+    const Json checkpoint = Json::parse(in, nullptr, false);
+    if (checkpoint.is_discarded() || !checkpoint.is_object()) {
+        error = name + ": not a seed search checkpoint";
+        return false;
+    }
+
+    const Json header = checkpointHeader(config);
+    for (const auto &[key, value] : header.items()) {
+        if (!checkpoint.contains(key) || checkpoint[key] != value) {
+            error = name + ": checkpoint was made with a different " + key;
+            return false;
+        }
+    }
+
+    const Json &ranges = checkpoint.value("remaining", Json());
+    const Json &found = checkpoint.value("matches", Json());
+    if (!checkpoint.value("searched", Json()).is_number_unsigned() || !ranges.is_array() ||
+        !found.is_array()) {
+        error = name + ": incomplete checkpoint";
+        return false;
+    }
+    searched = checkpoint["searched"].get<std::uint64_t>();
+
+    for (const auto &range : ranges) {
+        if (!range.is_array() || range.size() != 2U || !range[0].is_number_unsigned() ||
+            !range[1].is_number_unsigned()) {
+            error = name + ": malformed remaining range";
+            return false;
+        }
+        const SeedRange parsed{range[0].get<std::uint64_t>(), range[1].get<std::uint64_t>()};
+        if (parsed.begin > parsed.end || parsed.begin < config.seeds.begin ||
+            parsed.end > config.seeds.end) {
+            error = name + ": remaining range outside the searched seeds";
+            return false;
+        }
+        remaining.push_back(parsed);
+    }
+
+    for (const auto &match : found) {
+        if (!match.is_object()) {
+            error = name + ": malformed match";
+            return false;
+        }
+        SeedMatch parsed;
+        parsed.seed = match.value("seed", 0U);
+        parsed.outcome.score = match.value("score", 0);
+        parsed.outcome.maxTile = match.value("max_tile", 0);
+        parsed.outcome.moves = match.value("moves", 0);
+        matches.push_back(parsed);
+    }
+    return true;
+}
+
+} // namespace
+
+bool parseSeedPredicate(const std::string_view text, SeedPredicate &predicate,
+                        std::string &error) {
+    if (text == "max-score") {
+        predicate = {};
+        predicate.kind = SeedPredicate::Kind::MaxScore;
+        return true;
+    }
+
+    if (text.starts_with("reach:")) {
+        int tile = 0;
+        if (!parseInt(text.substr(6), tile) || tile < 4 || !isPowerOfTwo(tile)) {
+            error = "reach needs a power-of-two tile of at least 4: " + std::string(text);
+            return false;
+        }
+        predicate = {};
+        predicate.kind = SeedPredicate::Kind::ReachTile;
+        predicate.tile = tile;
+        return true;
+    }
+
+    if (text.starts_with("opening:")) {
+        SeedPredicate parsed;
+        parsed.kind = SeedPredicate::Kind::Opening;
+        std::string_view cells = text.substr(8);
+        std::size_t count = 0;
+        while (true) {
+            const std::size_t comma = std::min(cells.find(','), cells.size());
+            const std::string_view cell = cells.substr(0, comma);
+            int value = -1;
+            if (count >= parsed.opening.size() || (cell != "*" && !parseInt(cell, value))) {
+                error = "opening needs 16 comma-separated cells (numbers or *)";
+                return false;
+            }
+            parsed.opening[count++] = value;
+            if (comma == cells.size()) {
+                break;
+            }
+            cells.remove_prefix(comma + 1U);
+        }
+        if (count != parsed.opening.size()) {
+            error = "opening needs 16 comma-separated cells (numbers or *)";
+            return false;
+        }
+        predicate = parsed;
+        return true;
+    }
+
+    error = "unknown predicate: " + std::string(text);
+    return false;
+}
+
+std::string describeSeedPredicate(const SeedPredicate &predicate) {
+    switch (predicate.kind) {
+    case SeedPredicate::Kind::ReachTile:
+        return "reach:" + std::to_string(predicate.tile);
+    case SeedPredicate::Kind::Opening: {
+        std::string text = "opening:";
+        for (std::size_t i = 0; i < predicate.opening.size(); ++i) {
+            text += i == 0U ? "" : ",";
+            text += predicate.opening[i] < 0 ? "*" : std::to_string(predicate.opening[i]);
+        }
+        return text;
+    }
+    case SeedPredicate::Kind::MaxScore:
+        break;
+    }
+    return "max-score";
+}
+
+bool runSeedSearch(const SeedSearchConfig &config, const std::atomic<bool> &cancel,
+                   SeedSearchResult &result, std::string &error,
+                   const SeedSearchProgress &progress) {
+    if (config.predicate.kind != SeedPredicate::Kind::Opening &&
+        makePolicy(config.policy, 0U) == nullptr) {
+        error = "unknown policy: " + config.policy;
+        return false;
+    }
+    if (config.blockSize == 0U || config.seeds.begin > config.seeds.end ||
+        config.seeds.end > (std::uint64_t{1} << 32U)) {
+        error = "invalid seed range or block size";
+        return false;
+    }
+    if (config.resume && config.checkpointPath.empty()) {
+        error = "resume needs a checkpoint file";
+        return false;
+    }
+
+    std::vector<SeedRange> remaining;
+    std::vector<SeedMatch> matches;
+    std::uint64_t searched = 0;
+    if (config.resume) {
+        if (!readCheckpoint(config, remaining, matches, searched, error)) {
+            return false;
+        }
+        remaining = coalesce(std::move(remaining));
+    } else if (rangeSize(config.seeds) > 0U) {
+        remaining.push_back(config.seeds);
+    }
+
+    const bool keepsBest = config.predicate.kind == SeedPredicate::Kind::MaxScore;
+    const auto limitReached = [&] {
+        return !keepsBest && config.limit != 0U && matches.size() >= config.limit;
+    };
+
+    std::uint64_t remainingSeeds = 0;
+    for (const auto &range : remaining) {
+        remainingSeeds += rangeSize(range);
+    }
+    const std::size_t threadCount = static_cast<std::size_t>(
+        std::clamp<std::uint64_t>((remainingSeeds + config.blockSize - 1U) / config.blockSize, 1U,
+                                  resolveThreadCount(config.threads)));
+
+    std::vector<WorkerQueue> queues(threadCount);
+    distribute(remaining, queues);
+
+    // Guards `matches`, `searched`, `activeWorkers`, block completion and steals. Taken before
+    // any queue mutex, so a snapshot under it sees every unfinished block either queued or in
+    // flight, and never a range halfway between two queues.
+    std::mutex stateMutex;
+    std::condition_variable stateChanged;
+    std::size_t activeWorkers = threadCount;
+    std::atomic<bool> stop{limitReached()};
+
+    const auto worker = [&](const std::size_t self) {
+        std::vector<SeedMatch> found;
+        while (!cancel.load(std::memory_order_relaxed) && !stop.load(std::memory_order_relaxed)) {
+            const auto block = nextBlock(queues, self, config.blockSize, stateMutex);
+            if (!block.has_value()) {
+                break;
+            }
+
+            found.clear();
+            bool finished = true;
+            for (std::uint64_t seed = block->begin; seed < block->end; ++seed) {
+                if (cancel.load(std::memory_order_relaxed) ||
+                    stop.load(std::memory_order_relaxed)) {
+                    finished = false;
+                    break;
+                }
+                const auto seed32 = static_cast<std::uint32_t>(seed);
+                if (const auto outcome = evaluateSeed(config, seed32)) {
+                    found.push_back({seed32, *outcome});
+                }
+            }
+
+            const std::lock_guard<std::mutex> stateLock(stateMutex);
+            const std::lock_guard<std::mutex> queueLock(queues[self].mutex);
+            queues[self].inFlight.reset();
+            if (!finished) {
+                queues[self].ranges.push_front(*block);
+                break;
+            }
+            matches.insert(matches.end(), found.begin(), found.end());
+            searched += rangeSize(*block);
+            if (limitReached()) {
+                stop.store(true, std::memory_order_relaxed);
+                orderMatches(config, matches);
+            } else if (keepsBest && matches.size() > 2U * topCount(config)) {
+                orderMatches(config, matches);
+            }
+        }
+
+        {
+            const std::lock_guard<std::mutex> lock(stateMutex);
+            --activeWorkers;
+        }
+        stateChanged.notify_one();
+    };
+
+    // Caller holds `stateMutex`.
+    const auto snapshotRemaining = [&] {
+        std::vector<SeedRange> ranges;
+        for (auto &queue : queues) {
+            const std::lock_guard<std::mutex> lock(queue.mutex);
+            ranges.insert(ranges.end(), queue.ranges.begin(), queue.ranges.end());
+            if (queue.inFlight.has_value()) {
+                ranges.push_back(*queue.inFlight);
+            }
+        }
+        return coalesce(std::move(ranges));
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(worker, i);
+    }
+
+    const std::uint64_t total = rangeSize(config.seeds);
+    const bool checkpoints = !config.checkpointPath.empty();
+    auto nextProgress = std::chrono::steady_clock::now() + kProgressInterval;
+    auto nextCheckpoint = std::chrono::steady_clock::now() + config.checkpointInterval;
+    bool checkpointOk = true;
+    {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        while (activeWorkers > 0U) {
+            // Without a callback or checkpoints only a finishing worker wakes the coordinator.
+            if (progress && checkpoints) {
+                stateChanged.wait_until(lock, std::min(nextProgress, nextCheckpoint));
+            } else if (progress) {
+                stateChanged.wait_until(lock, nextProgress);
+            } else if (checkpoints) {
+                stateChanged.wait_until(lock, nextCheckpoint);
+            } else {
+                stateChanged.wait(lock);
+            }
+
+            if (progress && std::chrono::steady_clock::now() >= nextProgress) {
+                const std::uint64_t done = searched;
+                lock.unlock();
+                progress(done, total);
+                nextProgress = std::chrono::steady_clock::now() + kProgressInterval;
+                lock.lock();
+            }
+
+            if (checkpoints && std::chrono::steady_clock::now() >= nextCheckpoint) {
+                const auto ranges = snapshotRemaining();
+                const auto found = matches;
+                const std::uint64_t done = searched;
+                lock.unlock();
+                checkpointOk = writeCheckpoint(config, ranges, found, done, error) && checkpointOk;
+                nextCheckpoint = std::chrono::steady_clock::now() + config.checkpointInterval;
+                lock.lock();
+            }
+        }
+    }
+
+    for (auto &thread : workers) {
+        thread.join();
+    }
+
+    const auto ranges = snapshotRemaining();
+    orderMatches(config, matches);
+    if (!config.checkpointPath.empty()) {
+        checkpointOk = writeCheckpoint(config, ranges, matches, searched, error) && checkpointOk;
+    }
+
+    result.matches = std::move(matches);
+    result.searched = searched;
+    result.total = total;
+    result.completed = ranges.empty();
+    return checkpointOk;
+}
+
+} // namespace sim2048
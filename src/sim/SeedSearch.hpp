@@ -0,0 +1,82 @@
+#pragma once
+
+#include "sim/Simulation.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sim2048 {
+
+// What a seed has to satisfy:
+//   reach:<tile>   the policy merges `tile` within `maxMoves` moves
+//   opening:<16>   the board after `Game(seed)` matches 16 comma-separated cells, row by row;
+//                  `*` matches any value
+//   max-score      keep the `limit` seeds with the highest final score
+struct SeedPredicate {
+    enum class Kind { ReachTile, Opening, MaxScore };
+
+    Kind kind{Kind::MaxScore};
+    int tile{0};
+    // -1 is a wildcard.
+    std::array<int, 16> opening{};
+};
+
+bool parseSeedPredicate(std::string_view text, SeedPredicate &predicate, std::string &error);
+
+// Canonical text form; `parseSeedPredicate` accepts it back.
+std::string describeSeedPredicate(const SeedPredicate &predicate);
+
+struct SeedSearchConfig {
+    SeedPredicate predicate;
+    std::string policy{"greedy"};
+    SeedRange seeds{0, std::uint64_t{1} << 32U};
+    int maxMoves{100000};
+    // 0 uses every hardware thread.
+    unsigned int threads{0};
+    std::uint32_t blockSize{4096};
+    // reach/opening: stop once this many seeds matched and keep the lowest of them
+    // (0 = search everything).
+    // max-score: number of best seeds to keep (0 = 10).
+    std::size_t limit{0};
+    // Empty disables checkpoints. With `resume`, remaining work and matches are read from it.
+    std::filesystem::path checkpointPath;
+    bool resume{false};
+    std::chrono::milliseconds checkpointInterval{std::chrono::seconds(60)};
+};
+
+struct SeedMatch {
+    std::uint32_t seed{0};
+    GameOutcome outcome;
+};
+
+struct SeedSearchResult {
+    // Sorted by seed, or by descending score for max-score.
+    std::vector<SeedMatch> matches;
+    std::uint64_t searched{0};
+    std::uint64_t total{0};
+    // True when every seed in the range was checked.
+    bool completed{false};
+};
+
+// Called from the calling thread about once a second with (searched, total) seed counts.
+using SeedSearchProgress = std::function<void(std::uint64_t, std::uint64_t)>;
+
+// Searches `config.seeds` on a pool of worker threads. Each worker owns a queue of seed ranges
+// and takes `blockSize` seeds at a time from its front; a worker that runs dry steals half of
+// the last range of another worker. Setting `cancel` stops the workers between seeds; blocks
+// that did not finish stay in the remaining work. The checkpoint (remaining ranges plus the
+// matches of finished blocks) is rewritten every `checkpointInterval` and when the search ends,
+// so a cancelled or killed run resumes where the last checkpoint left off.
+bool runSeedSearch(const SeedSearchConfig &config, const std::atomic<bool> &cancel,
+                   SeedSearchResult &result, std::string &error,
+                   const SeedSearchProgress &progress = {});
+
+} // namespace sim2048
@@ -0,0 +1,467 @@
+#include "sim/ShardFile.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include <system_error>
+
+namespace sim2048 {
+
+namespace {
+
+constexpr std::array<char, 4> kMagic = {'S', '2', 'S', 'R'};
+constexpr std::array<char, 4> kEndMagic = {'S', '2', 'S', 'E'};
+constexpr std::uint32_t kVersion = 2;
+constexpr std::size_t kTrailerSize = 2U * sizeof(std::uint64_t) + kEndMagic.size();
+constexpr std::size_t kWriteBufferSize = 64U * 1024U;
+constexpr std::uint32_t kMaxPolicyLength = 256;
+constexpr std::uint32_t kMaxSeedRanges = 1U << 20U;
+constexpr std::uint64_t kSeedSpace = std::uint64_t{1} << 32U;
+
+template <typename T> void appendLittleEndian(std::vector<char> &out, const T value) {
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<char>((value >> (8U * i)) & 0xFFU));
+    }
+}
+
+void appendVarint(std::vector<char> &out, std::uint64_t value) {
+    while (value >= 0x80U) {
+        out.push_back(static_cast<char>((value & 0x7FU) | 0x80U));
+        value >>= 7U;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+template <typename T> bool readLittleEndian(std::istream &in, T &value) {
+    std::array<unsigned char, sizeof(T)> bytes{};
+    if (!in.read(reinterpret_cast<char *>(bytes.data()), bytes.size())) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        value |= static_cast<T>(static_cast<T>(bytes[i]) << (8U * i));
+    }
+    return true;
+}
+
+// Reads one varint, counting consumed bytes into `position`.
+bool readVarint(std::istream &in, std::uint64_t &value, std::uint64_t &position) {
+    value = 0;
+    for (unsigned int shift = 0; shift < 64U; shift += 7U) {
+        const int byte = in.get();
+        if (byte == std::char_traits<char>::eof()) {
+            return false;
+        }
+        ++position;
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool readMagic(std::istream &in, const std::array<char, 4> &magic) {
+    std::array<char, 4> bytes{};
+    return in.read(bytes.data(), bytes.size()) && bytes == magic;
+}
+
+// Ranges are stored ascending, disjoint, non-empty and inside the 32-bit seed space.
+bool validSeedRanges(const std::vector<SeedRange> &ranges) {
+    std::uint64_t previousEnd = 0;
+    for (const auto &range : ranges) {
+        if (range.begin >= range.end || range.begin < previousEnd || range.end > kSeedSpace) {
+            return false;
+        }
+        previousEnd = range.end;
+    }
+    return ranges.size() <= kMaxSeedRanges;
+}
+
+bool containsSeed(const std::vector<SeedRange> &ranges, const std::uint64_t seed) {
+    const auto after = std::upper_bound(
+        ranges.begin(), ranges.end(), seed,
+        [](const std::uint64_t value, const SeedRange &range) { return value < range.begin; });
+    return after != ranges.begin() && seed < std::prev(after)->end;
+}
+
+std::uint64_t seedTotal(const std::vector<SeedRange> &ranges) {
+    std::uint64_t total = 0;
+    for (const auto &range : ranges) {
+        total += range.end - range.begin;
+    }
+    return total;
+}
+
+std::string describeSeeds(const std::uint64_t first, const std::uint64_t end) {
+    return end - first == 1U ? "seed " + std::to_string(first)
+                             : "seeds " + std::to_string(first) + ".." + std::to_string(end - 1U);
+}
+
+bool toInt(const std::uint64_t value, int &out) {
+    if (value > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+        return false;
+    }
+    out = static_cast<int>(value);
+    return true;
+}
+
+} // namespace
+
+ShardWriter::~ShardWriter() {
+    if (out_.is_open()) {
+        out_.close();
+        std::error_code ec;
+        std::filesystem::remove(tempPath_, ec);
+    }
+}
+
+bool ShardWriter::open(const std::filesystem::path &path, const ShardInfo &info,
+                       std::string &error) {
+    if (info.policy.size() > kMaxPolicyLength) {
+        error = "policy name too long";
+        return false;
+    }
+    if (!validSeedRanges(info.seeds)) {
+        error = "invalid shard seed ranges";
+        return false;
+    }
+
+    path_ = path;
+    tempPath_ = path;
+    tempPath_ += ".tmp";
+    out_.open(tempPath_, std::ios::binary | std::ios::trunc);
+    if (!out_.is_open()) {
+        error = "cannot open " + tempPath_.string();
+        return false;
+    }
+
+    buffer_.clear();
+    buffer_.reserve(kWriteBufferSize);
+    buffer_.insert(buffer_.end(), kMagic.begin(), kMagic.end());
+    appendLittleEndian(buffer_, kVersion);
+    appendLittleEndian(buffer_, static_cast<std::uint32_t>(info.maxMoves));
+    appendLittleEndian(buffer_, static_cast<std::uint32_t>(info.policy.size()));
+    buffer_.insert(buffer_.end(), info.policy.begin(), info.policy.end());
+    appendLittleEndian(buffer_, static_cast<std::uint32_t>(info.seeds.size()));
+    for (const auto &range : info.seeds) {
+        appendLittleEndian(buffer_, range.begin);
+        appendLittleEndian(buffer_, range.end);
+    }
+
+    written_ = 0;
+    recordsOffset_ = buffer_.size();
+    accumulator_ = {};
+    return true;
+}
+
+void ShardWriter::add(const std::uint32_t seed, const GameOutcome &outcome) {
+    appendVarint(buffer_, seed);
+    appendVarint(buffer_, static_cast<std::uint64_t>(outcome.score));
+    appendVarint(buffer_, static_cast<std::uint64_t>(outcome.moves));
+    buffer_.push_back(static_cast<char>(tileExponent(outcome.maxTile)));
+    accumulator_.add(outcome);
+
+    if (buffer_.size() >= kWriteBufferSize) {
+        flushBuffer();
+    }
+}
+
+bool ShardWriter::finish(std::string &error) {
+    const std::uint64_t summaryOffset = written_ + buffer_.size();
+
+    appendVarint(buffer_, accumulator_.games());
+    appendVarint(buffer_, accumulator_.totalScore());
+    appendVarint(buffer_, accumulator_.totalMoves());
+    for (const auto count : accumulator_.maxTileCounts()) {
+        appendVarint(buffer_, count);
+    }
+    appendVarint(buffer_, accumulator_.scoreCounts().size());
+    int previousScore = 0;
+    for (const auto &[score, count] : accumulator_.scoreCounts()) {
+        appendVarint(buffer_, static_cast<std::uint64_t>(score - previousScore));
+        appendVarint(buffer_, count);
+        previousScore = score;
+    }
+
+    appendLittleEndian(buffer_, recordsOffset_);
+    appendLittleEndian(buffer_, summaryOffset);
+    buffer_.insert(buffer_.end(), kEndMagic.begin(), kEndMagic.end());
+    flushBuffer();
+
+    out_.close();
+    if (!out_) {
+        error = "cannot write " + tempPath_.string();
+        std::error_code ec;
+        std::filesystem::remove(tempPath_, ec);
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath_, path_, ec);
+    if (ec) {
+        error = "cannot rename " + tempPath_.string() + ": " + ec.message();
+        std::filesystem::remove(tempPath_, ec);
+        return false;
+    }
+    return true;
+}
+
+void ShardWriter::flushBuffer() {
+    out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    written_ += buffer_.size();
+    buffer_.clear();
+}
+
+bool ShardReader::open(const std::filesystem::path &path, std::string &error) {
+    name_ = path.string();
+    const std::string &name = name_;
+    in_.open(path, std::ios::binary);
+    if (!in_.is_open()) {
+        error = "cannot open " + name;
+        return false;
+    }
+
+    std::uint32_t version = 0;
+    std::uint32_t maxMoves = 0;
+    std::uint32_t policyLength = 0;
+    if (!readMagic(in_, kMagic) || !readLittleEndian(in_, version) ||
+        !readLittleEndian(in_, maxMoves) || !readLittleEndian(in_, policyLength) ||
+        policyLength > kMaxPolicyLength) {
+        error = name + ": not a shard file";
+        return false;
+    }
+    if (version != kVersion) {
+        error = name + ": unsupported shard version " + std::to_string(version);
+        return false;
+    }
+    info_.policy.assign(policyLength, '\0');
+    std::uint32_t rangeCount = 0;
+    if (!in_.read(info_.policy.data(), policyLength) || !toInt(maxMoves, info_.maxMoves) ||
+        !readLittleEndian(in_, rangeCount) || rangeCount > kMaxSeedRanges) {
+        error = name + ": not a shard file";
+        return false;
+    }
+    info_.seeds.assign(rangeCount, {});
+    for (auto &range : info_.seeds) {
+        if (!readLittleEndian(in_, range.begin) || !readLittleEndian(in_, range.end)) {
+            error = name + ": not a shard file";
+            return false;
+        }
+    }
+    if (!validSeedRanges(info_.seeds)) {
+        error = name + ": corrupt shard seed ranges";
+        return false;
+    }
+    const std::uint64_t headerSize =
+        5U * sizeof(std::uint32_t) + policyLength +
+        std::uint64_t{rangeCount} * 2U * sizeof(std::uint64_t);
+
+    std::uint64_t recordsOffset = 0;
+    in_.seekg(-static_cast<std::streamoff>(kTrailerSize), std::ios::end);
+    const auto trailerOffset = static_cast<std::uint64_t>(in_.tellg());
+    if (!in_ || !readLittleEndian(in_, recordsOffset) || !readLittleEndian(in_, summaryOffset_) ||
+        !readMagic(in_, kEndMagic) || recordsOffset != headerSize ||
+        recordsOffset > summaryOffset_ || summaryOffset_ > trailerOffset) {
+        error = name + ": incomplete shard (no trailer)";
+        return false;
+    }
+
+    // Footer first, so the summary is known before any record is read.
+    summary_ = {};
+    std::uint64_t position = summaryOffset_;
+    in_.seekg(static_cast<std::streamoff>(summaryOffset_));
+    std::uint64_t games = 0;
+    std::uint64_t totalScore = 0;
+    std::uint64_t totalMoves = 0;
+    std::uint64_t distinctScores = 0;
+    bool ok = readVarint(in_, games, position) && readVarint(in_, totalScore, position) &&
+              readVarint(in_, totalMoves, position);
+    summary_.addCounts(games, totalScore, totalMoves);
+    for (std::size_t exponent = 0; ok && exponent < OutcomeAccumulator::kTileExponentCount;
+         ++exponent) {
+        std::uint64_t count = 0;
+        ok = readVarint(in_, count, position);
+        summary_.addMaxTileCount(exponent, count);
+    }
+    ok = ok && readVarint(in_, distinctScores, position);
+    std::uint64_t score = 0;
+    for (std::uint64_t i = 0; ok && i < distinctScores; ++i) {
+        std::uint64_t delta = 0;
+        std::uint64_t count = 0;
+        int value = 0;
+        ok = readVarint(in_, delta, position) && readVarint(in_, count, position) &&
+             toInt(score += delta, value);
+        summary_.addScoreCount(value, count);
+    }
+    if (!ok || position != trailerOffset) {
+        error = name + ": corrupt shard summary";
+        return false;
+    }
+    if (games != seedTotal(info_.seeds)) {
+        error = name + ": summary holds " + std::to_string(games) + " games for " +
+                std::to_string(seedTotal(info_.seeds)) + " seeds";
+        return false;
+    }
+
+    in_.seekg(static_cast<std::streamoff>(recordsOffset));
+    position_ = recordsOffset;
+    return true;
+}
+
+const ShardInfo &ShardReader::info() const noexcept {
+    return info_;
+}
+
+const OutcomeAccumulator &ShardReader::summary() const noexcept {
+    return summary_;
+}
+
+bool ShardReader::next(ShardRecord &record, std::string &error) {
+    if (position_ >= summaryOffset_) {
+        return false;
+    }
+
+    std::uint64_t seed = 0;
+    std::uint64_t score = 0;
+    std::uint64_t moves = 0;
+    bool ok = readVarint(in_, seed, position_) && readVarint(in_, score, position_) &&
+              readVarint(in_, moves, position_);
+    const int exponent = ok ? in_.get() : std::char_traits<char>::eof();
+    ++position_;
+    ok = ok && containsSeed(info_.seeds, seed) &&
+         toInt(score, record.outcome.score) && toInt(moves, record.outcome.moves) &&
+         exponent != std::char_traits<char>::eof() &&
+         static_cast<std::size_t>(exponent) < OutcomeAccumulator::kTileExponentCount &&
+         position_ <= summaryOffset_;
+    if (!ok) {
+        error = name_ + ": corrupt shard record";
+        return false;
+    }
+
+    record.seed = static_cast<std::uint32_t>(seed);
+    record.outcome.maxTile = exponent == 0 ? 0 : 1 << exponent;
+    return true;
+}
+
+bool simulateShard(const std::string &policy, const std::uint32_t firstSeed,
+                   const std::uint32_t seedCount, const int maxMoves,
+                   const std::filesystem::path &output, std::string &error) {
+    if (makePolicy(policy, 0U) == nullptr) {
+        error = "unknown policy: " + policy;
+        return false;
+    }
+
+    const SeedRange seeds{firstSeed, std::uint64_t{firstSeed} + seedCount};
+    if (seeds.end > kSeedSpace) {
+        error = "seed range " + std::to_string(firstSeed) + " + " + std::to_string(seedCount) +
+                " exceeds 32-bit seeds";
+        return false;
+    }
+
+    ShardInfo info{policy, maxMoves, {}};
+    if (seedCount != 0U) {
+        info.seeds.push_back(seeds);
+    }
+    ShardWriter writer;
+    if (!writer.open(output, info, error)) {
+        return false;
+    }
+    for (std::uint32_t i = 0; i < seedCount; ++i) {
+        const std::uint32_t seed = firstSeed + i;
+        const auto bot = makePolicy(policy, seed);
+        writer.add(seed, playGame(*bot, seed, maxMoves));
+    }
+    return writer.finish(error);
+}
+
+bool mergeShardFiles(const std::vector<std::filesystem::path> &inputs,
+                     const std::filesystem::path &output, ShardInfo &info,
+                     OutcomeAccumulator &merged, std::string &error) {
+    if (inputs.empty()) {
+        error = "no shard files given";
+        return false;
+    }
+
+    // Headers and footers first, so overlapping shards are rejected before any record is
+    // copied and the output header can list the union of the input seeds.
+    struct InputRange {
+        SeedRange range;
+        std::size_t input{0};
+    };
+    std::vector<InputRange> ranges;
+    merged = {};
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        ShardReader reader;
+        if (!reader.open(inputs[i], error)) {
+            return false;
+        }
+        if (i == 0U) {
+            info = {reader.info().policy, reader.info().maxMoves, {}};
+        } else if (reader.info().policy != info.policy ||
+                   reader.info().maxMoves != info.maxMoves) {
+            error = inputs[i].string() + ": shard of " + reader.info().policy + " with max moves " +
+                    std::to_string(reader.info().maxMoves) + " cannot be merged with " +
+                    info.policy + " with max moves " + std::to_string(info.maxMoves);
+            return false;
+        }
+        for (const auto &range : reader.info().seeds) {
+            ranges.push_back({range, i});
+        }
+        merged.merge(reader.summary());
+    }
+
+    std::sort(ranges.begin(), ranges.end(), [](const InputRange &a, const InputRange &b) {
+        return a.range.begin < b.range.begin;
+    });
+    std::size_t lastInput = 0;
+    for (const auto &[range, input] : ranges) {
+        if (!info.seeds.empty()) {
+            auto &last = info.seeds.back();
+            if (range.begin < last.end) {
+                error = inputs[input].string() + ": " +
+                        describeSeeds(range.begin, std::min(range.end, last.end)) +
+                        " already in " + inputs[lastInput].string();
+                return false;
+            }
+            if (range.begin == last.end) {
+                last.end = range.end;
+                lastInput = input;
+                continue;
+            }
+        }
+        info.seeds.push_back(range);
+        lastInput = input;
+    }
+
+    if (output.empty()) {
+        return true;
+    }
+    ShardWriter writer;
+    if (!writer.open(output, info, error)) {
+        return false;
+    }
+    for (const auto &input : inputs) {
+        ShardReader reader;
+        if (!reader.open(input, error)) {
+            return false;
+        }
+        OutcomeAccumulator replayed;
+        ShardRecord record;
+        while (reader.next(record, error)) {
+            writer.add(record.seed, record.outcome);
+            replayed.add(record.outcome);
+        }
+        if (!error.empty()) {
+            return false;
+        }
+        if (!(replayed == reader.summary())) {
+            error = input.string() + ": records do not match the shard summary";
+            return false;
+        }
+    }
+    return writer.finish(error);
+}
+
+} // namespace sim2048
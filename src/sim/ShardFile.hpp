@@ -0,0 +1,98 @@
+#pragma once
+
+#include "sim/Simulation.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace sim2048 {
+
+// Partial result of a sharded simulation: the games one process played plus their exact
+// summary, so shards can be merged without replaying or re-reading every record.
+//
+// Layout (little-endian, varints are unsigned LEB128):
+//   header  : magic "S2SR", u32 version, u32 max moves, u32 policy length, policy bytes,
+//             u32 seed range count, then (u64 begin, u64 end) per range, ascending and disjoint
+//   records : per game varint seed, varint score, varint moves, u8 max-tile exponent
+//   summary : varint games, total score, total moves, 18 max-tile counts,
+//             varint distinct scores, then (varint score delta, varint count) ascending
+//   trailer : u64 records offset, u64 summary offset, magic "S2SE"
+// `seeds` lists the seeds whose games the shard holds, so a merge can tell two copies of the
+// same shard from two halves of a run.
+struct ShardInfo {
+    std::string policy;
+    int maxMoves{0};
+    std::vector<SeedRange> seeds;
+};
+
+struct ShardRecord {
+    std::uint32_t seed{0};
+    GameOutcome outcome;
+};
+
+// Writes a shard to a temporary sibling file; `finish` appends the summary and renames it
+// over `path`, so a crashed or killed process never leaves a shard that looks complete.
+class ShardWriter {
+  public:
+    ShardWriter() = default;
+    ShardWriter(const ShardWriter &) = delete;
+    ShardWriter &operator=(const ShardWriter &) = delete;
+    ~ShardWriter();
+
+    bool open(const std::filesystem::path &path, const ShardInfo &info, std::string &error);
+    void add(std::uint32_t seed, const GameOutcome &outcome);
+    bool finish(std::string &error);
+
+  private:
+    void flushBuffer();
+
+    std::filesystem::path path_;
+    std::filesystem::path tempPath_;
+    std::ofstream out_;
+    std::vector<char> buffer_;
+    std::uint64_t written_{0};
+    std::uint64_t recordsOffset_{0};
+    OutcomeAccumulator accumulator_;
+};
+
+// Opens a shard by its trailer: `info` and `summary` are available immediately, records are
+// streamed with `next` without loading the file.
+class ShardReader {
+  public:
+    bool open(const std::filesystem::path &path, std::string &error);
+
+    const ShardInfo &info() const noexcept;
+    const OutcomeAccumulator &summary() const noexcept;
+
+    // Returns false at the end of the records or on a malformed record (`error` is set then).
+    bool next(ShardRecord &record, std::string &error);
+
+  private:
+    std::string name_;
+    std::ifstream in_;
+    std::uint64_t summaryOffset_{0};
+    std::uint64_t position_{0};
+    ShardInfo info_;
+    OutcomeAccumulator summary_;
+};
+
+// Plays `seedCount` games from `firstSeed` with one policy and writes them as a shard. The range
+// must fit in 32-bit seeds (firstSeed + seedCount <= 2^32).
+bool simulateShard(const std::string &policy, std::uint32_t firstSeed, std::uint32_t seedCount,
+                   int maxMoves, const std::filesystem::path &output, std::string &error);
+
+// Merges shards of the same policy and move cap in one streaming pass. Summaries are combined
+// from the shard footers; when `output` is non-empty every record is streamed into a new shard,
+// which can itself be merged again, and each input's records are checked against its footer.
+// Shards whose seed ranges overlap (including the same file given twice) are rejected, since
+// their games would be counted twice. Merging is associative, so the summary does not depend on
+// how the games were split or grouped.
+bool mergeShardFiles(const std::vector<std::filesystem::path> &inputs,
+                     const std::filesystem::path &output, ShardInfo &info,
+                     OutcomeAccumulator &merged, std::string &error);
+
+} // namespace sim2048
@@ -0,0 +1,157 @@
+#include "sim/Simulation.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace sim2048 {
+
+namespace {
+
+int maxTileOf(const core2048::Game::Grid &grid) {
+    int maxTile = 0;
+    for (const auto &row : grid) {
+        for (const int value : row) {
+            maxTile = std::max(maxTile, value);
+        }
+    }
+    return maxTile;
+}
+
+} // namespace
+
+GameOutcome playGame(MovePolicy &policy, const std::uint32_t seed, const int maxMoves,
+                     const int stopAtTile) {
+    core2048::Game game(seed);
+    GameOutcome outcome;
+
+    while (outcome.moves < maxMoves) {
+        const auto direction = policy.chooseMove(game.getGrid());
+        if (!direction.has_value()) {
+            break;
+        }
+        const auto result = game.applyMove(*direction);
+        ++outcome.moves;
+        if (stopAtTile > 0 && result.maxMergedValue >= stopAtTile) {
+            break;
+        }
+    }
+
+    outcome.score = game.getScore();
+    outcome.maxTile = maxTileOf(game.getGrid());
+    return outcome;
+}
+
+void OutcomeAccumulator::add(const GameOutcome &outcome) {
+    addCounts(1U, static_cast<std::uint64_t>(outcome.score),
+              static_cast<std::uint64_t>(outcome.moves));
+    addMaxTileCount(tileExponent(outcome.maxTile), 1U);
+    addScoreCount(outcome.score, 1U);
+}
+
+void OutcomeAccumulator::merge(const OutcomeAccumulator &other) {
+    addCounts(other.games_, other.totalScore_, other.totalMoves_);
+    for (std::size_t exponent = 0; exponent < kTileExponentCount; ++exponent) {
+        maxTileCounts_[exponent] += other.maxTileCounts_[exponent];
+    }
+    for (const auto &[score, count] : other.scoreCounts_) {
+        scoreCounts_[score] += count;
+    }
+}
+
+OutcomeSummary OutcomeAccumulator::summary() const {
+    OutcomeSummary summary;
+    summary.games = games_;
+    if (games_ == 0U) {
+        return summary;
+    }
+
+    const auto games = static_cast<double>(games_);
+    const auto rankedScore = [&](const std::uint64_t percent) {
+        // Nearest rank: ceil(p / 100 * n), at least 1.
+        const std::uint64_t rank = std::max<std::uint64_t>((percent * games_ + 99U) / 100U, 1U);
+        std::uint64_t seen = 0;
+        for (const auto &[score, count] : scoreCounts_) {
+            seen += count;
+            if (seen >= rank) {
+                return score;
+            }
+        }
+        return scoreCounts_.rbegin()->first;
+    };
+    const auto reachRate = [&](const std::size_t minExponent) {
+        std::uint64_t reached = 0;
+        for (std::size_t exponent = minExponent; exponent < kTileExponentCount; ++exponent) {
+            reached += maxTileCounts_[exponent];
+        }
+        return static_cast<double>(reached) / games;
+    };
+
+    summary.meanScore = static_cast<double>(totalScore_) / games;
+    summary.medianScore = rankedScore(50U);
+    summary.p99Score = rankedScore(99U);
+    summary.bestScore = scoreCounts_.rbegin()->first;
+    summary.reach2048 = reachRate(11U);
+    summary.reach4096 = reachRate(12U);
+    summary.reach8192 = reachRate(13U);
+    return summary;
+}
+
+std::uint64_t OutcomeAccumulator::games() const noexcept {
+    return games_;
+}
+
+std::uint64_t OutcomeAccumulator::totalScore() const noexcept {
+    return totalScore_;
+}
+
+std::uint64_t OutcomeAccumulator::totalMoves() const noexcept {
+    return totalMoves_;
+}
+
+const std::array<std::uint64_t, OutcomeAccumulator::kTileExponentCount> &
+OutcomeAccumulator::maxTileCounts() const noexcept {
+    return maxTileCounts_;
+}
+
+const std::map<int, std::uint64_t> &OutcomeAccumulator::scoreCounts() const noexcept {
+    return scoreCounts_;
+}
+
+void OutcomeAccumulator::addCounts(const std::uint64_t games, const std::uint64_t totalScore,
+                                   const std::uint64_t totalMoves) {
+    games_ += games;
+    totalScore_ += totalScore;
+    totalMoves_ += totalMoves;
+}
+
+void OutcomeAccumulator::addMaxTileCount(const std::size_t exponent, const std::uint64_t count) {
+    maxTileCounts_[std::min(exponent, kTileExponentCount - 1U)] += count;
+}
+
+void OutcomeAccumulator::addScoreCount(const int score, const std::uint64_t count) {
+    if (count != 0U) {
+        scoreCounts_[score] += count;
+    }
+}
+
+std::size_t tileExponent(const int tileValue) noexcept {
+    std::size_t exponent = 0;
+    for (int value = tileValue; value > 1; value >>= 1) {
+        ++exponent;
+    }
+    return std::min(exponent, OutcomeAccumulator::kTileExponentCount - 1U);
+}
+
+OutcomeSummary summarizeOutcomes(const std::span<const GameOutcome> outcomes) {
+    OutcomeAccumulator accumulator;
+    for (const auto &outcome : outcomes) {
+        accumulator.add(outcome);
+    }
+    return accumulator.summary();
+}
+
+unsigned int resolveThreadCount(const unsigned int requested) noexcept {
+    return requested != 0U ? requested : std::max(1U, std::thread::hardware_concurrency());
+}
+
+} // namespace sim2048
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "sim/Policy.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <span>
+
+namespace sim2048 {
+
+struct GameOutcome {
+    int score{0};
+    int maxTile{0};
+    int moves{0};
+};
+
+// Half-open range of seeds; 64-bit so the whole 32-bit space fits as [0, 2^32).
+struct SeedRange {
+    std::uint64_t begin{0};
+    std::uint64_t end{0};
+
+    bool operator==(const SeedRange &other) const = default;
+};
+
+// Plays `Game(seed)` with `policy` until no move is legal or `maxMoves` moves were made, or
+// as soon as a merge produces `stopAtTile` (0 never stops early).
+GameOutcome playGame(MovePolicy &policy, std::uint32_t seed, int maxMoves, int stopAtTile = 0);
+
+struct OutcomeSummary {
+    std::uint64_t games{0};
+    double meanScore{0.0};
+    int medianScore{0};
+    int p99Score{0};
+    int bestScore{0};
+    double reach2048{0.0};
+    double reach4096{0.0};
+    double reach8192{0.0};
+};
+
+// Exact, order-independent tallies of many games: counters, a max-tile histogram by exponent
+// and a sparse histogram of exact scores. `merge` is associative and commutative, so partial
+// results from any split of the games combine into the same summary as one run over all of them.
+class OutcomeAccumulator {
+  public:
+    static constexpr std::size_t kTileExponentCount = 18;
+
+    void add(const GameOutcome &outcome);
+    void merge(const OutcomeAccumulator &other);
+
+    // Percentiles use the nearest-rank method, so every reported score is one that occurred.
+    OutcomeSummary summary() const;
+
+    std::uint64_t games() const noexcept;
+    std::uint64_t totalScore() const noexcept;
+    std::uint64_t totalMoves() const noexcept;
+    const std::array<std::uint64_t, kTileExponentCount> &maxTileCounts() const noexcept;
+    const std::map<int, std::uint64_t> &scoreCounts() const noexcept;
+
+    // Used when reading a serialized accumulator; `add` and `merge` keep these consistent.
+    void addCounts(std::uint64_t games, std::uint64_t totalScore, std::uint64_t totalMoves);
+    void addMaxTileCount(std::size_t exponent, std::uint64_t count);
+    void addScoreCount(int score, std::uint64_t count);
+
+    bool operator==(const OutcomeAccumulator &other) const = default;
+
+  private:
+    std::uint64_t games_{0};
+    std::uint64_t totalScore_{0};
+    std::uint64_t totalMoves_{0};
+    std::array<std::uint64_t, kTileExponentCount> maxTileCounts_{};
+    std::map<int, std::uint64_t> scoreCounts_;
+};
+
+// Exponent of a power-of-two tile (2048 -> 11), clamped to the accumulator's histogram.
+std::size_t tileExponent(int tileValue) noexcept;
+
+OutcomeSummary summarizeOutcomes(std::span<const GameOutcome> outcomes);
+
+// Worker count for a `--threads` style option: 0 means one per hardware thread (at least one).
+unsigned int resolveThreadCount(unsigned int requested) noexcept;
+
+} // namespace sim2048
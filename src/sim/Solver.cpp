@@ -0,0 +1,680 @@
+#include "sim/Solver.hpp"
+
+#include "sim/BoardKeys.hpp"
+#include "sim/Simulation.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <queue>
+#include <span>
+#include <system_error>
+#include <utility>
+
+namespace sim2048 {
+
+namespace {
+
+using core2048::Direction;
+using Json = nlohmann::json;
+
+constexpr int kManifestVersion = 1;
+constexpr double kFourProbability = 0.1;
+constexpr int kFirstTileSum = 4;
+// Children buffered per worker before they are sorted, deduplicated and appended to disk.
+constexpr std::size_t kFlushEntries = std::size_t{1} << 20U;
+constexpr std::array<Direction, 4> kDirections = {Direction::Up, Direction::Down, Direction::Left,
+                                                  Direction::Right};
+
+template <int Size> struct Board {
+    static constexpr int kCells = Size * Size;
+    using Game = core2048::BasicGame<Size>;
+    using Grid = typename Game::Grid;
+    // For each of the 8 symmetries: destination cell -> source cell.
+    using Symmetries = std::array<std::array<int, kCells>, 8>;
+
+    static const Symmetries &symmetries() {
+        static const Symmetries table = [] {
+            Symmetries result{};
+            constexpr int last = Size - 1;
+            for (int r = 0; r < Size; ++r) {
+                for (int c = 0; c < Size; ++c) {
+                    const std::array<std::pair<int, int>, 8> sources = {{
+                        {r, c},
+                        {c, r},
+                        {r, last - c},
+                        {last - r, c},
+                        {last - r, last - c},
+                        {c, last - r},
+                        {last - c, r},
+                        {last - c, last - r},
+                    }};
+                    for (std::size_t t = 0; t < sources.size(); ++t) {
+                        result[t][r * Size + c] = sources[t].first * Size + sources[t].second;
+                    }
+                }
+            }
+            return result;
+        }();
+        return table;
+    }
+
+    static int nibble(const std::uint64_t key, const int cell) {
+        return static_cast<int>((key >> (4 * cell)) & 0xFU);
+    }
+
+    // Smallest key among the 8 rotations and reflections; values are invariant under them.
+    static std::uint64_t canonical(const std::uint64_t key) {
+        std::uint64_t best = key;
+        for (const auto &mapping : symmetries()) {
+            std::uint64_t transformed = 0;
+            for (int cell = 0; cell < kCells; ++cell) {
+                transformed |= static_cast<std::uint64_t>(nibble(key, mapping[cell])) << (4 * cell);
+            }
+            best = std::min(best, transformed);
+        }
+        return best;
+    }
+};
+
+struct Manifest {
+    int size{0};
+    // Tile sum -> number of positions, for every layer whose states file is final.
+    std::map<int, std::uint64_t> layers;
+    // Highest tile sum whose children were written; 0 before the first expansion.
+    int expanded{0};
+    bool forwardDone{false};
+    // Lowest tile sum whose values file is final; 0 before the first valued layer.
+    int valuedFrom{0};
+    bool completed{false};
+    double expectedScore{0.0};
+};
+
+std::filesystem::path layerPath(const std::filesystem::path &directory, const char *kind,
+                                const int tileSum) {
+    return directory / (std::string(kind) + "-" + std::to_string(tileSum) + ".bin");
+}
+
+std::filesystem::path manifestPath(const std::filesystem::path &directory) {
+    return directory / "solver.json";
+}
+
+bool saveManifest(const std::filesystem::path &directory, const Manifest &manifest,
+                  std::string &error) {
+    Json layers = Json::object();
+    for (const auto &[tileSum, states] : manifest.layers) {
+        layers[std::to_string(tileSum)] = states;
+    }
+    const Json json = {{"version", kManifestVersion},    {"size", manifest.size},
+                       {"layers", layers},               {"expanded", manifest.expanded},
+                       {"forward_done", manifest.forwardDone},
+                       {"valued_from", manifest.valuedFrom},
+                       {"completed", manifest.completed},
+                       {"expected_score", manifest.expectedScore}};
+
+    const auto path = manifestPath(directory);
+    auto tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::trunc);
+        out << json.dump(2) << '\n';
+        if (!out) {
+            error = "cannot write " + tempPath.string();
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        error = "cannot rename " + tempPath.string() + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+// A missing manifest is a fresh start; one for another board size is an error.
+bool loadManifest(const std::filesystem::path &directory, const int size, Manifest &manifest,
+                  std::string &error) {
+    manifest = {};
+    manifest.size = size;
+    const auto path = manifestPath(directory);
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        return true;
+    }
+
+    const Json json = Json::parse(in, nullptr, false);
+    if (json.is_discarded() || !json.is_object() || json.value("version", 0) != kManifestVersion) {
+        error = path.string() + ": not a solver manifest";
+        return false;
+    }
+    if (json.value("size", 0) != size) {
+        error = path.string() + ": solve is for a different board size";
+        return false;
+    }
+
+    const Json layers = json.value("layers", Json::object());
+    for (const auto &[tileSum, states] : layers.items()) {
+        manifest.layers[std::stoi(tileSum)] = states.get<std::uint64_t>();
+    }
+    manifest.expanded = json.value("expanded", 0);
+    manifest.forwardDone = json.value("forward_done", false);
+    manifest.valuedFrom = json.value("valued_from", 0);
+    manifest.completed = json.value("completed", false);
+    manifest.expectedScore = json.value("expected_score", 0.0);
+    return true;
+}
+
+// Does not create the file for an empty batch: a pending file means the layer has positions.
+bool appendKeys(const std::filesystem::path &path, std::vector<std::uint64_t> &keys,
+                std::string &error) {
+    if (keys.empty()) {
+        return true;
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    out.write(reinterpret_cast<const char *>(keys.data()),
+              static_cast<std::streamsize>(keys.size() * sizeof(std::uint64_t)));
+    keys.clear();
+    if (!out) {
+        error = "cannot append to " + path.string();
+        return false;
+    }
+    return true;
+}
+
+// Worker `index` of `count` handles [begin, end) of `total` items.
+std::pair<std::size_t, std::size_t> chunkOf(const std::size_t index, const std::size_t count,
+                                            const std::size_t total) {
+    return {total * index / count, total * (index + 1U) / count};
+}
+
+// Sorts the pending children of a layer in parallel chunks and streams their deduplicated
+// k-way merge into the layer's states file. The pending file is left for the caller to remove
+// once the layer is recorded in the manifest.
+bool finalizeLayer(const std::filesystem::path &directory, const int tileSum,
+                   const std::size_t workerCount, std::uint64_t &states, std::string &error) {
+    const auto pendingPath = layerPath(directory, "pending", tileSum);
+    auto pending = MappedFile::openReadWrite(pendingPath, error);
+    if (!pending.has_value()) {
+        return false;
+    }
+
+    const auto keys = pending->as<std::uint64_t>();
+    std::vector<std::span<std::uint64_t>> runs(workerCount);
+    forEachWorker(workerCount, [&](const std::size_t worker) {
+        const auto [begin, end] = chunkOf(worker, workerCount, keys.size());
+        auto run = keys.subspan(begin, end - begin);
+        std::sort(run.begin(), run.end());
+        runs[worker] = run.first(static_cast<std::size_t>(
+            std::unique(run.begin(), run.end()) - run.begin()));
+    });
+
+    const auto statesPath = layerPath(directory, "states", tileSum);
+    auto tempPath = statesPath;
+    tempPath += ".tmp";
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+
+    using Head = std::pair<std::uint64_t, std::size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<>> heads;
+    std::vector<std::size_t> positions(runs.size(), 0U);
+    for (std::size_t run = 0; run < runs.size(); ++run) {
+        if (!runs[run].empty()) {
+            heads.emplace(runs[run][0], run);
+        }
+    }
+
+    std::vector<std::uint64_t> buffer;
+    buffer.reserve(kFlushEntries);
+    states = 0;
+    std::optional<std::uint64_t> previous;
+    while (!heads.empty()) {
+        const auto [key, run] = heads.top();
+        heads.pop();
+        if (++positions[run] < runs[run].size()) {
+            heads.emplace(runs[run][positions[run]], run);
+        }
+        if (previous == key) {
+            continue;
+        }
+        previous = key;
+        buffer.push_back(key);
+        ++states;
+        if (buffer.size() == kFlushEntries) {
+            out.write(reinterpret_cast<const char *>(buffer.data()),
+                      static_cast<std::streamsize>(buffer.size() * sizeof(std::uint64_t)));
+            buffer.clear();
+        }
+    }
+    out.write(reinterpret_cast<const char *>(buffer.data()),
+              static_cast<std::streamsize>(buffer.size() * sizeof(std::uint64_t)));
+    out.close();
+    pending.reset();
+
+    std::error_code ec;
+    if (!out) {
+        error = "cannot write " + tempPath.string();
+        return false;
+    }
+    std::filesystem::rename(tempPath, statesPath, ec);
+    if (ec) {
+        error = "cannot rename " + tempPath.string() + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+// Appends every child of the layer's positions (one move, one spawn) to the pending files of
+// the next two layers.
+template <int Size>
+bool expandLayer(const std::filesystem::path &directory, const int tileSum,
+                 const std::size_t workerCount, std::string &error) {
+    using B = Board<Size>;
+    auto statesFile = MappedFile::openReadOnly(layerPath(directory, "states", tileSum), error);
+    if (!statesFile.has_value()) {
+        return false;
+    }
+    const auto states = statesFile->template as<std::uint64_t>();
+
+    const std::array<std::filesystem::path, 2> targets = {
+        layerPath(directory, "pending", tileSum + 2), layerPath(directory, "pending", tileSum + 4)};
+    std::mutex appendMutex;
+    std::atomic<bool> failed{false};
+
+    forEachWorker(workerCount, [&](const std::size_t worker) {
+        std::array<std::vector<std::uint64_t>, 2> children;
+        std::string workerError;
+        const auto flush = [&](const std::size_t target) {
+            const std::lock_guard<std::mutex> lock(appendMutex);
+            if (!appendKeys(targets[target], children[target], workerError)) {
+                failed.store(true);
+                error = workerError;
+            }
+        };
+
+        const auto [begin, end] = chunkOf(worker, workerCount, states.size());
+        for (std::size_t i = begin; i < end && !failed.load(std::memory_order_relaxed); ++i) {
+            const auto grid = unpackBoardKey<typename B::Grid>(states[i]);
+            for (const Direction direction : kDirections) {
+                auto moved = grid;
+                if (!B::Game::slide(moved, direction).moved) {
+                    continue;
+                }
+                std::uint64_t base = 0;
+                if (!packBoardKey(moved, base)) {
+                    const std::lock_guard<std::mutex> lock(appendMutex);
+                    failed.store(true);
+                    error = "tile above 32768";
+                    return;
+                }
+                for (int cell = 0; cell < B::kCells; ++cell) {
+                    if (B::nibble(base, cell) != 0) {
+                        continue;
+                    }
+                    for (std::size_t target = 0; target < 2U; ++target) {
+                        const std::uint64_t exponent = target + 1U;
+                        children[target].push_back(
+                            B::canonical(base | (exponent << (4 * cell))));
+                        if (children[target].size() >= kFlushEntries) {
+                            flush(target);
+                        }
+                    }
+                }
+            }
+        }
+        flush(0);
+        flush(1);
+    });
+    return !failed.load();
+}
+
+struct LayerView {
+    std::optional<MappedFile> states;
+    std::optional<MappedFile> values;
+
+    std::optional<double> find(const std::uint64_t key) const {
+        if (!states.has_value() || !values.has_value()) {
+            return std::nullopt;
+        }
+        const auto keys = states->as<std::uint64_t>();
+        const auto it = std::lower_bound(keys.begin(), keys.end(), key);
+        if (it == keys.end() || *it != key) {
+            return std::nullopt;
+        }
+        return values->as<double>()[static_cast<std::size_t>(it - keys.begin())];
+    }
+};
+
+bool openLayerView(const std::filesystem::path &directory, const int tileSum, LayerView &view,
+                   std::string &error) {
+    view.states = MappedFile::openReadOnly(layerPath(directory, "states", tileSum), error);
+    view.values = MappedFile::openReadOnly(layerPath(directory, "values", tileSum), error);
+    return view.states.has_value() && view.values.has_value();
+}
+
+// Expected score after moving to `afterstate` (spawn not yet placed).
+template <int Size>
+std::optional<double> spawnExpectation(const std::uint64_t afterstate, const LayerView &plusTwo,
+                                       const LayerView &plusFour) {
+    using B = Board<Size>;
+    double total = 0.0;
+    int empty = 0;
+    for (int cell = 0; cell < B::kCells; ++cell) {
+        if (B::nibble(afterstate, cell) != 0) {
+            continue;
+        }
+        const int shift = 4 * cell;
+        const auto two = plusTwo.find(B::canonical(afterstate | (std::uint64_t{1} << shift)));
+        const auto four = plusFour.find(B::canonical(afterstate | (std::uint64_t{2} << shift)));
+        if (!two.has_value() || !four.has_value()) {
+            return std::nullopt;
+        }
+        total += (1.0 - kFourProbability) * *two + kFourProbability * *four;
+        ++empty;
+    }
+    return empty == 0 ? 0.0 : total / empty;
+}
+
+// Values one layer from the two above it: best move of score gained plus spawn expectation.
+template <int Size>
+bool valueLayer(const std::filesystem::path &directory, const int tileSum,
+                const std::size_t workerCount, std::string &error) {
+    using B = Board<Size>;
+    auto statesFile = MappedFile::openReadOnly(layerPath(directory, "states", tileSum), error);
+    if (!statesFile.has_value()) {
+        return false;
+    }
+    const auto states = statesFile->template as<std::uint64_t>();
+
+    // Layers past the last one are empty: their views stay unopened and every lookup fails,
+    // which is only reached if a position there was generated but never finalized.
+    LayerView plusTwo;
+    LayerView plusFour;
+    std::string ignored;
+    openLayerView(directory, tileSum + 2, plusTwo, ignored);
+    openLayerView(directory, tileSum + 4, plusFour, ignored);
+
+    const auto valuesPath = layerPath(directory, "values", tileSum);
+    auto tempPath = valuesPath;
+    tempPath += ".tmp";
+    {
+        auto valuesFile = MappedFile::create(tempPath, states.size() * sizeof(double), error);
+        if (!valuesFile.has_value()) {
+            return false;
+        }
+        const auto values = valuesFile->as<double>();
+
+        std::atomic<bool> missing{false};
+        forEachWorker(workerCount, [&](const std::size_t worker) {
+            const auto [begin, end] = chunkOf(worker, workerCount, states.size());
+            for (std::size_t i = begin; i < end; ++i) {
+                const auto grid = unpackBoardKey<typename B::Grid>(states[i]);
+                double best = 0.0;
+                for (const Direction direction : kDirections) {
+                    auto moved = grid;
+                    const auto move = B::Game::slide(moved, direction);
+                    std::uint64_t afterstate = 0;
+                    if (!move.moved || !packBoardKey(moved, afterstate)) {
+                        continue;
+                    }
+                    const auto expectation = spawnExpectation<Size>(afterstate, plusTwo, plusFour);
+                    if (!expectation.has_value()) {
+                        missing.store(true);
+                        return;
+                    }
+                    best = std::max(best, move.scoreDelta + *expectation);
+                }
+                values[i] = best;
+            }
+        });
+        if (missing.load()) {
+            error = "layer " + std::to_string(tileSum) +
+                    " leads to a position that was never enumerated";
+            return false;
+        }
+        if (!valuesFile->flush()) {
+            error = "cannot write " + tempPath.string();
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, valuesPath, ec);
+    if (ec) {
+        error = "cannot rename " + tempPath.string() + ": " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+// Every opening: two spawns on an empty board, as `Game::reset` places them.
+template <int Size> std::vector<std::pair<std::uint64_t, double>> openings() {
+    using B = Board<Size>;
+    std::vector<std::pair<std::uint64_t, double>> result;
+    constexpr double cells = B::kCells;
+    for (int first = 0; first < B::kCells; ++first) {
+        for (int second = 0; second < B::kCells; ++second) {
+            if (second == first) {
+                continue;
+            }
+            for (const std::uint64_t a : {1U, 2U}) {
+                for (const std::uint64_t b : {1U, 2U}) {
+                    const double pa = a == 2U ? kFourProbability : 1.0 - kFourProbability;
+                    const double pb = b == 2U ? kFourProbability : 1.0 - kFourProbability;
+                    const std::uint64_t key = (a << (4 * first)) | (b << (4 * second));
+                    result.emplace_back(key, pa * pb / (cells * (cells - 1.0)));
+                }
+            }
+        }
+    }
+    return result;
+}
+
+int tileSumOf(std::uint64_t key) {
+    int sum = 0;
+    for (; key != 0U; key >>= 4U) {
+        const auto exponent = static_cast<int>(key & 0xFU);
+        sum += exponent == 0 ? 0 : 1 << exponent;
+    }
+    return sum;
+}
+
+} // namespace
+
+template <int Size>
+bool solveBoard(const SolverConfig &config, SolverResult &result, std::string &error) {
+    using B = Board<Size>;
+    result = {};
+
+    std::error_code ec;
+    std::filesystem::create_directories(config.directory, ec);
+    if (ec) {
+        error = "cannot create " + config.directory.string() + ": " + ec.message();
+        return false;
+    }
+
+    Manifest manifest;
+    if (!loadManifest(config.directory, Size, manifest, error)) {
+        return false;
+    }
+
+    const std::size_t workerCount = resolveThreadCount(config.threads);
+    std::size_t steps = 0;
+    const auto budgetLeft = [&] { return config.layerBudget == 0U || steps < config.layerBudget; };
+    const auto fillResult = [&] {
+        for (const auto &[tileSum, states] : manifest.layers) {
+            result.layers.push_back({tileSum, states});
+            result.totalStates += states;
+        }
+        result.completed = manifest.completed;
+        result.expectedScore = manifest.expectedScore;
+    };
+
+    if (manifest.layers.empty() && manifest.expanded == 0) {
+        std::map<int, std::vector<std::uint64_t>> firstLayers;
+        for (const auto &[key, probability] : openings<Size>()) {
+            firstLayers[tileSumOf(key)].push_back(B::canonical(key));
+        }
+        for (auto &[tileSum, keys] : firstLayers) {
+            std::filesystem::remove(layerPath(config.directory, "pending", tileSum), ec);
+            if (!appendKeys(layerPath(config.directory, "pending", tileSum), keys, error)) {
+                return false;
+            }
+        }
+    }
+
+    // Forward: finalize and expand layers in increasing tile sum.
+    for (int tileSum = kFirstTileSum; !manifest.forwardDone; tileSum += 2) {
+        const bool finalized = manifest.layers.contains(tileSum);
+        const bool expanded = tileSum <= manifest.expanded;
+        if (finalized && expanded) {
+            ++result.resumedSteps;
+            continue;
+        }
+        if (!budgetLeft()) {
+            fillResult();
+            return true;
+        }
+
+        if (!finalized) {
+            const bool hasPending =
+                std::filesystem::exists(layerPath(config.directory, "pending", tileSum));
+            if (!hasPending) {
+                // Layers grow by 2 or 4, so two empty layers in a row end the game tree.
+                const bool nextPending =
+                    std::filesystem::exists(layerPath(config.directory, "pending", tileSum + 2));
+                if (!nextPending) {
+                    manifest.forwardDone = true;
+                    if (!saveManifest(config.directory, manifest, error)) {
+                        return false;
+                    }
+                }
+                continue;
+            }
+            std::uint64_t states = 0;
+            if (!finalizeLayer(config.directory, tileSum, workerCount, states, error)) {
+                return false;
+            }
+            manifest.layers[tileSum] = states;
+            if (!saveManifest(config.directory, manifest, error)) {
+                return false;
+            }
+        }
+        // Also clears a pending file left by a run stopped right after the manifest save.
+        std::filesystem::remove(layerPath(config.directory, "pending", tileSum), ec);
+
+        if (!expandLayer<Size>(config.directory, tileSum, workerCount, error)) {
+            return false;
+        }
+        manifest.expanded = tileSum;
+        ++steps;
+        if (!saveManifest(config.directory, manifest, error)) {
+            return false;
+        }
+    }
+
+    // Backward: value layers from the highest tile sum down.
+    for (auto it = manifest.layers.rbegin(); it != manifest.layers.rend(); ++it) {
+        const int tileSum = it->first;
+        if (manifest.valuedFrom != 0 && tileSum >= manifest.valuedFrom) {
+            ++result.resumedSteps;
+            continue;
+        }
+        if (!budgetLeft()) {
+            fillResult();
+            return true;
+        }
+        if (!valueLayer<Size>(config.directory, tileSum, workerCount, error)) {
+            return false;
+        }
+        manifest.valuedFrom = tileSum;
+        ++steps;
+        if (!saveManifest(config.directory, manifest, error)) {
+            return false;
+        }
+    }
+
+    if (!manifest.completed) {
+        SolvedTable<Size> table;
+        manifest.completed = true;
+        if (!saveManifest(config.directory, manifest, error) ||
+            !table.open(config.directory, error)) {
+            return false;
+        }
+
+        double expected = 0.0;
+        for (const auto &[key, probability] : openings<Size>()) {
+            const auto value = table.value(unpackBoardKey<typename B::Grid>(key));
+            if (!value.has_value()) {
+                error = "opening position missing from the solved layers";
+                return false;
+            }
+            expected += probability * *value;
+        }
+        manifest.expectedScore = expected;
+        if (!saveManifest(config.directory, manifest, error)) {
+            return false;
+        }
+    }
+
+    fillResult();
+    return true;
+}
+
+template <int Size>
+bool SolvedTable<Size>::open(const std::filesystem::path &directory, std::string &error) {
+    Manifest manifest;
+    if (!loadManifest(directory, Size, manifest, error)) {
+        return false;
+    }
+    if (!manifest.completed) {
+        error = directory.string() + ": solve has not finished";
+        return false;
+    }
+
+    layers_.clear();
+    for (const auto &[tileSum, states] : manifest.layers) {
+        LayerView view;
+        if (!openLayerView(directory, tileSum, view, error)) {
+            return false;
+        }
+        layers_[tileSum] = Layer{std::move(view.states), std::move(view.values)};
+    }
+    expectedScore_ = manifest.expectedScore;
+    return true;
+}
+
+template <int Size> std::optional<double> SolvedTable<Size>::value(const Grid &grid) const {
+    std::uint64_t key = 0;
+    if (!packBoardKey(grid, key)) {
+        return std::nullopt;
+    }
+    const auto layer = layers_.find(tileSumOf(key));
+    if (layer == layers_.end()) {
+        return std::nullopt;
+    }
+
+    const auto keys = layer->second.states->template as<std::uint64_t>();
+    const std::uint64_t canonicalKey = Board<Size>::canonical(key);
+    const auto it = std::lower_bound(keys.begin(), keys.end(), canonicalKey);
+    if (it == keys.end() || *it != canonicalKey) {
+        return std::nullopt;
+    }
+    return layer->second.values->template as<double>()[static_cast<std::size_t>(it - keys.begin())];
+}
+
+template <int Size> double SolvedTable<Size>::expectedScore() const noexcept {
+    return expectedScore_;
+}
+
+template bool solveBoard<2>(const SolverConfig &, SolverResult &, std::string &);
+template bool solveBoard<3>(const SolverConfig &, SolverResult &, std::string &);
+template class SolvedTable<2>;
+template class SolvedTable<3>;
+
+} // namespace sim2048
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "core/Game.hpp"
+#include "sim/MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace sim2048 {
+
+// Exhaustive solver for small boards (2x2, 3x3). It computes the value of every position
+// reachable from an opening: the expected score still to be earned under optimal play, with
+// spawns of 2 (90%) or 4 (10%) on a uniformly chosen empty cell, as in `Game`.
+//
+// Moves never change the tile sum and every spawn adds 2 or 4, so positions fall into layers by
+// tile sum and each layer only leads to the next two. The solver works out-of-core, one layer
+// at a time, with everything in `directory`:
+//   states-<sum>.bin   sorted, deduplicated positions: 4-bit tile exponents packed into a u64,
+//                      reduced to the smallest of their 8 rotations/reflections
+//   values-<sum>.bin   one double per position, same order
+//   solver.json        manifest and per-layer checkpoint
+// The forward pass expands layers in increasing sum; each worker sorts its children and they
+// are merged into the next layers' files. The backward pass (retrograde analysis) walks back
+// down, valuing each layer in parallel from the two memory-mapped layers above it. Every
+// finished layer is recorded in the manifest, so an interrupted solve resumes at that layer.
+struct SolverConfig {
+    std::filesystem::path directory;
+    // 0 uses every hardware thread.
+    unsigned int threads{0};
+    // Stop after this many layer steps (forward or backward) in this run; 0 = no limit.
+    std::size_t layerBudget{0};
+};
+
+struct SolverLayer {
+    int tileSum{0};
+    std::uint64_t states{0};
+};
+
+struct SolverResult {
+    std::vector<SolverLayer> layers;
+    std::uint64_t totalStates{0};
+    // Expected final score of a new game under optimal play; valid when `completed`.
+    double expectedScore{0.0};
+    // Layer steps found already done in the manifest.
+    std::size_t resumedSteps{0};
+    bool completed{false};
+};
+
+template <int Size>
+bool solveBoard(const SolverConfig &config, SolverResult &result, std::string &error);
+
+// Read-only view of a finished solve: looks positions up by binary search in the mapped layers.
+template <int Size> class SolvedTable {
+  public:
+    using Grid = typename core2048::BasicGame<Size>::Grid;
+
+    bool open(const std::filesystem::path &directory, std::string &error);
+
+    // Expected score still to be earned from `grid` (a position right after a spawn) under
+    // optimal play, or nothing if the position is not reachable.
+    std::optional<double> value(const Grid &grid) const;
+    double expectedScore() const noexcept;
+
+  private:
+    struct Layer {
+        std::optional<MappedFile> states;
+        std::optional<MappedFile> values;
+    };
+
+    std::map<int, Layer> layers_;
+    double expectedScore_{0.0};
+};
+
+extern template bool solveBoard<2>(const SolverConfig &, SolverResult &, std::string &);
+extern template bool solveBoard<3>(const SolverConfig &, SolverResult &, std::string &);
+extern template class SolvedTable<2>;
+extern template class SolvedTable<3>;
+
+} // namespace sim2048
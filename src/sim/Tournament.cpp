@@ -0,0 +1,108 @@
+#include "sim/Tournament.hpp"
+
+#include "sim/Report.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+namespace sim2048 {
+
+bool runTournament(const TournamentConfig &config, std::ostream &out, std::string &error) {
+    if (config.policies.empty()) {
+        error = "no policies given";
+        return false;
+    }
+    for (const auto &policy : config.policies) {
+        if (makePolicy(policy, 0U) == nullptr) {
+            error = "unknown policy: " + policy;
+            return false;
+        }
+    }
+
+    if (std::uint64_t{config.firstSeed} + config.seedCount > std::uint64_t{1} << 32U) {
+        error = "seed range " + std::to_string(config.firstSeed) + " + " +
+                std::to_string(config.seedCount) + " exceeds 32-bit seeds";
+        return false;
+    }
+
+    const std::size_t policyCount = config.policies.size();
+    const std::size_t gameCount = policyCount * config.seedCount;
+
+    std::vector<GameOutcome> outcomes(gameCount);
+    std::vector<char> finished(gameCount, 0);
+    std::mutex mutex;
+    std::condition_variable gameFinished;
+    std::atomic<std::size_t> nextGame{0};
+
+    const auto worker = [&] {
+        while (true) {
+            const std::size_t index = nextGame.fetch_add(1U, std::memory_order_relaxed);
+            if (index >= gameCount) {
+                return;
+            }
+
+            const auto seed = static_cast<std::uint32_t>(config.firstSeed + index / policyCount);
+            const auto policy = makePolicy(config.policies[index % policyCount], seed);
+            const GameOutcome outcome = playGame(*policy, seed, config.maxMoves);
+
+            {
+                const std::lock_guard<std::mutex> lock(mutex);
+                outcomes[index] = outcome;
+                finished[index] = 1;
+            }
+            gameFinished.notify_one();
+        }
+    };
+
+    const std::size_t threadCount = std::min<std::size_t>(resolveThreadCount(config.threads),
+                                                          std::max<std::size_t>(gameCount, 1U));
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(worker);
+    }
+
+    // Stream finished games in index order so the output does not depend on scheduling.
+    for (std::size_t index = 0; index < gameCount; ++index) {
+        GameOutcome outcome;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (finished[index] == 0) {
+                // Make what is already known visible before blocking on the next game.
+                lock.unlock();
+                out.flush();
+                lock.lock();
+                gameFinished.wait(lock, [&] { return finished[index] != 0; });
+            }
+            outcome = outcomes[index];
+        }
+
+        const auto seed = static_cast<std::uint32_t>(config.firstSeed + index / policyCount);
+        out << gameJsonLine(config.policies[index % policyCount], seed, outcome) << '\n';
+    }
+
+    for (auto &thread : workers) {
+        thread.join();
+    }
+
+    std::vector<GameOutcome> policyOutcomes;
+    policyOutcomes.reserve(config.seedCount);
+    for (std::size_t policy = 0; policy < policyCount; ++policy) {
+        policyOutcomes.clear();
+        for (std::size_t index = policy; index < gameCount; index += policyCount) {
+            policyOutcomes.push_back(outcomes[index]);
+        }
+        out << aggregateJsonLine(config.policies[policy], summarizeOutcomes(policyOutcomes))
+            << '\n';
+    }
+
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+} // namespace sim2048
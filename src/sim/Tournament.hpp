@@ -0,0 +1,27 @@
+#pragma once
+
+#include "sim/Simulation.hpp"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sim2048 {
+
+struct TournamentConfig {
+    std::vector<std::string> policies;
+    std::uint32_t firstSeed{1};
+    std::uint32_t seedCount{100};
+    // 0 uses every hardware thread.
+    unsigned int threads{0};
+    int maxMoves{100000};
+};
+
+// Plays every policy against every seed in `[firstSeed, firstSeed + seedCount)` on a pool of
+// worker threads; a range past the last 32-bit seed is rejected. One JSON line per game is written, in (seed, policy) order, as soon as all
+// earlier games have finished; one aggregate line per policy follows. The output depends on
+// everything in `config` except `threads`.
+bool runTournament(const TournamentConfig &config, std::ostream &out, std::string &error);
+
+} // namespace sim2048
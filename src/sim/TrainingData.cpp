@@ -0,0 +1,469 @@
+#include "sim/TrainingData.hpp"
+
+#include "sim/Policy.hpp"
+#include "sim/Simulation.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <system_error>
+
+namespace sim2048 {
+
+namespace {
+
+using core2048::Direction;
+using core2048::Game;
+
+constexpr std::array<char, 4> kMagic = {'S', '2', 'T', 'D'};
+constexpr std::array<char, 4> kEndMagic = {'S', '2', 'T', 'E'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kTrailerSize = 4U * sizeof(std::uint64_t);
+constexpr std::size_t kIndexEntrySize = 2U * sizeof(std::uint64_t);
+constexpr std::uint32_t kMaxPolicyLength = 256;
+constexpr std::size_t kAlignment = 8;
+// Per sample: board, game, reward, outcome, legal mask, move, final tile.
+constexpr std::size_t kSampleBytes = 8U + 3U * 4U + 3U;
+constexpr std::array<Direction, 4> kDirections = {Direction::Up, Direction::Down, Direction::Left,
+                                                  Direction::Right};
+
+constexpr std::size_t alignUp(const std::size_t value) {
+    return (value + kAlignment - 1U) / kAlignment * kAlignment;
+}
+
+constexpr std::size_t chunkBytes(const std::size_t samples) {
+    return alignUp(samples * kSampleBytes);
+}
+
+std::size_t headerSize(const std::size_t policyLength) {
+    return alignUp(kMagic.size() + 2U * sizeof(std::uint32_t) + policyLength);
+}
+
+template <typename T> void writeRaw(std::ofstream &out, const T &value) {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> void writeColumn(std::ofstream &out, const std::vector<T> &column) {
+    out.write(reinterpret_cast<const char *>(column.data()),
+              static_cast<std::streamsize>(column.size() * sizeof(T)));
+}
+
+template <typename T> T readRaw(const std::byte *data) {
+    T value{};
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+template <typename T>
+std::span<const T> columnAt(const std::byte *&cursor, const std::size_t samples) {
+    const std::span<const T> column(reinterpret_cast<const T *>(cursor), samples);
+    cursor += samples * sizeof(T);
+    return column;
+}
+
+std::uint8_t maxTileExponent(const Game::Grid &grid) {
+    int maxTile = 0;
+    for (const auto &row : grid) {
+        for (const int value : row) {
+            maxTile = std::max(maxTile, value);
+        }
+    }
+    return static_cast<std::uint8_t>(tileExponent(maxTile));
+}
+
+} // namespace
+
+std::size_t TrainingWriter::Chunk::size() const noexcept {
+    return boards.size();
+}
+
+void TrainingWriter::Chunk::reserve(const std::size_t samples) {
+    boards.reserve(samples);
+    games.reserve(samples);
+    rewards.reserve(samples);
+    outcomes.reserve(samples);
+    legalMasks.reserve(samples);
+    moves.reserve(samples);
+    finalTiles.reserve(samples);
+}
+
+void TrainingWriter::Chunk::clear() noexcept {
+    boards.clear();
+    games.clear();
+    rewards.clear();
+    outcomes.clear();
+    legalMasks.clear();
+    moves.clear();
+    finalTiles.clear();
+}
+
+TrainingWriter::~TrainingWriter() {
+    stopWriter();
+    if (out_.is_open()) {
+        out_.close();
+        std::error_code ec;
+        std::filesystem::remove(tempPath_, ec);
+    }
+}
+
+bool TrainingWriter::open(const std::filesystem::path &path, const std::string &policy,
+                          const std::size_t chunkSamples, std::string &error) {
+    if constexpr (std::endian::native != std::endian::little) {
+        error = "training data files are written on little-endian hosts only";
+        return false;
+    }
+    if (policy.size() > kMaxPolicyLength) {
+        error = "policy name too long";
+        return false;
+    }
+    if (chunkSamples == 0U) {
+        error = "chunk size must be positive";
+        return false;
+    }
+
+    path_ = path;
+    tempPath_ = path;
+    tempPath_ += ".tmp";
+    out_.open(tempPath_, std::ios::binary | std::ios::trunc);
+    if (!out_.is_open()) {
+        error = "cannot open " + tempPath_.string();
+        return false;
+    }
+
+    out_.write(kMagic.data(), kMagic.size());
+    writeRaw(out_, kVersion);
+    writeRaw(out_, static_cast<std::uint32_t>(policy.size()));
+    out_.write(policy.data(), static_cast<std::streamsize>(policy.size()));
+    offset_ = headerSize(policy.size());
+    const std::array<char, kAlignment> padding{};
+    out_.write(padding.data(),
+               static_cast<std::streamsize>(offset_ - (kMagic.size() + 8U + policy.size())));
+
+    chunkSamples_ = chunkSamples;
+    index_.clear();
+    for (auto &chunk : chunks_) {
+        chunk.clear();
+        chunk.reserve(chunkSamples);
+    }
+    filling_ = &chunks_[0];
+    flushing_ = nullptr;
+    samples_ = 0;
+    stopping_ = false;
+    producerWaits_ = 0;
+    producerWaitTime_ = {};
+    failed_.store(false);
+    writer_ = std::thread([this] { writerLoop(); });
+    return true;
+}
+
+bool TrainingWriter::append(const std::span<const TrainingSample> samples) {
+    const std::lock_guard<std::mutex> producer(appendMutex_);
+    for (const auto &sample : samples) {
+        if (filling_->size() == chunkSamples_) {
+            handOff();
+        }
+        filling_->boards.push_back(sample.board);
+        filling_->games.push_back(sample.game);
+        filling_->rewards.push_back(sample.reward);
+        filling_->outcomes.push_back(sample.outcome);
+        filling_->legalMasks.push_back(sample.legalMask);
+        filling_->moves.push_back(sample.move);
+        filling_->finalTiles.push_back(sample.finalTile);
+    }
+    samples_ += samples.size();
+    return !failed_.load(std::memory_order_relaxed);
+}
+
+void TrainingWriter::handOff() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (flushing_ != nullptr) {
+        const auto began = std::chrono::steady_clock::now();
+        chunkWritten_.wait(lock, [this] { return flushing_ == nullptr; });
+        ++producerWaits_;
+        producerWaitTime_ += std::chrono::steady_clock::now() - began;
+    }
+    flushing_ = filling_;
+    filling_ = filling_ == &chunks_[0] ? &chunks_[1] : &chunks_[0];
+    lock.unlock();
+    chunkReady_.notify_one();
+}
+
+void TrainingWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        chunkReady_.wait(lock, [this] { return flushing_ != nullptr || stopping_; });
+        if (flushing_ == nullptr) {
+            return;
+        }
+
+        Chunk *chunk = flushing_;
+        lock.unlock();
+        if (!writeChunk(*chunk)) {
+            failed_.store(true);
+        }
+        chunk->clear();
+        lock.lock();
+        flushing_ = nullptr;
+        chunkWritten_.notify_all();
+    }
+}
+
+bool TrainingWriter::writeChunk(const Chunk &chunk) {
+    const std::size_t samples = chunk.size();
+    index_.push_back({offset_, samples});
+    writeColumn(out_, chunk.boards);
+    writeColumn(out_, chunk.games);
+    writeColumn(out_, chunk.rewards);
+    writeColumn(out_, chunk.outcomes);
+    writeColumn(out_, chunk.legalMasks);
+    writeColumn(out_, chunk.moves);
+    writeColumn(out_, chunk.finalTiles);
+    const std::array<char, kAlignment> padding{};
+    out_.write(padding.data(),
+               static_cast<std::streamsize>(chunkBytes(samples) - samples * kSampleBytes));
+    offset_ += chunkBytes(samples);
+    return static_cast<bool>(out_);
+}
+
+void TrainingWriter::stopWriter() {
+    if (!writer_.joinable()) {
+        return;
+    }
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    chunkReady_.notify_one();
+    writer_.join();
+}
+
+bool TrainingWriter::finish(std::string &error) {
+    {
+        const std::lock_guard<std::mutex> producer(appendMutex_);
+        if (filling_->size() > 0U) {
+            handOff();
+        }
+    }
+    stopWriter();
+
+    const std::uint64_t indexOffset = offset_;
+    for (const auto &[offset, samples] : index_) {
+        writeRaw(out_, offset);
+        writeRaw(out_, samples);
+    }
+    writeRaw(out_, indexOffset);
+    writeRaw(out_, static_cast<std::uint64_t>(index_.size()));
+    writeRaw(out_, samples_);
+    out_.write(kEndMagic.data(), kEndMagic.size());
+    writeRaw(out_, std::uint32_t{0});
+
+    out_.close();
+    std::error_code ec;
+    if (!out_ || failed_.load()) {
+        error = "cannot write " + tempPath_.string();
+        std::filesystem::remove(tempPath_, ec);
+        return false;
+    }
+    std::filesystem::rename(tempPath_, path_, ec);
+    if (ec) {
+        error = "cannot rename " + tempPath_.string() + ": " + ec.message();
+        std::filesystem::remove(tempPath_, ec);
+        return false;
+    }
+    return true;
+}
+
+TrainingWriterStats TrainingWriter::stats() const {
+    const std::lock_guard<std::mutex> producer(appendMutex_);
+    const std::lock_guard<std::mutex> lock(mutex_);
+    TrainingWriterStats stats;
+    stats.samples = samples_;
+    // The writer thread owns the index until it is joined; after `finish` it is final.
+    stats.chunks = writer_.joinable() ? 0U : index_.size();
+    stats.producerWaits = producerWaits_;
+    stats.producerWaitTime = producerWaitTime_;
+    return stats;
+}
+
+std::size_t TrainingChunkView::size() const noexcept {
+    return boards.size();
+}
+
+TrainingSample TrainingChunkView::sample(const std::size_t i) const noexcept {
+    return {boards[i], games[i], rewards[i], outcomes[i], legalMasks[i], moves[i], finalTiles[i]};
+}
+
+bool TrainingReader::open(const std::filesystem::path &path, std::string &error) {
+    if constexpr (std::endian::native != std::endian::little) {
+        error = "training data files are read on little-endian hosts only";
+        return false;
+    }
+
+    const std::string name = path.string();
+    file_ = MappedFile::openReadOnly(path, error);
+    if (!file_.has_value()) {
+        return false;
+    }
+    const auto bytes = file_->as<std::byte>();
+    const std::byte *data = bytes.data();
+
+    constexpr std::size_t fixedHeader = kMagic.size() + 2U * sizeof(std::uint32_t);
+    if (bytes.size() < fixedHeader + kTrailerSize ||
+        std::memcmp(data, kMagic.data(), kMagic.size()) != 0) {
+        error = name + ": not a training data file";
+        return false;
+    }
+    const auto version = readRaw<std::uint32_t>(data + kMagic.size());
+    const auto policyLength = readRaw<std::uint32_t>(data + kMagic.size() + 4U);
+    if (version != kVersion) {
+        error = name + ": unsupported training data version " + std::to_string(version);
+        return false;
+    }
+    if (policyLength > kMaxPolicyLength ||
+        headerSize(policyLength) + kTrailerSize > bytes.size()) {
+        error = name + ": not a training data file";
+        return false;
+    }
+    policy_.assign(reinterpret_cast<const char *>(data + fixedHeader), policyLength);
+
+    const std::byte *trailer = data + bytes.size() - kTrailerSize;
+    const auto indexOffset = readRaw<std::uint64_t>(trailer);
+    const auto chunkCount = readRaw<std::uint64_t>(trailer + 8U);
+    samples_ = readRaw<std::uint64_t>(trailer + 16U);
+    const std::uint64_t indexEnd = bytes.size() - kTrailerSize;
+    if (std::memcmp(trailer + 24U, kEndMagic.data(), kEndMagic.size()) != 0 ||
+        indexOffset > indexEnd || (indexEnd - indexOffset) / kIndexEntrySize != chunkCount ||
+        (indexEnd - indexOffset) % kIndexEntrySize != 0U) {
+        error = name + ": incomplete training data file (no trailer)";
+        return false;
+    }
+
+    // Chunks must tile the space between the header and the index exactly.
+    index_.clear();
+    index_.reserve(chunkCount);
+    std::uint64_t expectedOffset = headerSize(policyLength);
+    std::uint64_t samples = 0;
+    for (std::uint64_t i = 0; i < chunkCount; ++i) {
+        const std::byte *entry = data + indexOffset + i * kIndexEntrySize;
+        const auto offset = readRaw<std::uint64_t>(entry);
+        const auto count = readRaw<std::uint64_t>(entry + 8U);
+        if (offset != expectedOffset || offset > indexOffset ||
+            count > (indexOffset - offset) / kSampleBytes) {
+            error = name + ": corrupt chunk index";
+            return false;
+        }
+        index_.push_back({offset, count});
+        expectedOffset += chunkBytes(count);
+        samples += count;
+    }
+    if (expectedOffset != indexOffset || samples != samples_) {
+        error = name + ": corrupt chunk index";
+        return false;
+    }
+    return true;
+}
+
+const std::string &TrainingReader::policy() const noexcept {
+    return policy_;
+}
+
+std::uint64_t TrainingReader::samples() const noexcept {
+    return samples_;
+}
+
+std::size_t TrainingReader::chunkCount() const noexcept {
+    return index_.size();
+}
+
+TrainingChunkView TrainingReader::chunk(const std::size_t index) const {
+    const auto [offset, samples] = index_[index];
+    const std::byte *cursor = file_->as<std::byte>().data() + offset;
+    TrainingChunkView view;
+    view.boards = columnAt<std::uint64_t>(cursor, samples);
+    view.games = columnAt<std::uint32_t>(cursor, samples);
+    view.rewards = columnAt<std::uint32_t>(cursor, samples);
+    view.outcomes = columnAt<std::uint32_t>(cursor, samples);
+    view.legalMasks = columnAt<std::uint8_t>(cursor, samples);
+    view.moves = columnAt<std::uint8_t>(cursor, samples);
+    view.finalTiles = columnAt<std::uint8_t>(cursor, samples);
+    return view;
+}
+
+bool exportTrainingData(const TrainingExportConfig &config, TrainingExportResult &result,
+                        std::string &error) {
+    if (makePolicy(config.policy, 0U) == nullptr) {
+        error = "unknown policy: " + config.policy;
+        return false;
+    }
+
+    const auto began = std::chrono::steady_clock::now();
+    TrainingWriter writer;
+    if (!writer.open(config.output, config.policy, config.chunkSamples, error)) {
+        return false;
+    }
+
+    const unsigned int workerCount = resolveThreadCount(config.threads);
+    std::atomic<std::uint32_t> nextGame{0};
+    std::atomic<std::uint64_t> gamesPlayed{0};
+
+    const auto work = [&] {
+        std::vector<TrainingSample> samples;
+        for (std::uint32_t i = nextGame.fetch_add(1U); i < config.games;
+             i = nextGame.fetch_add(1U)) {
+            const std::uint32_t seed = config.firstSeed + i;
+            const auto bot = makePolicy(config.policy, seed);
+            Game game(seed);
+            samples.clear();
+
+            // Same loop as playGame, recording each decision.
+            while (static_cast<int>(samples.size()) < config.maxMoves) {
+                const Game::Grid grid = game.getGrid();
+                const auto direction = bot->chooseMove(grid);
+                if (!direction.has_value()) {
+                    break;
+                }
+                std::uint8_t legalMask = 0;
+                for (std::size_t d = 0; d < kDirections.size(); ++d) {
+                    Game::Grid next = grid;
+                    if (Game::slide(next, kDirections[d]).moved) {
+                        legalMask |= static_cast<std::uint8_t>(1U << d);
+                    }
+                }
+                const auto move = game.applyMove(*direction);
+                samples.push_back({core2048::packBoard(grid), seed,
+                                   static_cast<std::uint32_t>(move.scoreDelta), 0U, legalMask,
+                                   static_cast<std::uint8_t>(*direction), 0U});
+            }
+
+            const auto score = static_cast<std::uint32_t>(game.getScore());
+            const std::uint8_t finalTile = maxTileExponent(game.getGrid());
+            for (auto &sample : samples) {
+                sample.outcome = score;
+                sample.finalTile = finalTile;
+            }
+            gamesPlayed.fetch_add(1U, std::memory_order_relaxed);
+            if (!writer.append(samples)) {
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(work);
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    if (!writer.finish(error)) {
+        return false;
+    }
+    result.games = gamesPlayed.load();
+    result.writer = writer.stats();
+    result.elapsed = std::chrono::steady_clock::now() - began;
+    return true;
+}
+
+} // namespace sim2048
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "core/Heuristics.hpp"
+#include "sim/MappedFile.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sim2048 {
+
+// One decision of a bot: the board it saw, what it could and did play, and how it went.
+struct TrainingSample {
+    // Board before the move (`core2048::packBoard`).
+    core2048::PackedBoard board{0};
+    // Seed of the game; all samples of a game are stored contiguously, in move order.
+    std::uint32_t game{0};
+    // Score gained by the move.
+    std::uint32_t reward{0};
+    // Final score of the game.
+    std::uint32_t outcome{0};
+    // Bit `d` is set when `Direction(d)` changes the board.
+    std::uint8_t legalMask{0};
+    // The `Direction` played.
+    std::uint8_t move{0};
+    // Exponent of the largest tile at the end of the game.
+    std::uint8_t finalTile{0};
+};
+
+// Training data file (`.s2td`), little-endian and laid out for memory mapping:
+//   header : magic "S2TD", u32 version, u32 policy length, policy bytes, zero padding to 8
+//   chunks : columns of n samples: u64 board[n], u32 game[n], u32 reward[n], u32 outcome[n],
+//            u8 legal mask[n], u8 move[n], u8 final tile[n], zero padding to 8
+//   index  : per chunk u64 offset, u64 sample count
+//   trailer: u64 index offset, u64 chunk count, u64 sample count, magic "S2TE", u32 zero
+// Every column is aligned to its element size, so a reader can use it in place.
+inline constexpr std::size_t kDefaultTrainingChunkSamples = std::size_t{1} << 16U;
+
+struct TrainingWriterStats {
+    std::uint64_t samples{0};
+    std::uint64_t chunks{0};
+    // Times an `append` found both chunk buffers full and had to wait for the disk.
+    std::uint64_t producerWaits{0};
+    std::chrono::nanoseconds producerWaitTime{0};
+};
+
+// Streams samples into a training data file. Producers copy samples into the filling chunk
+// under a short lock; a background thread writes the other chunk, so appends only block when
+// the disk falls a whole chunk behind. The file is written to a temporary sibling and renamed by
+// `finish`, so an interrupted export never leaves a file that looks complete.
+class TrainingWriter {
+  public:
+    TrainingWriter() = default;
+    TrainingWriter(const TrainingWriter &) = delete;
+    TrainingWriter &operator=(const TrainingWriter &) = delete;
+    ~TrainingWriter();
+
+    bool open(const std::filesystem::path &path, const std::string &policy,
+              std::size_t chunkSamples, std::string &error);
+
+    // Thread-safe. The samples of one call stay contiguous in the file. Returns false once a
+    // write has failed; `finish` reports the error.
+    bool append(std::span<const TrainingSample> samples);
+    bool finish(std::string &error);
+
+    TrainingWriterStats stats() const;
+
+  private:
+    struct Chunk {
+        std::vector<std::uint64_t> boards;
+        std::vector<std::uint32_t> games;
+        std::vector<std::uint32_t> rewards;
+        std::vector<std::uint32_t> outcomes;
+        std::vector<std::uint8_t> legalMasks;
+        std::vector<std::uint8_t> moves;
+        std::vector<std::uint8_t> finalTiles;
+
+        std::size_t size() const noexcept;
+        void reserve(std::size_t samples);
+        void clear() noexcept;
+    };
+
+    void writerLoop();
+    bool writeChunk(const Chunk &chunk);
+    // Hands the filling chunk to the writer thread, first waiting for it to finish the other.
+    // Called with `appendMutex_` held.
+    void handOff();
+    void stopWriter();
+
+    std::filesystem::path path_;
+    std::filesystem::path tempPath_;
+    std::ofstream out_;
+    std::uint64_t offset_{0};
+    std::vector<std::array<std::uint64_t, 2>> index_;
+    std::size_t chunkSamples_{kDefaultTrainingChunkSamples};
+
+    // Serializes producers, so one `append` is never interleaved with another. `filling_` is
+    // only touched under it.
+    mutable std::mutex appendMutex_;
+    Chunk *filling_{nullptr};
+    std::uint64_t samples_{0};
+
+    // Guards the hand-off between producers and the writer thread.
+    mutable std::mutex mutex_;
+    std::condition_variable chunkReady_;
+    std::condition_variable chunkWritten_;
+    std::array<Chunk, 2> chunks_;
+    Chunk *flushing_{nullptr};
+    bool stopping_{false};
+    std::uint64_t producerWaits_{0};
+    std::chrono::nanoseconds producerWaitTime_{0};
+    std::atomic<bool> failed_{false};
+    std::thread writer_;
+};
+
+// Columns of one chunk, pointing into the mapped file.
+struct TrainingChunkView {
+    std::span<const std::uint64_t> boards;
+    std::span<const std::uint32_t> games;
+    std::span<const std::uint32_t> rewards;
+    std::span<const std::uint32_t> outcomes;
+    std::span<const std::uint8_t> legalMasks;
+    std::span<const std::uint8_t> moves;
+    std::span<const std::uint8_t> finalTiles;
+
+    std::size_t size() const noexcept;
+    TrainingSample sample(std::size_t i) const noexcept;
+};
+
+// Maps a training data file and validates its index; chunks are read without copying.
+class TrainingReader {
+  public:
+    bool open(const std::filesystem::path &path, std::string &error);
+
+    const std::string &policy() const noexcept;
+    std::uint64_t samples() const noexcept;
+    std::size_t chunkCount() const noexcept;
+    TrainingChunkView chunk(std::size_t index) const;
+
+  private:
+    std::optional<MappedFile> file_;
+    std::string policy_;
+    std::uint64_t samples_{0};
+    std::vector<std::array<std::uint64_t, 2>> index_;
+};
+
+struct TrainingExportConfig {
+    std::string policy{"greedy"};
+    std::uint32_t firstSeed{0};
+    std::uint32_t games{1000};
+    int maxMoves{100000};
+    // 0 uses every hardware thread.
+    unsigned int threads{0};
+    std::size_t chunkSamples{kDefaultTrainingChunkSamples};
+    std::filesystem::path output;
+};
+
+struct TrainingExportResult {
+    std::uint64_t games{0};
+    TrainingWriterStats writer;
+    std::chrono::nanoseconds elapsed{0};
+};
+
+// Plays games `firstSeed ..` with one policy on a worker pool and streams every move as a
+// sample. Games land in the file in the order they finish; each game's samples are contiguous.
+bool exportTrainingData(const TrainingExportConfig &config, TrainingExportResult &result,
+                        std::string &error);
+
+} // namespace sim2048
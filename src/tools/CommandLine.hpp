@@ -0,0 +1,26 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <system_error>
+
+namespace sim2048 {
+
+// Parses a whole decimal argument; signs, blanks, trailing text and out-of-range values fail.
+inline bool parseUnsigned(const std::string_view text, std::uint64_t &value) {
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return !text.empty() && ec == std::errc{} && ptr == text.data() + text.size();
+}
+
+inline bool parseUnsigned(const std::string_view text, std::uint32_t &value) {
+    std::uint64_t parsed = 0;
+    if (!parseUnsigned(text, parsed) || parsed > std::numeric_limits<std::uint32_t>::max()) {
+        return false;
+    }
+    value = static_cast<std::uint32_t>(parsed);
+    return true;
+}
+
+} // namespace sim2048
@@ -0,0 +1,97 @@
+#include "sim/ReplayAnalytics.hpp"
+#include "sim/Report.hpp"
+#include "tools/CommandLine.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+void printUsage(std::ostream &out) {
+    out << "usage: sfml_2048_analyze [options] <file.s2td | directory>...\n"
+        << "  --threads <uint>    worker threads, 0 = all cores (default 0)\n"
+        << "  --per-game          also print one line per game, in file order\n"
+        << "  --output <path>     write JSON lines here instead of stdout\n"
+        << "Directories are searched recursively for .s2td files (see sfml_2048_export).\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    sim2048::ReplayAnalyticsConfig config;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help") {
+            printUsage(std::cout);
+            return 0;
+        }
+        if (arg == "--per-game") {
+            config.perGame = true;
+            continue;
+        }
+        if (!arg.starts_with("--")) {
+            config.inputs.emplace_back(std::string(arg));
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            std::cerr << "sfml_2048_analyze: " << arg << " needs a value\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+
+        const std::string_view value = argv[++i];
+        std::uint32_t number = 0;
+        if (arg == "--output") {
+            outputPath = std::string(value);
+        } else if (arg == "--threads" && sim2048::parseUnsigned(value, number)) {
+            config.threads = number;
+        } else {
+            std::cerr << "sfml_2048_analyze: unknown option or invalid value: " << arg << "\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+    }
+
+    if (config.inputs.empty()) {
+        std::cerr << "sfml_2048_analyze: no input files or directories\n";
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    std::ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath, std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "sfml_2048_analyze: cannot open " << outputPath << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = outputPath.empty() ? std::cout : file;
+
+    sim2048::ReplayAnalyticsResult result;
+    std::string error;
+    if (!sim2048::analyzeReplays(config, result, error)) {
+        std::cerr << "sfml_2048_analyze: " << error << "\n";
+        return 1;
+    }
+
+    for (const auto &game : result.games) {
+        out << sim2048::replayGameJsonLine(result.files[game.file].string(),
+                                           result.policies[game.file], game)
+            << '\n';
+    }
+    out << sim2048::replayAggregateJsonLine(result.files.size(), result.total) << '\n';
+    out.flush();
+
+    const double seconds = std::chrono::duration<double>(result.elapsed).count();
+    std::cerr << "sfml_2048_analyze: " << result.total.outcomes().games() << " games, "
+              << result.samples << " moves in " << seconds << " s\n";
+    return out ? 0 : 1;
+}
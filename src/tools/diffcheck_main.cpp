@@ -0,0 +1,142 @@
+#include "sim/DiffCheck.hpp"
+#include "tools/CommandLine.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using core2048::Game;
+
+void printUsage(std::ostream &out) {
+    out << "usage: sfml_2048_diffcheck [options]\n"
+        << "  --moves <uint>            moves to compare in total (default 1000000)\n"
+        << "  --moves-per-case <uint>   random moves from each random board (default 256)\n"
+        << "  --first-seed <uint>       seed of the first case (default 0)\n"
+        << "  --threads <uint>          worker threads, 0 = all cores (default 0)\n"
+        << "  --no-shrink               report the failing case without minimizing it\n"
+        << "Compares Game against the frozen ReferenceGame; exits 1 on the first difference.\n";
+}
+
+// Row by row, in the format `sfml_2048_perft --board` reads.
+std::string boardText(const Game::Grid &grid) {
+    std::string text;
+    for (const auto &row : grid) {
+        for (const int value : row) {
+            if (!text.empty()) {
+                text += ',';
+            }
+            text += std::to_string(value);
+        }
+    }
+    return text;
+}
+
+std::string movesText(const std::vector<core2048::Direction> &moves) {
+    constexpr std::string_view kLetters = "UDLR";
+    std::string text;
+    for (const auto move : moves) {
+        text += kLetters[static_cast<std::size_t>(move)];
+    }
+    return text;
+}
+
+void printMismatch(std::ostream &out, const std::string_view title,
+                   const sim2048::DiffMismatch &mismatch) {
+    out << title << ":\n"
+        << "  seed   " << mismatch.seed << "\n"
+        << "  field  " << mismatch.field << "\n"
+        << "  start  " << boardText(mismatch.start) << "\n"
+        << "  moves  " << movesText(mismatch.moves) << "\n"
+        << "  before " << boardText(mismatch.board) << " (score " << mismatch.score << ")\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    sim2048::DiffCheckConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help") {
+            printUsage(std::cout);
+            return 0;
+        }
+        if (arg == "--no-shrink") {
+            config.shrink = false;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            std::cerr << "sfml_2048_diffcheck: " << arg << " needs a value\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+
+        const std::string_view value = argv[++i];
+        std::uint64_t number = 0;
+        if (!sim2048::parseUnsigned(value, number)) {
+            std::cerr << "sfml_2048_diffcheck: invalid value for " << arg << ": " << value
+                      << "\n";
+            return 2;
+        }
+
+        constexpr std::uint64_t kMaxU32 = std::numeric_limits<std::uint32_t>::max();
+        if (arg == "--moves") {
+            config.moves = number;
+        } else if (arg == "--moves-per-case" && number > 0U && number <= kMaxU32) {
+            config.movesPerCase = static_cast<std::uint32_t>(number);
+        } else if (arg == "--first-seed" && number <= kMaxU32) {
+            config.firstSeed = static_cast<std::uint32_t>(number);
+        } else if (arg == "--threads" && number <= 1024U) {
+            config.threads = static_cast<unsigned int>(number);
+        } else {
+            std::cerr << "sfml_2048_diffcheck: unknown option or value out of range: " << arg
+                      << "\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+    }
+
+    const auto reportProgress = [](const std::uint64_t checked, const std::uint64_t total) {
+        const double percent = total == 0U ? 100.0
+                                           : 100.0 * static_cast<double>(checked) /
+                                                 static_cast<double>(total);
+        std::cerr << "\rchecked " << checked << " / " << total << " moves (" << percent << "%)"
+                  << std::flush;
+    };
+
+    sim2048::DiffCheckResult result;
+    std::string error;
+    const bool ok = sim2048::runDifferentialCheck(config, result, error, reportProgress);
+    std::cerr << "\n";
+    if (!ok) {
+        std::cerr << "sfml_2048_diffcheck: " << error << "\n";
+        return 1;
+    }
+
+    const double seconds = std::chrono::duration<double>(result.elapsed).count();
+    const double movesPerSecond =
+        seconds > 0.0 ? static_cast<double>(result.moves) / seconds : 0.0;
+    std::cout << "compared " << result.moves << " moves in " << result.cases << " cases in "
+              << std::fixed << std::setprecision(3) << seconds << " s (" << std::setprecision(0)
+              << movesPerSecond << " moves/s)\n";
+
+    if (!result.mismatch.has_value()) {
+        std::cout << "no differences\n";
+        return 0;
+    }
+    printMismatch(std::cout, "first difference", *result.mismatch);
+    if (result.shrunk.has_value()) {
+        printMismatch(std::cout, "minimal single move", *result.shrunk);
+    } else if (config.shrink) {
+        std::cout << "the failing move does not fail on its own; replay the whole case\n";
+    }
+    return 1;
+}
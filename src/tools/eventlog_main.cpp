@@ -0,0 +1,84 @@
+#include "app/EventLog.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+void printUsage(std::ostream &out) {
+    out << "usage: sfml_2048_eventlog [options] <log.s2el>...\n"
+        << "  --output <path>     write JSON lines here instead of stdout\n"
+        << "Each log is decoded with its rotated files, oldest first: <log>.N ... <log>.1, "
+           "<log>.\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::vector<std::filesystem::path> inputs;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help") {
+            printUsage(std::cout);
+            return 0;
+        }
+        if (!arg.starts_with("--")) {
+            inputs.emplace_back(std::string(arg));
+            continue;
+        }
+        if (arg == "--output" && i + 1 < argc) {
+            outputPath = argv[++i];
+            continue;
+        }
+        std::cerr << "sfml_2048_eventlog: unknown option or missing value: " << arg << "\n";
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    if (inputs.empty()) {
+        std::cerr << "sfml_2048_eventlog: no event logs\n";
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    std::ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath, std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "sfml_2048_eventlog: cannot open " << outputPath << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = outputPath.empty() ? std::cout : file;
+
+    for (const auto &input : inputs) {
+        const auto files = app::eventLogFiles(input);
+        if (files.empty()) {
+            std::cerr << "sfml_2048_eventlog: cannot open " << input.string() << "\n";
+            return 1;
+        }
+        for (const auto &path : files) {
+            app::EventLogFile log;
+            std::string error;
+            if (!app::readEventLog(path, log, error)) {
+                std::cerr << "sfml_2048_eventlog: " << error << "\n";
+                return 1;
+            }
+            for (const auto &record : log.records) {
+                out << app::eventJsonLine(record, log.startedUnixNs) << '\n';
+            }
+            if (log.truncated) {
+                std::cerr << "sfml_2048_eventlog: " << path.string()
+                          << " ends inside a record; it was skipped\n";
+            }
+        }
+    }
+    out.flush();
+    return out ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#include "sim/TrainingData.hpp"
+#include "tools/CommandLine.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace {
+
+void printUsage(std::ostream &out) {
+    out << "usage: sfml_2048_export --output <file.s2td> [options]\n"
+        << "  --output <path>          training data file to write\n"
+        << "  --policy <name>          policy that plays the games (default greedy)\n"
+        << "  --first-seed <uint>      seed of the first game (default 0)\n"
+        << "  --games <uint>           number of games (default 1000)\n"
+        << "  --max-moves <uint>       move cap per game (default 100000)\n"
+        << "  --threads <uint>         simulation threads, 0 = all cores (default 0)\n"
+        << "  --chunk-samples <uint>   samples per chunk (default 65536)\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    sim2048::TrainingExportConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help") {
+            printUsage(std::cout);
+            return 0;
+        }
+
+        if (i + 1 >= argc) {
+            std::cerr << "sfml_2048_export: " << arg << " needs a value\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+
+        const std::string_view value = argv[++i];
+        if (arg == "--output") {
+            config.output = std::string(value);
+            continue;
+        }
+        if (arg == "--policy") {
+            config.policy = std::string(value);
+            continue;
+        }
+
+        std::uint32_t number = 0;
+        if (!sim2048::parseUnsigned(value, number)) {
+            std::cerr << "sfml_2048_export: invalid value for " << arg << ": " << value << "\n";
+            return 2;
+        }
+
+        if (arg == "--first-seed") {
+            config.firstSeed = number;
+        } else if (arg == "--games") {
+            config.games = number;
+        } else if (arg == "--max-moves") {
+            config.maxMoves = static_cast<int>(
+                std::min<std::uint32_t>(number, std::numeric_limits<int>::max()));
+        } else if (arg == "--threads") {
+            config.threads = number;
+        } else if (arg == "--chunk-samples" && number > 0U) {
+            config.chunkSamples = number;
+        } else {
+            std::cerr << "sfml_2048_export: unknown option or value out of range: " << arg
+                      << "\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+    }
+
+    if (config.output.empty()) {
+        std::cerr << "sfml_2048_export: --output is required\n";
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    sim2048::TrainingExportResult result;
+    std::string error;
+    if (!sim2048::exportTrainingData(config, result, error)) {
+        std::cerr << "sfml_2048_export: " << error << "\n";
+        return 1;
+    }
+
+    const double seconds = std::chrono::duration<double>(result.elapsed).count();
+    const double samplesPerSecond =
+        seconds > 0.0 ? static_cast<double>(result.writer.samples) / seconds : 0.0;
+    const double waitMs = std::chrono::duration<double, std::milli>(
+                              result.writer.producerWaitTime)
+                              .count();
+    std::cout << "wrote " << result.writer.samples << " samples from " << result.games
+              << " games in " << result.writer.chunks << " chunks to " << config.output.string()
+              << '\n'
+              << std::fixed << std::setprecision(3) << seconds * 1000.0 << " ms ("
+              << std::setprecision(0) << samplesPerSecond << " samples/s); producers waited for "
+              << "the writer " << result.writer.producerWaits << " times ("
+              << std::setprecision(3) << waitMs << " ms)\n";
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include "app/AssetPack.hpp"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Builds an asset pack: sfml_2048_pack <output.pack> <asset-root> <relative-path>...
+int main(int argc, char *argv[]) {
+    if (argc < 4) {
+        std::cerr << "usage: sfml_2048_pack <output.pack> <asset-root> <relative-path>...\n";
+        return 2;
+    }
+
+    const std::filesystem::path outputPath = argv[1];
+    const std::filesystem::path assetRoot = argv[2];
+
+    std::vector<app::AssetPack::SourceFile> files;
+    for (int i = 3; i < argc; ++i) {
+        const std::filesystem::path relativePath = argv[i];
+        files.push_back({relativePath.generic_string(), assetRoot / relativePath});
+    }
+
+    std::string error;
+    if (!app::AssetPack::write(outputPath, files, error)) {
+        std::cerr << "sfml_2048_pack: " << error << "\n";
+        return 1;
+    }
+
+    const auto pack = app::AssetPack::open(outputPath);
+    if (!pack.has_value() || !pack->verify()) {
+        std::cerr << "sfml_2048_pack: written pack failed verification: " << outputPath.string()
+                  << "\n";
+        return 1;
+    }
+
+    std::cout << "Packed " << pack->entries().size() << " assets into " << outputPath.string()
+              << "\n";
+    return 0;
+}
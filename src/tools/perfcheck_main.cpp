@@ -0,0 +1,436 @@
+#include "sim/PerfCheck.hpp"
+
+#include "app/AudioEventCollector.hpp"
+#include "app/EventLog.hpp"
+#include "app/SliceScheduler.hpp"
+#include "app/SoundSynth.hpp"
+#include "app/VoiceAllocator.hpp"
+#include "core/Game.hpp"
+#include "core/Heuristics.hpp"
+#include "core/MoveSearch.hpp"
+#include "sim/HardwareCounters.hpp"
+#include "tools/CommandLine.hpp"
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifndef SFML_2048_PERF_BASELINE
+#define SFML_2048_PERF_BASELINE ""
+#endif
+#ifndef SFML_2048_BUILD_TYPE
+#define SFML_2048_BUILD_TYPE ""
+#endif
+
+namespace {
+
+using core2048::Direction;
+using core2048::Game;
+using core2048::PackedBoard;
+
+// Exit code ctest reports as skipped: there is nothing to compare against.
+constexpr int kSkipped = 77;
+constexpr std::size_t kBoardCount = 256;
+constexpr const char *kCalibration = "calibration";
+
+// Keeps results alive so the compiler cannot drop the measured work.
+volatile std::uint64_t sink = 0;
+
+void printUsage(std::ostream &out) {
+    out << "usage: sfml_2048_perfcheck [options]\n"
+        << "  --baseline <path>         baseline JSON (default: this build's file in "
+           "perf/baselines)\n"
+        << "  --update-baseline         record the medians as the new baseline and exit\n"
+        << "  --threshold <percent>     slowdown that fails a quiet benchmark (default 10)\n"
+        << "  --repetitions <uint>      timed samples per benchmark (default 7)\n"
+        << "  --sample-ms <uint>        length of one sample in milliseconds (default 40)\n"
+        << "  --counters                print hardware counters per operation instead (Linux)\n"
+        << "Exits 1 when a benchmark got slower than allowed and 77 when there is no "
+           "baseline,\n"
+        << "or with --counters, no hardware counters.\n";
+}
+
+std::string compilerName() {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+    return "unknown";
+#endif
+}
+
+// Positions from real play: each seed plays a different number of random moves.
+std::vector<Game::Grid> sampleGrids() {
+    std::vector<Game::Grid> grids;
+    grids.reserve(kBoardCount);
+    std::mt19937 rng(2048);
+    for (std::size_t i = 0; i < kBoardCount; ++i) {
+        Game game(static_cast<std::uint32_t>(i));
+        const std::size_t moves = i % 200U;
+        for (std::size_t m = 0; m < moves && !game.isGameOver(); ++m) {
+            game.applyMove(static_cast<Direction>(rng() % 4U));
+        }
+        grids.push_back(game.getGrid());
+    }
+    return grids;
+}
+
+std::vector<PackedBoard> packedBoards(const std::vector<Game::Grid> &grids) {
+    std::vector<PackedBoard> boards;
+    boards.reserve(grids.size());
+    for (const auto &grid : grids) {
+        boards.push_back(core2048::packBoard(grid));
+    }
+    return boards;
+}
+
+std::vector<sim2048::PerfBenchmark> coreBenchmarks(const std::vector<Game::Grid> &grids,
+                                                   const std::vector<PackedBoard> &boards,
+                                                   const core2048::BoardEvaluator &evaluator) {
+    auto applyMoves = [seed = std::uint32_t{0}]() mutable {
+        constexpr std::uint64_t kMoves = 1024;
+        Game game(seed++);
+        int stuck = 0;
+        for (std::uint64_t i = 0; i < kMoves; ++i) {
+            const auto result = game.applyMove(static_cast<Direction>(i % 4U));
+            stuck = result.moved ? 0 : stuck + 1;
+            if (stuck == 4) {
+                game.reset(seed++);
+                stuck = 0;
+            }
+        }
+        sink = sink + static_cast<std::uint64_t>(game.getScore());
+        return kMoves;
+    };
+
+    const auto slideGrids = [&grids] {
+        std::uint64_t merges = 0;
+        for (const auto &grid : grids) {
+            for (int d = 0; d < 4; ++d) {
+                Game::Grid copy = grid;
+                merges += static_cast<std::uint64_t>(
+                    Game::slide(copy, static_cast<Direction>(d)).mergeCount);
+            }
+        }
+        sink = sink + merges;
+        return std::uint64_t{4} * grids.size();
+    };
+
+    const auto movePacked = [&boards] {
+        PackedBoard mixed = 0;
+        for (const PackedBoard board : boards) {
+            for (int d = 0; d < 4; ++d) {
+                mixed ^= core2048::movePackedBoard(board, static_cast<Direction>(d));
+            }
+        }
+        sink = sink + mixed;
+        return std::uint64_t{4} * boards.size();
+    };
+
+    const auto evaluate = [&boards, &evaluator] {
+        float total = 0.0F;
+        for (const PackedBoard board : boards) {
+            total += evaluator.evaluate(board);
+        }
+        sink = sink + static_cast<std::uint64_t>(total != 0.0F);
+        return std::uint64_t{boards.size()};
+    };
+
+    auto evaluateBatch = [&boards, &evaluator,
+                          scores = std::vector<float>(boards.size())]() mutable {
+        evaluator.evaluateBatch(boards, scores);
+        sink = sink + static_cast<std::uint64_t>(scores.front() != 0.0F);
+        return std::uint64_t{boards.size()};
+    };
+
+    // Nodes per second of a depth-2 expectimax search from a mid-game position.
+    const auto searchNodes = [&grids, &evaluator] {
+        core2048::MoveSearch search(evaluator, grids[150], 2);
+        search.runToEnd();
+        return search.progress().nodes;
+    };
+
+    return {{"game_apply_move", std::move(applyMoves)},
+            {"game_slide", slideGrids},
+            {"packed_move", movePacked},
+            {"evaluate", evaluate},
+            {"evaluate_batch", std::move(evaluateBatch)},
+            {"search_nodes", searchNodes}};
+}
+
+// The per-frame work of the app that does not need a window: audio event collection, voice
+// assignment, hint slice scheduling and merge tone synthesis.
+std::vector<sim2048::PerfBenchmark> frameBenchmarks() {
+    using app::SoundEffect;
+    using app::soundEffectIndex;
+
+    app::AudioEventCollector::RetriggerIntervals intervals{};
+    intervals[soundEffectIndex(SoundEffect::TileSlide)] = std::chrono::milliseconds(45);
+    intervals[soundEffectIndex(SoundEffect::Merge)] = std::chrono::milliseconds(45);
+    intervals[soundEffectIndex(SoundEffect::Spawn)] = std::chrono::milliseconds(60);
+    auto collectAudio = [collector = app::AudioEventCollector(intervals),
+                         now = app::AudioEventCollector::Clock::time_point{}]() mutable {
+        constexpr std::uint64_t kFrames = 256;
+        app::AudioEventCollector::FrameEvents events{};
+        std::uint64_t emitted = 0;
+        for (std::uint64_t frame = 0; frame < kFrames; ++frame) {
+            collector.trigger(SoundEffect::TileSlide);
+            collector.trigger(SoundEffect::Merge, 2, 64);
+            collector.trigger(SoundEffect::Merge, 1, 128);
+            collector.trigger(SoundEffect::Spawn);
+            now += std::chrono::milliseconds(16);
+            emitted += collector.flush(now, events);
+        }
+        sink = sink + emitted;
+        return kFrames;
+    };
+
+    app::VoiceAllocator::PolyphonyLimits limits{};
+    limits[soundEffectIndex(SoundEffect::TileSlide)] = 3;
+    limits[soundEffectIndex(SoundEffect::Merge)] = 4;
+    limits[soundEffectIndex(SoundEffect::Spawn)] = 2;
+    limits[soundEffectIndex(SoundEffect::GameOver)] = 1;
+    limits[soundEffectIndex(SoundEffect::HighScore)] = 1;
+    auto acquireVoices = [allocator = app::VoiceAllocator(limits)]() mutable {
+        constexpr std::uint64_t kAcquisitions = 256;
+        app::VoiceAllocator::VoiceFlags busy{};
+        std::uint64_t voices = 0;
+        for (std::uint64_t i = 0; i < kAcquisitions; ++i) {
+            const auto acquired = allocator.acquire(static_cast<SoundEffect>(i % 3U), busy);
+            busy[acquired.voice] = i % 5U != 0U;
+            voices += acquired.voice;
+        }
+        sink = sink + voices;
+        return kAcquisitions;
+    };
+
+    auto scheduleSlices = [scheduler = app::SliceScheduler()]() mutable {
+        constexpr std::uint64_t kFrames = 256;
+        std::int64_t total = 0;
+        for (std::uint64_t i = 0; i < kFrames; ++i) {
+            const auto work = static_cast<std::int64_t>(2000U + (i * 37U) % 5000U);
+            scheduler.recordFrameWork(std::chrono::microseconds(work));
+            total += scheduler.nextSlice().count();
+        }
+        sink = sink + static_cast<std::uint64_t>(total);
+        return kFrames;
+    };
+
+    // Samples per second, cycling through the tone range.
+    auto synthesizeTones = [exponent = app::kMinMergeToneExponent]() mutable {
+        const app::PcmSamples samples = app::synthesizeMergeTone(exponent);
+        exponent = exponent == app::kMaxMergeToneExponent ? app::kMinMergeToneExponent
+                                                          : exponent + 1;
+        sink = sink + static_cast<std::uint64_t>(samples.back());
+        return std::uint64_t{samples.size()};
+    };
+
+    // Game-thread cost of an event: the clock read and the ring buffer push. The drain keeps the
+    // ring from filling and is counted too, so this is an upper bound.
+    auto recordEvents = [log = std::make_shared<app::EventLog>(app::EventLogConfig{}),
+                         records = std::vector<app::EventRecord>()]() mutable {
+        constexpr std::uint64_t kEvents = 256;
+        for (std::uint64_t i = 0; i < kEvents; ++i) {
+            log->record(app::EventType::Sound, 1, 1, static_cast<std::uint32_t>(i), 0);
+        }
+        records.clear();
+        sink = sink + log->drain(records);
+        return kEvents;
+    };
+
+    return {{"audio_frame", std::move(collectAudio)},
+            {"voice_acquire", std::move(acquireVoices)},
+            {"event_record", std::move(recordEvents)},
+            {"slice_schedule", std::move(scheduleSlices)},
+            {"merge_tone_synth", std::move(synthesizeTones)}};
+}
+
+// A fixed chain of multiplies and shifts; its speed follows the CPU clock, not this code.
+sim2048::PerfBenchmark calibrationBenchmark() {
+    const auto mix = [] {
+        constexpr std::uint64_t kRounds = 1U << 16U;
+        std::uint64_t x = sink | 1U;
+        for (std::uint64_t i = 0; i < kRounds; ++i) {
+            x ^= x >> 29U;
+            x *= 0xBF58476D1CE4E5B9ULL;
+        }
+        sink = x;
+        return kRounds;
+    };
+    return {kCalibration, mix};
+}
+
+std::vector<sim2048::PerfMeasurement>
+measureAll(const std::vector<sim2048::PerfBenchmark> &benchmarks,
+           const sim2048::PerfRunConfig &config) {
+    const auto reportProgress = [](const std::uint64_t rounds, const std::uint64_t total) {
+        std::cerr << "\rround " << rounds << " / " << total << std::flush;
+    };
+    auto measurements = sim2048::measureBenchmarks(benchmarks, config, reportProgress);
+    std::cerr << "\n";
+    return measurements;
+}
+
+// One counted sample per benchmark, after the same warm-up as the timed ones.
+int printCounters(const std::vector<sim2048::PerfBenchmark> &benchmarks,
+                  const sim2048::PerfRunConfig &config) {
+    sim2048::HardwareCounters counters;
+    std::string error;
+    if (!counters.open(error)) {
+        std::cout << "no hardware counters: " << error << "\n";
+        return kSkipped;
+    }
+    std::vector<std::pair<std::string, sim2048::HardwareCounts>> rows;
+    for (const auto &benchmark : benchmarks) {
+        rows.emplace_back(benchmark.name,
+                          sim2048::countPerOperation(counters, benchmark, config.sampleTime));
+        std::cerr << "\rcounted " << rows.size() << " / " << benchmarks.size() << std::flush;
+    }
+    std::cerr << "\n";
+    std::cout << "per operation, user space only\n" << sim2048::formatHardwareCounts(rows);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string baselinePath = SFML_2048_PERF_BASELINE;
+    bool updateBaseline = false;
+    bool countersOnly = false;
+    sim2048::PerfRunConfig runConfig;
+    sim2048::PerfCompareConfig compareConfig;
+    compareConfig.calibration = kCalibration;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help") {
+            printUsage(std::cout);
+            return 0;
+        }
+        if (arg == "--update-baseline") {
+            updateBaseline = true;
+            continue;
+        }
+        if (arg == "--counters") {
+            countersOnly = true;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            std::cerr << "sfml_2048_perfcheck: " << arg << " needs a value\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+
+        const std::string_view value = argv[++i];
+        if (arg == "--baseline") {
+            baselinePath = value;
+            continue;
+        }
+
+        std::uint64_t number = 0;
+        if (!sim2048::parseUnsigned(value, number)) {
+            std::cerr << "sfml_2048_perfcheck: invalid value for " << arg << ": " << value
+                      << "\n";
+            return 2;
+        }
+        if (arg == "--threshold" && number > 0U && number < 100U) {
+            compareConfig.threshold = static_cast<double>(number) / 100.0;
+        } else if (arg == "--repetitions" && number > 0U && number <= 1000U) {
+            runConfig.repetitions = static_cast<unsigned int>(number);
+        } else if (arg == "--sample-ms" && number > 0U && number <= 60'000U) {
+            runConfig.sampleTime = std::chrono::milliseconds(number);
+        } else {
+            std::cerr << "sfml_2048_perfcheck: unknown option or value out of range: " << arg
+                      << "\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+    }
+    if (baselinePath.empty() && !countersOnly) {
+        std::cerr << "sfml_2048_perfcheck: no baseline path; pass --baseline\n";
+        return 2;
+    }
+
+    sim2048::PerfBaseline baseline;
+    std::string error;
+    if (!updateBaseline && !countersOnly &&
+        !sim2048::loadPerfBaseline(baselinePath, baseline, error)) {
+        std::cout << "no usable baseline (" << error << "); record one with --update-baseline\n";
+        return kSkipped;
+    }
+
+    const auto grids = sampleGrids();
+    const auto boards = packedBoards(grids);
+    const core2048::BoardEvaluator evaluator;
+    std::vector<sim2048::PerfBenchmark> benchmarks = {calibrationBenchmark()};
+    for (auto &benchmark : coreBenchmarks(grids, boards, evaluator)) {
+        benchmarks.push_back(std::move(benchmark));
+    }
+    for (auto &benchmark : frameBenchmarks()) {
+        benchmarks.push_back(std::move(benchmark));
+    }
+
+    if (countersOnly) {
+        return printCounters(benchmarks, runConfig);
+    }
+
+    auto measurements = measureAll(benchmarks, runConfig);
+
+    if (updateBaseline) {
+        sim2048::PerfBaseline recorded;
+        recorded.buildType = SFML_2048_BUILD_TYPE;
+        recorded.compiler = compilerName();
+        recorded.benchmarks = std::move(measurements);
+        if (!sim2048::savePerfBaseline(baselinePath, recorded, error)) {
+            std::cerr << "sfml_2048_perfcheck: " << error << "\n";
+            return 1;
+        }
+        std::cout << "wrote " << baselinePath << "\n";
+        return 0;
+    }
+
+    auto comparisons = sim2048::comparePerf(baseline, measurements, compareConfig);
+    if (sim2048::hasRegression(comparisons)) {
+        // A slowdown has to show up twice: measure every regressed benchmark again and keep the
+        // faster run, so one unlucky burst of load does not fail the check.
+        std::vector<sim2048::PerfBenchmark> retry;
+        for (const auto &comparison : comparisons) {
+            if (comparison.status == sim2048::PerfComparison::Status::Regressed) {
+                for (const auto &benchmark : benchmarks) {
+                    if (benchmark.name == comparison.name) {
+                        retry.push_back(benchmark);
+                    }
+                }
+            }
+        }
+        std::cout << "re-measuring " << retry.size() << " slower benchmark(s)\n";
+        for (const auto &again : measureAll(retry, runConfig)) {
+            for (auto &measurement : measurements) {
+                if (measurement.name == again.name && again.median > measurement.median) {
+                    measurement = again;
+                }
+            }
+        }
+        comparisons = sim2048::comparePerf(baseline, measurements, compareConfig);
+    }
+
+    std::cout << "baseline " << baselinePath << " (" << baseline.compiler << ", "
+              << (baseline.buildType.empty() ? "no build type" : baseline.buildType) << ")\n"
+              << sim2048::formatPerfComparison(comparisons);
+    if (sim2048::hasRegression(comparisons)) {
+        std::cout << "throughput regressed; if the slowdown is intended, rerun with "
+                     "--update-baseline and commit the file\n";
+        return 1;
+    }
+    return 0;
+}
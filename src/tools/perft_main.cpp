@@ -0,0 +1,133 @@
+#include "sim/Perft.hpp"
+#include "tools/CommandLine.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace {
+
+using core2048::Game;
+
+void printUsage(std::ostream &out) {
+    out << "usage: sfml_2048_perft [options]\n"
+        << "  --depth <uint>              plies to enumerate, move + spawn each (default 4)\n"
+        << "  --seed <uint>               start from the opening board of Game(seed) (default 1)\n"
+        << "  --board <16 cells>          start from this board, comma-separated, row by row\n"
+        << "  --threads <uint>            worker threads, 0 = all cores (default 0)\n"
+        << "  --expect-paths <uint>       exit 1 unless the deepest layer has this many paths\n"
+        << "  --expect-positions <uint>   exit 1 unless it has this many distinct positions\n";
+}
+
+bool parseBoard(std::string_view text, Game::Grid &grid) {
+    std::size_t cell = 0;
+    while (true) {
+        const std::size_t comma = std::min(text.find(','), text.size());
+        std::uint64_t value = 0;
+        if (cell >= 16U || !sim2048::parseUnsigned(text.substr(0, comma), value) ||
+            value > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+            return false;
+        }
+        grid[cell / 4U][cell % 4U] = static_cast<int>(value);
+        ++cell;
+        if (comma == text.size()) {
+            return cell == 16U;
+        }
+        text.remove_prefix(comma + 1U);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::uint64_t depth = 4;
+    std::uint64_t threads = 0;
+    Game::Grid start = Game(1U).getGrid();
+    std::optional<std::uint64_t> expectPaths;
+    std::optional<std::uint64_t> expectPositions;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help") {
+            printUsage(std::cout);
+            return 0;
+        }
+
+        if (i + 1 >= argc) {
+            std::cerr << "sfml_2048_perft: " << arg << " needs a value\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+
+        const std::string_view value = argv[++i];
+        if (arg == "--board") {
+            if (!parseBoard(value, start)) {
+                std::cerr << "sfml_2048_perft: --board needs 16 comma-separated numbers\n";
+                return 2;
+            }
+            continue;
+        }
+
+        std::uint64_t number = 0;
+        if (!sim2048::parseUnsigned(value, number)) {
+            std::cerr << "sfml_2048_perft: invalid value for " << arg << ": " << value << "\n";
+            return 2;
+        }
+
+        if (arg == "--depth" && number <= 64U) {
+            depth = number;
+        } else if (arg == "--seed" && number <= std::numeric_limits<std::uint32_t>::max()) {
+            start = Game(static_cast<std::uint32_t>(number)).getGrid();
+        } else if (arg == "--threads" && number <= 1024U) {
+            threads = number;
+        } else if (arg == "--expect-paths") {
+            expectPaths = number;
+        } else if (arg == "--expect-positions") {
+            expectPositions = number;
+        } else {
+            std::cerr << "sfml_2048_perft: unknown option or value out of range: " << arg << "\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+    }
+
+    sim2048::PerftResult result;
+    std::string error;
+    if (!sim2048::runPerft(start, static_cast<int>(depth), static_cast<unsigned int>(threads),
+                           result, error)) {
+        std::cerr << "sfml_2048_perft: " << error << "\n";
+        return 1;
+    }
+
+    std::cout << "depth " << std::setw(20) << "paths" << ' ' << std::setw(14) << "positions"
+              << '\n';
+    for (std::size_t ply = 0; ply < result.layers.size(); ++ply) {
+        std::cout << std::setw(5) << ply << ' ' << std::setw(20) << result.layers[ply].paths << ' '
+                  << std::setw(14) << result.layers[ply].positions << '\n';
+    }
+
+    const double seconds = std::chrono::duration<double>(result.elapsed).count();
+    const double nodesPerSecond =
+        seconds > 0.0 ? static_cast<double>(result.generated) / seconds : 0.0;
+    std::cout << "generated " << result.generated << " nodes in " << std::fixed
+              << std::setprecision(3) << seconds * 1000.0 << " ms (" << std::setprecision(0)
+              << nodesPerSecond << " nodes/s)\n";
+
+    const auto &last = result.layers.back();
+    bool matches = true;
+    if (expectPaths.has_value() && *expectPaths != last.paths) {
+        std::cerr << "sfml_2048_perft: expected " << *expectPaths << " paths, got " << last.paths
+                  << "\n";
+        matches = false;
+    }
+    if (expectPositions.has_value() && *expectPositions != last.positions) {
+        std::cerr << "sfml_2048_perft: expected " << *expectPositions << " positions, got "
+                  << last.positions << "\n";
+        matches = false;
+    }
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+#include "sim/SeedSearch.hpp"
+#include "tools/CommandLine.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace {
+
+std::atomic<bool> gCancel{false};
+
+extern "C" void handleInterrupt(int) {
+    gCancel.store(true);
+}
+
+void printUsage(std::ostream &out) {
+    out << "usage: sfml_2048_seedsearch --predicate <p> [options]\n"
+        << "  --predicate <p>        reach:<tile> | opening:<16 cells, * = any> | max-score\n"
+        << "  --policy <name>        policy that plays the games (default greedy)\n"
+        << "  --first-seed <uint>    first seed (default 0)\n"
+        << "  --last-seed <uint>     last seed, inclusive (default 4294967295)\n"
+        << "  --max-moves <uint>     move cap per game (default 100000)\n"
+        << "  --limit <uint>         stop after this many matches; max-score: seeds kept (10)\n"
+        << "  --threads <uint>       worker threads, 0 = all cores (default 0)\n"
+        << "  --block-size <uint>    seeds per work block (default 4096)\n"
+        << "  --checkpoint <path>    save progress here (every --checkpoint-interval seconds)\n"
+        << "  --checkpoint-interval <uint>  seconds between checkpoints (default 60)\n"
+        << "  --resume               continue from --checkpoint\n"
+        << "  --output <path>        write JSON lines here instead of stdout\n"
+        << "Ctrl+C stops the search, saves the checkpoint and prints what was found.\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    sim2048::SeedSearchConfig config;
+    bool hasPredicate = false;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help") {
+            printUsage(std::cout);
+            return 0;
+        }
+        if (arg == "--resume") {
+            config.resume = true;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            std::cerr << "sfml_2048_seedsearch: " << arg << " needs a value\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+
+        const std::string_view value = argv[++i];
+        if (arg == "--predicate") {
+            std::string error;
+            if (!sim2048::parseSeedPredicate(value, config.predicate, error)) {
+                std::cerr << "sfml_2048_seedsearch: " << error << "\n";
+                return 2;
+            }
+            hasPredicate = true;
+            continue;
+        }
+        if (arg == "--policy") {
+            config.policy = std::string(value);
+            continue;
+        }
+        if (arg == "--checkpoint") {
+            config.checkpointPath = std::string(value);
+            continue;
+        }
+        if (arg == "--output") {
+            outputPath = std::string(value);
+            continue;
+        }
+
+        std::uint32_t number = 0;
+        if (!sim2048::parseUnsigned(value, number)) {
+            std::cerr << "sfml_2048_seedsearch: invalid value for " << arg << ": " << value
+                      << "\n";
+            return 2;
+        }
+
+        if (arg == "--first-seed") {
+            config.seeds.begin = number;
+        } else if (arg == "--last-seed") {
+            config.seeds.end = std::uint64_t{number} + 1U;
+        } else if (arg == "--max-moves") {
+            config.maxMoves = static_cast<int>(
+                std::min<std::uint32_t>(number, std::numeric_limits<int>::max()));
+        } else if (arg == "--limit") {
+            config.limit = number;
+        } else if (arg == "--threads") {
+            config.threads = number;
+        } else if (arg == "--block-size") {
+            config.blockSize = number;
+        } else if (arg == "--checkpoint-interval") {
+            config.checkpointInterval = std::chrono::seconds(number);
+        } else {
+            std::cerr << "sfml_2048_seedsearch: unknown option: " << arg << "\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+    }
+
+    if (!hasPredicate) {
+        std::cerr << "sfml_2048_seedsearch: --predicate is required\n";
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    std::ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath, std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "sfml_2048_seedsearch: cannot open " << outputPath << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = outputPath.empty() ? std::cout : file;
+
+    std::signal(SIGINT, handleInterrupt);
+    std::signal(SIGTERM, handleInterrupt);
+
+    const auto reportProgress = [](const std::uint64_t searched, const std::uint64_t total) {
+        const double percent = total == 0U ? 100.0
+                                           : 100.0 * static_cast<double>(searched) /
+                                                 static_cast<double>(total);
+        std::cerr << "\rsearched " << searched << " / " << total << " seeds (" << percent << "%)"
+                  << std::flush;
+    };
+
+    sim2048::SeedSearchResult result;
+    std::string error;
+    const bool ok = sim2048::runSeedSearch(config, gCancel, result, error, reportProgress);
+    std::cerr << "\n";
+    // Setup errors leave `result` empty; a failed checkpoint write still reports what was found.
+    if (!ok && result.total == 0U) {
+        std::cerr << "sfml_2048_seedsearch: " << error << "\n";
+        return 1;
+    }
+
+    for (const auto &match : result.matches) {
+        nlohmann::json line;
+        line["type"] = "seed";
+        line["seed"] = match.seed;
+        line["score"] = match.outcome.score;
+        line["max_tile"] = match.outcome.maxTile;
+        line["moves"] = match.outcome.moves;
+        out << line.dump() << '\n';
+    }
+
+    nlohmann::json summary;
+    summary["type"] = "search";
+    summary["predicate"] = sim2048::describeSeedPredicate(config.predicate);
+    summary["policy"] = config.policy;
+    summary["searched"] = result.searched;
+    summary["total"] = result.total;
+    summary["matches"] = result.matches.size();
+    summary["completed"] = result.completed;
+    out << summary.dump() << '\n';
+    out.flush();
+
+    if (!ok) {
+        std::cerr << "sfml_2048_seedsearch: " << error << "\n";
+        return 1;
+    }
+    if (gCancel.load() && !config.checkpointPath.empty()) {
+        std::cerr << "sfml_2048_seedsearch: interrupted; rerun with --resume to continue\n";
+    }
+    return out ? 0 : 1;
+}
@@ -0,0 +1,314 @@
+#include "sim/HardwareCounters.hpp"
+#include "sim/Report.hpp"
+#include "sim/ShardFile.hpp"
+#include "sim/Simulation.hpp"
+#include "tools/CommandLine.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char **environ;
+#endif
+
+namespace {
+
+constexpr std::string_view kToolName = "sfml_2048_sim";
+
+void printUsage(std::ostream &out) {
+    out << "usage: sfml_2048_sim <command> [options]\n"
+        << "  shard --policy <name> --output <file> [--first-seed S] [--seeds N] [--max-moves M]\n"
+        << "      [--counters]\n"
+        << "      play seeds [S, S + N) in this process and write a partial result file;\n"
+        << "      --counters prints hardware counters per game and per move (Linux)\n"
+        << "  run --policy <name> --output-dir <dir> [--shards K] [--first-seed S] [--seeds N]\n"
+        << "      [--max-moves M]\n"
+        << "      split the seeds across K shard processes, merge them and print the report\n"
+        << "  merge [--output <file>] <shard>...\n"
+        << "      merge partial result files (from any machine) and print the report\n"
+        << "Defaults: --first-seed 1, --seeds 100, --max-moves 100000, --shards = cores.\n";
+}
+
+int fail(const std::string &message) {
+    std::cerr << kToolName << ": " << message << "\n";
+    return 1;
+}
+
+int usageError(const std::string &message) {
+    std::cerr << kToolName << ": " << message << "\n";
+    printUsage(std::cerr);
+    return 2;
+}
+
+struct Options {
+    std::string policy;
+    std::uint32_t firstSeed{1};
+    std::uint32_t seedCount{100};
+    std::uint32_t shards{0};
+    int maxMoves{100000};
+    bool counters{false};
+    std::filesystem::path output;
+    std::filesystem::path outputDir;
+    std::vector<std::filesystem::path> inputs;
+};
+
+// Parses `args` after the command name; positional arguments are collected as inputs.
+bool parseOptions(const std::vector<std::string_view> &args, Options &options,
+                  std::string &error) {
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        const std::string_view arg = args[i];
+        if (!arg.starts_with("--")) {
+            options.inputs.emplace_back(arg);
+            continue;
+        }
+        if (arg == "--counters") {
+            options.counters = true;
+            continue;
+        }
+        if (i + 1U >= args.size()) {
+            error = std::string(arg) + " needs a value";
+            return false;
+        }
+
+        const std::string_view value = args[++i];
+        if (arg == "--policy") {
+            options.policy = std::string(value);
+            continue;
+        }
+        if (arg == "--output") {
+            options.output = std::filesystem::path(value);
+            continue;
+        }
+        if (arg == "--output-dir") {
+            options.outputDir = std::filesystem::path(value);
+            continue;
+        }
+
+        std::uint32_t number = 0;
+        if (!sim2048::parseUnsigned(value, number)) {
+            error = "invalid value for " + std::string(arg) + ": " + std::string(value);
+            return false;
+        }
+
+        if (arg == "--first-seed") {
+            options.firstSeed = number;
+        } else if (arg == "--seeds") {
+            options.seedCount = number;
+        } else if (arg == "--shards") {
+            options.shards = number;
+        } else if (arg == "--max-moves") {
+            options.maxMoves =
+                static_cast<int>(std::min<std::uint32_t>(number, std::numeric_limits<int>::max()));
+        } else {
+            error = "unknown option: " + std::string(arg);
+            return false;
+        }
+    }
+
+    // `run` hands out sub-ranges as --first-seed values, so the range must not wrap past 2^32.
+    if (std::uint64_t{options.firstSeed} + options.seedCount > std::uint64_t{1} << 32U) {
+        error = "--first-seed " + std::to_string(options.firstSeed) + " with --seeds " +
+                std::to_string(options.seedCount) + " runs past the last 32-bit seed";
+        return false;
+    }
+    return true;
+}
+
+// Starts `program` with `args` and returns a handle to wait on, or -1.
+std::intptr_t spawnProcess(const std::string &program, const std::vector<std::string> &args) {
+#if defined(_WIN32)
+    // _spawnv joins argv with spaces, so arguments with spaces must be quoted.
+    std::vector<std::string> quoted;
+    quoted.reserve(args.size() + 1U);
+    quoted.push_back('"' + program + '"');
+    for (const auto &arg : args) {
+        quoted.push_back('"' + arg + '"');
+    }
+    std::vector<const char *> argv;
+    for (const auto &arg : quoted) {
+        argv.push_back(arg.c_str());
+    }
+    argv.push_back(nullptr);
+    return _spawnv(_P_NOWAIT, program.c_str(), argv.data());
+#else
+    std::vector<char *> argv;
+    argv.push_back(const_cast<char *>(program.c_str()));
+    for (const auto &arg : args) {
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = 0;
+    if (::posix_spawnp(&pid, program.c_str(), nullptr, nullptr, argv.data(), environ) != 0) {
+        return -1;
+    }
+    return pid;
+#endif
+}
+
+// Waits for a process started by `spawnProcess` and returns whether it exited with status 0.
+bool waitForProcess(const std::intptr_t handle) {
+#if defined(_WIN32)
+    int status = 0;
+    return _cwait(&status, handle, _WAIT_CHILD) != -1 && status == 0;
+#else
+    int status = 0;
+    pid_t result = 0;
+    do {
+        result = ::waitpid(static_cast<pid_t>(handle), &status, 0);
+    } while (result < 0 && errno == EINTR);
+    return result >= 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+}
+
+int printReport(const std::vector<std::filesystem::path> &inputs,
+                const std::filesystem::path &output) {
+    sim2048::ShardInfo info;
+    sim2048::OutcomeAccumulator merged;
+    std::string error;
+    if (!sim2048::mergeShardFiles(inputs, output, info, merged, error)) {
+        return fail(error);
+    }
+    std::cout << sim2048::aggregateJsonLine(info.policy, merged.summary()) << '\n';
+    return std::cout.flush() ? 0 : 1;
+}
+
+int runShard(const Options &options) {
+    if (options.policy.empty() || options.output.empty()) {
+        return usageError("shard needs --policy and --output");
+    }
+    std::string error;
+    sim2048::HardwareCounters counters;
+    if (options.counters && !counters.open(error)) {
+        // The games are still worth playing; only the counter table is lost.
+        std::cerr << kToolName << ": no hardware counters: " << error << "\n";
+    }
+    counters.start();
+    if (!sim2048::simulateShard(options.policy, options.firstSeed, options.seedCount,
+                                options.maxMoves, options.output, error)) {
+        return fail(error);
+    }
+    const sim2048::HardwareCounts counts = counters.stop();
+
+    if (counters.isOpen()) {
+        sim2048::ShardReader reader;
+        if (!reader.open(options.output, error)) {
+            return fail(error);
+        }
+        std::cerr << sim2048::formatHardwareCounts(
+            {{"game", counts.per(reader.summary().games())},
+             {"move", counts.per(reader.summary().totalMoves())}});
+    }
+    return 0;
+}
+
+int runSharded(const std::string &program, const Options &options) {
+    if (options.policy.empty() || options.outputDir.empty()) {
+        return usageError("run needs --policy and --output-dir");
+    }
+    if (sim2048::makePolicy(options.policy, 0U) == nullptr) {
+        return fail("unknown policy: " + options.policy);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.outputDir, ec);
+    if (ec) {
+        return fail("cannot create " + options.outputDir.string() + ": " + ec.message());
+    }
+
+    const std::uint32_t shardCount =
+        std::max(1U, std::min(sim2048::resolveThreadCount(options.shards), options.seedCount));
+
+    // Shard i plays seeds [first + i*N/K, first + (i+1)*N/K).
+    std::vector<std::filesystem::path> shardFiles;
+    std::vector<std::intptr_t> processes;
+    bool spawnFailed = false;
+    for (std::uint32_t shard = 0; shard < shardCount; ++shard) {
+        const auto begin = static_cast<std::uint64_t>(options.seedCount) * shard / shardCount;
+        const auto end = static_cast<std::uint64_t>(options.seedCount) * (shard + 1U) / shardCount;
+        const auto path = options.outputDir / ("shard-" + std::to_string(shard) + ".s2sr");
+
+        const std::vector<std::string> args = {
+            "shard",
+            "--policy",
+            options.policy,
+            "--first-seed",
+            std::to_string(options.firstSeed + begin),
+            "--seeds",
+            std::to_string(end - begin),
+            "--max-moves",
+            std::to_string(options.maxMoves),
+            "--output",
+            path.string(),
+        };
+        const std::intptr_t process = spawnProcess(program, args);
+        if (process < 0) {
+            spawnFailed = true;
+            break;
+        }
+        processes.push_back(process);
+        shardFiles.push_back(path);
+    }
+
+    bool shardsOk = !spawnFailed;
+    for (const auto process : processes) {
+        shardsOk = waitForProcess(process) && shardsOk;
+    }
+    if (spawnFailed) {
+        return fail("cannot start " + program);
+    }
+    if (!shardsOk) {
+        return fail("a shard process failed");
+    }
+    return printReport(shardFiles, options.outputDir / "merged.s2sr");
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        return usageError("missing command");
+    }
+
+    const std::string_view command = argv[1];
+    if (command == "--help" || command == "help") {
+        printUsage(std::cout);
+        return 0;
+    }
+
+    Options options;
+    std::string error;
+    if (!parseOptions(std::vector<std::string_view>(argv + 2, argv + argc), options, error)) {
+        return usageError(error);
+    }
+    if (command != "merge" && !options.inputs.empty()) {
+        return usageError("unexpected argument: " + options.inputs.front().string());
+    }
+
+    if (command == "shard") {
+        return runShard(options);
+    }
+    if (command == "run") {
+        return runSharded(argv[0], options);
+    }
+    if (command == "merge") {
+        if (options.inputs.empty()) {
+            return usageError("merge needs at least one shard file");
+        }
+        return printReport(options.inputs, options.output);
+    }
+    return usageError("unknown command: " + std::string(command));
+}
@@ -0,0 +1,99 @@
+#include "sim/Solver.hpp"
+#include "tools/CommandLine.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+void printUsage(std::ostream &out) {
+    out << "usage: sfml_2048_solve3x3 --dir <path> [options]\n"
+        << "  --dir <path>          layer files and checkpoint; created if missing\n"
+        << "  --size <2|3>          board size (default 3)\n"
+        << "  --threads <uint>      worker threads, 0 = all cores (default 0)\n"
+        << "  --max-layers <uint>   stop after this many layer steps, 0 = no limit (default 0)\n"
+        << "Every finished layer is checkpointed: run again with the same --dir to resume.\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    sim2048::SolverConfig config;
+    std::uint64_t size = 3;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help") {
+            printUsage(std::cout);
+            return 0;
+        }
+
+        if (i + 1 >= argc) {
+            std::cerr << "sfml_2048_solve3x3: " << arg << " needs a value\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+
+        const std::string_view value = argv[++i];
+        if (arg == "--dir") {
+            config.directory = std::string(value);
+            continue;
+        }
+
+        std::uint64_t number = 0;
+        if (!sim2048::parseUnsigned(value, number)) {
+            std::cerr << "sfml_2048_solve3x3: invalid value for " << arg << ": " << value << "\n";
+            return 2;
+        }
+
+        if (arg == "--size" && (number == 2U || number == 3U)) {
+            size = number;
+        } else if (arg == "--threads" && number <= 1024U) {
+            config.threads = static_cast<unsigned int>(number);
+        } else if (arg == "--max-layers") {
+            config.layerBudget = static_cast<std::size_t>(number);
+        } else {
+            std::cerr << "sfml_2048_solve3x3: unknown option or value out of range: " << arg
+                      << "\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+    }
+
+    if (config.directory.empty()) {
+        std::cerr << "sfml_2048_solve3x3: --dir is required\n";
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    sim2048::SolverResult result;
+    std::string error;
+    const bool solved = size == 2U ? sim2048::solveBoard<2>(config, result, error)
+                                   : sim2048::solveBoard<3>(config, result, error);
+    if (!solved) {
+        std::cerr << "sfml_2048_solve3x3: " << error << "\n";
+        return 1;
+    }
+
+    std::cout << "tile sum " << std::setw(14) << "positions" << '\n';
+    for (const auto &layer : result.layers) {
+        std::cout << std::setw(8) << layer.tileSum << ' ' << std::setw(14) << layer.states << '\n';
+    }
+    std::cout << result.totalStates << " positions in " << result.layers.size() << " layers";
+    if (result.resumedSteps > 0U) {
+        std::cout << " (" << result.resumedSteps << " layer steps resumed from checkpoint)";
+    }
+    std::cout << '\n';
+
+    if (!result.completed) {
+        std::cout << "stopped before the solve finished; run again with --dir "
+                  << config.directory.string() << " to continue\n";
+        return 0;
+    }
+    std::cout << "expected score under optimal play: " << std::fixed << std::setprecision(4)
+              << result.expectedScore << '\n';
+    return 0;
+}
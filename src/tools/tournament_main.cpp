@@ -0,0 +1,112 @@
+#include "sim/Tournament.hpp"
+#include "tools/CommandLine.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+void printUsage(std::ostream &out) {
+    out << "usage: sfml_2048_tournament [options]\n"
+        << "  --policies <a,b,...>  policies to compare (default: all of";
+    for (const auto name : sim2048::policyNames()) {
+        out << ' ' << name;
+    }
+    out << ")\n"
+        << "  --seeds <uint>        number of shared seeds (default 100)\n"
+        << "  --first-seed <uint>   first seed (default 1)\n"
+        << "  --threads <uint>      worker threads, 0 = all cores (default 0)\n"
+        << "  --max-moves <uint>    move cap per game (default 100000)\n"
+        << "  --output <path>       write JSON lines here instead of stdout\n";
+}
+
+std::vector<std::string> splitList(const std::string_view text) {
+    std::vector<std::string> items;
+    std::size_t begin = 0;
+    while (begin <= text.size()) {
+        const std::size_t end = std::min(text.find(',', begin), text.size());
+        if (end > begin) {
+            items.emplace_back(text.substr(begin, end - begin));
+        }
+        begin = end + 1U;
+    }
+    return items;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    sim2048::TournamentConfig config;
+    for (const auto name : sim2048::policyNames()) {
+        config.policies.emplace_back(name);
+    }
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help") {
+            printUsage(std::cout);
+            return 0;
+        }
+
+        if (i + 1 >= argc) {
+            std::cerr << "sfml_2048_tournament: " << arg << " needs a value\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+
+        const std::string_view value = argv[++i];
+        if (arg == "--policies") {
+            config.policies = splitList(value);
+            continue;
+        }
+        if (arg == "--output") {
+            outputPath = std::string(value);
+            continue;
+        }
+
+        std::uint32_t number = 0;
+        if (!sim2048::parseUnsigned(value, number)) {
+            std::cerr << "sfml_2048_tournament: invalid value for " << arg << ": " << value
+                      << "\n";
+            return 2;
+        }
+
+        if (arg == "--seeds") {
+            config.seedCount = number;
+        } else if (arg == "--first-seed") {
+            config.firstSeed = number;
+        } else if (arg == "--threads") {
+            config.threads = number;
+        } else if (arg == "--max-moves") {
+            config.maxMoves = static_cast<int>(
+                std::min<std::uint32_t>(number, std::numeric_limits<int>::max()));
+        } else {
+            std::cerr << "sfml_2048_tournament: unknown option: " << arg << "\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+    }
+
+    std::ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath, std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "sfml_2048_tournament: cannot open " << outputPath << "\n";
+            return 1;
+        }
+    }
+
+    std::string error;
+    if (!sim2048::runTournament(config, outputPath.empty() ? std::cout : file, error)) {
+        std::cerr << "sfml_2048_tournament: " << (error.empty() ? "write failed" : error) << "\n";
+        return 1;
+    }
+    return 0;
+}
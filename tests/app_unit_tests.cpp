@@ -0,0 +1,859 @@
+#include "app/AssetPack.hpp"
+#include "app/AssetResolver.hpp"
+#include "app/AudioEventCollector.hpp"
+#include "app/EventLog.hpp"
+#include "app/MetricsExporter.hpp"
+#include "app/SettingsStore.hpp"
+#include "app/SliceScheduler.hpp"
+#include "app/SoundSynth.hpp"
+#include "app/SpscQueue.hpp"
+#include "app/StartupProfiler.hpp"
+#include "app/VoiceAllocator.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using app::SoundEffect;
+using app::VoiceAllocator;
+
+constexpr std::array<SoundEffect, app::kSoundEffectCount> kAllEffects = {
+    SoundEffect::TileSlide, SoundEffect::Merge,     SoundEffect::Spawn,
+    SoundEffect::GameOver,  SoundEffect::HighScore,
+};
+
+VoiceAllocator::PolyphonyLimits uniformLimits(const std::size_t limit) {
+    VoiceAllocator::PolyphonyLimits limits{};
+    limits.fill(limit);
+    return limits;
+}
+
+std::filesystem::path makeUniqueTempDirectory(const std::string &suffix) {
+    const auto timestamp = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    auto directory = std::filesystem::temp_directory_path() /
+                     ("sfml_2048_" + suffix + "_" + std::to_string(timestamp));
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+void writeBytes(const std::filesystem::path &path, const std::string &content) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream out(path, std::ios::binary);
+    out << content;
+}
+
+std::string toString(const app::AssetBytes bytes) {
+    return std::string(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+}
+
+VoiceAllocator::VoiceFlags allBusy() {
+    VoiceAllocator::VoiceFlags flags{};
+    flags.fill(true);
+    return flags;
+}
+
+std::size_t countZeroCrossings(const app::PcmSamples &samples) {
+    std::size_t crossings = 0;
+    for (std::size_t i = 1; i < samples.size(); ++i) {
+        if ((samples[i - 1] < 0) != (samples[i] < 0)) {
+            ++crossings;
+        }
+    }
+    return crossings;
+}
+
+} // namespace
+
+TEST_CASE("voice allocator respects per-effect polyphony limits", "[voice-pool]") {
+    VoiceAllocator allocator(uniformLimits(2));
+
+    VoiceAllocator::VoiceFlags busy{};
+    const auto first = allocator.acquire(SoundEffect::Merge, busy);
+    busy[first.voice] = true;
+    const auto second = allocator.acquire(SoundEffect::Merge, busy);
+    busy[second.voice] = true;
+
+    REQUIRE(first.voice != second.voice);
+    REQUIRE_FALSE(first.stolen);
+    REQUIRE_FALSE(second.stolen);
+    REQUIRE(allocator.activeVoices(SoundEffect::Merge) == 2);
+
+    const auto third = allocator.acquire(SoundEffect::Merge, busy);
+    REQUIRE(third.stolen);
+    REQUIRE(third.voice == first.voice);
+    REQUIRE(allocator.activeVoices(SoundEffect::Merge) == 2);
+    REQUIRE(allocator.stolenCount() == 1);
+
+    const auto other = allocator.acquire(SoundEffect::GameOver, busy);
+    REQUIRE_FALSE(other.stolen);
+    REQUIRE(other.voice != first.voice);
+    REQUIRE(other.voice != second.voice);
+}
+
+TEST_CASE("voice allocator steals the oldest voice when the pool is exhausted", "[voice-pool]") {
+    VoiceAllocator allocator(uniformLimits(VoiceAllocator::kVoiceCount));
+    const auto busy = allBusy();
+
+    std::vector<std::size_t> order;
+    for (std::size_t i = 0; i < VoiceAllocator::kVoiceCount; ++i) {
+        const auto acquisition = allocator.acquire(kAllEffects[i % kAllEffects.size()], busy);
+        REQUIRE_FALSE(acquisition.stolen);
+        order.push_back(acquisition.voice);
+    }
+
+    const auto stolen = allocator.acquire(SoundEffect::Spawn, busy);
+    REQUIRE(stolen.stolen);
+    REQUIRE(stolen.voice == order.front());
+
+    const auto next = allocator.acquire(SoundEffect::Spawn, busy);
+    REQUIRE(next.stolen);
+    REQUIRE(next.voice == order[1]);
+}
+
+TEST_CASE("voice allocator reuses finished voices bound to the same effect", "[voice-pool]") {
+    VoiceAllocator allocator(uniformLimits(4));
+
+    VoiceAllocator::VoiceFlags busy{};
+    const auto slide = allocator.acquire(SoundEffect::TileSlide, busy);
+    REQUIRE(slide.rebind);
+    busy[slide.voice] = true;
+    const auto merge = allocator.acquire(SoundEffect::Merge, busy);
+    REQUIRE(merge.rebind);
+
+    busy.fill(false);
+    const auto slideAgain = allocator.acquire(SoundEffect::TileSlide, busy);
+    REQUIRE(slideAgain.voice == slide.voice);
+    REQUIRE_FALSE(slideAgain.rebind);
+    REQUIRE_FALSE(slideAgain.stolen);
+}
+
+TEST_CASE("voice acquisition stays bounded under 1000 triggers per second", "[voice-pool][stress]") {
+    constexpr std::uint64_t kTriggersPerSecond = 1000;
+    constexpr std::uint64_t kSimulatedSeconds = 60;
+    constexpr std::array<std::uint64_t, app::kSoundEffectCount> kDurationsMs = {90, 180, 120,
+                                                                               900, 1100};
+
+    VoiceAllocator::PolyphonyLimits limits{};
+    limits[app::soundEffectIndex(SoundEffect::TileSlide)] = 3;
+    limits[app::soundEffectIndex(SoundEffect::Merge)] = 4;
+    limits[app::soundEffectIndex(SoundEffect::Spawn)] = 2;
+    limits[app::soundEffectIndex(SoundEffect::GameOver)] = 1;
+    limits[app::soundEffectIndex(SoundEffect::HighScore)] = 1;
+    VoiceAllocator allocator(limits);
+
+    std::mt19937 rng(20260301);
+    std::uniform_int_distribution<std::size_t> effectDist(0, kAllEffects.size() - 1U);
+
+    std::array<std::uint64_t, VoiceAllocator::kVoiceCount> voiceEndsAtMs{};
+    std::array<std::uint64_t, VoiceAllocator::kVoiceCount> voiceStartedAtMs{};
+    std::array<std::size_t, VoiceAllocator::kVoiceCount> voiceEffect{};
+    std::vector<std::int64_t> secondDurationsNs;
+    secondDurationsNs.reserve(kSimulatedSeconds);
+
+    for (std::uint64_t second = 0; second < kSimulatedSeconds; ++second) {
+        std::int64_t elapsedNs = 0;
+
+        for (std::uint64_t i = 0; i < kTriggersPerSecond; ++i) {
+            const std::uint64_t nowMs = second * 1000U + i;
+            const SoundEffect effect = kAllEffects[effectDist(rng)];
+            const std::size_t effectIndex = app::soundEffectIndex(effect);
+
+            VoiceAllocator::VoiceFlags busy{};
+            for (std::size_t v = 0; v < busy.size(); ++v) {
+                busy[v] = voiceEndsAtMs[v] > nowMs;
+            }
+
+            const auto startedAt = std::chrono::steady_clock::now();
+            const auto acquisition = allocator.acquire(effect, busy);
+            elapsedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - startedAt)
+                             .count();
+
+            if (acquisition.stolen && busy[acquisition.voice] &&
+                voiceEffect[acquisition.voice] == effectIndex) {
+                for (std::size_t v = 0; v < busy.size(); ++v) {
+                    if (busy[v] && voiceEffect[v] == effectIndex) {
+                        REQUIRE(voiceStartedAtMs[acquisition.voice] <= voiceStartedAtMs[v]);
+                    }
+                }
+            }
+
+            voiceEndsAtMs[acquisition.voice] = nowMs + kDurationsMs[effectIndex];
+            voiceStartedAtMs[acquisition.voice] = nowMs;
+            voiceEffect[acquisition.voice] = effectIndex;
+
+            REQUIRE(allocator.activeVoices(effect) <= allocator.polyphonyLimit(effect));
+        }
+
+        secondDurationsNs.push_back(elapsedNs);
+    }
+
+    REQUIRE(allocator.stolenCount() > 0);
+
+    const auto median = [](std::vector<std::int64_t> values) {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2U];
+    };
+    const auto earlyMedian = median({secondDurationsNs.begin(), secondDurationsNs.begin() + 10});
+    const auto lateMedian = median({secondDurationsNs.end() - 10, secondDurationsNs.end()});
+
+    // A constant-time acquire keeps late batches in line with early ones; the margin absorbs
+    // scheduler noise on shared CI runners.
+    REQUIRE(lateMedian <= earlyMedian * 4 + 1'000'000);
+}
+
+TEST_CASE("spsc queue preserves FIFO order and reports full", "[spsc]") {
+    app::SpscQueue<int, 4> queue;
+    REQUIRE(queue.empty());
+    REQUIRE_FALSE(queue.tryPop().has_value());
+
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(queue.tryPush(i));
+    }
+    REQUIRE_FALSE(queue.tryPush(99));
+
+    REQUIRE(queue.tryPop() == 0);
+    REQUIRE(queue.tryPush(4));
+
+    for (int expected = 1; expected <= 4; ++expected) {
+        REQUIRE(queue.tryPop() == expected);
+    }
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("spsc queue delivers every item across threads in order", "[spsc]") {
+    constexpr std::uint32_t kItemCount = 200000;
+    app::SpscQueue<std::uint32_t, 64> queue;
+
+    std::thread producer([&queue] {
+        for (std::uint32_t i = 0; i < kItemCount;) {
+            if (queue.tryPush(i)) {
+                ++i;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::uint32_t expected = 0;
+    bool ordered = true;
+    while (expected < kItemCount) {
+        const auto item = queue.tryPop();
+        if (!item.has_value()) {
+            std::this_thread::yield();
+            continue;
+        }
+        ordered = ordered && (*item == expected);
+        ++expected;
+    }
+    producer.join();
+
+    REQUIRE(ordered);
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("asset pack round-trips files through the memory-mapped index", "[asset-pack]") {
+    const auto root = makeUniqueTempDirectory("pack");
+    writeBytes(root / "assets/sounds/merge.wav", std::string("RIFF\0merge", 10));
+    writeBytes(root / "assets/fonts/font.ttf", std::string(1000, 'f'));
+
+    const auto packPath = root / "assets.pack";
+    std::string error;
+    REQUIRE(app::AssetPack::write(packPath,
+                                  {{"assets/sounds/merge.wav", root / "assets/sounds/merge.wav"},
+                                   {"assets/fonts/font.ttf", root / "assets/fonts/font.ttf"}},
+                                  error));
+    REQUIRE_FALSE(std::filesystem::exists(root / "assets.pack.tmp"));
+
+    {
+        const auto pack = app::AssetPack::open(packPath);
+        REQUIRE(pack.has_value());
+        REQUIRE(pack->entries().size() == 2);
+        REQUIRE(pack->verify());
+
+        const auto merge = pack->find("assets/sounds/merge.wav");
+        REQUIRE(merge.has_value());
+        REQUIRE(toString(*merge) == std::string("RIFF\0merge", 10));
+        REQUIRE(reinterpret_cast<std::uintptr_t>(merge->data()) % 16U == 0U);
+
+        const auto font = pack->find("assets/./fonts/font.ttf");
+        REQUIRE(font.has_value());
+        REQUIRE(font->size() == 1000);
+        REQUIRE(app::AssetPack::hashBytes(*font) == pack->entries()[1].hash);
+
+        REQUIRE_FALSE(pack->find("assets/sounds/missing.wav").has_value());
+    }
+
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("asset pack rejects missing and corrupt files", "[asset-pack]") {
+    const auto root = makeUniqueTempDirectory("pack_corrupt");
+
+    REQUIRE_FALSE(app::AssetPack::open(root / "missing.pack").has_value());
+
+    writeBytes(root / "garbage.pack", "not a pack file at all");
+    REQUIRE_FALSE(app::AssetPack::open(root / "garbage.pack").has_value());
+
+    writeBytes(root / "a.bin", "payload");
+    std::string error;
+    REQUIRE(app::AssetPack::write(root / "truncated.pack", {{"a.bin", root / "a.bin"}}, error));
+    std::filesystem::resize_file(root / "truncated.pack", 40);
+    REQUIRE_FALSE(app::AssetPack::open(root / "truncated.pack").has_value());
+
+    REQUIRE_FALSE(app::AssetPack::write(root / "bad.pack", {{"a.bin", root / "nope.bin"}}, error));
+    REQUIRE_FALSE(error.empty());
+
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("asset resolver caches positive and negative lookups", "[asset-resolver]") {
+    const auto root = makeUniqueTempDirectory("resolver");
+    const auto first = root / "first";
+    const auto second = root / "second";
+    writeBytes(second / "assets/fonts/font.ttf", "font");
+    writeBytes(first / "assets.pack", "pack");
+
+    app::AssetResolver resolver({first, second});
+
+    const auto font = resolver.resolve("assets/fonts/font.ttf");
+    REQUIRE(font.resolvedPath == (second / "assets/fonts/font.ttf").lexically_normal());
+    REQUIRE(font.candidates.size() == 2);
+
+    const auto missing = resolver.resolve("assets/fonts/missing.ttf");
+    REQUIRE_FALSE(missing.resolvedPath.has_value());
+
+    const auto checksBefore = resolver.stats().existenceChecks;
+    REQUIRE(resolver.resolve("assets/./fonts/font.ttf").resolvedPath == font.resolvedPath);
+    REQUIRE_FALSE(resolver.resolve("assets/fonts/missing.ttf").resolvedPath.has_value());
+
+    const auto stats = resolver.stats();
+    REQUIRE(stats.existenceChecks == checksBefore);
+    REQUIRE(stats.cacheHits == 2);
+    REQUIRE(stats.lookups == 4);
+
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("asset resolver batch scans each directory once per base", "[asset-resolver]") {
+    const auto root = makeUniqueTempDirectory("resolver_batch");
+    const auto first = root / "first";
+    const auto second = root / "second";
+    writeBytes(first / "assets/sounds/slide.wav", "slide");
+    writeBytes(second / "assets/sounds/merge.wav", "merge");
+    writeBytes(second / "assets/sounds/spawn.wav", "spawn");
+
+    app::AssetResolver resolver({first, second});
+    const auto results = resolver.resolveBatch({"assets/sounds/slide.wav",
+                                                "assets/sounds/merge.wav",
+                                                "assets/sounds/spawn.wav",
+                                                "assets/sounds/missing.wav"});
+
+    REQUIRE(results.size() == 4);
+    REQUIRE(results[0].resolvedPath == (first / "assets/sounds/slide.wav").lexically_normal());
+    REQUIRE(results[1].resolvedPath == (second / "assets/sounds/merge.wav").lexically_normal());
+    REQUIRE(results[2].resolvedPath == (second / "assets/sounds/spawn.wav").lexically_normal());
+    REQUIRE_FALSE(results[3].resolvedPath.has_value());
+
+    auto stats = resolver.stats();
+    REQUIRE(stats.directoryScans == 2);
+    REQUIRE(stats.existenceChecks == 0);
+
+    REQUIRE(resolver.resolve("assets/sounds/merge.wav").resolvedPath == results[1].resolvedPath);
+    REQUIRE_FALSE(resolver.resolve("assets/sounds/missing.wav").resolvedPath.has_value());
+    stats = resolver.stats();
+    REQUIRE(stats.cacheHits == 2);
+    REQUIRE(stats.directoryScans == 2);
+
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("audio collector merges duplicate triggers within a frame", "[audio-events]") {
+    app::AudioEventCollector collector(app::AudioEventCollector::RetriggerIntervals{});
+    app::AudioEventCollector::FrameEvents events{};
+    const auto now = app::AudioEventCollector::Clock::now();
+
+    collector.trigger(app::SoundEffect::TileSlide);
+    collector.trigger(app::SoundEffect::Spawn);
+    collector.trigger(app::SoundEffect::TileSlide);
+    collector.trigger(app::SoundEffect::Merge, 3);
+
+    REQUIRE(collector.flush(now, events) == 3);
+    REQUIRE(events[0].effect == app::SoundEffect::TileSlide);
+    REQUIRE(events[0].count == 2);
+    REQUIRE(events[0].volumeScale == 1.f);
+    REQUIRE(events[1].effect == app::SoundEffect::Merge);
+    REQUIRE(events[1].count == 3);
+    REQUIRE(events[1].volumeScale > 1.f);
+    REQUIRE(events[1].pitch > 1.f);
+    REQUIRE(events[2].effect == app::SoundEffect::Spawn);
+
+    REQUIRE(collector.flush(now, events) == 0);
+    REQUIRE(collector.stats().coalesced == 1);
+    REQUIRE(collector.stats().emitted == 3);
+}
+
+TEST_CASE("audio collector enforces the minimum retrigger interval", "[audio-events]") {
+    using std::chrono::milliseconds;
+
+    app::AudioEventCollector::RetriggerIntervals intervals{};
+    intervals[app::soundEffectIndex(app::SoundEffect::TileSlide)] = milliseconds(50);
+    app::AudioEventCollector collector(intervals);
+    app::AudioEventCollector::FrameEvents events{};
+    const auto start = app::AudioEventCollector::Clock::now();
+
+    collector.trigger(app::SoundEffect::TileSlide);
+    REQUIRE(collector.flush(start, events) == 1);
+
+    collector.trigger(app::SoundEffect::TileSlide);
+    collector.trigger(app::SoundEffect::Spawn);
+    REQUIRE(collector.flush(start + milliseconds(16), events) == 1);
+    REQUIRE(events[0].effect == app::SoundEffect::Spawn);
+
+    collector.trigger(app::SoundEffect::TileSlide);
+    REQUIRE(collector.flush(start + milliseconds(50), events) == 1);
+    REQUIRE(events[0].effect == app::SoundEffect::TileSlide);
+    REQUIRE(collector.stats().rateLimited == 1);
+
+    collector.reset();
+    collector.trigger(app::SoundEffect::TileSlide);
+    REQUIRE(collector.flush(start + milliseconds(51), events) == 1);
+}
+
+TEST_CASE("merge feedback scales with merge count and saturates", "[audio-events]") {
+    using Collector = app::AudioEventCollector;
+
+    REQUIRE(Collector::mergeVolumeScale(1) == 1.f);
+    REQUIRE(Collector::mergePitch(1) == 1.f);
+    REQUIRE(Collector::mergeVolumeScale(2) < Collector::mergeVolumeScale(4));
+    REQUIRE(Collector::mergePitch(2) < Collector::mergePitch(4));
+    REQUIRE(Collector::mergeVolumeScale(6) == Collector::mergeVolumeScale(8));
+    REQUIRE(Collector::mergePitch(6) == Collector::mergePitch(8));
+}
+
+TEST_CASE("heavy input collapses to one event per effect per frame", "[audio-events][stress]") {
+    using std::chrono::milliseconds;
+
+    app::AudioEventCollector::RetriggerIntervals intervals{};
+    intervals.fill(milliseconds(45));
+    app::AudioEventCollector collector(intervals);
+    app::AudioEventCollector::FrameEvents events{};
+    const auto start = app::AudioEventCollector::Clock::now();
+
+    std::size_t emitted = 0;
+    for (int frame = 0; frame < 60; ++frame) {
+        for (int move = 0; move < 4; ++move) {
+            collector.trigger(app::SoundEffect::TileSlide);
+            collector.trigger(app::SoundEffect::Merge, 2);
+            collector.trigger(app::SoundEffect::Spawn);
+        }
+        emitted += collector.flush(start + milliseconds(frame * 16), events);
+    }
+
+    // 240 moves over ~1s: every effect fires at most once per 45ms window.
+    REQUIRE(emitted <= 3U * 20U);
+    REQUIRE(collector.stats().triggers == 720);
+}
+
+TEST_CASE("synthesized effects are non-silent and deterministic", "[synth]") {
+    for (std::size_t i = 0; i < app::kSoundEffectCount; ++i) {
+        const auto effect = static_cast<app::SoundEffect>(i);
+        const auto samples = app::synthesizeEffect(effect);
+
+        REQUIRE(samples.size() > app::kSynthSampleRate / 50U);
+        REQUIRE(samples.size() < app::kSynthSampleRate * 2U);
+
+        const auto [lowest, highest] = std::minmax_element(samples.begin(), samples.end());
+        REQUIRE(*highest > 16000);
+        REQUIRE(*lowest < -16000);
+        REQUIRE(samples == app::synthesizeEffect(effect));
+    }
+}
+
+TEST_CASE("merge tones rise with the tile exponent", "[synth]") {
+    std::size_t previousCrossings = 0;
+    for (int exponent = app::kMinMergeToneExponent; exponent <= app::kMaxMergeToneExponent;
+         ++exponent) {
+        const auto tone = app::synthesizeMergeTone(exponent);
+        REQUIRE_FALSE(tone.empty());
+
+        const std::size_t crossings = countZeroCrossings(tone);
+        REQUIRE(crossings > previousCrossings);
+        previousCrossings = crossings;
+    }
+}
+
+TEST_CASE("merge tone index covers 4 through 131072 and clamps", "[synth]") {
+    REQUIRE(app::kMergeToneCount == 16);
+    REQUIRE(app::mergeToneIndex(4) == 0);
+    REQUIRE(app::mergeToneIndex(2048) == 9);
+    REQUIRE(app::mergeToneIndex(131072) == app::kMergeToneCount - 1U);
+    REQUIRE(app::mergeToneIndex(2) == 0);
+    REQUIRE(app::mergeToneIndex(0) == 0);
+    REQUIRE(app::mergeToneIndex(1 << 20) == app::kMergeToneCount - 1U);
+}
+
+TEST_CASE("settings store falls back to defaults for missing or invalid values", "[settings]") {
+    const auto root = makeUniqueTempDirectory("settings_defaults");
+    const auto path = root / "settings.json";
+    writeBytes(path, R"({"sound_enabled": "yes", "master_volume": 250, "theme": "dark"})");
+
+    app::SettingsStore store(path);
+    REQUIRE(store.load());
+    REQUIRE(store.get(app::settings::kSoundEnabled));
+    REQUIRE(store.get(app::settings::kMasterVolume) == 100.0);
+    REQUIRE_FALSE(store.get(app::settings::kWavSounds));
+
+    REQUIRE_FALSE(store.set(app::settings::kMasterVolume, -1.0));
+    REQUIRE(store.set(app::settings::kMasterVolume, 40.0));
+    REQUIRE(store.get(app::settings::kMasterVolume) == 40.0);
+    REQUIRE(store.flush());
+
+    app::SettingsStore reloaded(path);
+    REQUIRE(reloaded.load());
+    REQUIRE(reloaded.get(app::settings::kMasterVolume) == 40.0);
+    const app::SettingKey<std::string> kTheme{"theme", "light"};
+    REQUIRE(reloaded.get(kTheme) == "dark");
+
+    writeBytes(path, "{ not json");
+    app::SettingsStore broken(path);
+    REQUIRE_FALSE(broken.load());
+    REQUIRE(broken.get(app::settings::kSoundEnabled));
+
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("settings store coalesces rapid changes into one write per window", "[settings]") {
+    const auto root = makeUniqueTempDirectory("settings_debounce");
+    const auto path = root / "nested" / "settings.json";
+
+    {
+        app::SettingsStore store(path, std::chrono::milliseconds(200));
+        for (int i = 0; i < 100; ++i) {
+            store.set(app::settings::kSoundEnabled, i % 2 == 0);
+        }
+        REQUIRE(store.stats().writes == 0);
+        REQUIRE_FALSE(std::filesystem::exists(path));
+
+        REQUIRE(store.flush());
+        REQUIRE(store.stats().writes == 1);
+        REQUIRE(store.stats().sets == 100);
+
+        store.set(app::settings::kSoundEnabled, true);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (store.stats().writes < 2 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        REQUIRE(store.stats().writes == 2);
+
+        // Destruction writes whatever is still pending.
+        store.set(app::settings::kWavSounds, true);
+    }
+
+    app::SettingsStore reloaded(path);
+    REQUIRE(reloaded.load());
+    REQUIRE(reloaded.get(app::settings::kSoundEnabled));
+    REQUIRE(reloaded.get(app::settings::kWavSounds));
+    REQUIRE_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("startup profiler records phases and time to first frame", "[startup-profiler]") {
+    app::StartupProfiler profiler;
+    {
+        const auto window = profiler.phase("pencere");
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    auto font = profiler.phase("yazı tipi");
+    font.end();
+    font.end();
+
+    const auto phases = profiler.phases();
+    REQUIRE(phases.size() == 2);
+    REQUIRE(phases[0].name == "pencere");
+    REQUIRE(phases[0].elapsed >= std::chrono::milliseconds(5));
+    REQUIRE(phases[1].name == "yazı tipi");
+    REQUIRE(phases[1].start >= phases[0].start + phases[0].elapsed);
+
+    REQUIRE_FALSE(profiler.timeToFirstFrame().has_value());
+    profiler.markFirstFrame();
+    const auto firstFrame = profiler.timeToFirstFrame();
+    REQUIRE(firstFrame.has_value());
+    profiler.markFirstFrame();
+    REQUIRE(profiler.timeToFirstFrame() == firstFrame);
+
+    std::ostringstream report;
+    profiler.writeReport(report);
+    REQUIRE(report.str().find("pencere") != std::string::npos);
+    REQUIRE(report.str().find("yazı tipi") != std::string::npos);
+    REQUIRE(report.str().find("ilk kareye kadar") != std::string::npos);
+}
+
+TEST_CASE("slice scheduler follows frame headroom", "[slice-scheduler]") {
+    using std::chrono::microseconds;
+    using std::chrono::milliseconds;
+    app::SliceSchedulerConfig config;
+    config.frameBudget = milliseconds(16);
+    config.headroomShare = 0.5;
+    config.minSlice = microseconds(200);
+    config.maxSlice = milliseconds(10);
+    app::SliceScheduler scheduler(config);
+
+    // Idle frames hand out half the budget, capped at the maximum.
+    REQUIRE(scheduler.nextSlice() == milliseconds(8));
+    scheduler.recordFrameWork(milliseconds(4));
+    REQUIRE(scheduler.nextSlice() == milliseconds(6));
+
+    // A spike takes effect at once; an overrun frame leaves only the minimum slice.
+    scheduler.recordFrameWork(milliseconds(20));
+    REQUIRE(scheduler.estimatedFrameWork() == milliseconds(20));
+    REQUIRE(scheduler.nextSlice() == microseconds(200));
+
+    // Short frames afterwards win the slice back gradually.
+    auto previous = scheduler.nextSlice();
+    for (int frame = 0; frame < 60; ++frame) {
+        scheduler.recordFrameWork(milliseconds(2));
+        REQUIRE(scheduler.nextSlice() >= previous);
+        previous = scheduler.nextSlice();
+    }
+    REQUIRE(scheduler.estimatedFrameWork() < microseconds(2100));
+    REQUIRE(scheduler.nextSlice() > microseconds(6900));
+}
+
+namespace {
+
+std::string readFile(const std::filesystem::path &path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Polls for up to two seconds until `path` holds `needle`.
+bool waitForFileContaining(const std::filesystem::path &path, const std::string &needle) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (readFile(path).find(needle) != std::string::npos) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+
+#if !defined(_WIN32)
+std::string httpGet(const std::uint16_t port, const std::string &target) {
+    const int client = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    std::string response;
+    if (::connect(client, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0) {
+        const std::string request = "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        ::send(client, request.data(), request.size(), 0);
+        char buffer[1024];
+        for (auto received = ::recv(client, buffer, sizeof(buffer), 0); received > 0;
+             received = ::recv(client, buffer, sizeof(buffer), 0)) {
+            response.append(buffer, static_cast<std::size_t>(received));
+        }
+    }
+    ::close(client);
+    return response;
+}
+#endif
+
+} // namespace
+
+TEST_CASE("metrics exporter rewrites the text file and serves /metrics", "[metrics-exporter]") {
+    core2048::MetricsRegistry registry;
+    auto &frames = registry.counter("test_frames_total", "Frames.");
+    frames.add(3);
+
+    const auto directory = makeUniqueTempDirectory("metrics");
+    app::MetricsExportConfig config;
+    config.textFile = directory / "sfml_2048.prom";
+    config.interval = std::chrono::milliseconds(20);
+#if !defined(_WIN32)
+    config.httpPort = 0;
+#endif
+    app::MetricsExporter exporter(registry, config);
+    std::string error;
+    REQUIRE(exporter.start(error));
+    REQUIRE(waitForFileContaining(config.textFile, "test_frames_total 3\n"));
+    frames.add(4);
+    REQUIRE(waitForFileContaining(config.textFile, "test_frames_total 7\n"));
+    REQUIRE_FALSE(std::filesystem::exists(directory / "sfml_2048.prom.tmp"));
+
+#if !defined(_WIN32)
+    REQUIRE(exporter.httpPort() != 0U);
+    const std::string response = httpGet(exporter.httpPort(), "/metrics");
+    REQUIRE(response.rfind("HTTP/1.1 200 OK\r\n", 0) == 0U);
+    REQUIRE(response.find("\r\n\r\n# HELP test_frames_total Frames.\n") != std::string::npos);
+    REQUIRE(httpGet(exporter.httpPort(), "/").rfind("HTTP/1.1 404", 0) == 0U);
+
+    // The port is taken now.
+    app::MetricsExportConfig clash;
+    clash.httpPort = exporter.httpPort();
+    app::MetricsExporter second(registry, clash);
+    REQUIRE_FALSE(second.start(error));
+    REQUIRE(error.find("127.0.0.1") != std::string::npos);
+#endif
+
+    frames.add(1);
+    exporter.stop();
+    REQUIRE(exporter.httpPort() == 0U);
+    REQUIRE(readFile(config.textFile).find("test_frames_total 8\n") != std::string::npos);
+    REQUIRE(exporter.lastError().empty());
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("metrics exporter reports text file write failures", "[metrics-exporter]") {
+    core2048::MetricsRegistry registry;
+    const auto directory = makeUniqueTempDirectory("metrics_unwritable");
+
+    app::MetricsExportConfig missing;
+    missing.textFile = directory / "absent" / "sfml_2048.prom";
+    app::MetricsExporter unstarted(registry, missing);
+    std::string error;
+    REQUIRE_FALSE(unstarted.start(error));
+    REQUIRE(error.find("cannot write") != std::string::npos);
+
+    // Writes that start failing later keep the first error for the caller.
+    app::MetricsExportConfig config;
+    config.textFile = directory / "nested" / "sfml_2048.prom";
+    config.interval = std::chrono::milliseconds(20);
+    std::filesystem::create_directories(config.textFile.parent_path());
+    app::MetricsExporter exporter(registry, config);
+    REQUIRE(exporter.start(error));
+    REQUIRE(exporter.lastError().empty());
+    std::filesystem::remove_all(config.textFile.parent_path());
+    exporter.stop();
+    REQUIRE(exporter.lastError().find("cannot write") != std::string::npos);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("event log records fixed-size events and drops on overflow", "[event-log]") {
+    app::EventLog log(app::EventLogConfig{});
+    core2048::MoveResult move;
+    move.moved = true;
+    move.scoreDelta = 12;
+    move.mergeCount = 2;
+    move.maxMergedValue = 8;
+    move.spawnedTile = core2048::SpawnedTile{1, 2, 4};
+    log.recordMove(core2048::Direction::Left, move, 40);
+    log.recordSceneChange(app::LoggedScene::Playing, app::LoggedScene::GameOver, 40);
+    log.recordSound(SoundEffect::Merge, 2, 8);
+    log.recordSlowFrame(std::chrono::milliseconds(50), std::chrono::microseconds(16667));
+
+    std::vector<app::EventRecord> records;
+    REQUIRE(log.drain(records) == 6U);
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        REQUIRE(records[i].sequence == i);
+        REQUIRE((i == 0U || records[i].timeNs >= records[i - 1U].timeNs));
+    }
+    REQUIRE(records[0].type == app::EventType::Move);
+    REQUIRE(records[1].type == app::EventType::Merge);
+    REQUIRE(records[2].type == app::EventType::Spawn);
+    REQUIRE(app::eventJsonLine(records[0], 0).find(
+                R"("event":"move","direction":"left","merges":2,"score_delta":12,"score":40)") !=
+            std::string::npos);
+    REQUIRE(app::eventJsonLine(records[1], 0).find(R"("merges":2,"max_value":8)") !=
+            std::string::npos);
+    REQUIRE(app::eventJsonLine(records[2], 0).find(R"("row":1,"col":2,"value":4)") !=
+            std::string::npos);
+    REQUIRE(app::eventJsonLine(records[3], 0).find(
+                R"("event":"scene","from":"playing","to":"game_over","score":40)") !=
+            std::string::npos);
+    REQUIRE(app::eventJsonLine(records[4], 0).find(
+                R"("event":"sound","effect":"merge","count":2,"tile":8)") != std::string::npos);
+    REQUIRE(app::eventJsonLine(records[5], 0).find(R"("frame_us":50000,"budget_us":16667)") !=
+            std::string::npos);
+
+    // Nobody drains: the ring keeps the oldest records and counts the rest as dropped.
+    for (std::size_t i = 0; i < app::EventLog::kCapacity + 5U; ++i) {
+        log.record(app::EventType::Move, 0, 0, 0, 0);
+    }
+    REQUIRE(log.droppedRecords() == 5U);
+    records.clear();
+    REQUIRE(log.drain(records) == app::EventLog::kCapacity);
+    REQUIRE(records.back().sequence == 6U + app::EventLog::kCapacity - 1U);
+}
+
+TEST_CASE("event log rotates files and reads back in order", "[event-log]") {
+    const auto directory = makeUniqueTempDirectory("eventlog");
+    const auto path = directory / "events.s2el";
+    writeBytes(path, "left over from an earlier run");
+
+    app::EventLogConfig config;
+    config.path = path;
+    config.maxFileBytes = 24U + 100U * sizeof(app::EventRecord);
+    config.maxFiles = 3;
+    config.flushInterval = std::chrono::milliseconds(5);
+    app::EventLog log(config);
+    std::string error;
+    REQUIRE(log.start(error));
+    // The earlier file was kept as the first rotation.
+    REQUIRE(std::filesystem::exists(directory / "events.s2el.1"));
+    for (std::uint32_t i = 0; i < 250U; ++i) {
+        log.record(app::EventType::Sound, 1, 1, i, 0);
+        if (i % 50U == 49U) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    log.stop();
+    REQUIRE(log.lastError().empty());
+    REQUIRE(log.writtenRecords() == 250U);
+    REQUIRE(log.droppedRecords() == 0U);
+
+    // 100 records per file: the earlier run's file rotated out, the three kept hold all 250.
+    const auto files = app::eventLogFiles(path);
+    REQUIRE(files == std::vector<std::filesystem::path>{directory / "events.s2el.2",
+                                                        directory / "events.s2el.1", path});
+    std::uint32_t expected = 0;
+    for (const auto &file : files) {
+        app::EventLogFile decoded;
+        REQUIRE(app::readEventLog(file, decoded, error));
+        REQUIRE_FALSE(decoded.truncated);
+        for (const auto &record : decoded.records) {
+            REQUIRE(record.sequence == expected);
+            REQUIRE(record.value == expected);
+            ++expected;
+        }
+    }
+    REQUIRE(expected == 250U);
+
+    // A crash mid-write leaves part of a record; the whole ones still decode.
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out << "partial";
+    }
+    app::EventLogFile decoded;
+    REQUIRE(app::readEventLog(path, decoded, error));
+    REQUIRE(decoded.truncated);
+    REQUIRE(decoded.records.size() == 50U);
+
+    writeBytes(directory / "garbage.s2el", "not an event log at all");
+    REQUIRE_FALSE(app::readEventLog(directory / "garbage.s2el", decoded, error));
+    REQUIRE(error.find("not an event log") != std::string::npos);
+    std::filesystem::remove_all(directory);
+}
@@ -1,14 +1,21 @@
 #include "core/Game.hpp"
+#include "core/Heuristics.hpp"
+#include "core/Metrics.hpp"
+#include "core/MoveSearch.hpp"
 #include "core/ScoreManager.hpp"
 #include <catch2/catch_test_macros.hpp>
+#include <algorithm>
 #include <array>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <optional>
 #include <random>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace {
@@ -95,6 +102,7 @@ TEST_CASE("2,2,2,2 left merges to 4,4,0,0 with correct score", "[merge]") {
 
     REQUIRE(result.moved);
     REQUIRE(result.scoreDelta == 8);
+    REQUIRE(result.mergeCount == 2);
     REQUIRE_FALSE(result.spawnedTile.has_value());
 
     const Game::Grid expected = {
@@ -122,6 +130,8 @@ TEST_CASE("double merges happen once per tile", "[merge]") {
 
     REQUIRE(result.moved);
     REQUIRE(result.scoreDelta == 12);
+    REQUIRE(result.mergeCount == 2);
+    REQUIRE(result.maxMergedValue == 8);
 
     const Game::Grid expected = {
         std::array<int, 4>{4, 8, 0, 0},
@@ -177,6 +187,42 @@ TEST_CASE("game-over detection works for dead and alive boards", "[gameover]") {
     REQUIRE_FALSE(game.isGameOver());
 }
 
+TEST_CASE("3x3 boards slide, spawn and end like the 4x4 game", "[small-board]") {
+    using SmallGame = core2048::BasicGame<3>;
+    SmallGame game(7);
+
+    int tiles = 0;
+    for (const auto &row : game.getGrid()) {
+        for (const int value : row) {
+            tiles += value != 0 ? 1 : 0;
+        }
+    }
+    REQUIRE(tiles == 2);
+
+    SmallGame::Grid grid = {
+        std::array<int, 3>{2, 2, 4},
+        std::array<int, 3>{0, 4, 4},
+        std::array<int, 3>{8, 0, 8},
+    };
+    const auto slid = SmallGame::slide(grid, Direction::Left);
+    REQUIRE(slid.moved);
+    REQUIRE(slid.scoreDelta == 28);
+    REQUIRE(grid == SmallGame::Grid{
+                        std::array<int, 3>{4, 4, 0},
+                        std::array<int, 3>{8, 0, 0},
+                        std::array<int, 3>{16, 0, 0},
+                    });
+
+    game.loadState(
+        {
+            std::array<int, 3>{2, 4, 8},
+            std::array<int, 3>{4, 8, 2},
+            std::array<int, 3>{2, 4, 8},
+        },
+        0);
+    REQUIRE(game.isGameOver());
+}
+
 TEST_CASE("score accumulation is correct across moves", "[score]") {
     Game game(0);
     const Game::Grid grid = {
@@ -403,3 +449,373 @@ TEST_CASE("left and right moves are mirror symmetric without spawn", "[property]
         REQUIRE(leftGame.getGrid() == mirrorHorizontal(rightGame.getGrid()));
     }
 }
+
+TEST_CASE("static slide matches applyMove without spawn", "[property]") {
+    std::mt19937 rng(31337);
+
+    for (int iter = 0; iter < 200; ++iter) {
+        const Game::Grid grid = randomValidGrid(rng);
+
+        for (const Direction direction : kAllDirections) {
+            Game game(0);
+            game.loadState(grid, 10);
+            const auto applied = game.applyMove(direction, false);
+
+            Game::Grid slid = grid;
+            const auto slideResult = Game::slide(slid, direction);
+
+            REQUIRE(slid == game.getGrid());
+            REQUIRE(slideResult.moved == applied.moved);
+            REQUIRE(slideResult.scoreDelta == applied.scoreDelta);
+            REQUIRE(slideResult.mergeCount == applied.mergeCount);
+            REQUIRE_FALSE(slideResult.spawnedTile.has_value());
+            REQUIRE(game.getScore() == 10 + applied.scoreDelta);
+        }
+    }
+}
+
+namespace {
+
+int exponentOf(const int value) {
+    int exponent = 0;
+    for (int v = value; v > 1; v >>= 1) {
+        ++exponent;
+    }
+    return exponent;
+}
+
+// Direct evaluation over the grid, term by term, for checking the table-driven evaluator.
+double referenceEvaluation(const Game::Grid &grid, const core2048::HeuristicWeights &weights) {
+    std::array<std::array<int, 4>, 8> lines{};
+    double score = 0.0;
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            const int exponent = exponentOf(grid[r][c]);
+            lines[r][c] = exponent;
+            lines[4 + c][r] = exponent;
+            score += exponent == 0 ? weights.emptyCells : 0.0;
+            score += weights.corner * (r + 3 - c) / 6.0 * exponent;
+        }
+    }
+
+    for (const auto &line : lines) {
+        double left = 0.0;
+        double right = 0.0;
+        for (int i = 0; i < 3; ++i) {
+            const double a = std::pow(line[i], 4);
+            const double b = std::pow(line[i + 1], 4);
+            (line[i] > line[i + 1] ? left : right) += std::abs(a - b);
+        }
+        score -= weights.monotonicity * std::min(left, right);
+
+        std::vector<int> tiles;
+        std::copy_if(line.begin(), line.end(), std::back_inserter(tiles),
+                     [](const int exponent) { return exponent != 0; });
+        for (std::size_t i = 0; i + 1 < tiles.size(); ++i) {
+            score -= weights.smoothness * std::abs(tiles[i] - tiles[i + 1]);
+        }
+        for (std::size_t i = 0; i + 1 < tiles.size(); ++i) {
+            if (tiles[i] == tiles[i + 1]) {
+                score += weights.mergePotential;
+                ++i;
+            }
+        }
+    }
+    return score;
+}
+
+} // namespace
+
+TEST_CASE("packed boards transpose like the grid", "[heuristics]") {
+    std::mt19937 rng(4242);
+    for (int iter = 0; iter < 100; ++iter) {
+        const Game::Grid grid = randomValidGrid(rng);
+        Game::Grid transposed{};
+        for (int r = 0; r < 4; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                transposed[r][c] = grid[c][r];
+            }
+        }
+        const auto packed = core2048::packBoard(grid);
+        REQUIRE(core2048::packBoard(core2048::unpackBoard(packed)) == packed);
+        REQUIRE(core2048::transposeBoard(packed) == core2048::packBoard(transposed));
+        REQUIRE(core2048::transposeBoard(core2048::transposeBoard(packed)) == packed);
+    }
+}
+
+TEST_CASE("table-driven evaluation matches the direct terms", "[heuristics]") {
+    const core2048::HeuristicWeights weights;
+    const core2048::BoardEvaluator evaluator(weights);
+    std::mt19937 rng(777);
+    for (int iter = 0; iter < 300; ++iter) {
+        const Game::Grid grid = randomValidGrid(rng);
+        const double expected = referenceEvaluation(grid, weights);
+        const double actual = evaluator.evaluate(grid);
+        REQUIRE(std::abs(actual - expected) <= 1e-5 * std::max(1.0, std::abs(expected)));
+    }
+
+    // Each term pulls the way it should.
+    core2048::HeuristicWeights cornerOnly{};
+    cornerOnly.emptyCells = cornerOnly.monotonicity = cornerOnly.smoothness = 0.0F;
+    cornerOnly.mergePotential = 0.0F;
+    const core2048::BoardEvaluator corner(cornerOnly);
+    Game::Grid bottomLeft{};
+    bottomLeft[3][0] = 1024;
+    Game::Grid topRight{};
+    topRight[0][3] = 1024;
+    REQUIRE(corner.evaluate(bottomLeft) > corner.evaluate(topRight));
+    REQUIRE(corner.evaluate(topRight) == 0.0F);
+
+    Game::Grid pair{};
+    pair[0][0] = 8;
+    pair[0][2] = 8;
+    Game::Grid apart = pair;
+    apart[0][2] = 16;
+    REQUIRE(evaluator.evaluate(pair) > evaluator.evaluate(apart));
+}
+
+TEST_CASE("batch evaluation is bit-identical to single boards", "[heuristics]") {
+    const core2048::BoardEvaluator evaluator;
+    std::mt19937 rng(99);
+    // Not a multiple of 8, so the scalar tail after the AVX2 blocks is exercised too.
+    std::vector<core2048::PackedBoard> boards(45);
+    for (auto &board : boards) {
+        board = core2048::packBoard(randomValidGrid(rng));
+    }
+    boards[0] = 0;
+    boards[1] = ~core2048::PackedBoard{0};
+
+    std::vector<float> scores(boards.size(), -1.0F);
+    evaluator.evaluateBatch(boards, scores);
+    INFO("vectorized: " << core2048::BoardEvaluator::batchIsVectorized());
+    for (std::size_t i = 0; i < boards.size(); ++i) {
+        REQUIRE(scores[i] == evaluator.evaluate(boards[i]));
+    }
+}
+
+TEST_CASE("packed moves match Game::slide", "[search]") {
+    std::mt19937 rng(2024);
+    for (int iter = 0; iter < 500; ++iter) {
+        Game::Grid grid = randomValidGrid(rng);
+        for (auto &row : grid) {
+            // Packed boards have no tile of value 1.
+            std::replace(row.begin(), row.end(), 1, 0);
+        }
+        for (const Direction direction : kAllDirections) {
+            Game::Grid slid = grid;
+            const auto result = Game::slide(slid, direction);
+            const auto packed = core2048::packBoard(grid);
+            const auto moved = core2048::movePackedBoard(packed, direction);
+            REQUIRE(moved == core2048::packBoard(slid));
+            REQUIRE((moved != packed) == result.moved);
+        }
+    }
+}
+
+TEST_CASE("time-sliced move search matches a search run to the end", "[search]") {
+    const core2048::BoardEvaluator evaluator;
+    const Game::Grid grid = {{{2, 4, 0, 0}, {0, 8, 2, 0}, {16, 0, 0, 4}, {32, 64, 8, 2}}};
+
+    core2048::MoveSearch whole(evaluator, grid, 3);
+    whole.runToEnd();
+    const auto &expected = whole.progress();
+    REQUIRE(expected.finished);
+    REQUIRE(expected.depthCompleted == 3);
+    REQUIRE(expected.bestMove.has_value());
+
+    core2048::MoveSearch sliced(evaluator, grid, 3);
+    int slices = 0;
+    int lastDepth = 0;
+    std::uint64_t lastNodes = 0;
+    while (!sliced.runFor(std::chrono::nanoseconds(0))) {
+        ++slices;
+        // Each slice runs to the next checkpoint, and progress only moves forward.
+        REQUIRE(sliced.progress().nodes > lastNodes);
+        REQUIRE(sliced.progress().depthCompleted >= lastDepth);
+        lastNodes = sliced.progress().nodes;
+        lastDepth = sliced.progress().depthCompleted;
+    }
+    REQUIRE(slices > 10);
+    REQUIRE(sliced.progress().nodes == expected.nodes);
+    REQUIRE(sliced.progress().bestMove == expected.bestMove);
+    REQUIRE(sliced.progress().bestValue == expected.bestValue);
+
+    // Depth 1 picks the move with the best average evaluation over spawns.
+    core2048::MoveSearch shallow(evaluator, grid, 1);
+    shallow.runToEnd();
+    std::optional<Direction> bestMove;
+    float bestValue = 0.0F;
+    for (const Direction direction : kAllDirections) {
+        Game::Grid slid = grid;
+        if (!Game::slide(slid, direction).moved) {
+            continue;
+        }
+        float sum = 0.0F;
+        int empty = 0;
+        for (int r = 0; r < 4; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                if (slid[r][c] != 0) {
+                    continue;
+                }
+                ++empty;
+                for (const auto &[value, weight] : {std::pair{2, 0.9F}, std::pair{4, 0.1F}}) {
+                    Game::Grid spawned = slid;
+                    spawned[r][c] = value;
+                    sum += weight * evaluator.evaluate(spawned);
+                }
+            }
+        }
+        const float value = sum / static_cast<float>(empty);
+        if (!bestMove.has_value() || value > bestValue) {
+            bestMove = direction;
+            bestValue = value;
+        }
+    }
+    REQUIRE(shallow.progress().bestMove == bestMove);
+
+    const Game::Grid dead = {{{2, 4, 2, 4}, {4, 2, 4, 2}, {2, 4, 2, 4}, {4, 2, 4, 2}}};
+    core2048::MoveSearch stuck(evaluator, dead, 3);
+    REQUIRE(stuck.runFor(std::chrono::milliseconds(1)));
+    REQUIRE_FALSE(stuck.progress().bestMove.has_value());
+    REQUIRE(stuck.progress().depthCompleted == 0);
+}
+
+TEST_CASE("deadline search returns the deepest finished iteration in time", "[search]") {
+    using Clock = core2048::MoveSearch::Clock;
+    const core2048::BoardEvaluator evaluator;
+    Game game;
+    game.loadState({{{2, 4, 0, 0}, {0, 8, 2, 0}, {16, 0, 0, 4}, {32, 64, 8, 2}}});
+
+    // A deadline far away: every depth up to the limit, same move as the plain search.
+    const auto full =
+        core2048::searchBestMove(game, evaluator, Clock::now() + std::chrono::hours(1), 3);
+    core2048::MoveSearch reference(evaluator, game.getGrid(), 3);
+    reference.runToEnd();
+    REQUIRE(full.move == reference.progress().bestMove);
+    REQUIRE(full.depthCompleted == 3);
+    REQUIRE(full.nodes == reference.progress().nodes);
+    REQUIRE(full.nodesPerSecond > 0.0);
+    REQUIRE(full.iterations.size() == 3U);
+    std::uint64_t iterationNodes = 0;
+    for (std::size_t i = 0; i < full.iterations.size(); ++i) {
+        REQUIRE(full.iterations[i].depth == static_cast<int>(i) + 1);
+        REQUIRE(full.iterations[i].elapsed <= full.elapsed);
+        iterationNodes += full.iterations[i].nodes;
+    }
+    REQUIRE(iterationNodes == full.nodes);
+    REQUIRE(full.iterations.back().bestMove == full.move);
+
+    // A deadline already past still yields a legal move from depth 1.
+    const auto rushed = core2048::searchBestMove(game, evaluator, Clock::now());
+    REQUIRE(rushed.move.has_value());
+    REQUIRE(rushed.depthCompleted >= 1);
+    Game::Grid slid = game.getGrid();
+    REQUIRE(Game::slide(slid, *rushed.move).moved);
+
+    // An open board cannot reach the depth limit in time; the deadline holds regardless.
+    const auto began = Clock::now();
+    const auto deadline = began + std::chrono::milliseconds(30);
+    const auto timed = core2048::searchBestMove(game, evaluator, deadline);
+    const auto returnedAt = Clock::now();
+    REQUIRE(timed.move.has_value());
+    REQUIRE(timed.depthCompleted >= 2);
+    REQUIRE(timed.depthCompleted < core2048::kMaxSearchDepth);
+    REQUIRE(returnedAt - deadline < std::chrono::milliseconds(20));
+
+    Game dead;
+    dead.loadState({{{2, 4, 2, 4}, {4, 2, 4, 2}, {2, 4, 2, 4}, {4, 2, 4, 2}}});
+    const auto none =
+        core2048::searchBestMove(dead, evaluator, Clock::now() + std::chrono::seconds(1));
+    REQUIRE_FALSE(none.move.has_value());
+    REQUIRE(none.depthCompleted == 0);
+}
+
+TEST_CASE("metrics merge per-thread shards, including exited threads", "[metrics]") {
+    core2048::MetricsRegistry registry;
+    auto &counter = registry.counter("test_events_total", "Events.");
+    REQUIRE(&registry.counter("test_events_total", "Events.") == &counter);
+
+    constexpr int kThreads = 4;
+    constexpr std::uint64_t kAddsPerThread = 10'000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&counter] {
+            for (std::uint64_t i = 0; i < kAddsPerThread; ++i) {
+                counter.add();
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    counter.add(5);
+    REQUIRE(counter.value() == kThreads * kAddsPerThread + 5U);
+
+    // Reused shards start from zero: a second pool adds on top of the retired totals.
+    std::thread([&counter] { counter.add(7); }).join();
+    REQUIRE(counter.value() == kThreads * kAddsPerThread + 12U);
+
+    auto &gauge = registry.gauge("test_level", "Level.", {{"path", "C:\\kiosk \"a\""}});
+    gauge.set(2.5);
+    gauge.add(-1.0);
+    REQUIRE(gauge.value() == 1.5);
+
+    auto &histogram = registry.histogram("test_seconds", "Durations.", {0.1, 1.0});
+    for (const double value : {0.05, 0.1, 0.5, 3.0}) {
+        histogram.observe(value);
+    }
+    const auto snapshot = histogram.snapshot();
+    REQUIRE(snapshot.buckets == std::vector<std::uint64_t>{2, 1, 1});
+    REQUIRE(snapshot.count == 4U);
+    REQUIRE(std::abs(snapshot.sum - 3.65) < 1e-9);
+
+    const std::string text = registry.renderPrometheus();
+    REQUIRE(text == "# HELP test_events_total Events.\n"
+                    "# TYPE test_events_total counter\n"
+                    "test_events_total 40012\n"
+                    "# HELP test_level Level.\n"
+                    "# TYPE test_level gauge\n"
+                    "test_level{path=\"C:\\\\kiosk \\\"a\\\"\"} 1.5\n"
+                    "# HELP test_seconds Durations.\n"
+                    "# TYPE test_seconds histogram\n"
+                    "test_seconds_bucket{le=\"0.1\"} 2\n"
+                    "test_seconds_bucket{le=\"1\"} 3\n"
+                    "test_seconds_bucket{le=\"+Inf\"} 4\n"
+                    "test_seconds_sum 3.65\n"
+                    "test_seconds_count 4\n");
+}
+
+TEST_CASE("game moves and score saves report to the global metrics", "[metrics]") {
+    auto &registry = core2048::MetricsRegistry::global();
+    auto &moves = registry.counter("sfml_2048_game_moves_total", "");
+    auto &merges = registry.counter("sfml_2048_game_merges_total", "");
+    const std::uint64_t movesBefore = moves.value();
+    const std::uint64_t mergesBefore = merges.value();
+
+    Game game(11U);
+    std::uint64_t moved = 0;
+    std::uint64_t merged = 0;
+    for (int i = 0; i < 200; ++i) {
+        const auto result = game.applyMove(kAllDirections[static_cast<std::size_t>(i % 4)]);
+        moved += result.moved ? 1U : 0U;
+        merged += static_cast<std::uint64_t>(result.mergeCount);
+    }
+    REQUIRE(moves.value() - movesBefore == moved);
+    REQUIRE(merges.value() - mergesBefore == merged);
+
+    // The first save registers the histogram with its real bounds.
+    const auto filePath = makeUniqueTempFilePath("metrics_scores");
+    ScoreManager manager(filePath);
+    manager.addScore(128);
+    REQUIRE(manager.save());
+    auto &saves = registry.histogram("sfml_2048_score_save_seconds", "", {});
+    REQUIRE(saves.bounds().size() > 1U);
+    const std::uint64_t savesBefore = saves.snapshot().count;
+    REQUIRE(manager.save());
+    REQUIRE(saves.snapshot().count == savesBefore + 1U);
+    std::filesystem::remove(filePath);
+
+    const std::string text = registry.renderPrometheus();
+    REQUIRE(text.find("# TYPE sfml_2048_game_moves_total counter\n") != std::string::npos);
+    REQUIRE(text.find("sfml_2048_score_save_seconds_bucket{le=\"+Inf\"}") != std::string::npos);
+}
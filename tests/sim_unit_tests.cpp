@@ -0,0 +1,1100 @@
+#include "sim/DiffCheck.hpp"
+#include "sim/HardwareCounters.hpp"
+#include "sim/PerfCheck.hpp"
+#include "sim/Perft.hpp"
+#include "sim/Policy.hpp"
+#include "sim/ReplayAnalytics.hpp"
+#include "sim/SeedSearch.hpp"
+#include "sim/ShardFile.hpp"
+#include "sim/Simulation.hpp"
+#include "sim/Solver.hpp"
+#include "sim/Tournament.hpp"
+#include "sim/TrainingData.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <time.h>
+#endif
+
+namespace {
+
+using core2048::Direction;
+using core2048::Game;
+
+std::string runToString(sim2048::TournamentConfig config, const unsigned int threads) {
+    config.threads = threads;
+    std::ostringstream out;
+    std::string error;
+    REQUIRE(sim2048::runTournament(config, out, error));
+    return out.str();
+}
+
+std::filesystem::path makeUniqueTempDirectory(const std::string &suffix) {
+    const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    auto directory = std::filesystem::temp_directory_path() /
+                     ("sfml_2048_sim_" + suffix + "_" + std::to_string(stamp));
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+std::size_t countLines(const std::string &text, const std::string &needle) {
+    std::size_t count = 0;
+    std::istringstream in(text);
+    for (std::string line; std::getline(in, line);) {
+        count += line.find(needle) != std::string::npos ? 1U : 0U;
+    }
+    return count;
+}
+
+} // namespace
+
+TEST_CASE("every policy only picks moves that change the board", "[policy]") {
+    const Game::Grid dead = {
+        std::array<int, 4>{2, 4, 2, 4},
+        std::array<int, 4>{4, 2, 4, 2},
+        std::array<int, 4>{2, 4, 2, 4},
+        std::array<int, 4>{4, 2, 4, 2},
+    };
+    const Game::Grid onlyLeft = {
+        std::array<int, 4>{0, 2, 4, 8},
+        std::array<int, 4>{2, 4, 8, 16},
+        std::array<int, 4>{4, 8, 16, 32},
+        std::array<int, 4>{8, 16, 32, 64},
+    };
+
+    for (const auto name : sim2048::policyNames()) {
+        const auto policy = sim2048::makePolicy(name, 7U);
+        REQUIRE(policy != nullptr);
+        REQUIRE_FALSE(policy->chooseMove(dead).has_value());
+
+        const auto move = policy->chooseMove(onlyLeft);
+        REQUIRE(move.has_value());
+        Game::Grid next = onlyLeft;
+        REQUIRE(Game::slide(next, *move).moved);
+    }
+
+    REQUIRE(sim2048::makePolicy("unknown", 0U) == nullptr);
+}
+
+TEST_CASE("games replay identically from policy and seed", "[simulation]") {
+    for (const auto name : sim2048::policyNames()) {
+        auto first = sim2048::makePolicy(name, 99U);
+        auto second = sim2048::makePolicy(name, 99U);
+        const auto a = sim2048::playGame(*first, 99U, 100000);
+        const auto b = sim2048::playGame(*second, 99U, 100000);
+
+        REQUIRE(a.score == b.score);
+        REQUIRE(a.maxTile == b.maxTile);
+        REQUIRE(a.moves == b.moves);
+        REQUIRE(a.moves > 0);
+    }
+
+    auto capped = sim2048::makePolicy("greedy", 5U);
+    REQUIRE(sim2048::playGame(*capped, 5U, 10).moves == 10);
+}
+
+TEST_CASE("outcome summary uses nearest-rank percentiles", "[simulation]") {
+    std::vector<sim2048::GameOutcome> outcomes;
+    for (int i = 1; i <= 100; ++i) {
+        outcomes.push_back({i * 10, i <= 10 ? 4096 : (i <= 30 ? 2048 : 512), 1});
+    }
+    outcomes.push_back({5000, 8192, 1});
+
+    const auto summary = sim2048::summarizeOutcomes(outcomes);
+    REQUIRE(summary.games == 101);
+    REQUIRE(summary.medianScore == 510);
+    REQUIRE(summary.p99Score == 1000);
+    REQUIRE(summary.bestScore == 5000);
+    REQUIRE(summary.meanScore == (50500.0 + 5000.0) / 101.0);
+    REQUIRE(summary.reach2048 == 31.0 / 101.0);
+    REQUIRE(summary.reach4096 == 11.0 / 101.0);
+    REQUIRE(summary.reach8192 == 1.0 / 101.0);
+
+    REQUIRE(sim2048::summarizeOutcomes({}).games == 0);
+}
+
+TEST_CASE("tournament output is byte-identical for any thread count", "[tournament]") {
+    sim2048::TournamentConfig config;
+    config.policies = {"greedy", "corner", "random"};
+    config.firstSeed = 40;
+    config.seedCount = 12;
+    config.maxMoves = 400;
+
+    const std::string single = runToString(config, 1);
+    REQUIRE(countLines(single, R"("type":"game")") == 36);
+    REQUIRE(countLines(single, R"("type":"aggregate")") == 3);
+    REQUIRE(runToString(config, 3) == single);
+    REQUIRE(runToString(config, 8) == single);
+}
+
+TEST_CASE("tournament rejects unknown policies", "[tournament]") {
+    sim2048::TournamentConfig config;
+    config.policies = {"greedy", "nope"};
+
+    std::ostringstream out;
+    std::string error;
+    REQUIRE_FALSE(sim2048::runTournament(config, out, error));
+    REQUIRE(error.find("nope") != std::string::npos);
+    REQUIRE(out.str().empty());
+}
+
+TEST_CASE("tournament rejects seed ranges past the last 32-bit seed", "[tournament]") {
+    sim2048::TournamentConfig config;
+    config.policies = {"greedy"};
+    config.firstSeed = 4294967295U;
+    config.seedCount = 2;
+    config.maxMoves = 50;
+
+    std::ostringstream out;
+    std::string error;
+    REQUIRE_FALSE(sim2048::runTournament(config, out, error));
+    REQUIRE(error.find("exceeds 32-bit seeds") != std::string::npos);
+    REQUIRE(out.str().empty());
+
+    config.seedCount = 1;
+    REQUIRE(sim2048::runTournament(config, out, error));
+    REQUIRE(countLines(out.str(), R"("seed":4294967295)") == 1);
+}
+
+TEST_CASE("outcome accumulators merge associatively", "[simulation]") {
+    std::vector<sim2048::GameOutcome> outcomes;
+    for (int i = 0; i < 60; ++i) {
+        outcomes.push_back({(i * 7919) % 3000, 2 << (i % 13), i});
+    }
+
+    std::array<sim2048::OutcomeAccumulator, 3> parts;
+    sim2048::OutcomeAccumulator all;
+    for (std::size_t i = 0; i < outcomes.size(); ++i) {
+        parts[i % 3U].add(outcomes[i]);
+        all.add(outcomes[i]);
+    }
+
+    sim2048::OutcomeAccumulator left = parts[0];
+    left.merge(parts[1]);
+    left.merge(parts[2]);
+    sim2048::OutcomeAccumulator right = parts[1];
+    right.merge(parts[2]);
+    sim2048::OutcomeAccumulator grouped = parts[0];
+    grouped.merge(right);
+
+    REQUIRE(left == all);
+    REQUIRE(grouped == all);
+
+    const auto merged = left.summary();
+    const auto direct = sim2048::summarizeOutcomes(outcomes);
+    REQUIRE(merged.games == direct.games);
+    REQUIRE(merged.meanScore == direct.meanScore);
+    REQUIRE(merged.medianScore == direct.medianScore);
+    REQUIRE(merged.p99Score == direct.p99Score);
+    REQUIRE(merged.reach2048 == direct.reach2048);
+}
+
+TEST_CASE("shard files round-trip records and summary", "[shard]") {
+    const auto root = makeUniqueTempDirectory("roundtrip");
+    const auto path = root / "a.s2sr";
+
+    std::string error;
+    REQUIRE(sim2048::simulateShard("greedy", 10U, 8U, 300, path, error));
+    REQUIRE_FALSE(std::filesystem::exists(root / "a.s2sr.tmp"));
+
+    sim2048::ShardReader reader;
+    REQUIRE(reader.open(path, error));
+    REQUIRE(reader.info().policy == "greedy");
+    REQUIRE(reader.info().maxMoves == 300);
+    REQUIRE(reader.info().seeds == std::vector<sim2048::SeedRange>{{10U, 18U}});
+    REQUIRE(reader.summary().games() == 8U);
+
+    sim2048::ShardRecord record;
+    std::uint32_t expectedSeed = 10U;
+    while (reader.next(record, error)) {
+        auto policy = sim2048::makePolicy("greedy", expectedSeed);
+        const auto outcome = sim2048::playGame(*policy, expectedSeed, 300);
+        REQUIRE(record.seed == expectedSeed);
+        REQUIRE(record.outcome.score == outcome.score);
+        REQUIRE(record.outcome.maxTile == outcome.maxTile);
+        REQUIRE(record.outcome.moves == outcome.moves);
+        ++expectedSeed;
+    }
+    REQUIRE(error.empty());
+    REQUIRE(expectedSeed == 18U);
+
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("merged shards report the same as one unsharded run", "[shard]") {
+    const auto root = makeUniqueTempDirectory("merge");
+    std::string error;
+    REQUIRE(sim2048::simulateShard("corner", 1U, 5U, 500, root / "a.s2sr", error));
+    REQUIRE(sim2048::simulateShard("corner", 6U, 9U, 500, root / "b.s2sr", error));
+    REQUIRE(sim2048::simulateShard("corner", 15U, 6U, 500, root / "c.s2sr", error));
+    REQUIRE(sim2048::simulateShard("corner", 1U, 20U, 500, root / "all.s2sr", error));
+
+    sim2048::ShardInfo info;
+    sim2048::OutcomeAccumulator flat;
+    REQUIRE(sim2048::mergeShardFiles({root / "a.s2sr", root / "b.s2sr", root / "c.s2sr"}, {},
+                                     info, flat, error));
+
+    sim2048::OutcomeAccumulator nested;
+    REQUIRE(sim2048::mergeShardFiles({root / "b.s2sr", root / "c.s2sr"}, root / "bc.s2sr", info,
+                                     nested, error));
+    REQUIRE(sim2048::mergeShardFiles({root / "a.s2sr", root / "bc.s2sr"}, root / "abc.s2sr",
+                                     info, nested, error));
+
+    sim2048::OutcomeAccumulator single;
+    REQUIRE(sim2048::mergeShardFiles({root / "all.s2sr"}, {}, info, single, error));
+    REQUIRE(info.policy == "corner");
+    REQUIRE(flat == single);
+    REQUIRE(nested == single);
+
+    sim2048::ShardReader reader;
+    REQUIRE(reader.open(root / "abc.s2sr", error));
+    REQUIRE(reader.summary() == single);
+
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("shard merge rejects mismatched or truncated shards", "[shard]") {
+    const auto root = makeUniqueTempDirectory("reject");
+    std::string error;
+    REQUIRE(sim2048::simulateShard("corner", 1U, 3U, 500, root / "a.s2sr", error));
+    REQUIRE(sim2048::simulateShard("greedy", 4U, 3U, 500, root / "b.s2sr", error));
+
+    sim2048::ShardInfo info;
+    sim2048::OutcomeAccumulator merged;
+    REQUIRE_FALSE(sim2048::mergeShardFiles({root / "a.s2sr", root / "b.s2sr"}, {}, info, merged,
+                                           error));
+    REQUIRE(error.find("cannot be merged") != std::string::npos);
+
+    const auto size = std::filesystem::file_size(root / "a.s2sr");
+    std::filesystem::resize_file(root / "a.s2sr", size - 3U);
+    error.clear();
+    REQUIRE_FALSE(sim2048::mergeShardFiles({root / "a.s2sr"}, {}, info, merged, error));
+    REQUIRE(error.find("incomplete") != std::string::npos);
+
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("shard merge rejects overlapping seed ranges", "[shard]") {
+    const auto root = makeUniqueTempDirectory("overlap");
+    std::string error;
+    REQUIRE(sim2048::simulateShard("corner", 1U, 10U, 500, root / "a.s2sr", error));
+    REQUIRE(sim2048::simulateShard("corner", 5U, 10U, 500, root / "b.s2sr", error));
+    REQUIRE(sim2048::simulateShard("corner", 11U, 10U, 500, root / "c.s2sr", error));
+    REQUIRE(sim2048::simulateShard("corner", 40U, 5U, 500, root / "d.s2sr", error));
+
+    sim2048::ShardInfo info;
+    sim2048::OutcomeAccumulator merged;
+    REQUIRE_FALSE(sim2048::mergeShardFiles({root / "a.s2sr", root / "a.s2sr"}, {}, info, merged,
+                                           error));
+    REQUIRE(error.find("seeds 1..10 already in") != std::string::npos);
+
+    error.clear();
+    REQUIRE_FALSE(sim2048::mergeShardFiles({root / "c.s2sr", root / "b.s2sr"}, {}, info, merged,
+                                           error));
+    REQUIRE(error.find("seeds 11..14 already in") != std::string::npos);
+
+    error.clear();
+    REQUIRE(sim2048::mergeShardFiles({root / "d.s2sr", root / "c.s2sr", root / "a.s2sr"},
+                                     root / "acd.s2sr", info, merged, error));
+    REQUIRE(merged.games() == 25U);
+    REQUIRE(info.seeds == std::vector<sim2048::SeedRange>{{1U, 21U}, {40U, 45U}});
+
+    // A merged shard keeps its seeds, so merging it with one of its inputs is caught as well.
+    REQUIRE_FALSE(sim2048::mergeShardFiles({root / "acd.s2sr", root / "b.s2sr"}, {}, info,
+                                           merged, error));
+    REQUIRE(error.find("b.s2sr") != std::string::npos);
+
+    REQUIRE_FALSE(sim2048::simulateShard("corner", 4294967290U, 7U, 500, root / "e.s2sr", error));
+    REQUIRE(error.find("exceeds 32-bit seeds") != std::string::npos);
+    REQUIRE(sim2048::simulateShard("corner", 4294967290U, 6U, 500, root / "e.s2sr", error));
+
+    std::filesystem::remove_all(root);
+}
+
+namespace {
+
+sim2048::SeedSearchResult searchSeeds(const sim2048::SeedSearchConfig &config,
+                                      const std::atomic<bool> &cancel) {
+    sim2048::SeedSearchResult result;
+    std::string error;
+    const bool ok = sim2048::runSeedSearch(config, cancel, result, error);
+    INFO(error);
+    REQUIRE(ok);
+    return result;
+}
+
+std::vector<std::uint32_t> seedsOf(const sim2048::SeedSearchResult &result) {
+    std::vector<std::uint32_t> seeds;
+    for (const auto &match : result.matches) {
+        seeds.push_back(match.seed);
+    }
+    return seeds;
+}
+
+} // namespace
+
+TEST_CASE("seed predicates parse and print canonically", "[seed-search]") {
+    sim2048::SeedPredicate predicate;
+    std::string error;
+    REQUIRE(sim2048::parseSeedPredicate("reach:512", predicate, error));
+    REQUIRE(predicate.kind == sim2048::SeedPredicate::Kind::ReachTile);
+    REQUIRE(sim2048::describeSeedPredicate(predicate) == "reach:512");
+
+    const std::string opening = "opening:2,*,*,*,*,*,*,*,*,*,*,*,*,*,*,0";
+    REQUIRE(sim2048::parseSeedPredicate(opening, predicate, error));
+    REQUIRE(predicate.opening[0] == 2);
+    REQUIRE(predicate.opening[1] == -1);
+    REQUIRE(sim2048::describeSeedPredicate(predicate) == opening);
+
+    REQUIRE(sim2048::parseSeedPredicate("max-score", predicate, error));
+    REQUIRE_FALSE(sim2048::parseSeedPredicate("reach:100", predicate, error));
+    REQUIRE_FALSE(sim2048::parseSeedPredicate("opening:2,4", predicate, error));
+    REQUIRE_FALSE(sim2048::parseSeedPredicate("luck", predicate, error));
+}
+
+TEST_CASE("seed search finds the same seeds for any thread count", "[seed-search]") {
+    sim2048::SeedSearchConfig config;
+    std::string error;
+    REQUIRE(sim2048::parseSeedPredicate("reach:128", config.predicate, error));
+    config.seeds = {100, 220};
+    config.maxMoves = 150;
+    config.blockSize = 7;
+
+    const std::atomic<bool> cancel{false};
+    config.threads = 1;
+    const auto single = searchSeeds(config, cancel);
+    REQUIRE(single.completed);
+    REQUIRE(single.searched == 120U);
+    REQUIRE_FALSE(single.matches.empty());
+
+    std::vector<std::uint32_t> expected;
+    for (std::uint32_t seed = 100; seed < 220; ++seed) {
+        auto policy = sim2048::makePolicy("greedy", seed);
+        if (sim2048::playGame(*policy, seed, 150).maxTile >= 128) {
+            expected.push_back(seed);
+        }
+    }
+    REQUIRE(seedsOf(single) == expected);
+
+    config.threads = 4;
+    REQUIRE(seedsOf(searchSeeds(config, cancel)) == expected);
+
+    REQUIRE(expected.size() >= 2U);
+    config.limit = 2;
+    const auto limited = searchSeeds(config, cancel);
+    REQUIRE(limited.matches.size() == 2U);
+    for (const auto seed : seedsOf(limited)) {
+        REQUIRE(std::binary_search(expected.begin(), expected.end(), seed));
+    }
+
+    // One worker searches in seed order, so the matches it stops at are the lowest ones.
+    config.threads = 1;
+    REQUIRE(seedsOf(searchSeeds(config, cancel)) ==
+            std::vector<std::uint32_t>(expected.begin(), expected.begin() + 2));
+}
+
+TEST_CASE("seed search opening pattern matches the initial board", "[seed-search]") {
+    sim2048::SeedSearchConfig config;
+    std::string error;
+    REQUIRE(sim2048::parseSeedPredicate("opening:0,0,0,*,0,0,0,*,0,0,0,*,0,0,0,*",
+                                        config.predicate, error));
+    config.seeds = {0, 5000};
+    config.threads = 3;
+
+    const std::atomic<bool> cancel{false};
+    const auto result = searchSeeds(config, cancel);
+    REQUIRE(result.completed);
+    REQUIRE_FALSE(result.matches.empty());
+    for (const auto &match : result.matches) {
+        const Game game(match.seed);
+        for (const auto &row : game.getGrid()) {
+            REQUIRE(row[0] == 0);
+            REQUIRE(row[1] == 0);
+            REQUIRE(row[2] == 0);
+        }
+    }
+}
+
+TEST_CASE("cancelled seed search resumes from its checkpoint", "[seed-search]") {
+    const auto root = makeUniqueTempDirectory("seedsearch");
+    sim2048::SeedSearchConfig config;
+    std::string error;
+    REQUIRE(sim2048::parseSeedPredicate("max-score", config.predicate, error));
+    config.seeds = {1, 301};
+    config.maxMoves = 200;
+    config.blockSize = 5;
+    config.threads = 3;
+    config.limit = 4;
+    config.checkpointPath = root / "search.json";
+
+    const std::atomic<bool> noCancel{false};
+    sim2048::SeedSearchConfig full = config;
+    full.checkpointPath.clear();
+    const auto expected = searchSeeds(full, noCancel);
+    REQUIRE(expected.matches.size() == 4U);
+
+    // Cancelled before any block finishes: everything is still remaining.
+    const std::atomic<bool> cancelled{true};
+    const auto none = searchSeeds(config, cancelled);
+    REQUIRE_FALSE(none.completed);
+    REQUIRE(none.searched == 0U);
+
+    std::atomic<bool> cancel{false};
+    std::thread canceller([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        cancel.store(true);
+    });
+    config.resume = true;
+    const auto partial = searchSeeds(config, cancel);
+    canceller.join();
+    REQUIRE(partial.searched <= 300U);
+
+    const auto resumed = searchSeeds(config, noCancel);
+    REQUIRE(resumed.completed);
+    REQUIRE(resumed.searched == 300U);
+    REQUIRE(seedsOf(resumed) == seedsOf(expected));
+
+    config.maxMoves = 201;
+    sim2048::SeedSearchResult mismatch;
+    REQUIRE_FALSE(sim2048::runSeedSearch(config, noCancel, mismatch, error));
+    REQUIRE(error.find("max_moves") != std::string::npos);
+
+    std::filesystem::remove_all(root);
+}
+
+#if !defined(_WIN32)
+// Reads the checkpoint while it is being replaced, which Windows does not allow.
+TEST_CASE("seed search checkpoints account for every seed while workers steal",
+          "[seed-search][stress]") {
+    const auto root = makeUniqueTempDirectory("seedsearch_steal");
+    sim2048::SeedSearchConfig config;
+    std::string error;
+    REQUIRE(sim2048::parseSeedPredicate("reach:256", config.predicate, error));
+    config.seeds = {1, 4001};
+    config.maxMoves = 400;
+    config.blockSize = 1;
+    config.threads = 32;
+    config.checkpointPath = root / "search.json";
+    config.checkpointInterval = std::chrono::milliseconds(0);
+
+    const std::uint64_t total = config.seeds.end - config.seeds.begin;
+    std::size_t checked = 0;
+    for (int run = 0; run < 4; ++run) {
+        std::filesystem::remove(config.checkpointPath);
+        std::atomic<bool> done{false};
+        std::vector<std::uint64_t> unaccounted;
+        std::thread reader([&] {
+            std::string last;
+            while (!done.load()) {
+                std::ifstream in(config.checkpointPath);
+                std::stringstream text;
+                text << in.rdbuf();
+                if (text.str().empty() || text.str() == last) {
+                    continue;
+                }
+                last = text.str();
+                const auto checkpoint = nlohmann::json::parse(last);
+                std::uint64_t accounted = checkpoint["searched"].get<std::uint64_t>();
+                for (const auto &range : checkpoint["remaining"]) {
+                    accounted += range[1].get<std::uint64_t>() - range[0].get<std::uint64_t>();
+                }
+                unaccounted.push_back(total - accounted);
+            }
+        });
+
+        const std::atomic<bool> cancel{false};
+        const auto result = searchSeeds(config, cancel);
+        done.store(true);
+        reader.join();
+
+        REQUIRE(result.completed);
+        REQUIRE(result.searched == total);
+        REQUIRE(std::all_of(unaccounted.begin(), unaccounted.end(),
+                            [](const std::uint64_t missing) { return missing == 0U; }));
+        checked += unaccounted.size();
+    }
+    REQUIRE(checked > 0U);
+
+    std::filesystem::remove_all(root);
+}
+
+namespace {
+
+std::chrono::nanoseconds threadCpuTime() {
+    timespec now{};
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec);
+}
+
+} // namespace
+
+TEST_CASE("seed search coordinator sleeps without a progress callback", "[seed-search]") {
+    sim2048::SeedSearchConfig config;
+    std::string error;
+    REQUIRE(sim2048::parseSeedPredicate("max-score", config.predicate, error));
+    config.maxMoves = 200;
+    config.threads = 1;
+
+    // The calling thread only coordinates; past the first progress interval it must keep
+    // waiting instead of spinning until the worker is cancelled.
+    std::atomic<bool> cancel{false};
+    std::thread canceller([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+        cancel.store(true);
+    });
+    const auto cpuBefore = threadCpuTime();
+    const auto result = searchSeeds(config, cancel);
+    const auto coordinatorCpu = threadCpuTime() - cpuBefore;
+    canceller.join();
+
+    REQUIRE_FALSE(result.completed);
+    REQUIRE(result.searched > 0U);
+    REQUIRE(coordinatorCpu < std::chrono::milliseconds(100));
+}
+#endif
+
+namespace {
+
+// Straightforward recursive reference: every path through applyMove + every spawn.
+void naivePerft(const Game::Grid &grid, const int depth, const int ply,
+                std::vector<std::uint64_t> &paths, std::vector<std::set<Game::Grid>> &positions) {
+    ++paths[static_cast<std::size_t>(ply)];
+    positions[static_cast<std::size_t>(ply)].insert(grid);
+    if (ply == depth) {
+        return;
+    }
+    for (const auto direction : {core2048::Direction::Up, core2048::Direction::Down,
+                                 core2048::Direction::Left, core2048::Direction::Right}) {
+        Game game;
+        game.loadState(grid);
+        if (!game.applyMove(direction, false).moved) {
+            continue;
+        }
+        for (int cell = 0; cell < 16; ++cell) {
+            Game::Grid child = game.getGrid();
+            if (child[cell / 4][cell % 4] != 0) {
+                continue;
+            }
+            for (const int value : {2, 4}) {
+                child[cell / 4][cell % 4] = value;
+                naivePerft(child, depth, ply + 1, paths, positions);
+            }
+        }
+    }
+}
+
+const Game::Grid kPerftBoard = {
+    std::array<int, 4>{2, 2, 0, 0},
+    std::array<int, 4>{0, 0, 0, 0},
+    std::array<int, 4>{0, 0, 0, 0},
+    std::array<int, 4>{0, 0, 0, 4},
+};
+
+} // namespace
+
+TEST_CASE("perft matches a naive enumeration", "[perft]") {
+    constexpr int depth = 2;
+    std::vector<std::uint64_t> paths(depth + 1, 0U);
+    std::vector<std::set<Game::Grid>> positions(depth + 1);
+    naivePerft(kPerftBoard, depth, 0, paths, positions);
+
+    sim2048::PerftResult result;
+    std::string error;
+    REQUIRE(sim2048::runPerft(kPerftBoard, depth, 1, result, error));
+    REQUIRE(result.layers.size() == depth + 1U);
+    for (std::size_t ply = 0; ply <= depth; ++ply) {
+        REQUIRE(result.layers[ply].paths == paths[ply]);
+        REQUIRE(result.layers[ply].positions == positions[ply].size());
+    }
+}
+
+TEST_CASE("perft node counts are fixed and thread-independent", "[perft]") {
+    // Regression values for the move generator and spawn enumeration.
+    const std::array<sim2048::PerftLayer, 4> expected = {{
+        {1U, 1U},
+        {108U, 108U},
+        {10808U, 2492U},
+        {1037120U, 19166U},
+    }};
+
+    for (const unsigned int threads : {1U, 4U}) {
+        sim2048::PerftResult result;
+        std::string error;
+        REQUIRE(sim2048::runPerft(kPerftBoard, 3, threads, result, error));
+        for (std::size_t ply = 0; ply < expected.size(); ++ply) {
+            REQUIRE(result.layers[ply].paths == expected[ply].paths);
+            REQUIRE(result.layers[ply].positions == expected[ply].positions);
+        }
+        REQUIRE(result.generated > 0U);
+    }
+
+    Game::Grid huge = kPerftBoard;
+    huge[1][1] = 65536;
+    sim2048::PerftResult result;
+    std::string error;
+    REQUIRE_FALSE(sim2048::runPerft(huge, 1, 1, result, error));
+}
+
+namespace {
+
+using TinyGame = core2048::BasicGame<2>;
+
+// Plain memoized expectimax over the 2x2 game, without layers, symmetry or files.
+double naiveValue(const TinyGame::Grid &grid, std::map<TinyGame::Grid, double> &memo) {
+    if (const auto it = memo.find(grid); it != memo.end()) {
+        return it->second;
+    }
+    double best = 0.0;
+    for (const auto direction : {Direction::Up, Direction::Down, Direction::Left,
+                                 Direction::Right}) {
+        TinyGame::Grid moved = grid;
+        const auto move = TinyGame::slide(moved, direction);
+        if (!move.moved) {
+            continue;
+        }
+        double expectation = 0.0;
+        int empty = 0;
+        for (int cell = 0; cell < 4; ++cell) {
+            if (moved[cell / 2][cell % 2] != 0) {
+                continue;
+            }
+            auto child = moved;
+            child[cell / 2][cell % 2] = 2;
+            expectation += 0.9 * naiveValue(child, memo);
+            child[cell / 2][cell % 2] = 4;
+            expectation += 0.1 * naiveValue(child, memo);
+            ++empty;
+        }
+        best = std::max(best, move.scoreDelta + expectation / empty);
+    }
+    memo[grid] = best;
+    return best;
+}
+
+} // namespace
+
+TEST_CASE("2x2 solve matches a naive expectimax", "[solver]") {
+    const auto root = makeUniqueTempDirectory("solver");
+    sim2048::SolverConfig config;
+    config.directory = root;
+    config.threads = 2;
+    sim2048::SolverResult result;
+    std::string error;
+    const bool solved = sim2048::solveBoard<2>(config, result, error);
+    INFO(error);
+    REQUIRE(solved);
+    REQUIRE(result.completed);
+
+    sim2048::SolvedTable<2> table;
+    REQUIRE(table.open(root, error));
+
+    std::map<TinyGame::Grid, double> memo;
+    double expected = 0.0;
+    for (int first = 0; first < 4; ++first) {
+        for (int second = 0; second < 4; ++second) {
+            if (second == first) {
+                continue;
+            }
+            for (const int a : {2, 4}) {
+                for (const int b : {2, 4}) {
+                    TinyGame::Grid grid{};
+                    grid[first / 2][first % 2] = a;
+                    grid[second / 2][second % 2] = b;
+                    const double value = naiveValue(grid, memo);
+                    const auto solvedValue = table.value(grid);
+                    REQUIRE(solvedValue.has_value());
+                    REQUIRE(std::abs(*solvedValue - value) < 1e-9);
+                    expected += (a == 2 ? 0.9 : 0.1) * (b == 2 ? 0.9 : 0.1) / 12.0 * value;
+                }
+            }
+        }
+    }
+    REQUIRE(std::abs(result.expectedScore - expected) < 1e-9);
+    REQUIRE(std::abs(table.expectedScore() - expected) < 1e-9);
+
+    // Every position the naive search visited is in the table with the same value.
+    std::uint64_t reachable = 0;
+    for (const auto &[grid, value] : memo) {
+        const auto solvedValue = table.value(grid);
+        REQUIRE(solvedValue.has_value());
+        REQUIRE(std::abs(*solvedValue - value) < 1e-9);
+        ++reachable;
+    }
+    REQUIRE(result.totalStates <= reachable);
+    REQUIRE_FALSE(table.value(TinyGame::Grid{std::array<int, 2>{2, 0}, {0, 0}}).has_value());
+
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("interrupted solve resumes from its layer checkpoints", "[solver]") {
+    const auto reference = makeUniqueTempDirectory("solver_full");
+    const auto root = makeUniqueTempDirectory("solver_resume");
+    std::string error;
+
+    sim2048::SolverConfig config;
+    config.directory = reference;
+    config.threads = 1;
+    sim2048::SolverResult full;
+    REQUIRE(sim2048::solveBoard<2>(config, full, error));
+
+    config.directory = root;
+    config.threads = 3;
+    config.layerBudget = 2;
+    sim2048::SolverResult partial;
+    std::size_t runs = 0;
+    do {
+        REQUIRE(sim2048::solveBoard<2>(config, partial, error));
+        REQUIRE(++runs < 100U);
+        if (runs > 1U && !partial.completed) {
+            REQUIRE(partial.resumedSteps > 0U);
+        }
+    } while (!partial.completed);
+
+    REQUIRE(runs > 2U);
+    REQUIRE(partial.totalStates == full.totalStates);
+    REQUIRE(partial.layers.size() == full.layers.size());
+    REQUIRE(partial.expectedScore == full.expectedScore);
+
+    // A finished solve only reads its manifest.
+    sim2048::SolverResult again;
+    REQUIRE(sim2048::solveBoard<2>(config, again, error));
+    REQUIRE(again.completed);
+    REQUIRE(again.expectedScore == full.expectedScore);
+
+    config.directory = reference;
+    REQUIRE_FALSE(sim2048::solveBoard<3>(config, again, error));
+
+    std::filesystem::remove_all(reference);
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("exported training data replays every game move by move", "[training-data]") {
+    const auto root = makeUniqueTempDirectory("export");
+    sim2048::TrainingExportConfig config;
+    config.policy = "greedy";
+    config.firstSeed = 500;
+    config.games = 12;
+    config.maxMoves = 150;
+    config.threads = 3;
+    // Small chunks so games span chunks and producers wait on the writer.
+    config.chunkSamples = 97;
+    config.output = root / "games.s2td";
+
+    sim2048::TrainingExportResult result;
+    std::string error;
+    const bool exported = sim2048::exportTrainingData(config, result, error);
+    INFO(error);
+    REQUIRE(exported);
+    REQUIRE(result.games == config.games);
+    REQUIRE_FALSE(std::filesystem::exists(root / "games.s2td.tmp"));
+
+    sim2048::TrainingReader reader;
+    REQUIRE(reader.open(config.output, error));
+    REQUIRE(reader.policy() == "greedy");
+    REQUIRE(reader.samples() == result.writer.samples);
+    REQUIRE(reader.chunkCount() == result.writer.chunks);
+    REQUIRE(reader.chunkCount() > 1U);
+
+    std::vector<sim2048::TrainingSample> samples;
+    for (std::size_t c = 0; c < reader.chunkCount(); ++c) {
+        const auto chunk = reader.chunk(c);
+        REQUIRE(chunk.size() <= config.chunkSamples);
+        for (std::size_t i = 0; i < chunk.size(); ++i) {
+            samples.push_back(chunk.sample(i));
+        }
+    }
+    REQUIRE(samples.size() == reader.samples());
+
+    // Each game is one contiguous run that replays exactly.
+    std::set<std::uint32_t> seen;
+    for (std::size_t begin = 0; begin < samples.size();) {
+        const std::uint32_t seed = samples[begin].game;
+        REQUIRE(seen.insert(seed).second);
+
+        const auto bot = sim2048::makePolicy(config.policy, seed);
+        const auto outcome = sim2048::playGame(*bot, seed, config.maxMoves);
+        Game game(seed);
+        std::size_t i = begin;
+        for (; i < samples.size() && samples[i].game == seed; ++i) {
+            const auto &sample = samples[i];
+            REQUIRE(sample.board == core2048::packBoard(game.getGrid()));
+            REQUIRE((sample.legalMask & (1U << sample.move)) != 0U);
+            const auto move = game.applyMove(static_cast<Direction>(sample.move));
+            REQUIRE(sample.reward == static_cast<std::uint32_t>(move.scoreDelta));
+            REQUIRE(sample.outcome == static_cast<std::uint32_t>(outcome.score));
+            REQUIRE(sample.finalTile == sim2048::tileExponent(outcome.maxTile));
+        }
+        REQUIRE(i - begin == static_cast<std::size_t>(outcome.moves));
+        begin = i;
+    }
+    REQUIRE(seen.size() == config.games);
+
+    // A truncated file has no valid trailer.
+    const auto size = std::filesystem::file_size(config.output);
+    std::filesystem::resize_file(config.output, size - 3U);
+    sim2048::TrainingReader truncated;
+    REQUIRE_FALSE(truncated.open(config.output, error));
+
+    config.policy = "nope";
+    REQUIRE_FALSE(sim2048::exportTrainingData(config, result, error));
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("replay analytics are exact and thread-independent", "[replay-analytics]") {
+    const auto root = makeUniqueTempDirectory("analytics");
+    sim2048::TrainingExportConfig config;
+    config.policy = "corner";
+    config.games = 9;
+    config.maxMoves = 400;
+    config.threads = 2;
+    config.chunkSamples = 128;
+    std::string error;
+    sim2048::TrainingExportResult exported;
+    for (const std::uint32_t firstSeed : {0U, 100U}) {
+        config.firstSeed = firstSeed;
+        config.output = root / ("games" + std::to_string(firstSeed) + ".s2td");
+        REQUIRE(sim2048::exportTrainingData(config, exported, error));
+    }
+
+    // Reference: replay each game directly through applyMove.
+    sim2048::ReplayAccumulator expected;
+    for (const std::uint32_t firstSeed : {0U, 100U}) {
+        for (std::uint32_t seed = firstSeed; seed < firstSeed + config.games; ++seed) {
+            const auto bot = sim2048::makePolicy(config.policy, seed);
+            Game game(seed);
+            sim2048::GameAnalytics analytics;
+            analytics.seed = seed;
+            while (analytics.outcome.moves < config.maxMoves) {
+                const auto direction = bot->chooseMove(game.getGrid());
+                if (!direction.has_value()) {
+                    break;
+                }
+                int maxTile = 0;
+                for (const auto &row : game.getGrid()) {
+                    maxTile = std::max(maxTile, *std::max_element(row.begin(), row.end()));
+                }
+                const auto &grid = game.getGrid();
+                const bool corner = grid[0][0] == maxTile || grid[0][3] == maxTile ||
+                                    grid[3][0] == maxTile || grid[3][3] == maxTile;
+                analytics.cornerMoves += corner ? 1U : 0U;
+                ++analytics.moveCounts[static_cast<std::size_t>(sim2048::boardPhaseOf(maxTile))]
+                                      [static_cast<std::size_t>(*direction)];
+                const auto move = game.applyMove(*direction);
+                ++analytics.outcome.moves;
+                analytics.merges += static_cast<std::uint64_t>(move.mergeCount);
+                for (std::size_t m = 0; m < sim2048::kMilestoneTiles.size(); ++m) {
+                    if (!analytics.milestoneMoves[m].has_value() &&
+                        move.maxMergedValue >= sim2048::kMilestoneTiles[m]) {
+                        analytics.milestoneMoves[m] = analytics.outcome.moves;
+                    }
+                }
+            }
+            analytics.outcome.score = game.getScore();
+            const auto outcome = sim2048::playGame(*sim2048::makePolicy(config.policy, seed),
+                                                   seed, config.maxMoves);
+            analytics.outcome.maxTile = outcome.maxTile;
+            expected.add(analytics);
+        }
+    }
+
+    for (const unsigned int threads : {1U, 4U}) {
+        sim2048::ReplayAnalyticsConfig analyticsConfig;
+        analyticsConfig.inputs = {root};
+        analyticsConfig.threads = threads;
+        analyticsConfig.perGame = true;
+        sim2048::ReplayAnalyticsResult result;
+        const bool analyzed = sim2048::analyzeReplays(analyticsConfig, result, error);
+        INFO(error);
+        REQUIRE(analyzed);
+        REQUIRE(result.files.size() == 2U);
+        REQUIRE(result.games.size() == 2U * config.games);
+        REQUIRE(result.total == expected);
+    }
+
+    sim2048::ReplayAnalyticsConfig empty;
+    empty.inputs = {root / "missing"};
+    sim2048::ReplayAnalyticsResult result;
+    REQUIRE_FALSE(sim2048::analyzeReplays(empty, result, error));
+    std::filesystem::remove_all(root);
+}
+
+TEST_CASE("differential check agrees with the reference and shrinks a planted bug",
+          "[diffcheck]") {
+    sim2048::DiffCheckConfig config;
+    config.moves = 20'000;
+    config.threads = 2;
+    sim2048::DiffCheckResult result;
+    std::string error;
+    REQUIRE(sim2048::runDifferentialCheck(config, result, error));
+    REQUIRE_FALSE(result.mismatch.has_value());
+    REQUIRE(result.cases == (config.moves + 255U) / 256U);
+    REQUIRE(result.moves == result.cases * 256U);
+
+    // Miscounts the score of merges into 1024 and nothing else.
+    config.engine = [](Game &game, const core2048::Direction direction) {
+        auto moveResult = game.applyMove(direction);
+        if (moveResult.maxMergedValue == 1024) {
+            --moveResult.scoreDelta;
+        }
+        return moveResult;
+    };
+    std::optional<sim2048::DiffMismatch> firstFailure;
+    for (const unsigned int threads : {1U, 4U}) {
+        config.threads = threads;
+        REQUIRE(sim2048::runDifferentialCheck(config, result, error));
+        REQUIRE(result.mismatch.has_value());
+        REQUIRE(result.mismatch->field == "score_delta");
+        if (firstFailure.has_value()) {
+            REQUIRE(result.mismatch->seed == firstFailure->seed);
+            REQUIRE(result.mismatch->moves == firstFailure->moves);
+        }
+        firstFailure = result.mismatch;
+
+        // The minimal board is the two 512 tiles that merge.
+        REQUIRE(result.shrunk.has_value());
+        REQUIRE(result.shrunk->moves.size() == 1U);
+        std::vector<int> tiles;
+        for (const auto &row : result.shrunk->start) {
+            std::copy_if(row.begin(), row.end(), std::back_inserter(tiles),
+                         [](const int value) { return value != 0; });
+        }
+        REQUIRE(tiles == std::vector<int>{512, 512});
+        REQUIRE(sim2048::replayDifferential(config.engine, result.shrunk->seed,
+                                            result.shrunk->start, result.shrunk->moves)
+                    .has_value());
+    }
+}
+
+TEST_CASE("perf baselines round-trip and compare within their noise", "[perf-check]") {
+    REQUIRE(sim2048::medianOf({3.0, 1.0, 2.0}) == 2.0);
+    REQUIRE(sim2048::medianOf({4.0, 1.0, 3.0, 2.0}) == 2.5);
+    REQUIRE(sim2048::relativeNoise({100.0, 100.0, 100.0}, 100.0) == 0.0);
+    // Deviations 0, 10 and 10: the median deviation is 10% of the median.
+    REQUIRE(std::abs(sim2048::relativeNoise({90.0, 100.0, 110.0}, 100.0) - 0.14826) < 1e-9);
+
+    const sim2048::PerfBenchmark counter{"counter", [] { return std::uint64_t{1000}; }};
+    sim2048::PerfRunConfig runConfig;
+    runConfig.repetitions = 3;
+    runConfig.sampleTime = std::chrono::milliseconds(2);
+    std::uint64_t rounds = 0;
+    const auto measured = sim2048::measureBenchmarks(
+        {counter}, runConfig, [&](const std::uint64_t done, std::uint64_t) { rounds = done; });
+    REQUIRE(measured.size() == 1U);
+    REQUIRE(measured[0].samples.size() == 3U);
+    REQUIRE(measured[0].median > 0.0);
+    REQUIRE(rounds == 3U);
+
+    sim2048::PerfBaseline baseline;
+    baseline.buildType = "Release";
+    baseline.compiler = "test";
+    baseline.benchmarks = {{"calibration", 1000.0, 0.01, {}},
+                           {"quiet", 100.0, 0.01, {}},
+                           {"noisy", 100.0, 0.10, {}},
+                           {"dropped", 50.0, 0.0, {}}};
+    const auto directory = makeUniqueTempDirectory("perf");
+    const auto path = directory / "baseline.json";
+    std::string error;
+    REQUIRE(sim2048::savePerfBaseline(path, baseline, error));
+    sim2048::PerfBaseline loaded;
+    REQUIRE(sim2048::loadPerfBaseline(path, loaded, error));
+    REQUIRE(loaded.buildType == "Release");
+    REQUIRE(loaded.benchmarks.size() == 4U);
+    REQUIRE(loaded.benchmarks[1].name == "quiet");
+    REQUIRE(loaded.benchmarks[2].noise == 0.10);
+
+    // The machine runs at half speed: the calibration halves, so 48 is within 10% of 50.
+    const std::vector<sim2048::PerfMeasurement> current = {{"calibration", 500.0, 0.01, {}},
+                                                           {"quiet", 48.0, 0.01, {}},
+                                                           {"noisy", 40.0, 0.01, {}},
+                                                           {"added", 7.0, 0.0, {}}};
+    sim2048::PerfCompareConfig compareConfig;
+    compareConfig.calibration = "calibration";
+    auto comparisons = sim2048::comparePerf(loaded, current, compareConfig);
+    REQUIRE(comparisons.size() == 4U);
+    REQUIRE(comparisons[0].name == "quiet");
+    REQUIRE(comparisons[0].status == sim2048::PerfComparison::Status::Ok);
+    REQUIRE(comparisons[0].expected == 50.0);
+    // 20% slower, but its baseline scattered by 10%, which allows 30%.
+    REQUIRE(comparisons[1].status == sim2048::PerfComparison::Status::Ok);
+    REQUIRE(std::abs(comparisons[1].allowed - 0.30) < 1e-9);
+    REQUIRE(comparisons[2].status == sim2048::PerfComparison::Status::Missing);
+    REQUIRE(comparisons[3].status == sim2048::PerfComparison::Status::New);
+    REQUIRE_FALSE(sim2048::hasRegression(comparisons));
+
+    compareConfig.calibration.clear();
+    comparisons = sim2048::comparePerf(loaded, current, compareConfig);
+    REQUIRE(comparisons[0].name == "calibration");
+    REQUIRE(comparisons[0].status == sim2048::PerfComparison::Status::Regressed);
+    REQUIRE(comparisons[1].status == sim2048::PerfComparison::Status::Regressed);
+    REQUIRE(sim2048::hasRegression(comparisons));
+    const std::string table = sim2048::formatPerfComparison(comparisons);
+    REQUIRE(countLines(table, "REGRESSED") == 3U);
+    REQUIRE(countLines(table, "-52.0%") == 1U);
+
+    std::ofstream(path, std::ios::trunc) << "{\"version\": 99, \"benchmarks\": {}}";
+    REQUIRE_FALSE(sim2048::loadPerfBaseline(path, loaded, error));
+    REQUIRE(error.find("version") != std::string::npos);
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("hardware counters report per operation or nothing at all", "[hardware-counters]") {
+    sim2048::HardwareCounts counts;
+    counts.values[0] = 2000.0;
+    counts.values[1] = 5000.0;
+    counts.values[4] = 10.0;
+    REQUIRE(counts.ipc() == 2.5);
+    const auto perMove = counts.per(1000);
+    REQUIRE(perMove[sim2048::HardwareEvent::Cycles] == 2.0);
+    REQUIRE(perMove[sim2048::HardwareEvent::BranchMisses] == 0.01);
+    REQUIRE_FALSE(perMove[sim2048::HardwareEvent::L1dMisses].has_value());
+    REQUIRE(perMove.ipc() == 2.5);
+
+    const std::string table = sim2048::formatHardwareCounts({{"move", perMove}});
+    REQUIRE(table.find("LLC misses") != std::string::npos);
+    REQUIRE(table.find("move") != std::string::npos);
+    REQUIRE(table.find("2.000") != std::string::npos);
+    REQUIRE(table.find("2.500") != std::string::npos);
+    REQUIRE(table.find('-') != std::string::npos);
+
+    // Many containers and VMs grant no counters; then every count stays empty.
+    sim2048::HardwareCounters counters;
+    std::string error;
+    const auto playMoves = [] {
+        core2048::Game game(7U);
+        for (int i = 0; i < 64; ++i) {
+            game.applyMove(static_cast<Direction>(i % 4));
+        }
+        return std::uint64_t{64};
+    };
+    const sim2048::PerfBenchmark moves{"moves", playMoves};
+    const bool opened = counters.open(error);
+    const auto measured =
+        sim2048::countPerOperation(counters, moves, std::chrono::milliseconds(2));
+    if (opened) {
+        REQUIRE(counters.isOpen());
+        if (counters.has(sim2048::HardwareEvent::Instructions)) {
+            REQUIRE(measured[sim2048::HardwareEvent::Instructions].value_or(0.0) > 0.0);
+        }
+    } else {
+        REQUIRE_FALSE(error.empty());
+        REQUIRE_FALSE(counters.isOpen());
+        REQUIRE(std::none_of(measured.values.begin(), measured.values.end(),
+                             [](const std::optional<double> &value) { return value.has_value(); }));
+    }
+}